@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2016, 2019, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2016, 2019, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -24,11 +24,21 @@
 #endif /* HAVE_CONFIG_H */
 
 #include "cachecontrol.hh"
+#include "lru_pool_allocator.hh"
 
 LRU::CacheControl::~CacheControl()
 {
     disable_garbage_collection();
 
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(sources_lock_);
+
+    if(timeout_source_id_ != 0)
+        g_source_remove(timeout_source_id_);
+
+    if(idle_source_id_ != 0)
+        g_source_remove(idle_source_id_);
+
     if(loop_ != NULL)
         g_main_loop_unref(loop_);
 }
@@ -38,7 +48,17 @@ static gboolean trampoline(gpointer user_data)
     auto ctrl = static_cast<LRU::CacheControl *>(user_data);
     msg_log_assert(ctrl != nullptr);
 
-    ctrl->trigger_gc();
+    ctrl->timeout_expired();
+
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean trampoline_next_slice(gpointer user_data)
+{
+    auto ctrl = static_cast<LRU::CacheControl *>(user_data);
+    msg_log_assert(ctrl != nullptr);
+
+    ctrl->continue_gc();
 
     return G_SOURCE_REMOVE;
 }
@@ -47,24 +67,85 @@ void LRU::CacheControl::trigger_gc()
 {
     msg_log_assert(loop_ != NULL);
 
-    msg_info("Garbage collection triggered");
+    if(schedule_next_slice())
+        msg_info("Garbage collection triggered");
+}
+
+void LRU::CacheControl::timeout_expired()
+{
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(sources_lock_);
+        timeout_source_id_ = 0;
+    }
+
+    msg_info("Garbage collection timeout expired");
     gc_and_set_timeout();
     msg_info("Garbage collection done");
+
+    LRU::PoolRegistry::get_singleton().log_statistics(MESSAGE_LEVEL_DIAG);
+}
+
+void LRU::CacheControl::continue_gc()
+{
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(sources_lock_);
+        idle_source_id_ = 0;
+    }
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Garbage collection continued");
+    gc_and_set_timeout();
 }
 
 void LRU::CacheControl::gc_and_set_timeout()
 {
-    timeout_source_id_ = 0;
-    timeout_source_ = NULL;
+    if(!is_enabled_)
+    {
+        msg_info("Garbage collection disabled");
+        return;
+    }
 
-    if(is_enabled_)
-        set_timeout(cache_.gc());
+    bool is_incomplete;
+    const auto next_call = cache_.gc(slice_budget_, is_incomplete);
+
+    if(is_incomplete)
+        schedule_next_slice();
     else
-        msg_info("Garbage collection disabled");
+        set_timeout(next_call);
+}
+
+bool LRU::CacheControl::schedule_next_slice()
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(sources_lock_);
+
+    if(idle_source_id_ != 0)
+        return false;
+
+    GSource *idle_source = g_idle_source_new();
+    msg_log_assert(idle_source != NULL);
+
+    g_source_set_callback(idle_source, trampoline_next_slice, this, NULL);
+    idle_source_id_ = g_source_attach(idle_source, NULL);
+    g_source_unref(idle_source);
+
+    return true;
 }
 
 void LRU::CacheControl::set_timeout(std::chrono::seconds timeout)
 {
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(sources_lock_);
+
+    /* garbage may have been collected before the timeout has expired, in
+     * which case the timeout is programmed anew */
+    if(timeout_source_id_ != 0)
+    {
+        g_source_remove(timeout_source_id_);
+        timeout_source_id_ = 0;
+    }
+
     if(timeout == std::chrono::seconds::max())
         return;
 
@@ -84,11 +165,12 @@ void LRU::CacheControl::set_timeout(std::chrono::seconds timeout)
 
     msg_info("Garbage collection timeout %u ms", source_timeout_ms);
 
-    timeout_source_ = g_timeout_source_new(source_timeout_ms);
-    msg_log_assert(timeout_source_ != NULL);
+    GSource *timeout_source = g_timeout_source_new(source_timeout_ms);
+    msg_log_assert(timeout_source != NULL);
 
-    g_source_set_callback(timeout_source_, trampoline, this, NULL);
-    timeout_source_id_ = g_source_attach(timeout_source_, NULL);
+    g_source_set_callback(timeout_source, trampoline, this, NULL);
+    timeout_source_id_ = g_source_attach(timeout_source, NULL);
+    g_source_unref(timeout_source);
 }
 
 void LRU::CacheControl::enable_garbage_collection()
@@ -97,8 +179,16 @@ void LRU::CacheControl::enable_garbage_collection()
 
     is_enabled_ = true;
 
-    if(timeout_source_id_ == 0)
-        gc_and_set_timeout();
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(sources_lock_);
+
+        if(timeout_source_id_ != 0)
+            return;
+    }
+
+    /* the first garbage collection programs the timeout */
+    trigger_gc();
 }
 
 void LRU::CacheControl::disable_garbage_collection()
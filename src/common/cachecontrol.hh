@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2019, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2019, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -24,7 +24,10 @@
 
 #include <glib.h>
 
+#include <atomic>
+
 #include "lru.hh"
+#include "logged_lock.hh"
 
 namespace LRU
 {
@@ -35,39 +38,93 @@ namespace LRU
  * This class registers a timeout signal with the given GLib main loop and uses
  * the return value of #LRU::Cache::gc() to program that timeout. When the
  * timeout expires, the garbage collector is started.
+ *
+ * Garbage collection is done in slices of limited duration so that D-Bus
+ * requests are not blocked for long while many objects are discarded. In case
+ * a slice cannot complete its work, the next slice is scheduled from an idle
+ * source, and so on until the low watermarks are reached. Only then the
+ * timeout is programmed again.
+ *
+ * Garbage collection always runs in the context of the main loop. The cache
+ * may request garbage collection from any thread (see
+ * #LRU::CacheControl::trigger_gc()), in which case an idle source is added
+ * unless one is pending already. Idle sources may be starved by a busy main
+ * loop, so only work for soft limits is deferred this way; the cache enforces
+ * its hard limits by itself before requesting garbage collection.
  */
 class CacheControl
 {
   private:
     LRU::Cache &cache_;
     GMainLoop *const loop_;
-    GSource *timeout_source_;
+
+    /*!
+     * Protects the source IDs, which are set from any thread.
+     */
+    LoggedLock::Mutex sources_lock_;
     guint timeout_source_id_;
-    bool is_enabled_;
+    guint idle_source_id_;
+
+    std::atomic<bool> is_enabled_;
+
+    /*!
+     * Limits for each slice of garbage collection.
+     */
+    const GCBudget slice_budget_;
 
   public:
+    static constexpr size_t GC_SLICE_MAX_DISCARDS = 200;
+    static constexpr std::chrono::milliseconds GC_SLICE_MAX_DURATION{10};
+
     CacheControl(const CacheControl &) = delete;
     CacheControl &operator=(const CacheControl &) = delete;
 
     explicit CacheControl(Cache &cache, GMainLoop *loop):
         cache_(cache),
         loop_(loop),
-        timeout_source_(NULL),
         timeout_source_id_(0),
-        is_enabled_(false)
+        idle_source_id_(0),
+        is_enabled_(false),
+        slice_budget_(GC_SLICE_MAX_DISCARDS, GC_SLICE_MAX_DURATION)
     {
+        LoggedLock::configure(sources_lock_, "CacheControl::sources_lock_",
+                              MESSAGE_LEVEL_DEBUG);
         g_main_loop_ref(loop);
     }
 
     ~CacheControl();
 
+    /*!
+     * Enable garbage collection, may be called from any thread.
+     */
     void enable_garbage_collection();
+
+    /*!
+     * Disable garbage collection, may be called from any thread.
+     */
     void disable_garbage_collection();
 
+    /*!
+     * Request garbage collection, may be called from any thread.
+     *
+     * Garbage is collected from an idle source in the main loop. Nothing
+     * happens if a slice of garbage collection is pending already.
+     */
     void trigger_gc();
 
+    /*!
+     * Called by the timeout source in the main loop.
+     */
+    void timeout_expired();
+
+    /*!
+     * Called by the idle source in the main loop.
+     */
+    void continue_gc();
+
   private:
     void set_timeout(std::chrono::seconds timeout);
+    bool schedule_next_slice();
     void gc_and_set_timeout();
 };
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2016, 2017, 2019, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2016, 2017, 2019, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -27,6 +27,8 @@
 #include "dbus_common.h"
 #include "messages_dbus.h"
 #include "gerrorwrapper.hh"
+#include "lru_statistics.hh"
+#include "messages.h"
 
 struct dbus_debug_levels_data_t
 {
@@ -34,8 +36,128 @@ struct dbus_debug_levels_data_t
 
     tdbusdebugLogging *debug_logging_iface;
     tdbusdebugLoggingConfig *debug_logging_config_proxy;
+
+    GDBusConnection *statistics_connection;
+    GDBusNodeInfo *statistics_node_info;
+    guint statistics_registration_id;
 };
 
+/*!
+ * Cache statistics for debugging and tuning.
+ *
+ * This interface is not part of the generated Tahifi debug interfaces, so it
+ * is registered manually on the object path of the debug logging interface.
+ *
+ * Counters are returned as a dictionary of event counts since program start.
+ * Histograms are returned as a dictionary of arrays of pairs of upper bucket
+ * bound in microseconds (exclusive) and the number of durations in that
+ * bucket. Empty buckets are omitted.
+ */
+static const char statistics_introspection_xml[] =
+    "<node>"
+    "  <interface name='de.tahifi.Debug.Statistics'>"
+    "    <method name='GetCacheStatistics'>"
+    "      <arg name='counters' type='a{st}' direction='out'/>"
+    "      <arg name='histograms' type='a{sa(tt)}' direction='out'/>"
+    "    </method>"
+    "    <method name='ResetCacheStatistics'/>"
+    "  </interface>"
+    "</node>";
+
+static GVariant *get_cache_statistics()
+{
+    const auto &stats(LRU::Statistics::get_singleton());
+
+    GVariantBuilder counters;
+    g_variant_builder_init(&counters, G_VARIANT_TYPE("a{st}"));
+
+    for(size_t i = 0; i < LRU::Statistics::NUMBER_OF_COUNTERS; ++i)
+    {
+        const auto c = LRU::Statistics::Counter(i);
+        g_variant_builder_add(&counters, "{st}",
+                              LRU::Statistics::get_name(c), stats.get(c));
+    }
+
+    GVariantBuilder histograms;
+    g_variant_builder_init(&histograms, G_VARIANT_TYPE("a{sa(tt)}"));
+
+    LRU::Statistics::Buckets buckets;
+
+    for(size_t i = 0; i < LRU::Statistics::NUMBER_OF_HISTOGRAMS; ++i)
+    {
+        const auto h = LRU::Statistics::Histogram(i);
+        stats.get(h, buckets);
+
+        GVariantBuilder histogram;
+        g_variant_builder_init(&histogram, G_VARIANT_TYPE("a(tt)"));
+
+        for(size_t b = 0; b < buckets.size(); ++b)
+            if(buckets[b] > 0)
+                g_variant_builder_add(&histogram, "(tt)",
+                                      LRU::Statistics::get_bucket_upper_bound(b),
+                                      buckets[b]);
+
+        g_variant_builder_add(&histograms, "{sa(tt)}",
+                              LRU::Statistics::get_name(h), &histogram);
+    }
+
+    return g_variant_new("(a{st}a{sa(tt)})", &counters, &histograms);
+}
+
+static void handle_statistics_method_call(GDBusConnection *connection,
+                                          const gchar *sender,
+                                          const gchar *object_path,
+                                          const gchar *interface_name,
+                                          const gchar *method_name,
+                                          GVariant *parameters,
+                                          GDBusMethodInvocation *invocation,
+                                          gpointer user_data)
+{
+    if(g_strcmp0(method_name, "GetCacheStatistics") == 0)
+        g_dbus_method_invocation_return_value(invocation, get_cache_statistics());
+    else if(g_strcmp0(method_name, "ResetCacheStatistics") == 0)
+    {
+        msg_info("Resetting cache statistics");
+        LRU::Statistics::get_singleton().reset();
+        g_dbus_method_invocation_return_value(invocation, NULL);
+    }
+    else
+        g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR,
+                                              G_DBUS_ERROR_UNKNOWN_METHOD,
+                                              "Unknown method %s", method_name);
+}
+
+static const GDBusInterfaceVTable statistics_vtable =
+{
+    handle_statistics_method_call,
+    NULL,
+    NULL,
+    {},
+};
+
+static void export_statistics(GDBusConnection *connection,
+                              dbus_debug_levels_data_t *data)
+{
+    GErrorWrapper error;
+
+    data->statistics_node_info =
+        g_dbus_node_info_new_for_xml(statistics_introspection_xml, error.await());
+
+    if(error.log_failure("Parse statistics interface"))
+        return;
+
+    data->statistics_registration_id =
+        g_dbus_connection_register_object(connection, data->dbus_object_path,
+                                          data->statistics_node_info->interfaces[0],
+                                          &statistics_vtable, data, NULL,
+                                          error.await());
+
+    if(error.log_failure("Export statistics interface"))
+        data->statistics_registration_id = 0;
+    else
+        data->statistics_connection = G_DBUS_CONNECTION(g_object_ref(connection));
+}
+
 static void export_self(GDBusConnection *connection, const gchar *name,
                         bool is_session_bus, gpointer user_data)
 {
@@ -49,6 +171,8 @@ static void export_self(GDBusConnection *connection, const gchar *name,
     dbus_common_try_export_iface(connection,
                                  G_DBUS_INTERFACE_SKELETON(data->debug_logging_iface),
                                  data->dbus_object_path);
+
+    export_statistics(connection, data);
 }
 
 static void created_debug_config_proxy(GObject *source_object, GAsyncResult *res,
@@ -86,6 +210,16 @@ static void shutdown_dbus(bool is_session_bus, gpointer user_data)
 
     if(data->debug_logging_config_proxy != NULL)
         g_object_unref(data->debug_logging_config_proxy);
+
+    if(data->statistics_connection != NULL)
+    {
+        g_dbus_connection_unregister_object(data->statistics_connection,
+                                            data->statistics_registration_id);
+        g_object_unref(data->statistics_connection);
+    }
+
+    if(data->statistics_node_info != NULL)
+        g_dbus_node_info_unref(data->statistics_node_info);
 }
 
 static dbus_debug_levels_data_t dbus_debug_levels_data;
@@ -96,6 +230,9 @@ void DBusDebugLevels::dbus_setup(bool connect_to_session_bus,
     dbus_debug_levels_data.dbus_object_path = dbus_object_path;
     dbus_debug_levels_data.debug_logging_iface = NULL;
     dbus_debug_levels_data.debug_logging_config_proxy = NULL;
+    dbus_debug_levels_data.statistics_connection = NULL;
+    dbus_debug_levels_data.statistics_node_info = NULL;
+    dbus_debug_levels_data.statistics_registration_id = 0;
 
     const struct dbus_register_submodule_t self =
     {
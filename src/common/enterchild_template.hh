@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2019, 2021, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2019, 2021, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -118,7 +118,7 @@ ID::List enter_child_template(ContainingListType *const this_ptr,
     try
     {
         ChildListItemType &child_entry = (*this_ptr)[item];
-        const auto cached_child_id = child_entry.get_child_list();
+        const auto cached_child_id = this_ptr->lookup_child_list(item);
 
         if(use_cached(cached_child_id))
         {
@@ -127,10 +127,10 @@ ID::List enter_child_template(ContainingListType *const this_ptr,
         }
 
         return purge_list(cached_child_id, add_to_cache(child_entry),
-                          [&child_entry, &error] (ID::List old_id, ID::List new_id)
+                          [this_ptr, item, &error] (ID::List old_id, ID::List new_id)
                           {
                               if(new_id.is_valid() || error != ListError::INVALID_ID)
-                                  child_entry.set_child_list(new_id);
+                                  this_ptr->link_child_list(item, new_id);
                           });
     }
     catch(const ListIterException &e)
@@ -142,6 +142,56 @@ ID::List enter_child_template(ContainingListType *const this_ptr,
     }
 }
 
+/*!
+ * Generic implementation of entering child list without touching the item.
+ *
+ * Same as #EnterChild::enter_child_template(), but the child item is not
+ * materialized. This is for lists which keep the data required for creating
+ * the child list outside of their items, so that entering a child does not
+ * move their tiles around. The \p add_to_cache function is responsible for
+ * checking whether or not the item may be entered.
+ */
+template <typename ContainingListType>
+ID::List enter_child_by_index_template(ContainingListType *const this_ptr,
+                                       LRU::Cache &cache, ID::Item item,
+                                       const std::function<bool()> &may_continue,
+                                       const EnterChild::CheckUseCached &use_cached,
+                                       const EnterChild::DoPurgeList &purge_list,
+                                       ListError &error,
+                                       const std::function<ID::List()> &add_to_cache)
+{
+    if(!may_continue())
+    {
+        error = ListError::INTERRUPTED;
+        return ID::List();
+    }
+
+    error = ListError::OK;
+
+    msg_log_assert(cache.lookup(this_ptr->get_cache_id()) != nullptr);
+
+    if(item.get_raw_id() >= this_ptr->size())
+    {
+        error = ListError::INVALID_ID;
+        return ID::List();
+    }
+
+    const auto cached_child_id = this_ptr->lookup_child_list(item);
+
+    if(use_cached(cached_child_id))
+    {
+        msg_log_assert(cached_child_id.is_valid());
+        return cached_child_id;
+    }
+
+    return purge_list(cached_child_id, add_to_cache(),
+                      [this_ptr, item, &error] (ID::List old_id, ID::List new_id)
+                      {
+                          if(new_id.is_valid() || error != ListError::INVALID_ID)
+                              this_ptr->link_child_list(item, new_id);
+                      });
+}
+
 }
 
 #endif /* !ENTERCHILD_TEMPLATE_HH */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -24,9 +24,14 @@
 
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <mutex>
+#include <unordered_map>
 
 #include "lists_base.hh"
 #include "lru.hh"
+#include "lru_pool_allocator.hh"
 
 namespace Airable { class RemoteList; }
 
@@ -98,6 +103,34 @@ class GenericList
      */
     virtual bool lookup_item_id_by_child_id(ID::List child_id, ID::Item &idx) const = 0;
 
+    /*!
+     * Find cache ID of the child list an item links to.
+     *
+     * \returns
+     *     The ID of the child list, or the invalid ID in case the item does
+     *     not link to any list or is not physically stored.
+     */
+    virtual ID::List lookup_child_list(ID::Item idx) const = 0;
+
+    /*!
+     * Link item to child list.
+     *
+     * Items stored in lists must be linked to their child lists through this
+     * function, not through #ListItem_::set_child_list(), so that lookups by
+     * child list ID remain cheap.
+     *
+     * An item which is linked already is linked to the new child list
+     * instead. Passing the invalid ID removes the link.
+     */
+    virtual void link_child_list(ID::Item idx, ID::List child_id) = 0;
+
+    /*!
+     * Remove link from item to its child list.
+     *
+     * \see #GenericList::link_child_list()
+     */
+    virtual void unlink_child_list(ID::Item idx) = 0;
+
     /*!
      * Direct access to children by item index.
      *
@@ -116,6 +149,128 @@ class GenericList
 };
 
 
+/*!
+ * Index for finding items by the ID of their child list.
+ *
+ * Lists may contain tens of thousands of items, but only few of them link to
+ * child lists. Each child list removed from cache leads to a lookup in its
+ * parent, so lists maintain this index to avoid searching all their items.
+ *
+ * Entries may become stale when items lose their child lists behind the
+ * list's back (e.g., when a tile is reset). Users of this class must
+ * therefore check the item found through the index and remove stale entries.
+ */
+class ChildListIndex
+{
+  private:
+    mutable LoggedLock::Mutex lock_;
+    std::unordered_map<uint32_t, uint32_t> items_;
+
+  public:
+    ChildListIndex(const ChildListIndex &) = delete;
+    ChildListIndex &operator=(const ChildListIndex &) = delete;
+
+    explicit ChildListIndex()
+    {
+        LoggedLock::configure(lock_, "ChildListIndex", MESSAGE_LEVEL_DEBUG);
+    }
+
+    void insert(ID::List child_id, ID::Item idx)
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+        items_[child_id.get_raw_id()] = idx.get_raw_id();
+    }
+
+    void erase(ID::List child_id)
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+        items_.erase(child_id.get_raw_id());
+    }
+
+    /*!
+     * Erase entry, but only if it still refers to the given item.
+     */
+    void erase_stale(ID::List child_id, ID::Item idx)
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        const auto it = items_.find(child_id.get_raw_id());
+
+        if(it != items_.end() && it->second == idx.get_raw_id())
+            items_.erase(it);
+    }
+
+    bool lookup(ID::List child_id, ID::Item &idx) const
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        const auto it = items_.find(child_id.get_raw_id());
+
+        if(it == items_.end())
+            return false;
+
+        idx = ID::Item(it->second);
+        return true;
+    }
+
+    /*!
+     * Adjust indices after inserting an item at \p idx.
+     */
+    void inserted(ID::Item idx)
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        for(auto &it : items_)
+            if(it.second >= idx.get_raw_id())
+                ++it.second;
+    }
+
+    /*!
+     * Adjust indices after removing the item at \p idx.
+     */
+    void removed(ID::Item idx)
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        for(auto it = items_.begin(); it != items_.end(); /* nothing */)
+        {
+            if(it->second == idx.get_raw_id())
+                it = items_.erase(it);
+            else
+            {
+                if(it->second > idx.get_raw_id())
+                    --it->second;
+
+                ++it;
+            }
+        }
+    }
+
+    void clear()
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+        items_.clear();
+    }
+
+    /*!
+     * Rough estimate of heap memory used by the index.
+     */
+    size_t get_heap_size() const
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+        return items_.bucket_count() * sizeof(void *) +
+               items_.size() * (sizeof(decltype(items_)::value_type) + 2 * sizeof(void *));
+    }
+};
+
 /*!
  * Class template for flat lists.
  *
@@ -132,12 +287,23 @@ class FlatList: public LRU::Entry, public GenericList<T>
   private:
     std::vector<ListItem_<T>> items_;
 
+    /*!
+     * Heap memory allocated by the items in #FlatList::items_.
+     *
+     * Maintained when items are added or removed. Changes of items in place
+     * are not tracked.
+     */
+    std::atomic<size_t> items_heap_size_;
+
+    mutable ChildListIndex child_index_;
+
   public:
     FlatList(const FlatList &) = delete;
     FlatList &operator=(const FlatList &) = delete;
 
     explicit FlatList(std::shared_ptr<Entry> parent):
-        LRU::Entry(parent)
+        LRU::Entry(parent),
+        items_heap_size_(0)
     {}
 
     virtual ~FlatList() {}
@@ -183,11 +349,22 @@ class FlatList: public LRU::Entry, public GenericList<T>
      */
     void append_unsorted(ListItem_<T> &&item)
     {
+        items_heap_size_ += item.get_heap_size();
+
+        if(item.get_child_list().is_valid())
+            child_index_.insert(item.get_child_list(), ID::Item(items_.size()));
+
         items_.emplace_back(std::move(item));
     }
 
     void insert_before(size_t idx, ListItem_<T> &&item)
     {
+        items_heap_size_ += item.get_heap_size();
+        child_index_.inserted(ID::Item(idx));
+
+        if(item.get_child_list().is_valid())
+            child_index_.insert(item.get_child_list(), ID::Item(idx));
+
         items_.insert(items_.begin() + idx, std::move(item));
     }
 
@@ -195,30 +372,63 @@ class FlatList: public LRU::Entry, public GenericList<T>
     {
         msg_log_assert(idx.get_raw_id() < items_.size());
         ID::List id = items_[idx.get_raw_id()].get_child_list();
+        items_heap_size_ -= items_[idx.get_raw_id()].get_heap_size();
         items_.erase(items_.begin() + idx.get_raw_id());
+        child_index_.removed(idx);
         return id;
     }
 
+    /*!
+     * Size of the list object, its item array, and all item data.
+     */
+    size_t get_size_in_bytes() const override
+    {
+        return sizeof(*this) + items_.capacity() * sizeof(ListItem_<T>) +
+               items_heap_size_ + child_index_.get_heap_size();
+    }
+
     const ListItem_<T> *lookup_child_by_id(ID::List child_id) const override
     {
-        const auto &found(std::find_if(items_.begin(), items_.end(),
-                                [child_id] (const auto &it)
-                                { return it.get_child_list() == child_id; }));
-        return found != items_.end() ? &*found : nullptr;
+        ID::Item idx;
+        return lookup_item_id_by_child_id(child_id, idx)
+            ? &items_[idx.get_raw_id()]
+            : nullptr;
     }
 
     bool lookup_item_id_by_child_id(ID::List child_id, ID::Item &idx) const override
     {
-        for(auto it = items_.begin(); it != items_.end(); ++it)
+        ID::Item found;
+
+        if(!child_index_.lookup(child_id, found))
+            return false;
+
+        if(found.get_raw_id() >= items_.size() ||
+           items_[found.get_raw_id()].get_child_list() != child_id)
         {
-            if(it->get_child_list() == child_id)
-            {
-                idx = ID::Item(it - items_.begin());
-                return true;
-            }
+            child_index_.erase_stale(child_id, found);
+            return false;
         }
 
-        return false;
+        idx = found;
+        return true;
+    }
+
+    ID::List lookup_child_list(ID::Item idx) const override
+    {
+        return items_[idx.get_raw_id()].get_child_list();
+    }
+
+    void link_child_list(ID::Item idx, ID::List child_id) override
+    {
+        items_[idx.get_raw_id()].set_child_list(child_id);
+        child_index_.insert(child_id, idx);
+    }
+
+    void unlink_child_list(ID::Item idx) override
+    {
+        auto &item(items_[idx.get_raw_id()]);
+        child_index_.erase_stale(item.get_child_list(), idx);
+        item.obliviate_child();
     }
 
     const ListItem_<T> &operator[](ID::Item idx) const override
@@ -239,15 +449,15 @@ class FlatList: public LRU::Entry, public GenericList<T>
  * it is much better to fetch data only when needed than attempting to fetch
  * and store all data that is available.
  *
- * The #TiledList does this by using three consecutive chunks of data---the
- * <em>tiles</em>---which represent only a small fraction of a potentially
- * large list. There is a \e center \e tile which stores the partial list
- * containing the most recently accessed item; it is filled when it is
- * accessed. In addition, there are two adjacent tiles called the \e up \e tile
- * and the \e down \e tile. These are used to prefetch the content that comes
- * before and after the center tile, respectively, and are dropped in as new
- * center tile when necessary. This way, scrolling up or down a list does not
- * lead to perceivable delays.
+ * The #TiledList does this by using a small number of consecutive chunks of
+ * data---the <em>tiles</em>---which represent only a small fraction of a
+ * potentially large list. There is a \e center \e tile which stores the
+ * partial list containing the most recently accessed item; it is filled when
+ * it is accessed. The other tiles are used to prefetch the content that comes
+ * before and after the center tile, and are dropped in as new center tile when
+ * necessary. Most of them are kept ahead of the center tile in scroll
+ * direction. This way, scrolling up or down a list does not lead to
+ * perceivable delays.
  *
  * Random access to elements is supported, but the array subscript operator
  * should not be used to enumerate a range of items (i.e., for showing them on
@@ -261,21 +471,37 @@ class FlatList: public LRU::Entry, public GenericList<T>
  *     Domain-specific data to be stored per list item.
  *
  * \tparam tile_size
- *     How many items to store per tile. This is the number of items retrieved
- *     in block when a specific item inside that block is asked for (comparable
- *     to harddisk sectors or flash read blocks).
+ *     How many items to store per tile at most. The number of items stored per
+ *     tile is the number of items retrieved in block when a specific item
+ *     inside that block is asked for (comparable to harddisk sectors or flash
+ *     read blocks). It can be adapted at runtime, see
+ *     #TiledList::request_tile_size().
+ *
+ * \tparam number_of_tiles
+ *     How many tiles to keep in memory, at least 3. Each additional tile
+ *     allows prefetching one more tile in scroll direction at the expense of
+ *     memory. See also #ListTiles_.
  *
  * \attention
  *     Objects implementing this interface are used from multiple threads while
  *     their internal tiles are filled in parallel. All interfaces
  *     implementation must be thread-safe.
  */
-template <typename T, uint16_t tile_size>
+template <typename T, uint16_t tile_size, size_t number_of_tiles>
 class TiledList: public LRU::Entry, public GenericList<T>
 {
   private:
-    size_t number_of_entries_;
-    ListTiles_<T, tile_size> tiles_;
+    std::atomic<size_t> number_of_entries_;
+    ListTiles_<T, tile_size, number_of_tiles> tiles_;
+    mutable ChildListIndex child_index_;
+
+    /*!
+     * Serializes #TiledList::reset_tiles() with readers of the tiles.
+     *
+     * Readers take the lock in shared mode, so they do not block each other.
+     * Fillers do not take the lock; resetting the tiles cancels them.
+     */
+    mutable std::shared_mutex reset_lock_;
 
   protected:
     const TiledListFillerIface<T> &filler_;
@@ -286,10 +512,11 @@ class TiledList: public LRU::Entry, public GenericList<T>
 
     explicit TiledList(std::shared_ptr<Entry> parent,
                        size_t number_of_entries,
-                       const TiledListFillerIface<T> &filler):
+                       const TiledListFillerIface<T> &filler,
+                       uint16_t items_per_tile = tile_size):
         LRU::Entry(parent),
         number_of_entries_(number_of_entries),
-        tiles_(get_thread_pool()),
+        tiles_(get_thread_pool(), items_per_tile),
         filler_(filler)
     {
         static_assert(tile_size > 0, "Tile size must be positive");
@@ -343,6 +570,7 @@ class TiledList: public LRU::Entry, public GenericList<T>
      */
     bool prefetch_range(ID::Item first, size_t count) const
     {
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
         return
             const_cast<TiledList *>(this)->tiles_.prefetch(filler_,
                                                            get_cache_id(),
@@ -351,6 +579,71 @@ class TiledList: public LRU::Entry, public GenericList<T>
                                                            false);
     }
 
+    /*!
+     * Change number of items per tile for future fills.
+     *
+     * The new tile size becomes effective when all tiles are filled from
+     * scratch next time. This function is thread-safe, it may be called from
+     * list filler threads.
+     */
+    void request_tile_size(uint16_t items_per_tile)
+    {
+        tiles_.request_items_per_tile(items_per_tile);
+    }
+
+    /*!
+     * Number of items per tile requested for future fills.
+     */
+    uint16_t get_requested_tile_size() const
+    {
+        return tiles_.get_requested_items_per_tile();
+    }
+
+  protected:
+    /*!
+     * Drop all tiles and set new number of items.
+     *
+     * For lists whose contents are changed in place. Queued fillers are
+     * canceled, and the tiles are filled again when accessed next time. This
+     * function blocks until all readers have left the tiles, so it must not
+     * be called while holding any lock taken by fillers.
+     *
+     * \param number_of_entries
+     *     The new size of the list.
+     *
+     * \param replace_contents
+     *     Called after the tiles have been dropped, but before any reader can
+     *     access them again. This is where the data the fillers read from
+     *     should be replaced. May be \c nullptr.
+     */
+    void reset_tiles(size_t number_of_entries,
+                     const std::function<void()> &replace_contents)
+    {
+        std::lock_guard<std::shared_mutex> lock(reset_lock_);
+        decltype(tiles_)::ClearTile::clear(tiles_);
+        child_index_.clear();
+
+        if(replace_contents != nullptr)
+            replace_contents();
+
+        number_of_entries_ = number_of_entries;
+    }
+
+    /*!
+     * Get item if it is stored in any of the tiles.
+     *
+     * In contrast to #TiledList::operator[](), the tiles are neither moved
+     * around nor filled.
+     *
+     * \returns
+     *     The item, or \c nullptr if the item is not stored in any tile.
+     */
+    const ListItem_<T> *lookup_list_item(ID::Item idx) const
+    {
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        return tiles_.lookup_list_item(idx);
+    }
+
   private:
     static ListThreads<T, tile_size> &get_thread_pool();
 
@@ -366,6 +659,9 @@ class TiledList: public LRU::Entry, public GenericList<T>
      *
      * \returns
      *     True if the materialization was successful, false otherwise.
+     *
+     * \note
+     *     Caller must hold #TiledList::reset_lock_.
      */
     bool materialize(ID::Item idx, ListError &error)
     {
@@ -375,16 +671,32 @@ class TiledList: public LRU::Entry, public GenericList<T>
             return false;
         }
 
-        if(idx.get_raw_id() >= number_of_entries_)
+        const size_t number_of_entries = number_of_entries_;
+
+        if(idx.get_raw_id() >= number_of_entries)
         {
             MSG_BUG("requested tile list materialization around %u, but have only %zu items",
-                    idx.get_raw_id(), number_of_entries_);
+                    idx.get_raw_id(), number_of_entries);
             error = ListError::INTERNAL;
             return false;
         }
 
         return tiles_.prefetch(filler_, get_cache_id(), idx, 1,
-                               number_of_entries_, true);
+                               number_of_entries, true);
+    }
+
+    /*!
+     * Materialize item and return it, caller must hold
+     * #TiledList::reset_lock_.
+     */
+    const ListItem_<T> &get_materialized_item(ID::Item idx) const
+    {
+        ListError error;
+
+        if(const_cast<TiledList *>(this)->materialize(idx, error))
+            return tiles_.get_list_item_unsafe(idx);
+        else
+            throw ListIterException("Tile materialization failed", error);
     }
 
   public:
@@ -409,6 +721,41 @@ class TiledList: public LRU::Entry, public GenericList<T>
         return number_of_entries_;
     }
 
+    /*!
+     * Size of the list object, including the tiles, and of the item data
+     * currently stored in the tiles and in the cold store.
+     *
+     * The tiles are part of the list object, so the size of a tiled list
+     * varies only with the data referenced by the items in the tiles and with
+     * the number of evicted tiles kept in the cold store.
+     */
+    size_t get_size_in_bytes() const override
+    {
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        return sizeof(*this) + tiles_.get_heap_size() +
+               child_index_.get_heap_size();
+    }
+
+    /*!
+     * Cost of creating the list plus the cost of filling its tiles.
+     */
+    std::chrono::microseconds get_refill_cost() const override
+    {
+        return LRU::Entry::get_refill_cost() + tiles_.get_fill_duration();
+    }
+
+    /*!
+     * Pass items stored in all ready tiles to given function.
+     *
+     * Items are passed along with their index in the list, in no particular
+     * order. Tiles which are currently being filled are skipped.
+     */
+    void for_each_ready_item(const std::function<void(uint32_t, const ListItem_<T> &)> &fn) const
+    {
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        tiles_.for_each_ready_item(fn);
+    }
+
   private:
     void deferred_set_size(size_t new_size)
     {
@@ -419,36 +766,78 @@ class TiledList: public LRU::Entry, public GenericList<T>
 
     void clear_all()
     {
+        std::lock_guard<std::shared_mutex> lock(reset_lock_);
         decltype(tiles_)::ClearTile::clear(tiles_);
+        child_index_.clear();
         number_of_entries_ = 0;
     }
 
   public:
     const ListItem_<T> *lookup_child_by_id(ID::List child_id) const override
     {
-        for(const auto &it : tiles_)
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        ID::Item idx;
+        return lookup_item_id_by_child_id_unlocked(child_id, idx)
+            ? tiles_.lookup_list_item(idx)
+            : nullptr;
+    }
+
+    bool lookup_item_id_by_child_id(ID::List child_id, ID::Item &idx) const override
+    {
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        return lookup_item_id_by_child_id_unlocked(child_id, idx);
+    }
+
+  private:
+    bool lookup_item_id_by_child_id_unlocked(ID::List child_id, ID::Item &idx) const
+    {
+        ID::Item found;
+
+        if(!child_index_.lookup(child_id, found))
+            return false;
+
+        const auto *item = tiles_.lookup_list_item(found);
+
+        if(item == nullptr || item->get_child_list() != child_id)
         {
-            /* our custom iterator doesn't work with std::find_if() atm */
-            // cppcheck-suppress useStlAlgorithm
-            if(it.get_child_list() == child_id)
-                return &it;
+            /* the tile has been reset or evicted in the meantime */
+            child_index_.erase_stale(child_id, found);
+            return false;
         }
 
-        return nullptr;
+        idx = found;
+        return true;
     }
 
-    bool lookup_item_id_by_child_id(ID::List child_id, ID::Item &idx) const override
+  public:
+    ID::List lookup_child_list(ID::Item idx) const override
+    {
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        const auto *item = tiles_.lookup_list_item(idx);
+        return item != nullptr ? item->get_child_list() : ID::List();
+    }
+
+    void link_child_list(ID::Item idx, ID::List child_id) override
     {
-        for(auto it = tiles_.begin(); it != tiles_.end(); ++it)
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        const_cast<ListItem_<T> &>(get_materialized_item(idx)).set_child_list(child_id);
+        child_index_.insert(child_id, idx);
+    }
+
+    void unlink_child_list(ID::Item idx) override
+    {
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        auto *item = const_cast<ListItem_<T> *>(tiles_.lookup_list_item(idx));
+
+        if(item == nullptr)
         {
-            if(it->get_child_list() == child_id)
-            {
-                idx = ID::Item(it.get_item_id());
-                return true;
-            }
+            MSG_BUG("Cannot unlink child of item %u in list %u, not in tiles",
+                    idx.get_raw_id(), get_cache_id().get_raw_id());
+            return;
         }
 
-        return false;
+        child_index_.erase_stale(item->get_child_list(), idx);
+        item->obliviate_child();
     }
 
     /*!
@@ -473,28 +862,27 @@ class TiledList: public LRU::Entry, public GenericList<T>
      * the list that span tile boundaries. It will work, but unnecessary cache
      * thrashing will take place.
      *
+     * The returned reference remains valid until the tiles are moved on by
+     * another access or reset by #TiledList::reset_tiles().
+     *
      * \see
      *     #for_each_item(), #TiledList::prefetch_range()
      */
     const ListItem_<T> &operator[](ID::Item idx) const override
     {
-        ListError error;
-
-        if(const_cast<TiledList *>(this)->materialize(idx, error))
-            return tiles_.get_list_item_unsafe(idx);
-        else
-            throw ListIterException("Tile materialization failed", error);
+        std::shared_lock<std::shared_mutex> lock(reset_lock_);
+        return get_materialized_item(idx);
     }
 
     class ManipulateRootList
     {
-        static inline void deferred_set_size(TiledList<T, tile_size> &list,
+        static inline void deferred_set_size(TiledList<T, tile_size, number_of_tiles> &list,
                                              size_t new_size)
         {
             list.deferred_set_size(new_size);
         }
 
-        static inline void clear_all(TiledList<T, tile_size> &list)
+        static inline void clear_all(TiledList<T, tile_size, number_of_tiles> &list)
         {
             list.clear_all();
         }
@@ -510,7 +898,7 @@ add_child_list_to_cache(LRU::Cache &cache, ID::List parent_id,
                         LRU::CacheMode cmode, const ID::List::context_t ctx,
                         size_t estimated_size_in_ram)
 {
-    auto list = std::make_shared<ListType>(cache.lookup(parent_id));
+    auto list = LRU::make_pooled<ListType>(cache.lookup(parent_id));
     if(list == nullptr)
         return ID::List();
 
@@ -524,7 +912,7 @@ add_child_list_to_cache(LRU::Cache &cache, ID::List parent_id,
                         size_t number_of_items, size_t estimated_size_in_ram,
                         const TiledListFillerIface<FillerType> &filler)
 {
-    auto list = std::make_shared<ListType>(cache.lookup(parent_id),
+    auto list = LRU::make_pooled<ListType>(cache.lookup(parent_id),
                                            number_of_items, filler);
     if(list == nullptr)
         return ID::List();
@@ -532,6 +920,32 @@ add_child_list_to_cache(LRU::Cache &cache, ID::List parent_id,
     return cache.insert(list, cmode, ctx, estimated_size_in_ram);
 }
 
+/*!
+ * Store time elapsed since \p fill_start as refill cost of a cached list.
+ */
+static inline void set_refill_cost_of_list(LRU::Entry &list,
+                                           const Timebase::time_point &fill_start)
+{
+    list.set_refill_cost(std::chrono::duration_cast<std::chrono::microseconds>(
+                             LRU::timebase->now() - fill_start));
+}
+
+/*!
+ * Store time elapsed since \p fill_start as refill cost of the cached list
+ * with given ID, if any.
+ */
+static inline void set_refill_cost_of_list(const LRU::Cache &cache, ID::List id,
+                                           const Timebase::time_point &fill_start)
+{
+    if(!id.is_valid())
+        return;
+
+    const auto list = cache.lookup(id);
+
+    if(list != nullptr)
+        set_refill_cost_of_list(*list, fill_start);
+}
+
 /*!
  * How the generic #for_each_item() implementation should work.
  */
@@ -621,10 +1035,10 @@ static ListError for_each_item(std::shared_ptr<T> list,
  * implementation (compiler optimizations will shrink these calls down to
  * almost nothing).
  */
-template <typename ItemType, uint16_t tile_size>
-struct ForEachItemTraits<const TiledList<ItemType, tile_size>>
+template <typename ItemType, uint16_t tile_size, size_t number_of_tiles>
+struct ForEachItemTraits<const TiledList<ItemType, tile_size, number_of_tiles>>
 {
-    using ListType = const TiledList<ItemType, tile_size>;
+    using ListType = const TiledList<ItemType, tile_size, number_of_tiles>;
     using IterType = typename ListType::const_iterator;
 
     static bool warm_up_cache(std::shared_ptr<ListType> list,
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2016, 2018, 2019  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2016, 2018, 2019, 2026  T+A elektroakustik GmbH & Co. KG
  * Copyright (C) 2021, 2022, 2023  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
@@ -25,6 +25,7 @@
 
 #include "lru.hh"
 #include "lru_killed_lists.hh"
+#include "string_arena.hh"
 #include "messages.h"
 #include "de_tahifi_lists_errors.hh"
 #include "de_tahifi_lists_item_kinds.hh"
@@ -40,7 +41,19 @@
 #include <algorithm>
 #include <stdexcept>
 
-template <typename T, uint16_t> class TiledList;
+template <typename T, uint16_t, size_t> class TiledList;
+
+/*!
+ * Number of bytes allocated on the heap by a \c std::string.
+ *
+ * Short strings are stored inside the string object itself, so these don't
+ * count.
+ */
+static inline size_t get_heap_size(const std::string &s)
+{
+    static const size_t inline_capacity = std::string().capacity();
+    return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+}
 
 class ListIterException: public std::runtime_error
 {
@@ -136,6 +149,12 @@ class ListItem_
         return data_.get_kind();
     };
 
+    /*!
+     * Link to child list.
+     *
+     * Items stored in a list should be linked through
+     * #GenericList::link_child_list() instead.
+     */
     void set_child_list(ID::List child)
     {
         msg_log_assert(child.is_valid());
@@ -162,6 +181,14 @@ class ListItem_
         return child_;
     }
 
+    /*!
+     * Number of bytes allocated on the heap by the stored data.
+     */
+    size_t get_heap_size() const
+    {
+        return data_.get_heap_size();
+    }
+
     /*! Return const stored data for type-specific code. */
     const T &get_specific_data() const
     {
@@ -187,6 +214,26 @@ enum class ListTileState
     ERROR,
 };
 
+/*!
+ * How urgently a tile needs to be filled.
+ *
+ * Worker threads always pick the queued tile with the highest priority.
+ * Tiles of the same priority are filled in the order they were queued.
+ */
+enum class ListFillPriority
+{
+    /*! The reading thread is going to block on the tile. */
+    DEMAND,
+
+    /*! The tile is part of a range requested by #TiledList::prefetch_range(). */
+    PREFETCH,
+
+    /*! The tile is filled speculatively in anticipation of scrolling. */
+    BACKGROUND,
+
+    LAST_PRIORITY = BACKGROUND,
+};
+
 /*!
  * Class template for a single tile in a tiled list.
  *
@@ -205,6 +252,11 @@ enum class ListTileState
  * - When a writer releases the lock, it either means that the tile has been
  *   filled or that an error has occurred. Therefore, the reading thread must
  *   check the tile's error state right after lock acquisition.
+ * - While filling, a writer publishes the number of items at the beginning
+ *   of the tile which are complete. The reading thread may read these items
+ *   without taking the lock, and they are not going to be touched by the
+ *   writer anymore. This way, the first items of a tile can be shown while
+ *   the remaining items are still being filled in.
  *
  * \note
  *     The software design does not consider reading from multiple threads
@@ -216,7 +268,9 @@ enum class ListTileState
  *     Domain-specific data to be stored per list item.
  *
  * \tparam tile_size
- *     How many items to store per tile. See also #TiledList.
+ *     How many items can be stored per tile at most. The number of items
+ *     actually stored in a tile is chosen when the tile is activated. See
+ *     also #TiledList.
  */
 template <typename T, uint16_t tile_size>
 class ListTile_
@@ -226,9 +280,67 @@ class ListTile_
     LoggedLock::ConditionVariable tile_processed_;
     std::atomic<bool> cancel_filling_request_;
 
+    /*!
+     * Whether or not the tile is waiting in the work queue.
+     *
+     * Written by #ListThreads while holding the queue lock, may be read by
+     * any thread.
+     */
+    std::atomic<bool> is_queued_;
+
     std::array<ListItem_<T>, tile_size> items_;
 
+    /*!
+     * Storage for strings referenced by the items in this tile.
+     *
+     * Filled by the filling thread along with the items, cleared when the
+     * tile is reset.
+     */
+    StringArena strings_;
+
+    /*!
+     * Lock and condition for readers waiting for single items.
+     *
+     * These are separate from #ListTile_::write_lock_ because the writer
+     * holds that lock while filling the tile.
+     */
+    LoggedLock::Mutex publish_lock_;
+    LoggedLock::ConditionVariable items_published_;
+
+    /*!
+     * Number of items at the beginning of the tile which may be read.
+     *
+     * Written by the filling thread while holding
+     * #ListTile_::publish_lock_, may be read by the reading thread without
+     * locking.
+     */
+    std::atomic<uint16_t> published_items_count_;
+
+    /*!
+     * Whether or not a writer may still publish items.
+     *
+     * Protected by #ListTile_::publish_lock_.
+     */
+    bool is_publishing_;
+
+    /*!
+     * Heap memory allocated by the items in this tile.
+     *
+     * Written by the filling thread when the tile becomes ready, read by the
+     * reading thread without locking the tile.
+     */
+    std::atomic<size_t> heap_size_;
+
+    /*!
+     * How long it took to fill this tile the last time, in microseconds.
+     *
+     * Not cleared when the tile is reset, so that it can serve as estimate
+     * for the cost of filling the tile again.
+     */
+    std::atomic<uint64_t> fill_duration_us_;
+
     uint32_t base_;
+    uint16_t items_per_tile_;
     uint16_t stored_items_count_;
     ListTileState state_;
     ListError error_;
@@ -238,7 +350,13 @@ class ListTile_
     ListTile_ &operator=(const ListTile_ &) = delete;
 
     explicit ListTile_():
+        is_queued_(false),
+        published_items_count_(0),
+        is_publishing_(false),
+        heap_size_(0),
+        fill_duration_us_(0),
         base_(0),
+        items_per_tile_(tile_size),
         stored_items_count_(0),
         state_(ListTileState::FREE),
         error_(ListError::INTERNAL)
@@ -248,6 +366,10 @@ class ListTile_
                               MESSAGE_LEVEL_DEBUG);
         LoggedLock::configure(tile_processed_, "ListTile_::tile_processed_-cv",
                               MESSAGE_LEVEL_DEBUG);
+        LoggedLock::configure(publish_lock_, "ListTile_::publish_lock_",
+                              MESSAGE_LEVEL_DEBUG);
+        LoggedLock::configure(items_published_, "ListTile_::items_published_-cv",
+                              MESSAGE_LEVEL_DEBUG);
     }
 
     ~ListTile_()
@@ -270,7 +392,7 @@ class ListTile_
 
     bool is_tile_for(ID::Item idx) const
     {
-        return idx.get_raw_id() >= base_ && idx.get_raw_id() < uint32_t(base_ + tile_size);
+        return idx.get_raw_id() >= base_ && idx.get_raw_id() < uint32_t(base_ + items_per_tile_);
     }
 
     /*!
@@ -293,8 +415,11 @@ class ListTile_
             items_[i].reset();
         }
 
+        strings_.clear();
+        heap_size_ = 0;
         base_ = 0;
         stored_items_count_ = 0;
+        published_items_count_ = 0;
         error_ = error;
         state_ = state;
     }
@@ -314,6 +439,33 @@ class ListTile_
         return lock.owns_lock() && state_ == ListTileState::FREE;
     }
 
+    /*!
+     * Pass all items to given function if the tile is ready.
+     *
+     * This function does not block. Tiles which are currently being filled
+     * are skipped.
+     *
+     * \returns
+     *     True if the tile was ready, false otherwise.
+     *
+     * \remark
+     *     This function is thread-safe if called from the reading thread.
+     *     Writers should not call this function.
+     */
+    bool for_each_ready_item(const std::function<void(uint32_t, const ListItem_<T> &)> &fn) const
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        auto lock(const_cast<ListTile_ *>(this)->try_lock_tile());
+
+        if(!lock.owns_lock() || state_ != ListTileState::READY)
+            return false;
+
+        for(uint16_t i = 0; i < stored_items_count_; ++i)
+            fn(base_ + i, items_[i]);
+
+        return true;
+    }
+
     /*!
      * Get tile state.
      *
@@ -353,41 +505,106 @@ class ListTile_
         reset(killed_list, error,
               (error == ListError::OK) ? ListTileState::CANCELED : ListTileState::ERROR);
 
-        tile_processed_.notify_all();
+        processed_notification();
+    }
+
+    /*!
+     * Callback from filling thread: The first \p count items are complete.
+     *
+     * Readers waiting for any of these items are woken up. The filling thread
+     * must not modify published items anymore.
+     *
+     * \remark
+     *     This function is called with the tile lock held by the calling
+     *     thread.
+     */
+    void publish_notification(uint16_t count)
+    {
+        msg_log_assert(count <= items_per_tile_);
+
+        if(count <= published_items_count_)
+            return;
+
+        {
+            LOGGED_LOCK_CONTEXT_HINT;
+            std::lock_guard<LoggedLock::Mutex> lock(publish_lock_);
+            published_items_count_ = count;
+        }
+
+        items_published_.notify_all();
+    }
+
+    /*!
+     * Number of items published by the filling thread so far.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block.
+     */
+    uint16_t get_published_items_count() const
+    {
+        return published_items_count_;
     }
 
     /*!
      * Callback from filling thread: Tile is ready for use.
      *
+     * \param count
+     *     Number of items filled in.
+     *
+     * \param fill_duration
+     *     How long it took to fill the tile.
+     *
      * \remark
      *     This function is called with the tile lock held by the calling
      *     thread.
      */
-    void done_notification(uint16_t count)
+    void done_notification(uint16_t count,
+                           std::chrono::microseconds fill_duration)
     {
+        fill_duration_us_ = fill_duration.count() > 0 ? fill_duration.count() : 0;
+
         stored_items_count_ += count;
-        msg_log_assert(stored_items_count_ <= tile_size);
+        msg_log_assert(stored_items_count_ <= items_per_tile_);
+
+        size_t heap_size = strings_.get_heap_size();
+
+        for(size_t i = 0; i < stored_items_count_; ++i)
+            heap_size += items_[i].get_heap_size();
+
+        heap_size_ = heap_size;
         state_ = ListTileState::READY;
 
-        tile_processed_.notify_all();
+        processed_notification();
     }
 
     /*!
      * Mark tile as occupied for filling.
      *
+     * \param idx
+     *     Some index in the tile.
+     *
+     * \param items_per_tile
+     *     How many items to store in this tile, at most \p tile_size. All
+     *     tiles of a list must use the same value.
+     *
      * \pre Tile is free and neither in error state nor occupied.
      *
      * \remark
      *     This function must be called from the reading thread.
      */
-    ListTile_ *activate_tile(ID::Item idx)
+    ListTile_ *activate_tile(ID::Item idx, uint16_t items_per_tile)
     {
         msg_log_assert(idx.get_raw_id() <= std::numeric_limits<decltype(base_)>::max());
         msg_log_assert(state_ == ListTileState::FREE);
+        msg_log_assert(items_per_tile > 0);
+        msg_log_assert(items_per_tile <= tile_size);
 
+        items_per_tile_ = items_per_tile;
         base_ = idx.get_raw_id();
-        base_ -= idx.get_raw_id() % tile_size;
+        base_ -= idx.get_raw_id() % items_per_tile_;
         state_ = ListTileState::FILLING;
+        published_items_count_ = 0;
+        is_publishing_ = true;
 
         cancel_filling_request_ = false;
 
@@ -404,6 +621,130 @@ class ListTile_
         return cancel_filling_request_;
     }
 
+    /*!\internal
+     * For #ListThreads only.
+     */
+    void set_queued(bool is_queued)
+    {
+        is_queued_ = is_queued;
+    }
+
+    /*!
+     * Whether or not the tile is waiting for a worker thread.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block, but the result may
+     *     be outdated by the time it is returned unless the caller holds the
+     *     work queue lock.
+     */
+    bool is_queued() const
+    {
+        return is_queued_;
+    }
+
+    /*!
+     * Move items out of the tile so that they can be kept in a cold store.
+     *
+     * Links to child lists are removed from the items and recorded in
+     * \p killed_list because the cache cannot find items outside of hot
+     * tiles. The tile must be reset afterwards.
+     *
+     * \param[out] items
+     *     The items stored in the tile are moved to this vector.
+     *
+     * \param[out] strings
+     *     The strings referenced by the items are moved to this arena.
+     *
+     * \param killed_list
+     *     Object which records lists removed from hot tiles.
+     *
+     * \returns
+     *     True if the tile was ready and its items have been moved to
+     *     \p items, false if there was nothing to take.
+     *
+     * \remark
+     *     This function must be called from the reading thread. It does not
+     *     block. Tiles which are currently being filled are skipped.
+     */
+    bool take_items(std::vector<ListItem_<T>> &items, StringArena &strings,
+                    LRU::KilledLists &killed_list)
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        auto lock(try_lock_tile());
+
+        if(!lock.owns_lock() || state_ != ListTileState::READY ||
+           stored_items_count_ == 0)
+            return false;
+
+        items.clear();
+        items.reserve(stored_items_count_);
+
+        for(uint16_t i = 0; i < stored_items_count_; ++i)
+        {
+            const auto child_id(items_[i].get_child_list());
+
+            if(child_id.is_valid())
+            {
+                killed_list.killed(child_id);
+                items_[i].obliviate_child();
+            }
+
+            items.emplace_back(std::move(items_[i]));
+        }
+
+        strings = std::move(strings_);
+
+        return true;
+    }
+
+    /*!
+     * Put items taken by #ListTile_::take_items() back into the tile.
+     *
+     * The tile becomes ready immediately.
+     *
+     * \pre Tile has been activated for the range of indices the items were
+     *     taken from, using the same number of items per tile.
+     *
+     * \remark
+     *     This function must be called from the reading thread.
+     */
+    void restore_items(std::vector<ListItem_<T>> &&items,
+                       StringArena &&strings,
+                       std::chrono::microseconds fill_duration)
+    {
+        msg_log_assert(state_ == ListTileState::FILLING);
+        msg_log_assert(items.size() <= items_per_tile_);
+
+        LOGGED_LOCK_CONTEXT_HINT;
+        auto lock(lock_tile());
+
+        for(size_t i = 0; i < items.size(); ++i)
+            items_[i] = std::move(items[i]);
+
+        strings_ = std::move(strings);
+
+        done_notification(items.size(), fill_duration);
+    }
+
+  private:
+    /*!
+     * Wake up all readers after the filling thread has finished.
+     *
+     * All items stored in the tile are published.
+     */
+    void processed_notification()
+    {
+        {
+            LOGGED_LOCK_CONTEXT_HINT;
+            std::lock_guard<LoggedLock::Mutex> lock(publish_lock_);
+            published_items_count_ = stored_items_count_;
+            is_publishing_ = false;
+        }
+
+        items_published_.notify_all();
+        tile_processed_.notify_all();
+    }
+
   protected:
     /*!
      * Lock tile, wait for ready state if not ready yet.
@@ -424,6 +765,42 @@ class ListTile_
             throw ListIterException(exception_text, error_);
     }
 
+    /*!
+     * Wait until given item has been published or the tile is processed.
+     *
+     * Published items are available right away without locking the tile.
+     *
+     * \returns
+     *     True if the item is available, false if the tile is ready, but
+     *     contains fewer items.
+     *
+     * \exception #ListIterException
+     *     This function throws a #ListIterException in case the item has not
+     *     been published and the tile is not ready after processing.
+     */
+    bool wait_for_item(uint16_t raw_index, const char *const exception_text)
+    {
+        if(raw_index < published_items_count_)
+            return true;
+
+        {
+            LOGGED_LOCK_CONTEXT_HINT;
+            LoggedLock::UniqueLock<LoggedLock::Mutex> lock(publish_lock_);
+
+            items_published_.wait(lock,
+                [this, raw_index]()
+                {
+                    return raw_index < published_items_count_ || !is_publishing_;
+                });
+
+            if(raw_index < published_items_count_)
+                return true;
+        }
+
+        wait_for_ready_state(exception_text);
+        return raw_index < stored_items_count_;
+    }
+
   public:
     /*!
      * Get number of items stored in this tile.
@@ -444,23 +821,71 @@ class ListTile_
         return stored_items_count_;
     }
 
+    /*!
+     * Check whether or not the tile contains an item at given index.
+     *
+     * This function blocks until the item has been published by the filling
+     * thread, or until the tile has been filled completely.
+     *
+     * \exception #ListIterException
+     *     This function throws a #ListIterException in case the item has not
+     *     been published and the tile is not ready after acquiring the lock.
+     *
+     * \remark
+     *     This function is thread-safe if called from the reading thread.
+     *     Writers should not call this function.
+     */
+    bool has_item(uint16_t raw_index) const
+    {
+        return const_cast<ListTile_ *>(this)->wait_for_item(raw_index,
+                                                            "Cannot get size of tile");
+    }
+
     uint32_t get_base() const
     {
         return base_;
     }
 
+    uint16_t get_items_per_tile() const
+    {
+        return items_per_tile_;
+    }
+
+    /*!
+     * Get number of bytes allocated on the heap by the items in this tile.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block.
+     */
+    size_t get_heap_size() const
+    {
+        return heap_size_;
+    }
+
+    /*!
+     * Get time it took to fill this tile the last time.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block.
+     */
+    std::chrono::microseconds get_fill_duration() const
+    {
+        return std::chrono::microseconds(fill_duration_us_.load());
+    }
+
     /*!
      * Get list item stored in this tile.
      *
-     * This function blocks until the tile has been filled by some thread.
+     * This function blocks until the item has been published by the filling
+     * thread, or until the tile has been filled completely.
      *
      * \param raw_index
      *     Return a const reference to the item at this index. Must be
-     *     non-negative and smaller than \p tile_size.
+     *     non-negative and smaller than the number of items per tile.
      *
      * \exception #ListIterException
-     *     This function throws a #ListIterException in case the tile is not
-     *     ready after acquiring the lock.
+     *     This function throws a #ListIterException in case the item has not
+     *     been published and the tile is not ready after acquiring the lock.
      *
      * \remark
      *     This function is thread-safe if called from the reading thread.
@@ -468,7 +893,7 @@ class ListTile_
      */
     const ListItem_<T> &get_list_item_by_raw_index(uint16_t raw_index) const
     {
-        const_cast<ListTile_ *>(this)->wait_for_ready_state("Cannot get item from tile");
+        const_cast<ListTile_ *>(this)->wait_for_item(raw_index, "Cannot get item from tile");
         return items_[raw_index];
     }
 
@@ -495,6 +920,11 @@ class ListTile_
             return tile.get_items_data();
         }
 
+        static StringArena &get_strings(ListTile_ &tile)
+        {
+            return tile.strings_;
+        }
+
         friend class ListThreads<T, tile_size>;
     };
 };
@@ -510,31 +940,93 @@ class ListTile_
  * The main purpose of the #ItemProvider class is to enable decoupling the item
  * fill-in function implementation from the concrete list type whose items
  * shall be filled.
+ *
+ * Items may be spread over several blocks, e.g., over several adjacent
+ * tiles filled by a single request. When a block is exhausted, the next
+ * block is obtained from a function passed to the constructor. That function
+ * is also the place to signal that the items of the previous block are
+ * complete.
+ *
+ * Handing out an item implies that the items handed out before it are
+ * complete. This is reported to an optional progress function so that these
+ * items can be made available to readers early.
+ *
+ * Each block comes with a #StringArena which item data may use to store
+ * strings with the same lifetime as the items in the block. Use
+ * #ItemProvider::next(StringArena *&) to obtain it.
  */
 template <typename T>
 class ItemProvider
 {
+  public:
+    /*!
+     * Function which returns the next block of items, its size, and the
+     * storage for its strings.
+     *
+     * It is called when all items of the current block have been handed out.
+     * It must return \c nullptr if there are no more blocks.
+     */
+    using NextBlockFn = std::function<ListItem_<T> *(size_t &count, StringArena *&strings)>;
+
+    /*!
+     * Function which is told how many items of the current block are
+     * complete.
+     */
+    using ProgressFn = std::function<void(size_t count)>;
+
   private:
-    ListItem_<T> *const items_;
-    const size_t items_count_;
+    ListItem_<T> *items_;
+    size_t items_count_;
+    StringArena *strings_;
     size_t next_item_index_;
+    const NextBlockFn next_block_fn_;
+    const ProgressFn progress_fn_;
 
   public:
     ItemProvider(const ItemProvider &) = delete;
     ItemProvider &operator=(const ItemProvider &) = delete;
 
-    constexpr explicit ItemProvider(ListItem_<T> *const items, size_t count):
+    explicit ItemProvider(ListItem_<T> *const items, size_t count,
+                          StringArena *const strings,
+                          NextBlockFn &&next_block_fn = nullptr,
+                          ProgressFn &&progress_fn = nullptr):
         items_(items),
         items_count_(count),
-        next_item_index_(0)
+        strings_(strings),
+        next_item_index_(0),
+        next_block_fn_(std::move(next_block_fn)),
+        progress_fn_(std::move(progress_fn))
     {}
 
     T *next()
     {
+        if(next_item_index_ >= items_count_ &&
+           items_ != nullptr && next_block_fn_ != nullptr)
+        {
+            items_ = next_block_fn_(items_count_, strings_);
+            next_item_index_ = 0;
+
+            if(items_ == nullptr)
+                items_count_ = 0;
+        }
+        else if(next_item_index_ > 0 && next_item_index_ < items_count_ &&
+                progress_fn_ != nullptr)
+            progress_fn_(next_item_index_);
+
         return (next_item_index_ < items_count_
                 ? &items_[next_item_index_++].get_specific_data()
                 : static_cast<T *>(nullptr));
     }
+
+    /*!
+     * Get next item along with the storage for the strings it references.
+     */
+    T *next(StringArena *&strings)
+    {
+        T *const item = next();
+        strings = strings_;
+        return item;
+    }
 };
 
 /*!
@@ -582,7 +1074,11 @@ class TiledListFillerIface
      *     first position in the tile to be filled.
      *
      * \param count
-     *     Number of items that fit into the tile, i.e., the tile size.
+     *     Number of items that fit into the tile, i.e., the tile size. In case
+     *     several adjacent tiles are filled in one go, this is the number of
+     *     items that fit into all of them, and the \p item_provider moves on
+     *     to the next tile as needed. Implementations should fetch all items
+     *     in as few requests as possible.
      *
      * \param[out] error
      *     The kind of error that occurred while attempting to fill the tile,
@@ -609,6 +1105,17 @@ class TiledListFillerIface
 /*!
  * Classs template for managing threads that fill list tiles.
  *
+ * There is one queue per #ListFillPriority. Tiles the reading thread is
+ * waiting for are filled before tiles requested for prefetching, and these
+ * are filled before tiles filled speculatively.
+ *
+ * A worker thread which takes a tile from the queue also takes queued tiles
+ * adjacent to it in the same list, up to
+ * #ListThreads::MAXIMUM_TILES_PER_BATCH tiles in total. These are filled by
+ * a single call of #TiledListFillerIface::fill(), and each tile is signaled
+ * ready as soon as its last item has been filled in. Items of the tile being
+ * filled are published to readers one by one as the filler moves on.
+ *
  * \tparam T
  *     Domain-specific data to be stored per list item.
  *
@@ -642,11 +1149,22 @@ class ListThreads
         {}
     };
 
+    static constexpr size_t NUMBER_OF_PRIORITIES =
+        size_t(ListFillPriority::LAST_PRIORITY) + 1;
+
+  public:
+    /*!
+     * Maximum number of adjacent tiles filled by a single request.
+     */
+    static constexpr size_t MAXIMUM_TILES_PER_BATCH = 4;
+
+  private:
+
     struct WorkQueue
     {
         LoggedLock::Mutex lock_;
         LoggedLock::ConditionVariable work_available_;
-        std::deque<Work> work_;
+        std::array<std::deque<Work>, NUMBER_OF_PRIORITIES> work_;
         std::atomic<bool> shutdown_request_;
 
         constexpr explicit WorkQueue():
@@ -658,6 +1176,100 @@ class ListThreads
                                   "ListThreads::WorkQueue::work_available_-cv",
                                   MESSAGE_LEVEL_DEBUG);
         }
+
+        bool empty() const
+        {
+            return std::all_of(work_.begin(), work_.end(),
+                               [] (const auto &q) { return q.empty(); });
+        }
+
+        /*!
+         * Queue with highest priority which is not empty.
+         *
+         * \pre The queue is not empty.
+         */
+        std::deque<Work> &most_urgent()
+        {
+            for(auto &q : work_)
+                if(!q.empty())
+                    return q;
+
+            MSG_BUG("No work in queue");
+            return work_.back();
+        }
+
+        /*!
+         * Find work for given tile.
+         *
+         * \returns
+         *     Index of the queue the tile is stored in, or
+         *     #ListThreads::NUMBER_OF_PRIORITIES if the tile is not queued.
+         */
+        size_t find(const ListTile_<T, tile_size> &tile,
+                    typename std::deque<Work>::iterator &it)
+        {
+            for(size_t i = 0; i < NUMBER_OF_PRIORITIES; ++i)
+            {
+                it = std::find_if(work_[i].begin(), work_[i].end(),
+                                  [&tile] (const Work &w) { return w.tile_ == &tile; });
+
+                if(it != work_[i].end())
+                    return i;
+            }
+
+            return NUMBER_OF_PRIORITIES;
+        }
+
+        /*!
+         * Take work for the tile next to given work out of the queue.
+         *
+         * \param work
+         *     Work for some tile that has been taken from the queue already.
+         *
+         * \param below
+         *     If true, take work for the tile following the tile in \p work,
+         *     otherwise for the tile preceding it.
+         *
+         * \param[out] adjacent
+         *     Work for the adjacent tile of the same list.
+         *
+         * \returns
+         *     True if there was work for the adjacent tile, false otherwise.
+         */
+        bool take_adjacent(const Work &work, bool below, Work &adjacent)
+        {
+            const uint32_t base = work.tile_->get_base();
+            const uint16_t items_per_tile = work.tile_->get_items_per_tile();
+
+            if(!below && base < items_per_tile)
+                return false;
+
+            const uint32_t adjacent_base =
+                below ? base + items_per_tile : base - items_per_tile;
+
+            for(auto &q : work_)
+            {
+                const auto it =
+                    std::find_if(q.begin(), q.end(),
+                        [&work, adjacent_base, items_per_tile] (const Work &w)
+                        {
+                            return w.filler_ == work.filler_ &&
+                                   w.list_id_ == work.list_id_ &&
+                                   w.tile_->get_base() == adjacent_base &&
+                                   w.tile_->get_items_per_tile() == items_per_tile;
+                        });
+
+                if(it != q.end())
+                {
+                    adjacent = std::move(*it);
+                    q.erase(it);
+                    adjacent.tile_->set_queued(false);
+                    return true;
+                }
+            }
+
+            return false;
+        }
     };
 
     WorkQueue work_queue_;
@@ -693,7 +1305,7 @@ class ListThreads
     void start(size_t number_of_threads)
     {
         msg_log_assert(threads_.empty());
-        msg_log_assert(work_queue_.work_.empty());
+        msg_log_assert(work_queue_.empty());
         msg_log_assert(number_of_threads > 0);
 
         work_queue_.shutdown_request_ = false;
@@ -717,7 +1329,7 @@ class ListThreads
                 LOGGED_LOCK_CONTEXT_HINT;
                 std::lock_guard<LoggedLock::Mutex> qlock(work_queue_.lock_);
 
-                if(work_queue_.work_.empty())
+                if(work_queue_.empty())
                     return;
             }
 
@@ -762,15 +1374,48 @@ class ListThreads
     }
 
     void enqueue(ListTile_<T, tile_size> &tile,
-                 const TiledListFillerIface<T> &filler, ID::List list_id)
+                 const TiledListFillerIface<T> &filler, ID::List list_id,
+                 ListFillPriority priority)
     {
         msg_log_assert(!threads_.empty());
         msg_log_assert(tile.get_state() == ListTileState::FILLING);
 
         LOGGED_LOCK_CONTEXT_HINT;
         std::lock_guard<LoggedLock::Mutex> lock(work_queue_.lock_);
-        work_queue_.work_.emplace_back(tile, filler, list_id);
+        work_queue_.work_[size_t(priority)].emplace_back(tile, filler, list_id);
+        tile.set_queued(true);
         work_queue_.work_available_.notify_one();
+
+        LRU::Statistics::get_singleton().count(LRU::Statistics::Counter::TILE_FILLS);
+    }
+
+    /*!
+     * Change priority of a tile waiting in the queue.
+     *
+     * Nothing happens if the tile is not queued, i.e., if it is being filled
+     * or has been filled already. A tile moved to another priority is queued
+     * behind all tiles of that priority.
+     *
+     * \remark
+     *     This function does not block if the tile is not queued.
+     */
+    void set_priority(const ListTile_<T, tile_size> &tile,
+                      ListFillPriority priority)
+    {
+        if(!tile.is_queued())
+            return;
+
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(work_queue_.lock_);
+
+        typename std::deque<Work>::iterator it;
+        const size_t current = work_queue_.find(tile, it);
+
+        if(current >= NUMBER_OF_PRIORITIES || current == size_t(priority))
+            return;
+
+        work_queue_.work_[size_t(priority)].emplace_back(std::move(*it));
+        work_queue_.work_[current].erase(it);
     }
 
     /*!
@@ -784,14 +1429,18 @@ class ListThreads
         LOGGED_LOCK_CONTEXT_HINT;
         LoggedLock::UniqueLock<LoggedLock::Mutex> qlock(work_queue_.lock_);
 
-        for(auto &work : work_queue_.work_)
+        for(auto &q : work_queue_.work_)
         {
-            msg_log_assert(work.tile_->get_state() == ListTileState::FILLING);
-            work.tile_->canceled_notification(killed_list, ListError());
-            msg_log_assert(work.tile_->get_state() == ListTileState::CANCELED);
-        }
+            for(auto &work : q)
+            {
+                msg_log_assert(work.tile_->get_state() == ListTileState::FILLING);
+                work.tile_->set_queued(false);
+                work.tile_->canceled_notification(killed_list, ListError());
+                msg_log_assert(work.tile_->get_state() == ListTileState::CANCELED);
+            }
 
-        work_queue_.work_.clear();
+            q.clear();
+        }
     }
 
     /*!
@@ -850,13 +1499,13 @@ class ListThreads
             if(tstate == ListTileState::FILLING)
             {
                 /* should be in queue */
-                for(auto it = work_queue_.work_.begin(); it != work_queue_.work_.end(); ++it)
+                typename std::deque<Work>::iterator it;
+                const size_t priority = work_queue_.find(tile, it);
+
+                if(priority < NUMBER_OF_PRIORITIES)
                 {
-                    if(it->tile_ == &tile)
-                    {
-                        work_queue_.work_.erase(it);
-                        break;
-                    }
+                    work_queue_.work_[priority].erase(it);
+                    tile.set_queued(false);
                 }
             }
 
@@ -904,80 +1553,388 @@ class ListThreads
             queue->work_available_.wait(qlock,
                 [&queue]()
                 {
-                    return queue->shutdown_request_ || !queue->work_.empty();
+                    return queue->shutdown_request_ || !queue->empty();
                 });
 
             if(queue->shutdown_request_)
                 break;
 
-            /* copy work data to our own stack, lock the tile, unlock the
-             * queue, fill the tile --- IN THIS ORDER! */
-            const Work work_item(queue->work_.front());
-            queue->work_.pop_front();
+            /* copy work data to our own stack, lock the tiles, unlock the
+             * queue, fill the tiles --- IN THIS ORDER! */
+            auto &q(queue->most_urgent());
+            std::deque<Work> batch;
+            batch.emplace_back(std::move(q.front()));
+            q.pop_front();
+            batch.front().tile_->set_queued(false);
 
-            LOGGED_LOCK_CONTEXT_HINT;
-            auto tlock(work_item.tile_->lock_tile());
+            collect_adjacent_work(*queue, batch,
+                                  &q != &queue->work_[size_t(ListFillPriority::DEMAND)]);
+
+            std::vector<LoggedLock::UniqueLock<LoggedLock::Mutex>> tlocks;
+            tlocks.reserve(batch.size());
+
+            for(const auto &work_item : batch)
+            {
+                LOGGED_LOCK_CONTEXT_HINT;
+                tlocks.emplace_back(work_item.tile_->lock_tile());
+            }
 
             qlock.unlock();
 
-            do_fill_tile(work_item);
+            do_fill_tiles(batch, tlocks);
         }
     }
 
     /*!
-     * Helper for #ListThreads::worker() for readability.
+     * Extend batch by queued work for adjacent tiles.
+     *
+     * Tiles following the batch are preferred over tiles preceding it
+     * because lists are usually scrolled down.
+     *
+     * \param queue
+     *     Where to take work from.
      *
-     * \pre The tile to be filled is locked by us.
+     * \param batch
+     *     Contains work for a single tile on entry, extended by work for
+     *     adjacent tiles in ascending order.
+     *
+     * \param with_preceding
+     *     Whether or not to extend the batch by preceding tiles. Items of
+     *     preceding tiles are filled in before the items of the tile in
+     *     \p batch, so this should be avoided if the reader is waiting for
+     *     that tile.
+     *
+     * \pre The work queue is locked by us.
      */
-    static void do_fill_tile(const Work &work_item)
+    static void collect_adjacent_work(WorkQueue &queue, std::deque<Work> &batch,
+                                      bool with_preceding)
     {
+        Work adjacent(batch.front());
+
+        while(batch.size() < MAXIMUM_TILES_PER_BATCH &&
+              queue.take_adjacent(batch.back(), true, adjacent))
+            batch.emplace_back(std::move(adjacent));
+
+        while(with_preceding && batch.size() < MAXIMUM_TILES_PER_BATCH &&
+              queue.take_adjacent(batch.front(), false, adjacent))
+            batch.emplace_front(std::move(adjacent));
+
+        if(batch.size() > 1)
+            LRU::Statistics::get_singleton().count(
+                LRU::Statistics::Counter::COALESCED_TILE_FILLS, batch.size() - 1);
+    }
+
+    /*!
+     * Helper for #ListThreads::worker() for readability.
+     *
+     * Fills all tiles in \p batch with a single call of the filler. Each tile
+     * is signaled ready and unlocked as soon as the filler has moved on to the
+     * next tile, so that readers need not wait for the whole batch.
+     *
+     * \pre The tiles to be filled are adjacent, sorted by their base index,
+     *     and locked by us through \p tlocks.
+     */
+    static void do_fill_tiles(const std::deque<Work> &batch,
+                              std::vector<LoggedLock::UniqueLock<LoggedLock::Mutex>> &tlocks)
+    {
+        /* tiles must not be accessed anymore after they have been unlocked,
+         * so take what we need now */
+        const Work &first(batch.front());
+        const uint32_t first_base = first.tile_->get_base();
+        const auto fill_start = LRU::timebase->now();
+        size_t current = 0;
+        size_t signaled_items = 0;
+        size_t total_number_of_items = 0;
+
+        for(const auto &work_item : batch)
+            total_number_of_items += work_item.tile_->get_items_per_tile();
+
+        const auto get_duration_since_start =
+            [&fill_start] ()
+            {
+                return std::chrono::duration_cast<std::chrono::microseconds>(
+                    LRU::timebase->now() - fill_start);
+            };
+
         ItemProvider<T>
-            item_provider(ListTile_<T, tile_size>::ItemProviderExtra::get_items_data(*work_item.tile_),
-                          tile_size);
+            item_provider(ListTile_<T, tile_size>::ItemProviderExtra::get_items_data(*first.tile_),
+                          first.tile_->get_items_per_tile(),
+                          &ListTile_<T, tile_size>::ItemProviderExtra::get_strings(*first.tile_),
+                          [&batch, &tlocks, &current, &signaled_items,
+                           &get_duration_since_start]
+                          (size_t &count, StringArena *&strings) -> ListItem_<T> *
+                          {
+                              auto &tile(*batch[current].tile_);
+                              signaled_items += tile.get_items_per_tile();
+                              tile.done_notification(tile.get_items_per_tile(),
+                                                     get_duration_since_start());
+                              tlocks[current].unlock();
+
+                              if(++current >= batch.size())
+                              {
+                                  count = 0;
+                                  strings = nullptr;
+                                  return nullptr;
+                              }
+
+                              auto &next(*batch[current].tile_);
+                              count = next.get_items_per_tile();
+                              strings = &ListTile_<T, tile_size>::ItemProviderExtra::get_strings(next);
+                              return ListTile_<T, tile_size>::ItemProviderExtra::get_items_data(next);
+                          },
+                          [&batch, &current] (size_t count)
+                          {
+                              batch[current].tile_->publish_notification(count);
+                          });
 
         ListError error;
         const ssize_t count =
-            work_item.filler_->fill(item_provider, work_item.list_id_,
-                                    ID::Item(work_item.tile_->get_base()),
-                                    tile_size, error,
-                                    [&work_item]()
-                                    {
-                                        return !work_item.tile_->is_requesting_cancel();
-                                    } );
-
-        if(count > 0)
-            work_item.tile_->done_notification(count);
-        else if(count < 0)
+            first.filler_->fill(item_provider, first.list_id_,
+                                ID::Item(first_base), total_number_of_items, error,
+                                [&batch, &current]()
+                                {
+                                    for(size_t i = current; i < batch.size(); ++i)
+                                        if(!batch[i].tile_->is_requesting_cancel())
+                                            return true;
+
+                                    return false;
+                                } );
+        const auto fill_duration = get_duration_since_start();
+
+        LRU::Statistics::get_singleton().record(
+            LRU::Statistics::Histogram::TILE_FILL_DURATION, fill_duration);
+
+        if(count < 0)
         {
+            LRU::Statistics::get_singleton().count(
+                LRU::Statistics::Counter::TILE_FILL_FAILURES);
+
             msg_error(0, LOG_ERR,
                       "Failed filling tile from list %u, index %u",
-                      work_item.list_id_.get_raw_id(),
-                      work_item.tile_->get_base());
-            work_item.tile_->canceled_notification(LRU::KilledLists::get_singleton(),
-                                                   error);
+                      first.list_id_.get_raw_id(), first_base);
+        }
+
+        /* tiles signaled ready already are full */
+        size_t remaining = count > 0 ? count : 0;
+        remaining -= std::min(remaining, signaled_items);
+
+        for(; current < batch.size(); ++current)
+        {
+            auto &tile(*batch[current].tile_);
+            const size_t n = std::min(remaining, size_t(tile.get_items_per_tile()));
+            remaining -= n;
+
+            /* readers may be using published items already, so these must be
+             * kept even if the filler claims otherwise */
+            const size_t published = tile.get_published_items_count();
+
+            if(n > 0 || published > 0)
+                tile.done_notification(std::max(n, published), fill_duration);
+            else if(count < 0)
+                tile.canceled_notification(LRU::KilledLists::get_singleton(),
+                                           error);
         }
     }
 };
 
+/*!
+ * Bounded store for tiles recently evicted from a #ListTiles_ ring.
+ *
+ * When a tile drops out of the ring of hot tiles, its items are moved here
+ * instead of being thrown away. Scrolling back to an evicted part of the list
+ * promotes the items back into a hot tile without asking the list filler.
+ *
+ * Cold tiles are stored compactly as vectors of exactly the number of items
+ * filled in, without the locking and state machinery of a #ListTile_. Their
+ * memory is accounted for in #ListColdTiles_::get_heap_size() so that it is
+ * charged to the owning list in the #LRU::Cache. The tile stored least
+ * recently is discarded when the store is full.
+ *
+ * \remark
+ *     All functions except #ListColdTiles_::get_heap_size() must be called
+ *     from the reading thread.
+ */
+template <typename T>
+class ListColdTiles_
+{
+  private:
+    struct ColdTile
+    {
+        uint32_t base_;
+        uint16_t items_per_tile_;
+        std::chrono::microseconds fill_duration_;
+        size_t heap_size_;
+        std::vector<ListItem_<T>> items_;
+        StringArena strings_;
+    };
+
+    const size_t maximum_number_of_tiles_;
+
+    /*!
+     * Cold tiles, most recently stored tile first.
+     */
+    std::deque<ColdTile> tiles_;
+
+    /*!
+     * Memory occupied by all cold tiles.
+     *
+     * Written by the reading thread, may be read by any thread.
+     */
+    std::atomic<size_t> heap_size_;
+
+  public:
+    ListColdTiles_(const ListColdTiles_ &) = delete;
+    ListColdTiles_ &operator=(const ListColdTiles_ &) = delete;
+
+    explicit ListColdTiles_(size_t maximum_number_of_tiles):
+        maximum_number_of_tiles_(maximum_number_of_tiles),
+        heap_size_(0)
+    {}
+
+    /*!
+     * Take items from evicted tile.
+     *
+     * Nothing is stored if the tile is not ready.
+     *
+     * \param tile
+     *     The evicted tile. It must be canceled and reset by the caller
+     *     afterwards.
+     *
+     * \param killed_list
+     *     Object which records lists removed from hot tiles.
+     */
+    template <uint16_t tile_size>
+    void store(ListTile_<T, tile_size> &tile, LRU::KilledLists &killed_list)
+    {
+        if(maximum_number_of_tiles_ == 0)
+            return;
+
+        ColdTile cold
+        {
+            tile.get_base(), tile.get_items_per_tile(),
+            tile.get_fill_duration(), 0, {}, StringArena(),
+        };
+
+        if(!tile.take_items(cold.items_, cold.strings_, killed_list))
+            return;
+
+        cold.heap_size_ = cold.items_.capacity() * sizeof(ListItem_<T>) +
+                          cold.strings_.get_heap_size();
+
+        for(const auto &item : cold.items_)
+            cold.heap_size_ += item.get_heap_size();
+
+        while(tiles_.size() >= maximum_number_of_tiles_)
+        {
+            heap_size_ -= tiles_.back().heap_size_;
+            tiles_.pop_back();
+        }
+
+        heap_size_ += cold.heap_size_;
+        tiles_.emplace_front(std::move(cold));
+
+        LRU::Statistics::get_singleton().count(LRU::Statistics::Counter::COLD_TILE_STORES);
+    }
+
+    /*!
+     * Move items back into given tile if they are available.
+     *
+     * \param tile
+     *     A freshly activated tile.
+     *
+     * \returns
+     *     True if the tile has been filled from the cold store and is ready,
+     *     false if the tile still needs to be filled.
+     */
+    template <uint16_t tile_size>
+    bool promote(ListTile_<T, tile_size> &tile)
+    {
+        const auto it =
+            std::find_if(tiles_.begin(), tiles_.end(),
+                         [&tile] (const ColdTile &cold)
+                         {
+                             return cold.base_ == tile.get_base() &&
+                                    cold.items_per_tile_ == tile.get_items_per_tile();
+                         });
+
+        if(it == tiles_.end())
+            return false;
+
+        msg_vinfo(MESSAGE_LEVEL_TRACE,
+                  "promote cold tile at index %u", it->base_);
+
+        heap_size_ -= it->heap_size_;
+        tile.restore_items(std::move(it->items_), std::move(it->strings_),
+                           it->fill_duration_);
+        tiles_.erase(it);
+
+        LRU::Statistics::get_singleton().count(LRU::Statistics::Counter::COLD_TILE_HITS);
+
+        return true;
+    }
+
+    /*!
+     * Discard all cold tiles.
+     */
+    void clear()
+    {
+        tiles_.clear();
+        heap_size_ = 0;
+    }
+
+    /*!
+     * Get number of bytes allocated on the heap by the cold tiles.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block.
+     */
+    size_t get_heap_size() const
+    {
+        return heap_size_;
+    }
+};
+
 /*!
  * Class template for managing lists in tiles instead of flat lists.
  *
- * This class is concerned with the management of center, up, and down tiles.
+ * This class is concerned with the management of a ring of consecutive tiles
+ * around a center tile. The tiles are stored in logical slots numbered from 0
+ * (top) to \p number_of_tiles - 1 (bottom). Sliding the cache up or down
+ * rotates the ring by one slot and reuses the tile which drops out at one end
+ * of the ring for the tile next to the other end.
+ *
+ * After sliding, the center tile is moved close to the end of the ring the
+ * user is scrolling away from so that most tiles are prefetched in scroll
+ * direction. With three tiles, this is the classic up/center/down scheme.
+ *
+ * Tiles dropping out of the ring are kept in a #ListColdTiles_ store of
+ * #ListTiles_::maximum_number_of_cold_tiles tiles, so scrolling back and forth
+ * does not require filling the same tiles over and over again.
+ *
+ * Tiles containing the items of the most recent request are filled with
+ * #ListFillPriority::DEMAND or #ListFillPriority::PREFETCH priority, all
+ * other tiles are filled with #ListFillPriority::BACKGROUND priority. Queued
+ * tiles are reprioritized on each request, so a tile the reader is about to
+ * block on is filled before speculatively prefetched tiles.
  *
  * \tparam T
  *     Domain-specific data to be stored per list item.
  *
  * \tparam tile_size
- *     How many items to store per tile. See also #TiledList.
+ *     How many items can be stored per tile at most. The number of items per
+ *     tile actually used can be changed at runtime. See also #TiledList.
+ *
+ * \tparam number_of_tiles
+ *     How many tiles to keep in cache. Must be at least 3.
  */
-template <typename T, uint16_t tile_size>
+template <typename T, uint16_t tile_size, size_t number_of_tiles>
 class ListTiles_
 {
   public:
     /*!
      * Number of tiles maintained by the tile cache.
      */
-    static constexpr size_t maximum_number_of_active_tiles = 3;
+    static constexpr size_t maximum_number_of_active_tiles = number_of_tiles;
 
     /*!
      * Number of items that can be stored in cache in best case.
@@ -985,46 +1942,97 @@ class ListTiles_
     static constexpr size_t maximum_number_of_hot_items =
         maximum_number_of_active_tiles * tile_size;
 
-    enum class ItemLocation
+    /*!
+     * Smallest supported number of items per tile.
+     */
+    static constexpr uint16_t minimum_items_per_tile = 1;
+
+    /*!
+     * Number of evicted tiles kept in cold store.
+     */
+    static constexpr size_t maximum_number_of_cold_tiles = 2 * number_of_tiles;
+
+  private:
+    /*!
+     * Slot number returned for indices not in cache.
+     */
+    static constexpr size_t INVALID_SLOT = maximum_number_of_active_tiles;
+
+    /*!
+     * Slot of the center tile after filling all tiles.
+     */
+    static constexpr size_t NEUTRAL_CENTER_SLOT = (number_of_tiles - 1) / 2;
+
+    /*!
+     * Slot of the center tile after sliding down, one tile is kept above.
+     */
+    static constexpr size_t CENTER_SLOT_AFTER_SLIDING_DOWN = 1;
+
+    /*!
+     * Slot of the center tile after sliding up, one tile is kept below.
+     */
+    static constexpr size_t CENTER_SLOT_AFTER_SLIDING_UP = number_of_tiles - 2;
+
+    enum class Direction
     {
-        NIL    = -1,
-        UP     = 0,
-        CENTER = 1,
-        DOWN   = 2,
+        UP,
+        DOWN,
     };
 
-  private:
     ListThreads<T, tile_size> &thread_pool_;
 
     std::array<ListTile_<T, tile_size>, maximum_number_of_active_tiles> hot_tiles_;
+
+    /*!
+     * Ring of active tiles, logical slot 0 is stored at #ListTiles_::ring_head_.
+     */
     std::array<ListTile_<T, tile_size> *, maximum_number_of_active_tiles> active_tiles_;
+    size_t ring_head_;
 
-    ssize_t get_backing_store_index_for_tile(ItemLocation which)
-    {
-        if(active_tiles_[size_t(which)] == nullptr)
-            return -1;
-        else
-            return active_tiles_[size_t(which)] - hot_tiles_.begin();
-    }
+    /*!
+     * Items of tiles which have recently dropped out of the ring.
+     */
+    ListColdTiles_<T> cold_tiles_;
+
+    /*!
+     * Logical slot of the tile containing the most recently accessed item.
+     */
+    size_t center_slot_;
 
     /*!
-     * Find a free tile in the tile cache.
+     * Number of items stored in each active tile.
      *
-     * \returns
-     *     The index of a free tile in #ListTiles_::hot_tiles_, or
-     *     #ListTiles_::maximum_number_of_active_tiles in case there is no free
-     *     tile.
+     * All tiles have the same size. The size is changed only when all tiles
+     * are going to be filled from scratch.
+     */
+    uint16_t items_per_tile_;
+
+    /*!
+     * Number of items per tile to be used for the next full fill.
      *
-     * \remark
-     *     This function is thread-safe if called from the reading thread.
-     *     Writers should not call this function.
+     * Written by any thread, read by the reading thread.
      */
-    size_t find_free_tile() const
+    std::atomic<uint16_t> requested_items_per_tile_;
+
+    /*!
+     * Range of items most recently passed to #ListTiles_::prefetch().
+     *
+     * Tiles overlapping this range are filled with
+     * #ListTiles_::requested_priority_, all other tiles are filled in
+     * background.
+     */
+    ID::Item requested_first_;
+    size_t requested_count_;
+    ListFillPriority requested_priority_;
+
+    ListTile_<T, tile_size> *&slot(size_t s)
+    {
+        return active_tiles_[(ring_head_ + s) % maximum_number_of_active_tiles];
+    }
+
+    const ListTile_<T, tile_size> *slot(size_t s) const
     {
-        return std::distance(
-                    hot_tiles_.begin(),
-                    std::find_if(hot_tiles_.begin(), hot_tiles_.end(),
-                                 [] (const auto &t) { return t.is_free(); }));
+        return active_tiles_[(ring_head_ + s) % maximum_number_of_active_tiles];
     }
 
     class SyncThreads
@@ -1053,12 +2061,25 @@ class ListTiles_
      * \param threads
      *     Filler thread pool whose threads fetch data from the network and
      *     place them into list tiles.
+     *
+     * \param items_per_tile
+     *     Initial number of items per tile, at most \p tile_size.
      */
-    explicit ListTiles_(ListThreads<T, tile_size> &threads):
+    explicit ListTiles_(ListThreads<T, tile_size> &threads,
+                        uint16_t items_per_tile = tile_size):
         thread_pool_(threads),
-        active_tiles_({nullptr, nullptr, nullptr})
+        ring_head_(0),
+        cold_tiles_(maximum_number_of_cold_tiles),
+        center_slot_(NEUTRAL_CENTER_SLOT),
+        items_per_tile_(clamp_items_per_tile(items_per_tile)),
+        requested_items_per_tile_(items_per_tile_),
+        requested_count_(0),
+        requested_priority_(ListFillPriority::BACKGROUND)
     {
         static_assert(tile_size > 0, "Tile size must be positive");
+        static_assert(number_of_tiles >= 3, "Need at least three tiles");
+
+        active_tiles_.fill(nullptr);
     }
 
     ~ListTiles_()
@@ -1067,25 +2088,38 @@ class ListTiles_
     }
 
   private:
+    static uint16_t clamp_items_per_tile(uint16_t items_per_tile)
+    {
+        return std::min(std::max(items_per_tile, minimum_items_per_tile),
+                        tile_size);
+    }
+
+    /*!
+     * Number of items that can be stored in cache with current tile size.
+     */
+    size_t get_number_of_hot_items() const
+    {
+        return maximum_number_of_active_tiles * items_per_tile_;
+    }
+
     /*!
      * Check which tile contains the given index, if any.
      *
      * \returns
-     *     Either #ListTiles_::ItemLocation::UP,
-     *     #ListTiles_::ItemLocation::CENTER, or
-     *     #ListTiles_::ItemLocation::DOWN in case the index is in some cached
-     *     tile, or #ListTiles_::ItemLocation::NIL in case the index in not in
-     *     cache.
+     *     The logical slot of the cached tile the index is in, or
+     *     #ListTiles_::INVALID_SLOT in case the index in not in cache.
      */
-    ItemLocation contains(ID::Item idx) const
+    size_t contains(ID::Item idx) const
     {
-        for(auto i = 0U; i < active_tiles_.size(); ++i)
+        for(size_t i = 0; i < maximum_number_of_active_tiles; ++i)
         {
-            if(active_tiles_[i] != nullptr && active_tiles_[i]->is_tile_for(idx))
-                return ItemLocation(i);
+            const auto *tile = slot(i);
+
+            if(tile != nullptr && tile->is_tile_for(idx))
+                return i;
         }
 
-        return ItemLocation::NIL;
+        return INVALID_SLOT;
     }
 
     /*!
@@ -1106,39 +2140,88 @@ class ListTiles_
      *
      * \returns
      *     Some valid index that lies within the tile adjacent to the origin
-     *     tile, or \p total_number_of_items of items in case \p direction is
-     *     #ListTiles_::ItemLocation::NIL.
+     *     tile. The list is treated as a ring, so the first tile is adjacent
+     *     to the last tile.
      */
-    static ID::Item index_in_adjacent_tile(ID::Item idx, size_t total_number_of_items,
-                                           ItemLocation direction)
+    ID::Item index_in_adjacent_tile(ID::Item idx, size_t total_number_of_items,
+                                    Direction direction) const
     {
-        ID::Item item(total_number_of_items);
+        const uint32_t raw_id = idx.get_raw_id();
 
         switch(direction)
         {
-          case ItemLocation::NIL:
-            break;
+          case Direction::UP:
+            if(raw_id >= items_per_tile_)
+                return ID::Item(raw_id - items_per_tile_);
+            else
+                return ID::Item(total_number_of_items - 1);
 
-          case ItemLocation::UP:
-            if(idx.get_raw_id() >= tile_size)
-                item = ID::Item(idx.get_raw_id() - tile_size);
+          case Direction::DOWN:
+            if(raw_id + items_per_tile_ < total_number_of_items)
+                return ID::Item(raw_id + items_per_tile_);
+            else if(raw_id - raw_id % items_per_tile_ + items_per_tile_ < total_number_of_items)
+            {
+                /* last tile is not completely filled */
+                return ID::Item(total_number_of_items - 1);
+            }
             else
-                item = ID::Item(total_number_of_items - 1);
-            break;
+                return ID::Item(0);
+        }
 
-          case ItemLocation::CENTER:
-            item = idx;
-            break;
+        return ID::Item(total_number_of_items);
+    }
 
-          case ItemLocation::DOWN:
-            if(idx.get_raw_id() + tile_size < total_number_of_items)
-                item = ID::Item(idx.get_raw_id() + tile_size);
-            else
-                item = ID::Item(0);
-            break;
+    /*!
+     * Apply #ListTiles_::index_in_adjacent_tile() \p distance times.
+     */
+    ID::Item index_in_tile_at_distance(ID::Item idx, size_t total_number_of_items,
+                                       Direction direction, size_t distance) const
+    {
+        for(size_t i = 0; i < distance; ++i)
+            idx = index_in_adjacent_tile(idx, total_number_of_items, direction);
+
+        return idx;
+    }
+
+    /*!
+     * How urgently the given tile is needed for the most recent request.
+     */
+    ListFillPriority get_fill_priority(const ListTile_<T, tile_size> &tile) const
+    {
+        const uint32_t first = requested_first_.get_raw_id();
+
+        if(tile.get_base() < first + requested_count_ &&
+           tile.get_base() + tile.get_items_per_tile() > first)
+            return requested_priority_;
+        else
+            return ListFillPriority::BACKGROUND;
+    }
+
+    /*!
+     * Adjust priorities of queued tiles to the most recent request.
+     *
+     * Tiles requested before, but not needed anymore, are moved to the
+     * background so that they do not delay tiles needed now.
+     */
+    void update_fill_priorities()
+    {
+        for(size_t i = 0; i < maximum_number_of_active_tiles; ++i)
+        {
+            const auto *tile = slot(i);
+
+            if(tile != nullptr)
+                thread_pool_.set_priority(*tile, get_fill_priority(*tile));
         }
+    }
 
-        return item;
+    /*!
+     * Fill activated tile from cold store, or have it filled by filler thread.
+     */
+    void materialize(ListTile_<T, tile_size> &tile,
+                     const TiledListFillerIface<T> &filler, ID::List list_id)
+    {
+        if(!cold_tiles_.promote(tile))
+            thread_pool_.enqueue(tile, filler, list_id, get_fill_priority(tile));
     }
 
     /*!
@@ -1154,108 +2237,114 @@ class ListTiles_
      *     Which list to fill.
      *
      * \param idx
-     *     Some index in the new center tile
+     *     Some index in the tile which ends up in slot \p center_slot.
      *
      * \param total_number_of_items
      *     Total size of the list in terms of number of items.
      *
-     * \param tile_to_keep, tile_to_push_out
-     *     Which tile is going to drop out and which is going to be kept when
-     *     sliding the tile cache. One of them must be
-     *     #ListTiles_::ItemLocation::UP, the other must be
-     *     #ListTiles_::ItemLocation::DOWN. Together, they define the sliding
-     *     direction.
+     * \param direction
+     *     Sliding direction. When sliding down, the tile in the top slot drops
+     *     out and is reused in the bottom slot, and vice versa.
+     *
+     * \param center_slot
+     *     Logical slot of the center tile after sliding.
      */
     void slide(const TiledListFillerIface<T> &filler, LRU::KilledLists &killed_list,
                ID::List list_id, ID::Item idx, size_t total_number_of_items,
-               ItemLocation tile_to_push_out, ItemLocation tile_to_keep)
+               Direction direction, size_t center_slot)
     {
-        ListTile_<T, tile_size> *const temp = active_tiles_[size_t(tile_to_push_out)];
-        active_tiles_[size_t(tile_to_push_out)] = active_tiles_[size_t(ItemLocation::CENTER)];
-        active_tiles_[size_t(ItemLocation::CENTER)] = active_tiles_[size_t(tile_to_keep)];
-        active_tiles_[size_t(tile_to_keep)] = temp;
-
-        msg_log_assert(active_tiles_[size_t(tile_to_push_out)] != nullptr);
+        LRU::Statistics::get_singleton().count(LRU::Statistics::Counter::TILE_SLIDES);
 
-        const ID::Item adjacent_index =
-            index_in_adjacent_tile(idx, total_number_of_items, tile_to_keep);
+        ListTile_<T, tile_size> *temp;
+        ID::Item adjacent_index;
 
-        if(temp != nullptr)
+        if(direction == Direction::UP)
         {
-           if(!temp->is_tile_for(adjacent_index))
-           {
-               msg_log_assert(!temp->is_free());
-               thread_pool_.cancel_filler(killed_list, *temp);
-
-               /* no locking of temp tile required here because the only thread
-                * that has been working on this tile, if any, was told to stop
-                * doing it in #ListThreads::cancel_filler(), and that function
-                * also waited for the thread to release the lock on temp */
-               temp->reset(killed_list);
-           }
-           else
-           {
-               /* the list is short and resides completely in memory */
-               msg_log_assert(active_tiles_[size_t(ItemLocation::CENTER)] != nullptr);
-               return;
-           }
+            ring_head_ = (ring_head_ + maximum_number_of_active_tiles - 1) %
+                         maximum_number_of_active_tiles;
+            temp = slot(0);
+            adjacent_index =
+                index_in_tile_at_distance(idx, total_number_of_items,
+                                          Direction::UP, center_slot);
+        }
+        else
+        {
+            temp = slot(0);
+            ring_head_ = (ring_head_ + 1) % maximum_number_of_active_tiles;
+            adjacent_index =
+                index_in_tile_at_distance(idx, total_number_of_items,
+                                          Direction::DOWN,
+                                          maximum_number_of_active_tiles - 1 - center_slot);
         }
 
-        const SyncThreads sync_filler(thread_pool_);
+        /* the list is short and resides completely in memory, rotating the
+         * ring is all we need to do */
+        if(total_number_of_items <= get_number_of_hot_items())
+            return;
 
-        if(active_tiles_[size_t(ItemLocation::CENTER)] == nullptr)
+        /* tiles of long lists occupy all slots all the time */
+        if(temp == nullptr)
         {
-            msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                      "materialize center tile around index %u", idx.get_raw_id());
+            MSG_BUG("No tile to reuse in slot %zu", center_slot);
+            return;
+        }
 
-            size_t tile_index = find_free_tile();
-            msg_log_assert(tile_index < maximum_number_of_active_tiles);
-            auto tile = hot_tiles_[tile_index].activate_tile(idx);
-            active_tiles_[size_t(ItemLocation::CENTER)] = tile;
+        msg_log_assert(!temp->is_free());
 
-            thread_pool_.enqueue(*tile, filler, list_id);
-        }
+        cold_tiles_.store(*temp, killed_list);
+        thread_pool_.cancel_filler(killed_list, *temp);
 
-        if(temp != nullptr)
-        {
-            msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                      "materialize adjacent tile around index %u", adjacent_index.get_raw_id());
-            auto tile = temp->activate_tile(adjacent_index);
-            thread_pool_.enqueue(*tile, filler, list_id);
-        }
+        /* no locking of temp tile required here because the only thread that
+         * has been working on this tile, if any, was told to stop doing it in
+         * #ListThreads::cancel_filler(), and that function also waited for the
+         * thread to release the lock on temp */
+        temp->reset(killed_list);
+
+        const SyncThreads sync_filler(thread_pool_);
+
+        msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                  "materialize adjacent tile around index %u", adjacent_index.get_raw_id());
+        auto tile = temp->activate_tile(adjacent_index, items_per_tile_);
+        materialize(*tile, filler, list_id);
     }
 
     void slide_up(const TiledListFillerIface<T> &filler,
                   LRU::KilledLists &killed_list, ID::List list_id, ID::Item idx,
-                  size_t total_number_of_items, const unsigned int steps)
+                  size_t total_number_of_items, const unsigned int steps,
+                  size_t center_slot)
     {
         msg_log_assert(steps > 0);
-        msg_log_assert(steps < maximum_number_of_hot_items);
+        msg_log_assert(steps < maximum_number_of_active_tiles);
 
         for(unsigned int i = 0; i < steps; ++i)
             slide(filler, killed_list, list_id,
-                  ID::Item(idx.get_raw_id() + (steps - i - 1) * tile_size),
-                  total_number_of_items,
-                  ItemLocation::DOWN, ItemLocation::UP);
+                  index_in_tile_at_distance(idx, total_number_of_items,
+                                            Direction::DOWN, steps - i - 1),
+                  total_number_of_items, Direction::UP, center_slot);
     }
 
     void slide_down(const TiledListFillerIface<T> &filler,
                     LRU::KilledLists &killed_list, ID::List list_id, ID::Item idx,
-                    size_t total_number_of_items, const unsigned int steps)
+                    size_t total_number_of_items, const unsigned int steps,
+                    size_t center_slot)
     {
         msg_log_assert(steps > 0);
-        msg_log_assert(steps < maximum_number_of_hot_items);
+        msg_log_assert(steps < maximum_number_of_active_tiles);
 
         for(unsigned int i = 0; i < steps; ++i)
             slide(filler, killed_list, list_id,
-                  ID::Item(idx.get_raw_id() - (steps - i - 1) * tile_size),
-                  total_number_of_items,
-                  ItemLocation::UP, ItemLocation::DOWN);
+                  index_in_tile_at_distance(idx, total_number_of_items,
+                                            Direction::UP, steps - i - 1),
+                  total_number_of_items, Direction::DOWN, center_slot);
     }
 
     /*!
      * Attempt to fill all tiles using given filler.
      *
+     * The center tile is placed into #ListTiles_::NEUTRAL_CENTER_SLOT and is
+     * filled first. The remaining slots are filled alternating below and
+     * above the center tile.
+     *
      * \exception #ListIterException
      *     This function throws a #ListIterException in case the filler fails
      *     hard to fill any tile.
@@ -1271,46 +2360,136 @@ class ListTiles_
         const SyncThreads sync_filler(thread_pool_);
 
         /* center tile first */
-        auto tile = hot_tiles_[0].activate_tile(center_idx);
-        active_tiles_[size_t(ItemLocation::CENTER)] = tile;
+        auto tile = hot_tiles_[0].activate_tile(center_idx, items_per_tile_);
+        slot(NEUTRAL_CENTER_SLOT) = tile;
 
-        thread_pool_.enqueue(*tile, filler, list_id);
+        materialize(*tile, filler, list_id);
 
-        if(total_number_of_items <= tile_size)
-            return;
+        const size_t number_of_tiles_to_fill =
+            std::min(maximum_number_of_active_tiles,
+                     (total_number_of_items + items_per_tile_ - 1) / items_per_tile_);
+        size_t next_free_tile = 1;
+        const ListTile_<T, tile_size> *down_tile = tile;
+        const ListTile_<T, tile_size> *up_tile = tile;
 
-        /* have enough items to fill down-tile */
-        const ID::Item down_idx((tile->get_base() < total_number_of_items - tile_size)
-                                ? tile->get_base() + tile_size
-                                : 0);
-
-        tile = hot_tiles_[1].activate_tile(down_idx);
-        active_tiles_[size_t(ItemLocation::DOWN)] = tile;
+        for(size_t distance = 1; next_free_tile < number_of_tiles_to_fill; ++distance)
+        {
+            if(NEUTRAL_CENTER_SLOT + distance < maximum_number_of_active_tiles)
+            {
+                const ID::Item down_idx((down_tile->get_base() < total_number_of_items - items_per_tile_)
+                                        ? down_tile->get_base() + items_per_tile_
+                                        : 0);
 
-        thread_pool_.enqueue(*tile, filler, list_id);
+                tile = hot_tiles_[next_free_tile++].activate_tile(down_idx, items_per_tile_);
+                slot(NEUTRAL_CENTER_SLOT + distance) = tile;
+                down_tile = tile;
 
-        if(total_number_of_items <= 2U * tile_size)
-            return;
+                materialize(*tile, filler, list_id);
+            }
 
-        /* have enough items to fill up-tile as well */
-        tile = active_tiles_[size_t(ItemLocation::CENTER)];
-        const ID::Item up_idx((tile->get_base() > 0)
-                              ? tile->get_base() - tile_size
-                              : total_number_of_items - 1);
+            if(next_free_tile < number_of_tiles_to_fill &&
+               distance <= NEUTRAL_CENTER_SLOT)
+            {
+                const ID::Item up_idx((up_tile->get_base() > 0)
+                                      ? up_tile->get_base() - items_per_tile_
+                                      : total_number_of_items - 1);
 
-        tile = hot_tiles_[2].activate_tile(up_idx);
-        active_tiles_[size_t(ItemLocation::UP)] = tile;
+                tile = hot_tiles_[next_free_tile++].activate_tile(up_idx, items_per_tile_);
+                slot(NEUTRAL_CENTER_SLOT - distance) = tile;
+                up_tile = tile;
 
-        thread_pool_.enqueue(*tile, filler, list_id);
+                materialize(*tile, filler, list_id);
+            }
+        }
     }
 
   public:
+    /*!
+     * Get number of bytes allocated on the heap by the items in all tiles,
+     * including cold tiles.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block.
+     */
+    size_t get_heap_size() const
+    {
+        size_t result = 0;
+
+        for(const auto &t : hot_tiles_)
+            result += t.get_heap_size();
+
+        return result + cold_tiles_.get_heap_size();
+    }
+
+    /*!
+     * Get time it took to fill all tiles the last time.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block.
+     */
+    std::chrono::microseconds get_fill_duration() const
+    {
+        std::chrono::microseconds result(0);
+
+        for(const auto &t : hot_tiles_)
+            result += t.get_fill_duration();
+
+        return result;
+    }
+
+    /*!
+     * Pass items stored in all ready tiles to given function.
+     *
+     * \remark
+     *     This function is thread-safe. It does not block.
+     */
+    void for_each_ready_item(const std::function<void(uint32_t, const ListItem_<T> &)> &fn) const
+    {
+        for(const auto &t : hot_tiles_)
+            t.for_each_ready_item(fn);
+    }
+
     bool empty() const
     {
         return std::all_of(active_tiles_.begin(), active_tiles_.end(),
                            [] (const auto &t) { return t == nullptr; });
     }
 
+    /*!
+     * Number of items per tile currently in use.
+     *
+     * \remark
+     *     This function must be called from the reading thread.
+     */
+    uint16_t get_items_per_tile() const { return items_per_tile_; }
+
+    /*!
+     * Number of items per tile to be used for the next full fill.
+     *
+     * \remark
+     *     This function is thread-safe.
+     */
+    uint16_t get_requested_items_per_tile() const { return requested_items_per_tile_; }
+
+    /*!
+     * Change number of items per tile.
+     *
+     * The new size is not applied immediately because this would require
+     * dropping all tiles. Instead, it is applied when the cache is filled
+     * from scratch next time, i.e., when the list is accessed outside of the
+     * cached tiles.
+     *
+     * \param items_per_tile
+     *     New number of items per tile. It is limited to \p tile_size.
+     *
+     * \remark
+     *     This function is thread-safe.
+     */
+    void request_items_per_tile(uint16_t items_per_tile)
+    {
+        requested_items_per_tile_ = clamp_items_per_tile(items_per_tile);
+    }
+
     bool prefetch(const TiledListFillerIface<T> &filler, ID::List list_id,
                   ID::Item first, size_t count, size_t total_number_of_items,
                   bool auto_slide)
@@ -1318,184 +2497,222 @@ class ListTiles_
         if(count == 0)
             return false;
 
-        const uint16_t position_of_first_in_tile = first.get_raw_id() % tile_size;
-
-        if(count + position_of_first_in_tile > maximum_number_of_hot_items)
-        {
-            /* need more than three tiles for this */
-            return false;
-        }
+        requested_first_ = first;
+        requested_count_ = count;
+        requested_priority_ =
+            auto_slide ? ListFillPriority::DEMAND : ListFillPriority::PREFETCH;
 
-        unsigned int required_number_of_slides;
-        unsigned int number_of_spanned_tiles;
-        const ItemLocation slide_direction =
-            check_overlapping_range_for_prefetch(first, count, required_number_of_slides,
-                                                 number_of_spanned_tiles);
+        const uint16_t requested_items_per_tile = requested_items_per_tile_;
 
-        if(required_number_of_slides == 0)
+        if(requested_items_per_tile != items_per_tile_ &&
+           contains(first) == INVALID_SLOT &&
+           contains(ID::Item(first.get_raw_id() + count - 1)) == INVALID_SLOT)
         {
-           if(auto_slide && (slide_direction == ItemLocation::UP ||
-                             slide_direction == ItemLocation::DOWN))
-               required_number_of_slides = 1;
-           else
-           {
-               /* sliding up or down not required, and automatic sliding is either
-                * not requested or not applicable */
-               msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                         "no need to prefetch index %u, already in cache",
-                        first.get_raw_id());
-               return true;
-           }
+            /* going to fill all tiles anyway, so this is a good time for
+             * changing the tile size */
+            clear();
+            cold_tiles_.clear();
+            items_per_tile_ = requested_items_per_tile;
         }
 
-        ID::Item center_index;
+        /* done before sliding because sliding may block on the filler
+         * thread, which should pick up the requested tiles next */
+        update_fill_priorities();
 
-        if((auto_slide && number_of_spanned_tiles < maximum_number_of_active_tiles) ||
-           (slide_direction == ItemLocation::NIL && number_of_spanned_tiles < maximum_number_of_active_tiles) ||
-           (slide_direction == ItemLocation::DOWN && required_number_of_slides == 1) ||
-           required_number_of_slides == 0)
-        {
-            /* fewer than three tiles required, up tile remains empty */
-            center_index = first;
-        }
-        else
+        const uint16_t position_of_first_in_tile = first.get_raw_id() % items_per_tile_;
+
+        if(count + position_of_first_in_tile > get_number_of_hot_items())
         {
-            /* need three tiles, make sure first ends up in the up tile */
-            center_index = ID::Item(first.get_raw_id() + tile_size);
+            /* need more tiles than we have for this */
+            return false;
         }
 
-        switch(slide_direction)
-        {
-          case ItemLocation::CENTER:
-            MSG_BUG("Invalid slide direction");
-            break;
+        const size_t number_of_spanned_tiles =
+            1 + (position_of_first_in_tile + count - 1) / items_per_tile_;
 
-          case ItemLocation::UP:
-            if(required_number_of_slides == 0)
-                msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                          "no need to prefetch index %u, already in cache",
-                         first.get_raw_id());
-            else
-            {
-                msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                          "slide up to index %u", first.get_raw_id());
-                slide_up(filler, LRU::KilledLists::get_singleton(), list_id,
-                         center_index, total_number_of_items,
-                         required_number_of_slides);
-            }
+        Direction direction;
+        unsigned int number_of_slides;
+        size_t slot_of_first_after_sliding;
+        const bool is_in_cache =
+            check_overlapping_range_for_prefetch(first, count,
+                                                 number_of_spanned_tiles,
+                                                 auto_slide, direction,
+                                                 number_of_slides,
+                                                 slot_of_first_after_sliding);
 
+        auto &stats(LRU::Statistics::get_singleton());
+        stats.count(LRU::Statistics::Counter::TILE_PREFETCHES);
+
+        if(number_of_slides == 0)
+        {
+            stats.count(LRU::Statistics::Counter::TILE_HITS);
+            msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                      "no need to prefetch index %u, already in cache",
+                      first.get_raw_id());
             return true;
+        }
 
-          case ItemLocation::DOWN:
-            if(required_number_of_slides == 0)
-                msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                          "no need to prefetch index %u, already in cache",
-                         first.get_raw_id());
-            else
-            {
-                msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                          "slide down to index %u", first.get_raw_id());
-                slide_down(filler, LRU::KilledLists::get_singleton(), list_id,
-                           center_index, total_number_of_items,
-                           required_number_of_slides);
-            }
+        stats.count(is_in_cache
+                    ? LRU::Statistics::Counter::TILE_HITS
+                    : LRU::Statistics::Counter::TILE_MISSES);
 
-            return true;
+        if(number_of_slides >= maximum_number_of_active_tiles)
+        {
+            /* make sure the range fits with as many tiles as possible ahead */
+            const size_t tiles_ahead =
+                maximum_number_of_active_tiles - 1 - NEUTRAL_CENTER_SLOT;
+
+            const ID::Item center_index =
+                number_of_spanned_tiles - 1 <= tiles_ahead
+                ? first
+                : index_in_tile_at_distance(first, total_number_of_items,
+                                            Direction::DOWN,
+                                            number_of_spanned_tiles - 1 - tiles_ahead);
 
-          case ItemLocation::NIL:
             msg_vinfo(MESSAGE_LEVEL_DEBUG,
                       "prefetch %zu items, starting at index %u", count, first.get_raw_id());
             fill(filler, list_id, center_index, total_number_of_items);
+            center_slot_ = NEUTRAL_CENTER_SLOT;
             return true;
         }
 
-        throw ListIterException("Invalid slide direction", ListError::INTERNAL);
+        const size_t new_center_slot = direction == Direction::UP
+            ? CENTER_SLOT_AFTER_SLIDING_UP
+            : CENTER_SLOT_AFTER_SLIDING_DOWN;
 
-        return false;
-    }
+        msg_log_assert(slot_of_first_after_sliding <= new_center_slot);
+
+        const ID::Item center_index =
+            index_in_tile_at_distance(first, total_number_of_items, Direction::DOWN,
+                                      new_center_slot - slot_of_first_after_sliding);
 
-  private:
-    static unsigned int
-    compute_number_of_required_slides(ItemLocation &direction, bool is_first_item,
-                                      unsigned int number_of_spanned_tiles)
-    {
         switch(direction)
         {
-          case ItemLocation::UP:
-            if(is_first_item)
-                return 0;
-            else
-                return number_of_spanned_tiles - 1;
-
-          case ItemLocation::DOWN:
-            if(is_first_item)
-                return number_of_spanned_tiles - 1;
-            else
-                return 0;
-
-          case ItemLocation::CENTER:
-            {
-                unsigned int ret = number_of_spanned_tiles >= 2 ? number_of_spanned_tiles - 2 : 0;
-
-                if(ret > 0)
-                    direction = is_first_item ? ItemLocation::UP : ItemLocation::DOWN;
-
-                return ret;
-            }
+          case Direction::UP:
+            msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                      "slide up to index %u", first.get_raw_id());
+            slide_up(filler, LRU::KilledLists::get_singleton(), list_id,
+                     center_index, total_number_of_items, number_of_slides,
+                     new_center_slot);
+            break;
 
-          case ItemLocation::NIL:
+          case Direction::DOWN:
+            msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                      "slide down to index %u", first.get_raw_id());
+            slide_down(filler, LRU::KilledLists::get_singleton(), list_id,
+                       center_index, total_number_of_items, number_of_slides,
+                       new_center_slot);
             break;
         }
 
-        return maximum_number_of_active_tiles;
+        center_slot_ = new_center_slot;
+
+        return true;
     }
 
-    ItemLocation check_overlapping_range_for_prefetch(ID::Item first,
-                                                      size_t count,
-                                                      unsigned int &required_number_of_slides,
-                                                      unsigned int &number_of_spanned_tiles) const
+  private:
+    /*!
+     * Find out how to slide the tile cache so that the given range is cached.
+     *
+     * \param first, count
+     *     The range of items to be cached.
+     *
+     * \param number_of_spanned_tiles
+     *     Number of tiles the range spans.
+     *
+     * \param auto_slide
+     *     If true, then slide the tile containing \p first into the center slot
+     *     even if the range is in cache already.
+     *
+     * \param[out] direction
+     *     Sliding direction.
+     *
+     * \param[out] number_of_slides
+     *     How many slots the ring of tiles must be rotated by. This is 0 if
+     *     nothing needs to be done, and it is
+     *     #ListTiles_::maximum_number_of_active_tiles in case all tiles must be
+     *     filled from scratch.
+     *
+     * \param[out] slot_of_first_after_sliding
+     *     Logical slot of the tile containing \p first after sliding.
+     *
+     * \returns
+     *     True if the whole range is in cache, false otherwise.
+     */
+    bool check_overlapping_range_for_prefetch(ID::Item first, size_t count,
+                                              size_t number_of_spanned_tiles,
+                                              bool auto_slide,
+                                              Direction &direction,
+                                              unsigned int &number_of_slides,
+                                              size_t &slot_of_first_after_sliding) const
     {
-        const uint16_t position_of_first_in_tile =
-            first.get_raw_id() % tile_size;
-
-        number_of_spanned_tiles =
-            1 + (position_of_first_in_tile + count - 1) / tile_size;
-
         msg_log_assert(number_of_spanned_tiles >= 1);
         msg_log_assert(number_of_spanned_tiles <= maximum_number_of_active_tiles);
 
-        ItemLocation retval = contains(first);
+        direction = Direction::DOWN;
+        number_of_slides = 0;
+        slot_of_first_after_sliding = INVALID_SLOT;
+
+        const size_t first_slot = contains(first);
 
-        if(retval != ItemLocation::NIL)
+        if(first_slot != INVALID_SLOT)
         {
-            required_number_of_slides =
-                compute_number_of_required_slides(retval, true, number_of_spanned_tiles);
+            const size_t last_slot = first_slot + number_of_spanned_tiles - 1;
 
-            msg_log_assert(required_number_of_slides < maximum_number_of_active_tiles);
+            if(last_slot < maximum_number_of_active_tiles)
+            {
+                if(!auto_slide || first_slot == center_slot_)
+                    return true;
 
-            return retval;
+                /* move accessed tile into center, prefetch in scroll
+                 * direction */
+                if(first_slot > center_slot_)
+                {
+                    direction = Direction::DOWN;
+                    number_of_slides = first_slot - CENTER_SLOT_AFTER_SLIDING_DOWN;
+                }
+                else
+                {
+                    direction = Direction::UP;
+                    number_of_slides = CENTER_SLOT_AFTER_SLIDING_UP - first_slot;
+                }
+            }
+            else
+                number_of_slides =
+                    std::max(last_slot - (maximum_number_of_active_tiles - 1),
+                             first_slot > CENTER_SLOT_AFTER_SLIDING_DOWN
+                             ? first_slot - CENTER_SLOT_AFTER_SLIDING_DOWN
+                             : 0);
+
+            slot_of_first_after_sliding = direction == Direction::DOWN
+                ? first_slot - number_of_slides
+                : first_slot + number_of_slides;
+
+            return last_slot < maximum_number_of_active_tiles;
         }
 
         if(number_of_spanned_tiles > 1)
         {
-            ID::Item last(first.get_raw_id() + count - 1);
-
-            retval = contains(last);
+            const ID::Item last(first.get_raw_id() + count - 1);
+            const size_t last_slot = contains(last);
 
-            if(retval != ItemLocation::NIL)
+            if(last_slot != INVALID_SLOT && last_slot < number_of_spanned_tiles - 1)
             {
-                required_number_of_slides =
-                    compute_number_of_required_slides(retval, false, number_of_spanned_tiles);
-
-                msg_log_assert(required_number_of_slides < maximum_number_of_active_tiles);
-
-                return retval;
+                direction = Direction::UP;
+                number_of_slides =
+                    std::max(number_of_spanned_tiles - 1 - last_slot,
+                             CENTER_SLOT_AFTER_SLIDING_UP > last_slot
+                             ? CENTER_SLOT_AFTER_SLIDING_UP - last_slot
+                             : 0);
+                slot_of_first_after_sliding =
+                    last_slot + number_of_slides - (number_of_spanned_tiles - 1);
+                return false;
             }
         }
 
-        required_number_of_slides = maximum_number_of_active_tiles;
+        number_of_slides = maximum_number_of_active_tiles;
 
-        return ItemLocation::NIL;
+        return false;
     }
 
     void clear()
@@ -1514,34 +2731,36 @@ class ListTiles_
         }
 
         active_tiles_.fill(nullptr);
+        ring_head_ = 0;
+        center_slot_ = NEUTRAL_CENTER_SLOT;
     }
 
   public:
     /*!
      * Iterator for stored #ListItem_ structures.
+     *
+     * The iterator walks through the logical slots of the ring of tiles,
+     * starting at the slot of the first item and wrapping around at the
+     * bottom. Empty slots are skipped.
      */
     class const_iterator
     {
       private:
         const ListTiles_ &src_;
-        const ItemLocation last_tile_;
-        ItemLocation which_tile_;
+        const size_t last_tile_;
+        size_t which_tile_;
         uint16_t idx_;
         ListError first_list_error_;
 
-        static constexpr ItemLocation determine_last_tile(ItemLocation first)
+        static constexpr size_t determine_last_tile(size_t first)
         {
-            return (first == ItemLocation::DOWN
-                    ? ItemLocation::CENTER
-                    : (first == ItemLocation::UP
-                       ? ItemLocation::DOWN
-                       : (first == ItemLocation::CENTER
-                          ? ItemLocation::UP
-                          : ItemLocation::NIL)));
+            return (first == INVALID_SLOT
+                    ? INVALID_SLOT
+                    : (first + maximum_number_of_active_tiles - 1) % maximum_number_of_active_tiles);
         }
 
       public:
-        explicit const_iterator(const ListTiles_ &src, uint16_t idx, ItemLocation which_tile):
+        explicit const_iterator(const ListTiles_ &src, uint16_t idx, size_t which_tile):
             src_(src),
             last_tile_(determine_last_tile(which_tile)),
             which_tile_(which_tile),
@@ -1550,14 +2769,14 @@ class ListTiles_
         {
             find_first();
 
-            if(which_tile_ != ItemLocation::NIL)
+            if(which_tile_ != INVALID_SLOT)
                 idx_ = idx;
         }
 
         constexpr explicit const_iterator(const ListTiles_ &src):
             src_(src),
-            last_tile_(ItemLocation::NIL),
-            which_tile_(ItemLocation::NIL),
+            last_tile_(INVALID_SLOT),
+            which_tile_(INVALID_SLOT),
             idx_(0),
             first_list_error_(ListError::OK)
         {}
@@ -1569,7 +2788,7 @@ class ListTiles_
 
         const_iterator &operator++()
         {
-            if(which_tile_ == ItemLocation::NIL)
+            if(which_tile_ == INVALID_SLOT)
                 throw ListIterException("Cannot step beyond end of ListTiles_::const_iterator",
                                         get_list_error_code());
 
@@ -1581,11 +2800,11 @@ class ListTiles_
 
         const ListItem_<T> &operator*() const
         {
-            if(which_tile_ == ItemLocation::NIL)
+            if(which_tile_ == INVALID_SLOT)
                 throw ListIterException("Cannot dereference end of ListTiles_::const_iterator",
                                         get_list_error_code());
 
-            return src_.active_tiles_[size_t(which_tile_)]->get_list_item_by_raw_index(idx_);
+            return src_.slot(which_tile_)->get_list_item_by_raw_index(idx_);
         }
 
         const ListItem_<T> *operator->() const
@@ -1595,7 +2814,7 @@ class ListTiles_
 
         uint32_t get_item_id() const
         {
-            return src_.active_tiles_[size_t(which_tile_)]->get_base() + idx_;
+            return src_.slot(which_tile_)->get_base() + idx_;
         }
 
       private:
@@ -1617,35 +2836,22 @@ class ListTiles_
         {
             idx_ = 0;
 
-            if(which_tile_ == ItemLocation::NIL || which_tile_ == last_tile_)
-                which_tile_ = ItemLocation::NIL;
-
-            switch(which_tile_)
+            if(which_tile_ == INVALID_SLOT || which_tile_ == last_tile_)
             {
-              case ItemLocation::NIL:
-                break;
-
-              case ItemLocation::DOWN:
-                which_tile_ = ItemLocation::UP;
-                return true;
-
-              case ItemLocation::UP:
-                which_tile_ = ItemLocation::CENTER;
-                return true;
-
-              case ItemLocation::CENTER:
-                which_tile_ = ItemLocation::DOWN;
-                return true;
+                which_tile_ = INVALID_SLOT;
+                return false;
             }
 
-            return false;
+            which_tile_ = (which_tile_ + 1) % maximum_number_of_active_tiles;
+
+            return true;
         }
 
         bool step()
         {
             try
             {
-                if(++idx_ < src_.active_tiles_[size_t(which_tile_)]->size())
+                if(src_.slot(which_tile_)->has_item(++idx_))
                     return true;
                 else
                     return next_tile();
@@ -1659,15 +2865,15 @@ class ListTiles_
 
         void find_first()
         {
-            while(which_tile_ != ItemLocation::NIL)
+            while(which_tile_ != INVALID_SLOT)
             {
-                if(src_.active_tiles_[size_t(which_tile_)] == nullptr)
+                if(src_.slot(which_tile_) == nullptr)
                     (void)next_tile();
                 else
                 {
                     try
                     {
-                        if(idx_ < src_.active_tiles_[size_t(which_tile_)]->size())
+                        if(src_.slot(which_tile_)->has_item(idx_))
                             break;
                         else
                             (void)step();
@@ -1685,13 +2891,13 @@ class ListTiles_
     const_iterator begin(ID::Item first) const
     {
         return const_iterator(*this,
-                              first.get_raw_id() % tile_size,
+                              first.get_raw_id() % items_per_tile_,
                               contains(first));
     }
 
     const_iterator begin() const
     {
-        return const_iterator(*this, 0, ItemLocation::UP);
+        return const_iterator(*this, 0, 0);
     }
 
     constexpr const_iterator end() const
@@ -1706,19 +2912,53 @@ class ListTiles_
 
     const ListItem_<T> &get_list_item_unsafe(ID::Item id) const
     {
-        const auto center_tile = active_tiles_[size_t(ItemLocation::CENTER)];
+        const auto center_tile = slot(center_slot_);
         return center_tile->get_list_item_by_raw_index(id.get_raw_id() - center_tile->get_base());
     }
 
+    /*!
+     * Get item if it is stored in any of the active tiles.
+     *
+     * In contrast to #ListTiles_::get_list_item_unsafe(), the item need not
+     * be stored in the center tile, and the tiles are not moved around.
+     *
+     * \returns
+     *     The item, or \c nullptr if the item is not stored in any active tile
+     *     or if filling its tile has failed.
+     */
+    const ListItem_<T> *lookup_list_item(ID::Item id) const
+    {
+        const size_t s = contains(id);
+
+        if(s == INVALID_SLOT)
+            return nullptr;
+
+        const auto *tile = slot(s);
+        const uint16_t raw_index = id.get_raw_id() - tile->get_base();
+
+        try
+        {
+            if(tile->has_item(raw_index))
+                return &tile->get_list_item_by_raw_index(raw_index);
+        }
+        catch(const ListIterException &)
+        {
+            /* tile failed, so there is no item */
+        }
+
+        return nullptr;
+    }
+
     class ClearTile
     {
         static inline void clear(ListTiles_ &tiles)
         {
             tiles.clear();
+            tiles.cold_tiles_.clear();
         }
 
         /* for resetting a list to empty state without having to delete it*/
-        friend class TiledList<T, tile_size>;
+        friend class TiledList<T, tile_size, number_of_tiles>;
     };
 };
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2019  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2019, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -35,7 +35,7 @@ template <typename T>
 static void send_cover_art(const ListItem_<T> &item,
                            const ListItemKey &item_key, uint8_t priority)
 {
-    const Url::String album_art_url(item.get_specific_data().get_album_art_url());
+    const std::string_view album_art_url(item.get_specific_data().get_album_art_url_cleartext());
 
     if(album_art_url.empty())
         return;
@@ -44,7 +44,7 @@ static void send_cover_art(const ListItem_<T> &item,
     tdbus_artcache_write_call_add_image_by_uri_sync(dbus_artcache_get_write_iface(),
                                                     hash_to_variant(item_key),
                                                     priority,
-                                                    album_art_url.get_cleartext().c_str(),
+                                                    album_art_url.data(),
                                                     NULL, error.await());
     error.log_failure("Send cover art");
 }
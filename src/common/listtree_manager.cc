@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2022, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2022, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -56,7 +56,20 @@ bool ListTreeManager::use_list(ID::List id, bool pin_it)
     if(!id.is_valid())
         return false;
 
-    if(cache_.use(id) == LRU::Cache::USED_ENTRY_INVALID_ID)
+    /* the list may have grown or shrunk since it was used last time, so we
+     * take the opportunity to update its size in the cache */
+    const auto list(cache_.lookup(id));
+    if(list == nullptr)
+        return false;
+
+    const size_t size = list->get_size_in_bytes();
+
+    if(size > 0)
+    {
+        if(!cache_.set_object_size(id, size))
+            return false;
+    }
+    else if(cache_.use(id) == LRU::Cache::USED_ENTRY_INVALID_ID)
         return false;
 
     if(!pin_it)
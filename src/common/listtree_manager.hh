@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2022, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2022, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -25,6 +25,7 @@
 #include <string>
 
 #include "lru.hh"
+#include "lru_pool_allocator.hh"
 #include "i18nstring.hh"
 #include "enterchild_glue.hh"
 #include "cacheable.hh"
@@ -85,7 +86,7 @@ class ListTreeManager
     {
         msg_log_assert(pending_list_ == nullptr);
 
-        auto l = std::make_shared<T>(parent, args...);
+        auto l = LRU::make_pooled<T>(parent, args...);
         msg_log_assert(l != nullptr);
 
         pending_list_ = l;
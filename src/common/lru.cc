@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2021, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2021, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -29,6 +29,7 @@
 
 #include <algorithm>
 #include <unordered_map>
+#include <tuple>
 #include <ostream>
 
 void LRU::KilledLists::killed(ID::List list_id)
@@ -84,28 +85,51 @@ ID::List LRU::CacheIdGenerator::next(LRU::CacheMode cache_mode,
 {
     msg_log_assert(ctx <= DBUS_LISTS_CONTEXT_ID_MAX);
 
+    if(used_ids_[ctx] == nullptr)
+        used_ids_[ctx] = std::make_unique<IdBitmap>(base_id_max_ - base_id_min_ + 1);
+
+    IdBitmap &used(*used_ids_[ctx]);
     uint32_t &next_id_for_context = next_id_[ctx];
-    const uint32_t start_point = next_id_for_context;
 
-    do
-    {
-        const ID::List candidate(make_list_id(next_id_for_context,
-                                              cache_mode, ctx));
+    size_t bit = used.find_clear(next_id_for_context - base_id_min_);
 
-        if(next_id_for_context < base_id_max_)
-            ++next_id_for_context;
-        else
-        {
-            /* ID overflow */
-            next_id_for_context = base_id_min_;
-        }
+    if(bit >= used.size())
+    {
+        /* ID overflow */
+        bit = used.find_clear(0);
 
-        if(is_id_free_(candidate))
-            return candidate;
+        if(bit >= used.size())
+            return ID::List();
     }
-    while(start_point != next_id_for_context);
 
-    return ID::List();
+    used.set(bit);
+
+    const uint32_t raw_id = base_id_min_ + bit;
+    next_id_for_context = raw_id < base_id_max_ ? raw_id + 1 : base_id_min_;
+
+    return make_list_id(raw_id, cache_mode, ctx);
+}
+
+bool LRU::CacheIdGenerator::release(ID::List id)
+{
+    const auto ctx = id.get_context();
+    const uint32_t raw_id = id.get_cooked_id();
+
+    if(used_ids_[ctx] == nullptr || raw_id < base_id_min_)
+        return false;
+
+    return used_ids_[ctx]->clear(raw_id - base_id_min_);
+}
+
+bool LRU::CacheIdGenerator::is_used(ID::List id) const
+{
+    const auto ctx = id.get_context();
+    const uint32_t raw_id = id.get_cooked_id();
+
+    if(used_ids_[ctx] == nullptr || raw_id < base_id_min_)
+        return false;
+
+    return used_ids_[ctx]->is_set(raw_id - base_id_min_);
 }
 
 LRU::Cache::Cache(size_t memory_hard_upper_limit,
@@ -115,11 +139,7 @@ LRU::Cache::Cache(size_t memory_hard_upper_limit,
                   unsigned int memory_low_watermark_permil,
                   unsigned int count_high_watermark_permil,
                   unsigned int count_low_watermark_permil):
-    id_generator_(1, CacheIdGenerator::ID_MAX,
-                  [this](ID::List id) -> bool
-                  {
-                      return all_objects_.find(id) == all_objects_.end();
-                  }),
+    id_generator_(1, CacheIdGenerator::ID_MAX),
     memory_limits_(memory_hard_upper_limit,
                    memory_high_watermark_permil,
                    memory_low_watermark_permil),
@@ -132,7 +152,10 @@ LRU::Cache::Cache(size_t memory_hard_upper_limit,
     deepest_youngest_object_(nullptr),
     minimum_required_creation_time_(timebase->now()),
     total_size_(0),
-    is_garbage_collector_running_(false)
+    is_garbage_collector_running_(false),
+    gc_cursor_(nullptr),
+    eviction_policy_(EvictionPolicy::LEAST_RECENTLY_USED),
+    inflation_(0.0)
 {}
 
 LRU::Cache::~Cache()
@@ -197,38 +220,79 @@ ssize_t LRU::Cache::unlink_objects_on_path_to_root(Entry *entry,
 }
 
 void LRU::Cache::link_objects_on_path_to_root(Entry *entry,
-                                              const Timebase::time_point &now)
+                                              const Timebase::time_point &now,
+                                              double inflation)
 {
     for(Entry *e = entry; e != nullptr; e = e->get_parent().get())
     {
         Entry::AgeInfo::set_last_use(*e, now);
+        Entry::CacheInfo::set_inflation_at_last_use(*e, inflation);
         Entry::AgingList::insert_before_parent(*e);
     }
 }
 
-bool LRU::Cache::pin_or_unpin_objects_on_path_to_root(const LRU::Cache &cache,
-                                                      ID::List id,
+bool LRU::Cache::pin_or_unpin_objects_on_path_to_root(ID::List id,
                                                       bool pin_them)
 {
     if(!id.is_valid())
         return false;
 
-    const auto entry = cache.lookup(id);
+    const auto *entry = lookup_unlocked(id);
 
     if(entry == nullptr)
         return false;
 
-    for(Entry *e = entry.get(); e != nullptr; e = e->get_parent().get())
+    for(Entry *e = entry->get(); e != nullptr; e = e->get_parent().get())
+    {
+        if(pin_them)
+            remove_eviction_candidate(*e);
+
         Entry::CacheInfo::set_pin_mode(*e, pin_them);
 
+        if(!pin_them)
+            add_eviction_candidate(*e);
+    }
+
     return true;
 }
 
+void LRU::Cache::set_eviction_policy(EvictionPolicy policy)
+{
+    ExclusiveGuard lock(*this);
+
+    if(policy == eviction_policy_)
+        return;
+
+    eviction_policy_ = policy;
+
+    if(policy == EvictionPolicy::GREEDY_DUAL_SIZE)
+    {
+        for(const auto &obj : all_objects_)
+            add_eviction_candidate(*obj.second);
+    }
+    else
+    {
+        for(const auto &c : eviction_candidates_)
+            Entry::CacheInfo::set_eviction_candidate(*std::get<2>(c), false, 0.0);
+
+        eviction_candidates_.clear();
+    }
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Cache eviction policy: %s",
+              policy == EvictionPolicy::GREEDY_DUAL_SIZE
+              ? "GreedyDual-Size"
+              : "least recently used");
+}
+
 ssize_t LRU::Cache::use(const std::shared_ptr<Entry> entry)
 {
+    ExclusiveGuard lock(*this);
+
     msg_log_assert(entry != nullptr);
     msg_log_assert(entry->get_cache_id().is_valid());
-    msg_log_assert(lookup(entry->get_cache_id()) != nullptr);
+    msg_log_assert(lookup_unlocked(entry->get_cache_id()) != nullptr);
+
+    gc_cursor_ = nullptr;
 
     const Timebase::time_point now = timebase->now();
     msg_log_assert(now >= minimum_required_creation_time_);
@@ -256,17 +320,22 @@ ssize_t LRU::Cache::use(const std::shared_ptr<Entry> entry)
 
     deepest_youngest_object_ = entry.get();
 
+    /* objects on the path to the root other than the entry are no leaves */
+    remove_eviction_candidate(*entry);
+
     ssize_t depth =
         unlink_objects_on_path_to_root(const_cast<Entry *>(deepest_youngest_object_),
                                        oldest_object_, reconnect_tail_object);
 
     link_objects_on_path_to_root(const_cast<Entry *>(deepest_youngest_object_),
-                                 now);
+                                 now, inflation_);
 
     if(reconnect_tail_object != nullptr)
         Entry::AgingList::join_lists(const_cast<Entry *>(reconnect_tail_object),
                                      const_cast<Entry *>(deepest_youngest_object_));
 
+    add_eviction_candidate(*entry);
+
     msg_log_assert(oldest_object_->is_leaf());
 
     return depth;
@@ -274,28 +343,48 @@ ssize_t LRU::Cache::use(const std::shared_ptr<Entry> entry)
 
 ssize_t LRU::Cache::use(ID::List id)
 {
-    auto obj = LRU::Cache::lookup(id);
+    {
+        /*
+         * Fast path for the common case of several uses of the same objects
+         * within one tick of the clock (e.g., bursts of keep-alive requests),
+         * taken without blocking other readers.
+         */
+        CacheLock::SharedGuard guard(lock_);
+
+        if(lookup_unlocked(id) == nullptr)
+            return USED_ENTRY_INVALID_ID;
+
+        if(timebase->now() <= minimum_required_creation_time_)
+            return USED_ENTRY_ALREADY_UP_TO_DATE;
+    }
+
+    ExclusiveGuard lock(*this);
+    const auto *obj = lookup_unlocked(id);
 
     if(obj != nullptr)
-        return use(obj);
+        return use(*obj);
     else
         return USED_ENTRY_INVALID_ID;
 }
 
 bool LRU::Cache::pin(ID::List id)
 {
+    ExclusiveGuard lock(*this);
+
     if(pinned_object_id_ == id)
         return pinned_object_id_.is_valid();
 
+    gc_cursor_ = nullptr;
+
     const bool need_gc = pinned_object_id_.is_valid();
 
     if(need_gc)
-        pin_or_unpin_objects_on_path_to_root(*this, pinned_object_id_, false);
+        pin_or_unpin_objects_on_path_to_root(pinned_object_id_, false);
 
     pinned_object_id_ = id;
 
     const bool result = id.is_valid()
-        ? pin_or_unpin_objects_on_path_to_root(*this, pinned_object_id_, true)
+        ? pin_or_unpin_objects_on_path_to_root(pinned_object_id_, true)
         : true;
 
     if(!result)
@@ -312,6 +401,8 @@ ID::List LRU::Cache::insert(std::shared_ptr<Entry> &&entry,
                             const ID::List::context_t ctx,
                             size_t size_of_entry)
 {
+    ExclusiveGuard lock(*this);
+
     msg_log_assert(entry != nullptr);
 
     if(entry->get_cache_id().is_valid())
@@ -320,6 +411,8 @@ ID::List LRU::Cache::insert(std::shared_ptr<Entry> &&entry,
         return ID::List();
     }
 
+    gc_cursor_ = nullptr;
+
     const Timebase::time_point &entry_last_use(Entry::AgeInfo::get_last_use_time(*entry));
 
     if(entry_last_use < minimum_required_creation_time_)
@@ -347,7 +440,8 @@ ID::List LRU::Cache::insert(std::shared_ptr<Entry> &&entry,
         if(use(parent) < 0)
             deepest_youngest_object_ = parent.get();
 
-        Entry::AgingList::add_child(parent);
+        Entry::AgingList::add_child(parent, *entry);
+        remove_eviction_candidate(*parent);
 
         msg_log_assert(deepest_youngest_object_ == parent.get());
 
@@ -364,8 +458,11 @@ ID::List LRU::Cache::insert(std::shared_ptr<Entry> &&entry,
     const ID::List id =
         Entry::CacheInfo::set_id(entry, id_generator_.next(cmode, ctx));
 
-    msg_log_assert(all_objects_.find(id) == all_objects_.end());
-    all_objects_.insert(std::make_pair(id, entry));
+#ifndef NDEBUG
+    const bool inserted =
+#endif /* !NDEBUG */
+    all_objects_.insert(id, std::shared_ptr<Entry>(entry));
+    msg_log_assert(inserted);
 
     minimum_required_creation_time_ = Entry::AgeInfo::get_last_use_time(entry);
 
@@ -375,8 +472,12 @@ ID::List LRU::Cache::insert(std::shared_ptr<Entry> &&entry,
     msg_log_assert(oldest_object_->is_leaf());
 
     Entry::CacheInfo::set_size(entry, size_of_entry);
+    Entry::CacheInfo::set_inflation_at_last_use(*entry, inflation_);
+    add_eviction_candidate(*entry);
     total_size_ += size_of_entry;
 
+    Statistics::get_singleton().count(Statistics::Counter::INSERTIONS);
+
     if(all_objects_.size() == 1)
         notify_first_object_inserted_();
 
@@ -403,13 +504,18 @@ ID::List LRU::Cache::insert(std::shared_ptr<Entry> &&entry,
     }
 
     if(need_gc)
+    {
+        enforce_hard_limits();
         notify_garbage_collection_needed_();
+    }
 
     return id;
 }
 
 ID::List LRU::Cache::insert_again(std::shared_ptr<Entry> &&entry)
 {
+    ExclusiveGuard lock(*this);
+
     if(entry == nullptr)
         return ID::List();
 
@@ -418,15 +524,17 @@ ID::List LRU::Cache::insert_again(std::shared_ptr<Entry> &&entry)
     if(all_objects_.erase(old_id) == 0)
         return ID::List();
 
+    id_generator_.release(old_id);
+
     Entry::CacheInfo::set_id(entry, id_generator_.next(CacheIdGenerator::get_cache_mode(entry->get_cache_id()),
                                                        entry->get_cache_id().get_context()));
 
     const auto new_id = entry->get_cache_id();
 #ifndef NDEBUG
-    const auto inserted =
+    const bool inserted =
 #endif /* !NDEBUG */
-    all_objects_.insert(std::make_pair(new_id, std::move(entry)));
-    msg_log_assert(inserted.second);
+    all_objects_.insert(new_id, std::move(entry));
+    msg_log_assert(inserted);
 
     if(old_id == pinned_object_id_)
         pinned_object_id_ = new_id;
@@ -438,29 +546,70 @@ std::shared_ptr<LRU::Entry> LRU::Cache::lookup(ID::List entry_id) const
 {
     msg_log_assert(entry_id.is_valid());
 
+    CacheLock::SharedGuard guard(lock_);
+    const auto *obj = lookup_unlocked(entry_id);
+
+    Statistics::get_singleton().count(obj != nullptr
+                                      ? Statistics::Counter::LOOKUP_HITS
+                                      : Statistics::Counter::LOOKUP_MISSES);
+
+    if(obj != nullptr)
+        return *obj;
+    else
+        return nullptr;
+}
+
+const std::shared_ptr<LRU::Entry> *
+LRU::Cache::lookup_unlocked(ID::List entry_id) const
+{
     auto obj = all_objects_.find(entry_id);
 
     if(obj != all_objects_.end())
-        return obj->second;
+        return &obj->second;
     else
         return nullptr;
 }
 
 bool LRU::Cache::set_object_size(ID::List entry_id, size_t size_of_entry)
 {
-    std::shared_ptr<LRU::Entry> obj = lookup(entry_id);
+    bool is_size_unchanged;
+
+    {
+        /* sizes rarely change between uses, so we avoid blocking other
+         * readers in the common case and leave the rest to #LRU::Cache::use(),
+         * which has a fast path of its own */
+        CacheLock::SharedGuard guard(lock_);
+
+        const auto *found = lookup_unlocked(entry_id);
 
-    if(obj == nullptr)
+        if(found == nullptr)
+            return false;
+
+        is_size_unchanged = Entry::CacheInfo::get_size(*found) == size_of_entry;
+    }
+
+    if(is_size_unchanged)
+        return use(entry_id) != USED_ENTRY_INVALID_ID;
+
+    ExclusiveGuard lock(*this);
+
+    const auto *found = lookup_unlocked(entry_id);
+
+    if(found == nullptr)
         return false;
 
+    const std::shared_ptr<LRU::Entry> obj = *found;
+
     const size_t old_size = Entry::CacheInfo::get_size(obj);
     msg_log_assert(old_size <= total_size_);
     total_size_ -= old_size;
 
+    remove_eviction_candidate(*obj);
     Entry::CacheInfo::set_size(obj, size_of_entry);
     total_size_ += size_of_entry;
 
     use(obj);
+    add_eviction_candidate(*obj);
 
     if(size_of_entry > old_size && memory_limits_.exceeds_soft(total_size_))
     {
@@ -469,13 +618,15 @@ bool LRU::Cache::set_object_size(ID::List entry_id, size_t size_of_entry)
                   "attempting to collect garbage",
                   memory_limits_.exceeds_hard(total_size_) ? "Hard" : "Soft",
                   size_of_entry, entry_id.get_raw_id());
-        gc();
+        enforce_hard_limits();
+        notify_garbage_collection_needed_();
     }
 
     return true;
 }
 
 const LRU::Entry *LRU::Cache::discard(const Entry *const candidate,
+                                      DiscardReason reason,
                                       bool allow_notifications)
 {
     msg_log_assert(oldest_object_ != nullptr);
@@ -483,6 +634,11 @@ const LRU::Entry *LRU::Cache::discard(const Entry *const candidate,
     msg_log_assert(candidate != nullptr);
     msg_log_assert(!candidate->is_pinned());
 
+    if(gc_cursor_ == candidate)
+        gc_cursor_ = nullptr;
+
+    remove_eviction_candidate(*candidate);
+
     auto next_candidate = Entry::AgingList::unlink(*const_cast<Entry *>(candidate));
     if(oldest_object_ == candidate)
         oldest_object_ = next_candidate;
@@ -490,13 +646,42 @@ const LRU::Entry *LRU::Cache::discard(const Entry *const candidate,
     std::shared_ptr<Entry> parent = candidate->get_parent();
 
     if(parent != nullptr)
-        LRU::Entry::AgingList::del_child(parent);
+    {
+        LRU::Entry::AgingList::del_child(parent, *const_cast<Entry *>(candidate));
+        add_eviction_candidate(*parent);
+    }
 
     if(candidate == deepest_youngest_object_)
         deepest_youngest_object_ = parent.get();
 
-    msg_log_assert(Entry::CacheInfo::get_size(*candidate) <= total_size_);
-    total_size_ -= Entry::CacheInfo::get_size(*candidate);
+    const size_t size = Entry::CacheInfo::get_size(*candidate);
+    msg_log_assert(size <= total_size_);
+    total_size_ -= size;
+
+    auto &stats(Statistics::get_singleton());
+
+    switch(reason)
+    {
+      case DiscardReason::AGE:
+        stats.count(Statistics::Counter::DISCARDED_BY_AGE);
+        stats.count(Statistics::Counter::BYTES_DISCARDED_BY_AGE, size);
+        break;
+
+      case DiscardReason::SOFT_LIMIT:
+        stats.count(Statistics::Counter::DISCARDED_BY_SOFT_LIMIT);
+        stats.count(Statistics::Counter::BYTES_DISCARDED_BY_SOFT_LIMIT, size);
+        break;
+
+      case DiscardReason::HARD_LIMIT:
+        stats.count(Statistics::Counter::DISCARDED_BY_HARD_LIMIT);
+        stats.count(Statistics::Counter::BYTES_DISCARDED_BY_HARD_LIMIT, size);
+        break;
+
+      case DiscardReason::PURGE:
+        stats.count(Statistics::Counter::PURGED);
+        stats.count(Statistics::Counter::BYTES_PURGED, size);
+        break;
+    }
 
     ID::List removed_object_id = candidate->get_cache_id();
 
@@ -504,11 +689,18 @@ const LRU::Entry *LRU::Cache::discard(const Entry *const candidate,
         Entry::CachedObject::obliviate_child(parent, removed_object_id,
                                              candidate);
 
+    /* keep object alive until the cache has been unlocked, see
+     * #LRU::Cache::discarded_objects_ */
+    const auto *removed_object = lookup_unlocked(removed_object_id);
+    msg_log_assert(removed_object != nullptr);
+    discarded_objects_.push_back(*removed_object);
+
 #ifndef NDEBUG
     size_t removed_count =
 #endif /* !NDEBUG */
     all_objects_.erase(removed_object_id);
     msg_log_assert(removed_count == 1);
+    id_generator_.release(removed_object_id);
 
     if(allow_notifications)
         notify_object_removed_(removed_object_id);
@@ -517,6 +709,7 @@ const LRU::Entry *LRU::Cache::discard(const Entry *const candidate,
     {
         /* deleted the last object, cache is empty now */
         root_object_ = nullptr;
+        inflation_ = 0.0;
 
         if(allow_notifications)
             notify_last_object_removed_();
@@ -543,25 +736,101 @@ class SetFlagUntilReturn
     ~SetFlagUntilReturn() { flag_ = false; }
 };
 
+class RecordDurationUntilReturn
+{
+  private:
+    const LRU::Statistics::Histogram histogram_;
+    const Timebase::time_point start_;
+
+  public:
+    RecordDurationUntilReturn(const RecordDurationUntilReturn &) = delete;
+    RecordDurationUntilReturn &operator=(const RecordDurationUntilReturn &) = delete;
+
+    explicit RecordDurationUntilReturn(LRU::Statistics::Histogram histogram,
+                                       const Timebase::time_point &start):
+        histogram_(histogram),
+        start_(start)
+    {}
+
+    ~RecordDurationUntilReturn()
+    {
+        LRU::Statistics::get_singleton().record(
+            histogram_,
+            std::chrono::duration_cast<std::chrono::microseconds>(LRU::timebase->now() - start_));
+    }
+};
+
 std::chrono::seconds LRU::Cache::gc()
 {
+    bool is_incomplete;
+    return gc(GCBudget::unlimited(), is_incomplete);
+}
+
+std::chrono::seconds LRU::Cache::gc(const GCBudget &budget, bool &is_incomplete)
+{
+    ExclusiveGuard lock(*this);
+
     msg_log_assert(!is_garbage_collector_running_);
 
     SetFlagUntilReturn flag_guard(is_garbage_collector_running_);
 
-    const Entry *candidate = oldest_object_;
+    const Timebase::time_point slice_start = timebase->now();
+    RecordDurationUntilReturn duration_guard(LRU::Statistics::Histogram::GC_DURATION,
+                                             slice_start);
+    size_t discarded = 0;
+
+    const Entry *candidate =
+        gc_cursor_ != nullptr ? gc_cursor_ : oldest_object_;
+    gc_cursor_ = nullptr;
+    is_incomplete = false;
+
+    auto suspend = [this, &candidate, &is_incomplete] ()
+    {
+        msg_vinfo(MESSAGE_LEVEL_TRACE,
+                  "Garbage collection suspended at object %u",
+                  candidate->get_cache_id().get_raw_id());
+        gc_cursor_ = candidate;
+        is_incomplete = true;
+        return std::chrono::seconds(0);
+    };
 
     while(candidate != nullptr &&
           candidate->get_age() >= maximum_age_threshold_)
     {
         if(!candidate->is_pinned())
-            candidate = discard(candidate);
+        {
+            if(budget.is_exhausted(discarded, slice_start))
+                return suspend();
+
+            candidate = discard(candidate, DiscardReason::AGE);
+            ++discarded;
+        }
         else
             candidate = Entry::AgingList::next_younger(*candidate);
     }
 
-    if(memory_limits_.exceeds_soft(total_size_) ||
-       count_limits_.exceeds_soft(all_objects_.size()))
+    if((memory_limits_.exceeds_soft(total_size_) ||
+        count_limits_.exceeds_soft(all_objects_.size())) &&
+       eviction_policy_ == EvictionPolicy::GREEDY_DUAL_SIZE)
+    {
+        /*
+         * The aging list is of no use here. The candidates are kept ordered
+         * by priority, so an interrupted slice simply continues with the
+         * cheapest object in the next slice.
+         */
+        if(!discard_cheapest_objects(budget, slice_start, discarded))
+        {
+            msg_vinfo(MESSAGE_LEVEL_TRACE,
+                      "Garbage collection suspended after %zu objects",
+                      discarded);
+            is_incomplete = true;
+            return std::chrono::seconds(0);
+        }
+
+        candidate = oldest_object_;
+    }
+    else if(memory_limits_.exceeds_soft(total_size_) ||
+            count_limits_.exceeds_soft(all_objects_.size()))
     {
         /*
          * We should be killing more objects because we are under resource
@@ -578,22 +847,34 @@ std::chrono::seconds LRU::Cache::gc()
             }
 
             if(candidate != deepest_youngest_object_)
-                candidate = discard(candidate);
+            {
+                if(budget.is_exhausted(discarded, slice_start))
+                    return suspend();
+
+                candidate = discard(candidate,
+                                    exceeds_hard_limits()
+                                    ? DiscardReason::HARD_LIMIT
+                                    : DiscardReason::SOFT_LIMIT);
+                ++discarded;
+            }
             else
             {
                 /*
                  * Too young. This is the hot path the user is likely seeing
                  * right now, so we should only touch it when really needed.
                  */
-                if(memory_limits_.exceeds_hard(total_size_) ||
-                   count_limits_.exceeds_hard(all_objects_.size()))
+                if(exceeds_hard_limits())
                 {
+                    if(budget.is_exhausted(discarded, slice_start))
+                        return suspend();
+
                     msg_vinfo(MESSAGE_LEVEL_IMPORTANT,
                               "Discarding hot object %u (size %sexceeded, count %sexceeded)",
                               candidate->get_cache_id().get_raw_id(),
                               memory_limits_.exceeds_hard(total_size_) ? "" : "not ",
                               count_limits_.exceeds_hard(all_objects_.size()) ? "" : "not ");
-                    candidate = discard(candidate);
+                    candidate = discard(candidate, DiscardReason::HARD_LIMIT);
+                    ++discarded;
                 }
                 else
                     break;
@@ -632,18 +913,160 @@ std::chrono::seconds LRU::Cache::gc()
         return std::chrono::seconds(1);
 }
 
+void LRU::Cache::enforce_hard_limits()
+{
+    if(is_garbage_collector_running_)
+        return;
+
+    static const GCBudget single_object(1, std::chrono::milliseconds::max());
+    bool is_incomplete = true;
+
+    while(is_incomplete && exceeds_hard_limits())
+        gc(single_object, is_incomplete);
+}
+
+double LRU::Cache::get_priority(const Entry &entry)
+{
+    const size_t size = Entry::CacheInfo::get_size(entry);
+
+    return Entry::CacheInfo::get_inflation_at_last_use(entry) +
+           double(entry.get_refill_cost().count()) / double(size > 0 ? size : 1);
+}
+
+void LRU::Cache::add_eviction_candidate(const Entry &entry)
+{
+    if(eviction_policy_ != EvictionPolicy::GREEDY_DUAL_SIZE ||
+       Entry::CacheInfo::is_eviction_candidate(entry) ||
+       !entry.is_leaf() || entry.is_pinned())
+        return;
+
+    const double priority = get_priority(entry);
+
+    eviction_candidates_.emplace(priority,
+                                 Entry::AgeInfo::get_last_use_time(entry),
+                                 &entry);
+    Entry::CacheInfo::set_eviction_candidate(entry, true, priority);
+}
+
+void LRU::Cache::remove_eviction_candidate(const Entry &entry)
+{
+    if(!Entry::CacheInfo::is_eviction_candidate(entry))
+        return;
+
+#ifndef NDEBUG
+    const size_t removed_count =
+#endif /* !NDEBUG */
+    eviction_candidates_.erase(std::make_tuple(Entry::CacheInfo::get_eviction_priority(entry),
+                                               Entry::AgeInfo::get_last_use_time(entry),
+                                               &entry));
+    msg_log_assert(removed_count == 1);
+
+    Entry::CacheInfo::set_eviction_candidate(entry, false, 0.0);
+}
+
+bool LRU::Cache::discard_cheapest_objects(const GCBudget &budget,
+                                          const Timebase::time_point &slice_start,
+                                          size_t &discarded)
+{
+    while(!memory_limits_.is_low_enough(total_size_) ||
+          !count_limits_.is_low_enough(all_objects_.size()))
+    {
+        auto it = eviction_candidates_.begin();
+
+        if(it != eviction_candidates_.end() &&
+           std::get<2>(*it) == deepest_youngest_object_ &&
+           !exceeds_hard_limits())
+        {
+            /* hot path, see LRU::Cache::gc() */
+            ++it;
+        }
+
+        if(it == eviction_candidates_.end())
+            break;
+
+        const double priority = std::get<0>(*it);
+        const Entry *const candidate = std::get<2>(*it);
+
+        if(budget.is_exhausted(discarded, slice_start))
+            return false;
+
+        if(candidate == deepest_youngest_object_)
+            msg_vinfo(MESSAGE_LEVEL_IMPORTANT,
+                      "Discarding hot object %u (size %sexceeded, count %sexceeded)",
+                      candidate->get_cache_id().get_raw_id(),
+                      memory_limits_.exceeds_hard(total_size_) ? "" : "not ",
+                      count_limits_.exceeds_hard(all_objects_.size()) ? "" : "not ");
+
+        if(priority > inflation_)
+            inflation_ = priority;
+
+        /* the parent becomes a candidate in case it becomes a leaf */
+        discard(candidate, exceeds_hard_limits()
+                           ? DiscardReason::HARD_LIMIT
+                           : DiscardReason::SOFT_LIMIT);
+        ++discarded;
+    }
+
+    return true;
+}
+
 size_t LRU::Cache::count() const
 {
+    CacheLock::SharedGuard guard(lock_);
     return all_objects_.size();
 }
 
+void LRU::Cache::for_each_entry(const std::function<void(const Entry &)> &fn) const
+{
+    std::vector<std::shared_ptr<Entry>> entries;
+
+    {
+        CacheLock::SharedGuard guard(lock_);
+
+        entries.reserve(all_objects_.size());
+
+        for(const Entry *e = oldest_object_; e != nullptr; e = Entry::AgingList::next_younger(*e))
+            entries.push_back(*lookup_unlocked(e->get_cache_id()));
+    }
+
+    for(const auto &e : entries)
+        fn(*e);
+}
+
+void LRU::Cache::enumerate_subtree(const Entry &entry,
+                                   std::vector<ID::List> &nodes) const
+{
+    CacheLock::SharedGuard guard(lock_);
+
+    msg_log_assert(lookup_unlocked(entry.get_cache_id()) != nullptr);
+
+    std::vector<const Entry *> queue;
+    queue.push_back(&entry);
+
+    for(size_t next_unprocessed = 0;
+        next_unprocessed < queue.size();
+        ++next_unprocessed)
+    {
+        const Entry *e = queue[next_unprocessed];
+
+        nodes.push_back(e->get_cache_id());
+
+        for(const Entry *child = Entry::Children::first(*e);
+            child != nullptr;
+            child = Entry::Children::next_sibling(*child))
+            queue.push_back(child);
+    }
+}
+
 bool LRU::Cache::toposort_for_purge(const std::vector<ID::List>::iterator &kill_list_begin,
                                     const std::vector<ID::List>::iterator &kill_list_end) const
 {
+    CacheLock::SharedGuard guard(lock_);
+
     auto first_internal = std::partition(kill_list_begin, kill_list_end,
                                          [this] (const ID::List id)
                                          {
-                                             return lookup(id)->is_leaf();
+                                             return (*lookup_unlocked(id))->is_leaf();
                                          });
     if(first_internal == kill_list_end)
     {
@@ -651,7 +1074,7 @@ bool LRU::Cache::toposort_for_purge(const std::vector<ID::List>::iterator &kill_
         return true;
     }
 
-    if(!lookup(*kill_list_begin)->is_leaf())
+    if(!(*lookup_unlocked(*kill_list_begin))->is_leaf())
     {
         /* no leaves */
         MSG_BUG("Cannot sort for purge because set contains no leaves");
@@ -670,7 +1093,7 @@ bool LRU::Cache::toposort_for_purge(const std::vector<ID::List>::iterator &kill_
 
     for(auto it = kill_list_begin; it != first_internal; ++it)
     {
-        const auto &obj = lookup(*it);
+        const auto &obj = *lookup_unlocked(*it);
         size_t dist = 0;
 
         for(const Entry *e = obj->get_parent().get();
@@ -723,26 +1146,32 @@ void LRU::Cache::purge_entries(const std::vector<ID::List>::const_iterator &kill
                                const std::vector<ID::List>::const_iterator &kill_list_end,
                                bool allow_notifications)
 {
+    ExclusiveGuard lock(*this);
+
     for(auto it = kill_list_begin; it != kill_list_end; ++it)
     {
         msg_vinfo(MESSAGE_LEVEL_IMPORTANT, "Purge entry %u", it->get_raw_id());
 
-        std::shared_ptr<LRU::Entry> obj = lookup(*it);
+        const auto *found = lookup_unlocked(*it);
 
-        if(obj == nullptr)
+        if(found == nullptr)
             MSG_BUG("Tried to purge nonexistent entry %u", it->get_raw_id());
         else
         {
+            const std::shared_ptr<LRU::Entry> obj = *found;
+
             if(obj->is_pinned())
                 pin(ID::List());
 
-            discard(obj.get(), allow_notifications);
+            discard(obj.get(), DiscardReason::PURGE, allow_notifications);
         }
     }
 }
 
 void LRU::Cache::dump_pointers(std::ostream &os, const char *detail) const
 {
+    CacheLock::SharedGuard guard(lock_);
+
     os << "===========================\n"
        << "  Cache dump";
     if(detail != nullptr)
@@ -777,6 +1206,8 @@ void LRU::Cache::dump_pointers(std::ostream &os, const char *detail) const
 
 void LRU::Cache::self_check() const
 {
+    CacheLock::SharedGuard guard(lock_);
+
     static const char fail_message_format[] = "Cache inconsistent: %d";
 
 #define FAIL() \
@@ -834,11 +1265,20 @@ void LRU::Cache::self_check() const
 
         FAIL_IF(obj == nullptr);
         FAIL_IF(obj->get_cache_id() != it.first);
+        FAIL_IF(!id_generator_.is_used(it.first));
         FAIL_IF(obj->get_parent() == obj);
 
-        const size_t children =
-            std::count_if(all_objects_.begin(), all_objects_.end(),
-                [&obj] (const auto &o) { return o.second->get_parent() == obj; });
+        size_t children = 0;
+
+        for(const Entry *child = Entry::Children::first(*obj);
+            child != nullptr;
+            child = Entry::Children::next_sibling(*child))
+        {
+            FAIL_IF(child->get_parent() != obj);
+            FAIL_IF(all_objects_.get(child->get_cache_id()) != child);
+            ++children;
+        }
+
         number_of_children += children;
 
         FAIL_IF(children != obj->get_number_of_children());
@@ -847,7 +1287,7 @@ void LRU::Cache::self_check() const
     }
 
     FAIL_IF(root_object_ == nullptr && number_of_children != 0);
-    FAIL_IF(root_object_ != nullptr && number_of_children + 1 != count());
+    FAIL_IF(root_object_ != nullptr && number_of_children + 1 != all_objects_.size());
     FAIL_IF(root_object_ == nullptr && number_of_root_objects != 0);
     FAIL_IF(root_object_ != nullptr && number_of_root_objects != 1);
     FAIL_IF(oldest_object_ == nullptr && number_of_oldest_objects != 0);
@@ -948,16 +1388,7 @@ void LRU::Entry::enumerate_tree_of_sublists(const LRU::Cache &cache,
     if(!append_to_nodes)
         nodes.clear();
 
-    nodes.push_back(get_cache_id());
-
-    for(size_t next_unprocessed = nodes.size() - 1;
-        next_unprocessed < nodes.size();
-        ++next_unprocessed)
-    {
-        const auto &list = cache.lookup(nodes[next_unprocessed]);
-
-        list->enumerate_direct_sublists(cache, nodes);
-    }
+    cache.enumerate_subtree(*this, nodes);
 }
 
 bool LRU::Entry::insert_before(const Entry *const younger_object) const
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2020, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2020, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -24,13 +24,20 @@
 
 #include "idtypes.hh"
 #include "timebase.hh"
+#include "lru_object_table.hh"
+#include "lru_id_bitmap.hh"
+#include "lru_cache_lock.hh"
+#include "lru_statistics.hh"
 #include "messages.h"
 
 #include <memory>
 #include <array>
-#include <map>
 #include <vector>
 #include <functional>
+#include <limits>
+#include <atomic>
+#include <set>
+#include <tuple>
 
 /*!
  * \addtogroup lru_cache Least recently used object cache
@@ -55,6 +62,31 @@ enum class CacheModeRequest
     AUTO,
 };
 
+/*!
+ * How the cache picks objects to discard when it is under resource pressure.
+ *
+ * Expired objects (see #LRU::Cache::maximum_age_threshold_) are always
+ * discarded oldest first, independent of the policy.
+ */
+enum class EvictionPolicy
+{
+    /*! Discard least recently used objects first. */
+    LEAST_RECENTLY_USED,
+
+    /*!
+     * Discard objects which are cheapest to get back per byte first.
+     *
+     * This is a variant of the GreedyDual-Size algorithm. Each object is
+     * assigned a priority which is the sum of its refill cost divided by its
+     * size (see #LRU::Entry::get_refill_cost()), and the cache's inflation
+     * value at the time the object was last used. The object with the lowest
+     * priority is discarded, and the inflation value is raised to its
+     * priority. This way, objects not used for a long time lose their credit
+     * relative to recently used objects, no matter how expensive they were.
+     */
+    GREEDY_DUAL_SIZE,
+};
+
 static inline CacheMode to_cache_mode(const CacheModeRequest req)
 {
     return req == CacheModeRequest::AUTO ? CacheMode::CACHED : CacheMode(req);
@@ -76,6 +108,32 @@ class CacheMetaData
     size_t object_size_;
     bool is_pinned_;
 
+    /*!
+     * Time it took to fill the object, in microseconds.
+     *
+     * Atomic because objects are filled outside the cache lock.
+     */
+    std::atomic<uint64_t> refill_cost_us_;
+
+    /*!
+     * Inflation value of the cache when the object was last used.
+     *
+     * Only relevant for #LRU::EvictionPolicy::GREEDY_DUAL_SIZE.
+     */
+    double inflation_at_last_use_;
+
+    /*!
+     * Whether or not the object is in #LRU::Cache::eviction_candidates_.
+     */
+    bool is_eviction_candidate_;
+
+    /*!
+     * Priority the object has been added to the eviction candidates with.
+     *
+     * Only valid if #LRU::CacheMetaData::is_eviction_candidate_ is set.
+     */
+    double eviction_priority_;
+
   public:
     CacheMetaData(const CacheMetaData &) = delete;
     CacheMetaData &operator=(const CacheMetaData &) = delete;
@@ -83,7 +141,11 @@ class CacheMetaData
     explicit CacheMetaData():
         id_(0),
         object_size_(0),
-        is_pinned_(false)
+        is_pinned_(false),
+        refill_cost_us_(0),
+        inflation_at_last_use_(0.0),
+        is_eviction_candidate_(false),
+        eviction_priority_(0.0)
     {}
 
     ID::List get_id() const
@@ -101,6 +163,26 @@ class CacheMetaData
         return is_pinned_;
     }
 
+    std::chrono::microseconds get_refill_cost() const
+    {
+        return std::chrono::microseconds(refill_cost_us_.load(std::memory_order_relaxed));
+    }
+
+    double get_inflation_at_last_use() const
+    {
+        return inflation_at_last_use_;
+    }
+
+    bool is_eviction_candidate() const
+    {
+        return is_eviction_candidate_;
+    }
+
+    double get_eviction_priority() const
+    {
+        return eviction_priority_;
+    }
+
   private:
     ID::List set_id(ID::List id)
     {
@@ -118,6 +200,23 @@ class CacheMetaData
         is_pinned_ = pin_it;
     }
 
+    void set_refill_cost(std::chrono::microseconds cost)
+    {
+        refill_cost_us_.store(cost.count() > 0 ? cost.count() : 0,
+                              std::memory_order_relaxed);
+    }
+
+    void set_inflation_at_last_use(double inflation)
+    {
+        inflation_at_last_use_ = inflation;
+    }
+
+    void set_eviction_candidate(bool is_candidate, double priority)
+    {
+        is_eviction_candidate_ = is_candidate;
+        eviction_priority_ = priority;
+    }
+
     /* for setting the object ID at insertion time and setting object size */
     friend class Entry;
 };
@@ -195,8 +294,10 @@ class AgingListEntry
  * One cached entry in the LRU cache.
  *
  * Every entry has a link to one parent entry and a counter for the number of
- * child objects. There is no efficient way to traverse the tree downwards,
- * only one for following the path to the root node. Objects also have an
+ * child objects. Cached child objects are linked to their parent through an
+ * intrusive, doubly linked list of siblings in order of insertion, so the tree
+ * can be traversed downwards in time proportional to the size of the visited
+ * subtree (see #LRU::Cache::enumerate_subtree()). Objects also have an
  * identifier and directly store their aging list entry data.
  *
  * \note
@@ -209,6 +310,18 @@ class Entry
     const std::shared_ptr<Entry> parent_;
     size_t children_count_;
 
+    /*!
+     * Links to cached child objects and siblings.
+     *
+     * These are plain pointers because child objects are owned by the cache,
+     * and they keep their parents alive through #LRU::Entry::parent_. The
+     * cache unlinks its objects from their parents when discarding them.
+     */
+    Entry *first_child_;
+    Entry *last_child_;
+    Entry *prev_sibling_;
+    Entry *next_sibling_;
+
     CacheMetaData cache_data_;
     AgingListEntry aging_list_data_;
 
@@ -216,6 +329,10 @@ class Entry
     explicit Entry(const std::shared_ptr<Entry> &parent):
         parent_(parent),
         children_count_(0),
+        first_child_(nullptr),
+        last_child_(nullptr),
+        prev_sibling_(nullptr),
+        next_sibling_(nullptr),
         aging_list_data_(timebase->now(), nullptr, nullptr)
     {}
 
@@ -294,24 +411,60 @@ class Entry
      *     Whether or not to clear \p nodes. If true, the original contents of
      *     \p nodes will be kept and new content is appended to the ilst,
      *     otherwise the list's original content will be replaced.
+     *
+     * The default implementation enumerates the cached objects below this
+     * entry using #LRU::Cache::enumerate_subtree(), which does not need to
+     * look at the list contents at all.
      */
     virtual void enumerate_tree_of_sublists(const Cache &cache,
                                             std::vector<ID::List> &nodes,
                                             bool append_to_nodes = false) const;
 
     /*!
-     * Collect the list IDs of sublists referenced directly by this entry,
-     * excluding this entry.
+     * Number of bytes of memory currently occupied by this entry.
      *
-     * \param cache
-     *     Cache the list IDs refer to.
+     * The size passed to #LRU::Cache::insert() is usually only an estimate
+     * made before the entry has any content. Entries which know their actual
+     * memory consumption should report it here so that it can be passed to
+     * #LRU::Cache::set_object_size() when the entry is used, and the memory
+     * limits of the cache reflect reality.
      *
-     * \param nodes
-     *     The list of IDs is expected to be returned here. IDs are to be
-     *     \e appended to the list. The function shall \e not clear the list.
+     * This function is called whenever the entry is used, so it must not
+     * block and should be cheap.
+     *
+     * \returns
+     *     The size in bytes, or 0 in case the size is unknown. The default
+     *     implementation returns 0.
+     */
+    virtual size_t get_size_in_bytes() const { return 0; }
+
+    /*!
+     * Store the time it took to fill this entry with content.
+     *
+     * Entries should record this after they have been filled so that the
+     * cache can estimate how expensive it would be to get them back after
+     * discarding them (see #LRU::EvictionPolicy::GREEDY_DUAL_SIZE). May be
+     * called from any thread.
      */
-    virtual void enumerate_direct_sublists(const Cache &cache,
-                                           std::vector<ID::List> &nodes) const = 0;
+    void set_refill_cost(std::chrono::microseconds cost)
+    {
+        cache_data_.set_refill_cost(cost);
+    }
+
+    /*!
+     * Estimated time it would take to fill this entry again.
+     *
+     * The default implementation returns the value last passed to
+     * #LRU::Entry::set_refill_cost(). Entries which are filled in several
+     * steps should add the cost of the other steps.
+     *
+     * This function is called by the garbage collector with the cache locked,
+     * so it must not block and should be cheap.
+     */
+    virtual std::chrono::microseconds get_refill_cost() const
+    {
+        return cache_data_.get_refill_cost();
+    }
 
   private:
     /*!
@@ -347,19 +500,45 @@ class Entry
     const Entry *unlink_from_aging_list() const;
 
     /*!
-     * Increase child counter.
+     * Link child object to this object, increase child counter.
      */
-    void add_child()
+    void add_child(Entry &child)
     {
+        msg_log_assert(child.parent_.get() == this);
+        msg_log_assert(child.prev_sibling_ == nullptr);
+        msg_log_assert(child.next_sibling_ == nullptr);
+
+        child.prev_sibling_ = last_child_;
+
+        if(last_child_ != nullptr)
+            last_child_->next_sibling_ = &child;
+        else
+            first_child_ = &child;
+
+        last_child_ = &child;
         ++children_count_;
     }
 
     /*!
-     * Decrease child counter.
+     * Unlink child object from this object, decrease child counter.
      */
-    void del_child()
+    void del_child(Entry &child)
     {
         msg_log_assert(children_count_ > 0);
+        msg_log_assert(child.parent_.get() == this);
+
+        if(child.prev_sibling_ != nullptr)
+            child.prev_sibling_->next_sibling_ = child.next_sibling_;
+        else
+            first_child_ = child.next_sibling_;
+
+        if(child.next_sibling_ != nullptr)
+            child.next_sibling_->prev_sibling_ = child.prev_sibling_;
+        else
+            last_child_ = child.prev_sibling_;
+
+        child.prev_sibling_ = nullptr;
+        child.next_sibling_ = nullptr;
         --children_count_;
     }
 
@@ -389,14 +568,14 @@ class Entry
             return entry.aging_list_data_.next_younger();
         }
 
-        static void add_child(const std::shared_ptr<Entry> &entry)
+        static void add_child(const std::shared_ptr<Entry> &entry, Entry &child)
         {
-            entry->add_child();
+            entry->add_child(child);
         }
 
-        static void del_child(const std::shared_ptr<Entry> &entry)
+        static void del_child(const std::shared_ptr<Entry> &entry, Entry &child)
         {
-            entry->del_child();
+            entry->del_child(child);
         }
 
         static bool insert_before(const std::shared_ptr<Entry> &new_entry,
@@ -425,6 +604,22 @@ class Entry
         friend class Cache;
     };
 
+    class Children
+    {
+        static const Entry *first(const Entry &entry)
+        {
+            return entry.first_child_;
+        }
+
+        static const Entry *next_sibling(const Entry &entry)
+        {
+            return entry.next_sibling_;
+        }
+
+        /* for traversing the tree downwards */
+        friend class Cache;
+    };
+
     class CachedObject
     {
         static void obliviate_child(const std::shared_ptr<Entry> &entry,
@@ -485,6 +680,32 @@ class Entry
             entry.cache_data_.set_pin_mode(pin_it);
         }
 
+        static double get_inflation_at_last_use(const Entry &entry)
+        {
+            return entry.cache_data_.get_inflation_at_last_use();
+        }
+
+        static void set_inflation_at_last_use(Entry &entry, double inflation)
+        {
+            entry.cache_data_.set_inflation_at_last_use(inflation);
+        }
+
+        static bool is_eviction_candidate(const Entry &entry)
+        {
+            return entry.cache_data_.is_eviction_candidate();
+        }
+
+        static double get_eviction_priority(const Entry &entry)
+        {
+            return entry.cache_data_.get_eviction_priority();
+        }
+
+        static void set_eviction_candidate(const Entry &entry,
+                                           bool is_candidate, double priority)
+        {
+            const_cast<Entry &>(entry).cache_data_.set_eviction_candidate(is_candidate, priority);
+        }
+
         /* for setting the object ID at insertion time and setting object size */
         friend class Cache;
     };
@@ -549,8 +770,68 @@ class CacheLimits
     }
 };
 
+/*!
+ * Limits for a single slice of garbage collection.
+ *
+ * Garbage collection may take a long time if many objects need to be
+ * discarded at once, and the cache is locked for the whole duration. A budget
+ * splits the work into slices, so that other work can be done in between (see
+ * #LRU::Cache::gc(const GCBudget &, bool &)).
+ *
+ * A slice ends when either the number of discarded objects or the time spent
+ * in the slice reaches its limit. Time is measured using #LRU::timebase, and
+ * it is checked before each discard. Thus, a slice may exceed its maximum
+ * duration by the time it takes to discard a single object.
+ */
+class GCBudget
+{
+  public:
+    const size_t max_discards_;
+    const std::chrono::milliseconds max_duration_;
+
+    GCBudget(const GCBudget &) = delete;
+    GCBudget &operator=(const GCBudget &) = delete;
+
+    explicit GCBudget(size_t max_discards,
+                      std::chrono::milliseconds max_duration):
+        max_discards_(max_discards),
+        max_duration_(max_duration)
+    {
+        msg_log_assert(max_discards_ > 0);
+        msg_log_assert(max_duration_.count() > 0);
+    }
+
+    static const GCBudget &unlimited()
+    {
+        static const GCBudget budget(std::numeric_limits<size_t>::max(),
+                                     std::chrono::milliseconds::max());
+        return budget;
+    }
+
+    bool is_exhausted(size_t discarded,
+                      const Timebase::time_point &slice_start) const
+    {
+        if(discarded >= max_discards_)
+            return true;
+
+        if(max_duration_ == std::chrono::milliseconds::max())
+            return false;
+
+        return timebase->now() - slice_start >= max_duration_;
+    }
+};
+
 /*!
  * Helper class for obtaining a usable ID.
+ *
+ * IDs are handed out in ascending order for each context, wrapping around
+ * at the maximum ID and skipping IDs which are still in use. The IDs in use
+ * are tracked in an #LRU::IdBitmap per context, so that finding a free ID
+ * does not depend on the number of IDs in use. IDs which are not used
+ * anymore must be passed to #LRU::CacheIdGenerator::release().
+ *
+ * Cached and uncached IDs with the same value in the same context are
+ * considered the same ID.
  */
 class CacheIdGenerator
 {
@@ -560,29 +841,34 @@ class CacheIdGenerator
   private:
     const uint32_t base_id_min_;
     const uint32_t base_id_max_;
-    const std::function<bool(ID::List)> is_id_free_;
 
     /*!
      * Next candidate for an ID, further checked in #next() member function.
      */
     std::array<uint32_t, DBUS_LISTS_CONTEXT_ID_MAX + 1> next_id_;
 
+    /*!
+     * IDs in use, allocated when the first ID of a context is requested.
+     */
+    std::array<std::unique_ptr<IdBitmap>, DBUS_LISTS_CONTEXT_ID_MAX + 1> used_ids_;
+
   public:
     CacheIdGenerator(const CacheIdGenerator &) = delete;
     CacheIdGenerator &operator=(const CacheIdGenerator &) = delete;
 
     explicit CacheIdGenerator(const uint32_t base_id_min,
-                              const uint32_t base_id_max,
-                              std::function<bool(ID::List)> &&is_id_free):
+                              const uint32_t base_id_max):
         base_id_min_(base_id_min),
-        base_id_max_(base_id_max),
-        is_id_free_(is_id_free)
+        base_id_max_(base_id_max)
     {
+        msg_log_assert(base_id_min_ > 0);
+        msg_log_assert(base_id_min_ <= base_id_max_);
+        msg_log_assert(base_id_max_ <= ID_MAX);
         next_id_.fill(base_id_min);
     }
 
     /*!
-     * Generate next list ID for given context.
+     * Generate next list ID for given context, mark it as used.
      *
      * \param cache_mode
      *     Whether or not the object shall remain in cache on garbage
@@ -598,6 +884,19 @@ class CacheIdGenerator
      */
     ID::List next(CacheMode cache_mode, ID::List::context_t ctx);
 
+    /*!
+     * Mark ID as free so that it may be returned by #next() again.
+     *
+     * \returns
+     *     True if the ID has been released, false if it was not in use.
+     */
+    bool release(ID::List id);
+
+    /*!
+     * Check whether or not given ID is currently in use.
+     */
+    bool is_used(ID::List id) const;
+
     /*!
      * Figure out cache mode for an entry ID.
      */
@@ -789,10 +1088,26 @@ class CacheIdGenerator
  * time algorithm. Note that this only works because \c INSERT-NEW and \c
  * USE-OBJECT already do the work required to keep the aging list in proper
  * shape.
+ *
+ * \par Thread safety
+ *
+ * All public member functions may be called from any thread. The cache is
+ * protected by a reader-writer lock (see #LRU::CacheLock): lookups by ID and
+ * other read-only accessors take the lock in shared mode and thus run
+ * concurrently, all functions which modify the cache structure (including
+ * #LRU::Cache::use(), which relinks the aging list) take the lock in
+ * exclusive mode. Callbacks and #LRU::Entry member functions called by the
+ * cache are called while the exclusive lock is held, and they may call back
+ * into the cache from the same thread.
+ *
+ * The aging list iterators (#LRU::Cache::begin() and friends) are \e not
+ * protected. They are meant for tests and diagnostics only.
  */
 class Cache
 {
   private:
+    mutable CacheLock lock_;
+
     CacheIdGenerator id_generator_;
 
     const CacheLimits memory_limits_;
@@ -812,8 +1127,11 @@ class Cache
      * to #LRU::Entry used by this class are all contained in
      * #LRU::Cache::all_objects_. All public interfaces deal with smart
      * pointers (\c std::shared_ptr), so our internal plain pointers are safe.
+     *
+     * Objects are looked up on each use, so this is a hash table rather than
+     * a tree (see #LRU::ObjectTable). Iteration order is unspecified.
      */
-    std::map<ID::List, std::shared_ptr<Entry>> all_objects_;
+    ObjectTable all_objects_;
 
     /*!
      * The root object in the tree hierarchy.
@@ -872,6 +1190,86 @@ class Cache
      */
     bool is_garbage_collector_running_;
 
+    /*!
+     * Where to continue garbage collection after an interrupted slice.
+     *
+     * All objects older than this one have either been discarded or are
+     * pinned. The cursor is reset whenever the aging list or the pinned path
+     * changes outside the garbage collector, in which case the next slice
+     * starts over at #LRU::Cache::oldest_object_.
+     */
+    const Entry *gc_cursor_;
+
+    /*!
+     * How to choose objects to discard under resource pressure.
+     */
+    EvictionPolicy eviction_policy_;
+
+    /*!
+     * Inflation value for #LRU::EvictionPolicy::GREEDY_DUAL_SIZE.
+     *
+     * This is the priority of the object discarded last. It never decreases
+     * while there are objects in the cache.
+     */
+    double inflation_;
+
+    /*!
+     * Candidate objects for #LRU::EvictionPolicy::GREEDY_DUAL_SIZE.
+     *
+     * Unpinned leaf objects ordered by priority, least recently used first
+     * among equals. Objects are added with the priority they have after being
+     * inserted or used, and they are removed when discarded, pinned, or when
+     * they get a child object, so that the garbage collector does not need to
+     * look at all objects to find the cheapest one. Empty unless the policy is
+     * #LRU::EvictionPolicy::GREEDY_DUAL_SIZE.
+     */
+    std::set<std::tuple<double, Timebase::time_point, const Entry *>> eviction_candidates_;
+
+    /*!
+     * Objects discarded while holding the exclusive lock.
+     *
+     * Destroying a cached object may block, e.g., when waiting for a thread
+     * which fills the object and which in turn is waiting for the cache lock.
+     * Therefore, #LRU::Cache::discard() does not drop the last reference to
+     * the discarded object, but moves it here. The references are dropped by
+     * #LRU::Cache::ExclusiveGuard after releasing the lock.
+     */
+    std::vector<std::shared_ptr<Entry>> discarded_objects_;
+
+    /*!
+     * RAII guard for exclusive locking of the cache.
+     *
+     * Use this guard instead of \c std::lock_guard for any modification of
+     * the cache. It drops the references to objects discarded while the lock
+     * was held, but only after the outermost exclusive lock has been
+     * released.
+     */
+    class ExclusiveGuard
+    {
+      private:
+        Cache &cache_;
+
+      public:
+        ExclusiveGuard(const ExclusiveGuard &) = delete;
+        ExclusiveGuard &operator=(const ExclusiveGuard &) = delete;
+
+        explicit ExclusiveGuard(Cache &cache):
+            cache_(cache)
+        {
+            cache_.lock_.lock();
+        }
+
+        ~ExclusiveGuard()
+        {
+            std::vector<std::shared_ptr<Entry>> discarded;
+
+            if(cache_.lock_.is_locked_once_by_this_thread())
+                discarded.swap(cache_.discarded_objects_);
+
+            cache_.lock_.unlock();
+        }
+    };
+
     std::function<void()> notify_first_object_inserted_;
     std::function<void()> notify_garbage_collection_needed_;
     std::function<void(ID::List)> notify_object_removed_;
@@ -954,6 +1352,20 @@ class Cache
         notify_last_object_removed_ = notify_last_object_removed;
     }
 
+    /*!
+     * Select how objects are chosen for eviction under resource pressure.
+     *
+     * The default is #LRU::EvictionPolicy::LEAST_RECENTLY_USED. The policy
+     * may be changed at any time, it affects the next garbage collection.
+     */
+    void set_eviction_policy(EvictionPolicy policy);
+
+    EvictionPolicy get_eviction_policy() const
+    {
+        CacheLock::SharedGuard guard(lock_);
+        return eviction_policy_;
+    }
+
     static constexpr const ssize_t USED_ENTRY_ALREADY_UP_TO_DATE = -1;
     static constexpr const ssize_t USED_ENTRY_INVALID_ID         = -2;
 
@@ -987,7 +1399,11 @@ class Cache
     /*!
      * Get ID of pinned object, if any.
      */
-    ID::List get_pinned_object() const { return pinned_object_id_; }
+    ID::List get_pinned_object() const
+    {
+        CacheLock::SharedGuard guard(lock_);
+        return pinned_object_id_;
+    }
 
     /*!
      * Pin object in cache, never allow it or object on the path to the root to
@@ -1008,10 +1424,9 @@ class Cache
                                                   const Entry *&oldest,
                                                   const Entry *&reconnect_tail_object);
     static void link_objects_on_path_to_root(Entry *entry,
-                                             const Timebase::time_point &now);
-    static bool pin_or_unpin_objects_on_path_to_root(const Cache &cache,
-                                                     ID::List id,
-                                                     bool pin_them);
+                                             const Timebase::time_point &now,
+                                             double inflation);
+    bool pin_or_unpin_objects_on_path_to_root(ID::List id, bool pin_them);
 
   public:
     /*!
@@ -1074,6 +1489,14 @@ class Cache
      */
     std::shared_ptr<Entry> lookup(ID::List entry_id) const;
 
+  private:
+    /*!
+     * Look up cached object by ID, caller must hold #LRU::Cache::lock_.
+     */
+    const std::shared_ptr<Entry> *lookup_unlocked(ID::List entry_id) const;
+
+  public:
+
     /*!
      * Change the size of a cached object, automatically mark as used.
      *
@@ -1083,6 +1506,12 @@ class Cache
      * it needs to discard any entries from the cache to stay within the
      * configured limits.
      *
+     * Only as many objects as needed for meeting the hard limits are
+     * discarded by this function. For the soft limits, the callback for
+     * requesting garbage collection set by #LRU::Cache::set_callbacks() is
+     * called so that the garbage collector can run in slices. If the size is
+     * unchanged, then this function is equivalent to #LRU::Cache::use().
+     *
      * \param entry_id
      *     The ID of the cached entry (list) whose size has changed.
      *
@@ -1096,12 +1525,26 @@ class Cache
     bool set_object_size(ID::List entry_id, size_t size_of_entry);
 
   private:
+    /*!
+     * Why an object is discarded, for #LRU::Statistics.
+     */
+    enum class DiscardReason
+    {
+        AGE,
+        SOFT_LIMIT,
+        HARD_LIMIT,
+        PURGE,
+    };
+
     /*!
      * Discard given object in the cache.
      *
      * \param candidate
      *     A pointer to the oldest unpinned cache object.
      *
+     * \param reason
+     *     Why the object is discarded.
+     *
      * \param allow_notifications
      *     If \c false, then the callbacks for object removal set by
      *     #LRU::Cache::set_callbacks() are \e not called by this function.
@@ -1112,16 +1555,69 @@ class Cache
      *     A pointer to the next object that is younger than \p candidate, or
      *     \c nullptr in case there is no such object.
      */
-    const Entry *discard(const Entry *const candidate,
+    const Entry *discard(const Entry *const candidate, DiscardReason reason,
                          bool allow_notifications = true);
 
+    /*!
+     * Priority of an object for #LRU::EvictionPolicy::GREEDY_DUAL_SIZE.
+     *
+     * Objects with lower priority are discarded first.
+     */
+    static double get_priority(const Entry &entry);
+
+    /*!
+     * Add object to #LRU::Cache::eviction_candidates_ if it qualifies.
+     *
+     * Nothing happens if the object is already a candidate, if it is not an
+     * unpinned leaf, or if the policy is not
+     * #LRU::EvictionPolicy::GREEDY_DUAL_SIZE.
+     */
+    void add_eviction_candidate(const Entry &entry);
+
+    /*!
+     * Remove object from #LRU::Cache::eviction_candidates_, if it is there.
+     *
+     * Must be called before the object's time of last use changes.
+     */
+    void remove_eviction_candidate(const Entry &entry);
+
+    /*!
+     * Discard objects with lowest priority until the low watermarks are
+     * reached, for #LRU::EvictionPolicy::GREEDY_DUAL_SIZE.
+     *
+     * \returns
+     *     True if done, false if the budget has been exhausted before.
+     */
+    bool discard_cheapest_objects(const GCBudget &budget,
+                                  const Timebase::time_point &slice_start,
+                                  size_t &discarded);
+
+    bool exceeds_hard_limits() const
+    {
+        return memory_limits_.exceeds_hard(total_size_) ||
+               count_limits_.exceeds_hard(all_objects_.size());
+    }
+
+    /*!
+     * Discard objects right away until no hard limit is exceeded anymore.
+     *
+     * Garbage collection requested through the callback set by
+     * #LRU::Cache::set_callbacks() may be deferred, so hard limits are
+     * enforced synchronously by the functions which make the cache grow. The
+     * garbage collector is run in slices of a single object so that it stops
+     * as soon as the hard limits are met, leaving the remaining work to the
+     * deferred garbage collection.
+     */
+    void enforce_hard_limits();
+
   public:
     /*!
      * Run garbage collection on the cache.
      *
      * In case any configured limits are exceeded, this function discards the
      * least recently used objects from the cache until the size of the cache
-     * does not exceed any of the configured limits anymore.
+     * does not exceed any of the configured limits anymore. Which objects are
+     * discarded first depends on the configured #LRU::EvictionPolicy.
      *
      * This function needs to be called periodically, there is no thread in the
      * background that does this automatically. It should be called from some
@@ -1135,11 +1631,63 @@ class Cache
      */
     std::chrono::seconds gc();
 
+    /*!
+     * Run a single slice of garbage collection on the cache.
+     *
+     * This function does the same as #LRU::Cache::gc(), but stops as soon as
+     * the given budget is exhausted. The position in the cache is remembered,
+     * so that the next call continues where the previous one stopped. Callers
+     * should keep calling this function until \p is_incomplete is returned as
+     * \c false, i.e., until all expired objects have been discarded and the
+     * low watermarks have been reached, giving other work a chance to run
+     * between slices.
+     *
+     * \param budget
+     *     Limits for this slice.
+     *
+     * \param[out] is_incomplete
+     *     Set to \c true if the slice was stopped because its budget was
+     *     exhausted, \c false if garbage collection has been completed.
+     *
+     * \returns
+     *     The amount of time after which #LRU::Cache::gc() should be called
+     *     again, as described for #LRU::Cache::gc(). In case \p is_incomplete
+     *     is \c true, this is always 0.
+     */
+    std::chrono::seconds gc(const GCBudget &budget, bool &is_incomplete);
+
     /*!
      * Get Number of objects in the cache.
      */
     size_t count() const;
 
+    /*!
+     * Call function for each cached object, oldest first.
+     *
+     * The objects are collected while the cache is locked in shared mode, and
+     * \p fn is called after the lock has been released. Thus, \p fn may call
+     * back into the cache, and it may see objects which have been discarded
+     * from the cache in the meantime.
+     */
+    void for_each_entry(const std::function<void(const Entry &)> &fn) const;
+
+    /*!
+     * Collect the IDs of all cached objects in a subtree.
+     *
+     * The subtree is traversed breadth-first through the links between cached
+     * objects, so the cost is proportional to the number of objects in the
+     * subtree, independent of the size of the cache and of the size of the
+     * lists in the subtree.
+     *
+     * \param entry
+     *     Root of the subtree, must be stored in this cache. Its ID is always
+     *     the first one appended to \p nodes.
+     *
+     * \param nodes
+     *     IDs are appended to this list.
+     */
+    void enumerate_subtree(const Entry &entry, std::vector<ID::List> &nodes) const;
+
     /*!
      * Perform in-place topological sort of the given list of IDs.
      *
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef LRU_CACHE_LOCK_HH
+#define LRU_CACHE_LOCK_HH
+
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+
+namespace LRU
+{
+
+/*!
+ * Reader-writer lock for #LRU::Cache, recursive for the writer.
+ *
+ * Any number of threads may hold the lock in shared mode, or a single thread
+ * may hold it in exclusive mode. The thread holding the exclusive lock may
+ * lock again, in exclusive or shared mode, without blocking.
+ *
+ * Writer recursion is required because the cache calls out to its callbacks
+ * and to the cached objects while modifying its structure, and these are free
+ * to call back into the cache (e.g., the callback for exceeded limits usually
+ * runs the garbage collector right away). Recursion in shared mode is not
+ * supported; shared locks are only taken for short-lived lookups which never
+ * call out of the cache.
+ *
+ * Class #LRU::CacheLock satisfies the \c Lockable requirements, so that
+ * \c std::lock_guard may be used for exclusive locking. Use
+ * #LRU::CacheLock::SharedGuard for shared locking.
+ */
+class CacheLock
+{
+  private:
+    std::shared_mutex lock_;
+    std::atomic<std::thread::id> writer_;
+    size_t writer_depth_;
+
+  public:
+    CacheLock(const CacheLock &) = delete;
+    CacheLock &operator=(const CacheLock &) = delete;
+
+    explicit CacheLock():
+        writer_depth_(0)
+    {}
+
+    void lock()
+    {
+        const auto self = std::this_thread::get_id();
+
+        if(writer_.load(std::memory_order_relaxed) == self)
+        {
+            ++writer_depth_;
+            return;
+        }
+
+        lock_.lock();
+        writer_.store(self, std::memory_order_relaxed);
+        writer_depth_ = 1;
+    }
+
+    bool try_lock()
+    {
+        const auto self = std::this_thread::get_id();
+
+        if(writer_.load(std::memory_order_relaxed) == self)
+        {
+            ++writer_depth_;
+            return true;
+        }
+
+        if(!lock_.try_lock())
+            return false;
+
+        writer_.store(self, std::memory_order_relaxed);
+        writer_depth_ = 1;
+
+        return true;
+    }
+
+    void unlock()
+    {
+        if(--writer_depth_ > 0)
+            return;
+
+        writer_.store(std::thread::id(), std::memory_order_relaxed);
+        lock_.unlock();
+    }
+
+    /*!
+     * Whether or not the calling thread holds the exclusive lock.
+     */
+    bool is_locked_by_this_thread() const
+    {
+        return writer_.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+
+    /*!
+     * Whether or not the calling thread holds the exclusive lock, but not
+     * recursively.
+     *
+     * This is true while the outermost exclusive lock is held, so that
+     * anything to be done right before unlocking for real can be done if
+     * this function returns \c true.
+     */
+    bool is_locked_once_by_this_thread() const
+    {
+        return is_locked_by_this_thread() && writer_depth_ == 1;
+    }
+
+    /*!
+     * RAII guard for shared locking.
+     *
+     * In case the calling thread holds the exclusive lock already, the guard
+     * enters the exclusive lock recursively instead.
+     */
+    class SharedGuard
+    {
+      private:
+        CacheLock &lock_;
+        const bool is_exclusive_;
+
+      public:
+        SharedGuard(const SharedGuard &) = delete;
+        SharedGuard &operator=(const SharedGuard &) = delete;
+
+        explicit SharedGuard(CacheLock &lock):
+            lock_(lock),
+            is_exclusive_(lock.is_locked_by_this_thread())
+        {
+            if(is_exclusive_)
+                lock_.lock();
+            else
+                lock_.lock_.lock_shared();
+        }
+
+        ~SharedGuard()
+        {
+            if(is_exclusive_)
+                lock_.unlock();
+            else
+                lock_.lock_.unlock_shared();
+        }
+    };
+};
+
+}
+
+#endif /* !LRU_CACHE_LOCK_HH */
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef LRU_ID_BITMAP_HH
+#define LRU_ID_BITMAP_HH
+
+#include <memory>
+#include <vector>
+#include <array>
+#include <cinttypes>
+
+namespace LRU
+{
+
+/*!
+ * Set of used IDs in a contiguous range, for finding free IDs quickly.
+ *
+ * This is a three-level bitmap. The bits for the IDs are grouped into pages
+ * which are allocated when the first bit is set and freed when the last bit
+ * is cleared, so memory consumption depends on how the used IDs are spread,
+ * not on the size of the range. Each page keeps a summary bitmap of its
+ * words which have all bits set, and there is a summary bitmap of full pages
+ * on top.
+ *
+ * Finding the next clear bit at or after some position therefore never
+ * scans more than a few dozen words, each by a single count-trailing-zeros
+ * operation, regardless of how many bits are set.
+ */
+class IdBitmap
+{
+  public:
+    static constexpr const size_t WORDS_PER_PAGE = 512;
+    static constexpr const size_t BITS_PER_PAGE = WORDS_PER_PAGE * 64;
+
+  private:
+    struct Page
+    {
+        std::array<uint64_t, WORDS_PER_PAGE / 64> full_words_;
+        std::array<uint64_t, WORDS_PER_PAGE> words_;
+        size_t count_;
+
+        explicit Page(): count_(0)
+        {
+            full_words_.fill(0);
+            words_.fill(0);
+        }
+    };
+
+    const size_t number_of_bits_;
+    std::vector<std::unique_ptr<Page>> pages_;
+    std::vector<uint64_t> full_pages_;
+
+  public:
+    IdBitmap(const IdBitmap &) = delete;
+    IdBitmap &operator=(const IdBitmap &) = delete;
+
+    explicit IdBitmap(size_t number_of_bits):
+        number_of_bits_(number_of_bits),
+        pages_((number_of_bits + BITS_PER_PAGE - 1) / BITS_PER_PAGE),
+        full_pages_((pages_.size() + 63) / 64, 0)
+    {}
+
+    size_t size() const { return number_of_bits_; }
+
+    bool is_set(size_t bit) const
+    {
+        if(bit >= number_of_bits_)
+            return false;
+
+        const Page *page = pages_[bit / BITS_PER_PAGE].get();
+
+        if(page == nullptr)
+            return false;
+
+        const size_t offset = bit % BITS_PER_PAGE;
+
+        return (page->words_[offset / 64] & (uint64_t(1) << (offset % 64))) != 0;
+    }
+
+    /*!
+     * Set bit.
+     *
+     * \returns
+     *     True if the bit has been set, false if it was set already or if it
+     *     is out of range.
+     */
+    bool set(size_t bit)
+    {
+        if(bit >= number_of_bits_)
+            return false;
+
+        const size_t page_index = bit / BITS_PER_PAGE;
+        auto &page(pages_[page_index]);
+
+        if(page == nullptr)
+            page = std::make_unique<Page>();
+
+        const size_t offset = bit % BITS_PER_PAGE;
+        uint64_t &word(page->words_[offset / 64]);
+        const uint64_t mask = uint64_t(1) << (offset % 64);
+
+        if((word & mask) != 0)
+            return false;
+
+        word |= mask;
+
+        if(word == ~uint64_t(0))
+            set_bit(page->full_words_.data(), offset / 64);
+
+        if(++page->count_ == get_page_capacity(page_index))
+            set_bit(full_pages_.data(), page_index);
+
+        return true;
+    }
+
+    /*!
+     * Clear bit.
+     *
+     * \returns
+     *     True if the bit has been cleared, false if it was not set or if it
+     *     is out of range.
+     */
+    bool clear(size_t bit)
+    {
+        if(bit >= number_of_bits_)
+            return false;
+
+        const size_t page_index = bit / BITS_PER_PAGE;
+        auto &page(pages_[page_index]);
+
+        if(page == nullptr)
+            return false;
+
+        const size_t offset = bit % BITS_PER_PAGE;
+        uint64_t &word(page->words_[offset / 64]);
+        const uint64_t mask = uint64_t(1) << (offset % 64);
+
+        if((word & mask) == 0)
+            return false;
+
+        word &= ~mask;
+        clear_bit(page->full_words_.data(), offset / 64);
+        clear_bit(full_pages_.data(), page_index);
+
+        if(--page->count_ == 0)
+            page = nullptr;
+
+        return true;
+    }
+
+    /*!
+     * Find first clear bit at or after given position.
+     *
+     * \returns
+     *     The position of the clear bit, or #LRU::IdBitmap::size() if all
+     *     bits from \p from up to the end are set.
+     */
+    size_t find_clear(size_t from) const
+    {
+        if(from >= number_of_bits_)
+            return number_of_bits_;
+
+        size_t page_index = from / BITS_PER_PAGE;
+        size_t offset = from % BITS_PER_PAGE;
+
+        while(true)
+        {
+            const size_t next_page_index =
+                find_clear_bit(full_pages_.data(), full_pages_.size(), page_index);
+
+            if(next_page_index >= pages_.size())
+                return number_of_bits_;
+
+            if(next_page_index != page_index)
+            {
+                page_index = next_page_index;
+                offset = 0;
+            }
+
+            const Page *page = pages_[page_index].get();
+            const size_t found =
+                page == nullptr ? offset : find_clear_in_page(*page, offset);
+
+            if(found < BITS_PER_PAGE)
+            {
+                const size_t bit = page_index * BITS_PER_PAGE + found;
+                return bit < number_of_bits_ ? bit : number_of_bits_;
+            }
+
+            /* page not full, but all bits from offset on are set */
+            ++page_index;
+            offset = 0;
+        }
+    }
+
+  private:
+    size_t get_page_capacity(size_t page_index) const
+    {
+        const size_t first_bit = page_index * BITS_PER_PAGE;
+        const size_t remaining = number_of_bits_ - first_bit;
+        return remaining < BITS_PER_PAGE ? remaining : BITS_PER_PAGE;
+    }
+
+    static void set_bit(uint64_t *words, size_t bit)
+    {
+        words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+
+    static void clear_bit(uint64_t *words, size_t bit)
+    {
+        words[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+    }
+
+    static size_t find_clear_bit(const uint64_t *words, size_t number_of_words,
+                                 size_t from)
+    {
+        size_t w = from / 64;
+
+        if(w >= number_of_words)
+            return number_of_words * 64;
+
+        uint64_t clear_bits = ~words[w] & (~uint64_t(0) << (from % 64));
+
+        while(clear_bits == 0)
+        {
+            if(++w >= number_of_words)
+                return number_of_words * 64;
+
+            clear_bits = ~words[w];
+        }
+
+        return w * 64 + __builtin_ctzll(clear_bits);
+    }
+
+    static size_t find_clear_in_page(const Page &page, size_t offset)
+    {
+        const size_t w = offset / 64;
+        const uint64_t clear_bits =
+            ~page.words_[w] & (~uint64_t(0) << (offset % 64));
+
+        if(clear_bits != 0)
+            return w * 64 + __builtin_ctzll(clear_bits);
+
+        const size_t next_w =
+            find_clear_bit(page.full_words_.data(), page.full_words_.size(), w + 1);
+
+        if(next_w >= WORDS_PER_PAGE)
+            return BITS_PER_PAGE;
+
+        return next_w * 64 + __builtin_ctzll(~page.words_[next_w]);
+    }
+};
+
+}
+
+#endif /* !LRU_ID_BITMAP_HH */
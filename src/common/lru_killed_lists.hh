@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -44,9 +44,10 @@ namespace LRU
  * removal of a list. However, since a #TiledList doesn't know anything about
  * the #LRU::Cache which is managing it and because there are various threads
  * involved in #TiledList operation, it would get more complicated than
- * necessary to implement this. The cache structure is not thread-safe and is
- * not protected by locks anywhere, so we'd have to add locking all over the
- * place.
+ * necessary to implement this. The cache structure itself is protected by
+ * #LRU::CacheLock, but #TiledList would still need access to the cache and
+ * would have to take care not to call into it while the cache is calling out
+ * to the list (e.g., during garbage collection).
  *
  * Thus, we take a different approach. Since the cache is scrubbed regularly
  * via garbage collection driven by #LRU::CacheControl (based on timing and
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef LRU_OBJECT_TABLE_HH
+#define LRU_OBJECT_TABLE_HH
+
+#include "idtypes.hh"
+
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <utility>
+
+namespace LRU
+{
+
+class Entry;
+
+/*!
+ * Hash table mapping list IDs to cached objects.
+ *
+ * This is an open-addressing hash table with linear probing, keyed by the raw
+ * list ID. All slots are stored in a single contiguous array so that lookups
+ * usually touch only one or two cache lines, as opposed to the pointer chasing
+ * required for walking a balanced tree.
+ *
+ * Empty slots are marked by the invalid list ID (raw ID 0), which is never
+ * used for cached objects. Erasure is done by backward shifting of the
+ * following cluster, so there are no tombstones and probe sequences never
+ * degrade over time.
+ *
+ * The interface mimics the subset of \c std::map used by #LRU::Cache. Note,
+ * however, that iteration order is not related to the order of the keys, and
+ * that any modification of the table invalidates all iterators.
+ */
+class ObjectTable
+{
+  public:
+    using value_type = std::pair<ID::List, std::shared_ptr<Entry>>;
+
+  private:
+    static constexpr const size_t MINIMUM_CAPACITY = 16;
+
+    static bool is_free(const value_type &slot)
+    {
+        return slot.first.get_raw_id() == 0;
+    }
+
+    std::vector<value_type> slots_;
+    size_t size_;
+    unsigned int shift_;
+
+  public:
+    class const_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ObjectTable::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+      private:
+        const value_type *current_;
+        const value_type *end_;
+
+      public:
+        explicit const_iterator(const value_type *current, const value_type *end):
+            current_(current),
+            end_(end)
+        {
+            skip_empty();
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            return current_ == other.current_;
+        }
+
+        bool operator!=(const const_iterator &other) const
+        {
+            return current_ != other.current_;
+        }
+
+        const_iterator &operator++()
+        {
+            ++current_;
+            skip_empty();
+            return *this;
+        }
+
+        const value_type &operator*() const { return *current_; }
+        const value_type *operator->() const { return current_; }
+
+      private:
+        void skip_empty()
+        {
+            while(current_ != end_ && is_free(*current_))
+                ++current_;
+        }
+    };
+
+    ObjectTable(const ObjectTable &) = delete;
+    ObjectTable &operator=(const ObjectTable &) = delete;
+
+    explicit ObjectTable():
+        slots_(MINIMUM_CAPACITY),
+        size_(0),
+        shift_(compute_shift(MINIMUM_CAPACITY))
+    {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return slots_.size(); }
+
+    const_iterator begin() const
+    {
+        return const_iterator(slots_.data(), slots_.data() + slots_.size());
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(slots_.data() + slots_.size(),
+                              slots_.data() + slots_.size());
+    }
+
+    /*!
+     * Find object by ID.
+     *
+     * \returns
+     *     Iterator pointing to the object, or #LRU::ObjectTable::end() in case
+     *     there is no object stored under the given ID.
+     */
+    const_iterator find(ID::List id) const
+    {
+        const size_t idx = find_slot(id);
+        return idx < slots_.size()
+            ? const_iterator(&slots_[idx], slots_.data() + slots_.size())
+            : end();
+    }
+
+    /*!
+     * Return pointer to object stored under given ID, or \c nullptr.
+     *
+     * This is cheaper than #LRU::ObjectTable::find() followed by copying the
+     * smart pointer because no reference counting is involved.
+     */
+    Entry *get(ID::List id) const
+    {
+        const size_t idx = find_slot(id);
+        return idx < slots_.size() ? slots_[idx].second.get() : nullptr;
+    }
+
+    /*!
+     * Store object under given ID.
+     *
+     * \returns
+     *     True if the object has been inserted, false if there is already an
+     *     object stored under the same ID or if the ID is invalid (in which
+     *     cases the table remains unchanged).
+     */
+    bool insert(ID::List id, std::shared_ptr<Entry> &&entry)
+    {
+        if(!id.is_valid())
+            return false;
+
+        if((size_ + 1) * 4 > slots_.size() * 3)
+            rehash(slots_.size() * 2);
+
+        const size_t mask = slots_.size() - 1;
+
+        for(size_t idx = home_slot(id); /* nothing */; idx = (idx + 1) & mask)
+        {
+            value_type &slot(slots_[idx]);
+
+            if(slot.first == id)
+                return false;
+
+            if(is_free(slot))
+            {
+                slot.first = id;
+                slot.second = std::move(entry);
+                ++size_;
+                return true;
+            }
+        }
+    }
+
+    /*!
+     * Remove object stored under given ID.
+     *
+     * \returns
+     *     The number of objects removed, i.e., 0 or 1.
+     */
+    size_t erase(ID::List id)
+    {
+        size_t hole = find_slot(id);
+
+        if(hole >= slots_.size())
+            return 0;
+
+        const size_t mask = slots_.size() - 1;
+
+        slots_[hole].second.reset();
+        slots_[hole].first = ID::List();
+
+        /* backward shift of the following cluster to close the hole */
+        for(size_t idx = (hole + 1) & mask;
+            !is_free(slots_[idx]);
+            idx = (idx + 1) & mask)
+        {
+            const size_t home = home_slot(slots_[idx].first);
+
+            /* move object into hole only if its home lies cyclically
+             * outside of (hole, idx] */
+            if(((idx - home) & mask) >= ((idx - hole) & mask))
+            {
+                slots_[hole] = std::move(slots_[idx]);
+                slots_[idx].first = ID::List();
+                hole = idx;
+            }
+        }
+
+        --size_;
+
+        if(slots_.size() > MINIMUM_CAPACITY && size_ * 8 < slots_.size())
+            rehash(slots_.size() / 2);
+
+        return 1;
+    }
+
+    void clear()
+    {
+        slots_.clear();
+        slots_.resize(MINIMUM_CAPACITY);
+        shift_ = compute_shift(MINIMUM_CAPACITY);
+        size_ = 0;
+    }
+
+  private:
+    static unsigned int compute_shift(size_t capacity)
+    {
+        unsigned int bits = 0;
+
+        while((size_t(1) << bits) < capacity)
+            ++bits;
+
+        return 32 - bits;
+    }
+
+    /*!
+     * Fibonacci hashing of the raw ID.
+     *
+     * List IDs are mostly sequential in their lower bits, but the context ID
+     * is stored in the upper bits. Multiplicative hashing spreads both over
+     * the whole table.
+     */
+    size_t home_slot(ID::List id) const
+    {
+        return uint32_t(id.get_raw_id() * UINT32_C(2654435769)) >> shift_;
+    }
+
+    size_t find_slot(ID::List id) const
+    {
+        if(!id.is_valid())
+            return slots_.size();
+
+        const size_t mask = slots_.size() - 1;
+
+        for(size_t idx = home_slot(id); /* nothing */; idx = (idx + 1) & mask)
+        {
+            const value_type &slot(slots_[idx]);
+
+            if(slot.first == id)
+                return idx;
+
+            if(is_free(slot))
+                return slots_.size();
+        }
+    }
+
+    void rehash(size_t new_capacity)
+    {
+        std::vector<value_type> old_slots(new_capacity);
+        old_slots.swap(slots_);
+        shift_ = compute_shift(new_capacity);
+        size_ = 0;
+
+        for(auto &slot : old_slots)
+            if(!is_free(slot))
+                insert(slot.first, std::move(slot.second));
+    }
+};
+
+}
+
+#endif /* !LRU_OBJECT_TABLE_HH */
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef LRU_POOL_ALLOCATOR_HH
+#define LRU_POOL_ALLOCATOR_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <cstdlib>
+#include <typeinfo>
+#include <cxxabi.h>
+
+#include "messages.h"
+
+namespace LRU
+{
+
+/*!
+ * Usage statistics of a single #LRU::FixedSizePool.
+ */
+struct PoolStatistics
+{
+    std::string name_;
+    size_t object_size_;
+    size_t objects_per_slab_;
+    size_t slabs_;
+    size_t in_use_;
+    size_t peak_in_use_;
+    size_t allocations_;
+    size_t deallocations_;
+};
+
+/*!
+ * Pool of equally sized memory chunks, allocated in slabs.
+ *
+ * Memory is requested from the system in slabs of several chunks each. Freed
+ * chunks are kept on a free list for reuse by objects of the same type, they
+ * are not returned to the system. This keeps frequently allocated and freed
+ * objects out of the general heap, where they would cause fragmentation.
+ * Memory consumption of a pool is bounded by the peak number of objects ever
+ * allocated from it, which for cached lists is limited by the cache limits.
+ *
+ * All functions are thread-safe.
+ */
+class FixedSizePool
+{
+  private:
+    union Chunk
+    {
+        Chunk *next_;
+    };
+
+    static constexpr size_t MINIMUM_SLAB_SIZE = 16 * 1024;
+    static constexpr size_t MINIMUM_OBJECTS_PER_SLAB = 4;
+
+    mutable std::mutex lock_;
+
+    const std::string name_;
+    const std::align_val_t alignment_;
+    const size_t object_size_;
+    const size_t chunk_size_;
+    const size_t chunks_per_slab_;
+
+    std::vector<void *> slabs_;
+    Chunk *free_list_;
+
+    size_t in_use_;
+    size_t peak_in_use_;
+    size_t allocations_;
+    size_t deallocations_;
+
+  public:
+    FixedSizePool(const FixedSizePool &) = delete;
+    FixedSizePool &operator=(const FixedSizePool &) = delete;
+
+    explicit FixedSizePool(std::string &&name, size_t object_size,
+                           size_t alignment):
+        name_(std::move(name)),
+        alignment_(std::align_val_t(std::max(alignment, alignof(Chunk)))),
+        object_size_(object_size),
+        chunk_size_(round_up(std::max(object_size, sizeof(Chunk)),
+                             size_t(alignment_))),
+        chunks_per_slab_(std::max(MINIMUM_OBJECTS_PER_SLAB,
+                                  MINIMUM_SLAB_SIZE / chunk_size_)),
+        free_list_(nullptr),
+        in_use_(0),
+        peak_in_use_(0),
+        allocations_(0),
+        deallocations_(0)
+    {}
+
+    /*!
+     * Pools live until the end of the program.
+     *
+     * Objects allocated from a pool may still be referenced during static
+     * destruction, so pools are allocated on the heap and never destroyed.
+     */
+    ~FixedSizePool() = delete;
+
+    void *allocate()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        if(free_list_ == nullptr)
+            add_slab();
+
+        Chunk *c = free_list_;
+        free_list_ = c->next_;
+
+        ++allocations_;
+        ++in_use_;
+
+        if(in_use_ > peak_in_use_)
+            peak_in_use_ = in_use_;
+
+        return c;
+    }
+
+    void deallocate(void *p)
+    {
+        if(p == nullptr)
+            return;
+
+        std::lock_guard<std::mutex> lock(lock_);
+
+        msg_log_assert(in_use_ > 0);
+
+        Chunk *c = static_cast<Chunk *>(p);
+        c->next_ = free_list_;
+        free_list_ = c;
+
+        ++deallocations_;
+        --in_use_;
+    }
+
+    PoolStatistics get_statistics() const
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        return PoolStatistics
+        {
+            name_, object_size_, chunks_per_slab_, slabs_.size(),
+            in_use_, peak_in_use_, allocations_, deallocations_,
+        };
+    }
+
+  private:
+    static size_t round_up(size_t size, size_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    void add_slab()
+    {
+        auto *slab = static_cast<char *>(::operator new(chunk_size_ * chunks_per_slab_,
+                                                         alignment_));
+        slabs_.push_back(slab);
+
+        /* chain chunks in address order */
+        for(size_t i = chunks_per_slab_; i > 0; --i)
+        {
+            Chunk *c = reinterpret_cast<Chunk *>(slab + (i - 1) * chunk_size_);
+            c->next_ = free_list_;
+            free_list_ = c;
+        }
+    }
+};
+
+/*!
+ * Registry of all pools, for statistics.
+ */
+class PoolRegistry
+{
+  private:
+    std::mutex lock_;
+    std::vector<const FixedSizePool *> pools_;
+
+  public:
+    PoolRegistry(const PoolRegistry &) = delete;
+    PoolRegistry &operator=(const PoolRegistry &) = delete;
+
+    explicit PoolRegistry() {}
+
+    static PoolRegistry &get_singleton()
+    {
+        static PoolRegistry &registry(*new PoolRegistry);
+        return registry;
+    }
+
+    void add(const FixedSizePool &pool)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        pools_.push_back(&pool);
+    }
+
+    std::vector<PoolStatistics> get_statistics()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        std::vector<PoolStatistics> result;
+
+        for(const auto *pool : pools_)
+            result.emplace_back(pool->get_statistics());
+
+        return result;
+    }
+
+    void log_statistics(enum MessageVerboseLevel level)
+    {
+        if(!msg_is_verbose(level))
+            return;
+
+        for(const auto &s : get_statistics())
+            msg_vinfo(level,
+                      "Pool %s: %zu in use (peak %zu), %zu allocations, "
+                      "%zu deallocations, %zu slabs of %zu objects of size %zu",
+                      s.name_.c_str(), s.in_use_, s.peak_in_use_,
+                      s.allocations_, s.deallocations_,
+                      s.slabs_, s.objects_per_slab_, s.object_size_);
+    }
+};
+
+/*!
+ * Allocator for objects managed by the LRU cache, for use with
+ * \c std::allocate_shared().
+ *
+ * Single objects are allocated from a #LRU::FixedSizePool dedicated to type
+ * \p T, so objects of different types never share slabs. Through rebinding,
+ * \c std::allocate_shared() allocates the object together with its control
+ * block from the pool for that combined type, which is still specific to the
+ * original type \p Tag.
+ *
+ * \tparam T
+ *     Type of the objects to allocate.
+ *
+ * \tparam Tag
+ *     Type the pool is named after; \p T is rebound by the standard library,
+ *     but \p Tag stays the same.
+ */
+template <typename T, typename Tag = T>
+class PoolAllocator
+{
+  public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = PoolAllocator<U, Tag>;
+    };
+
+    PoolAllocator() noexcept {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U, Tag> &) noexcept {}
+
+    T *allocate(size_t n)
+    {
+        if(n == 1)
+            return static_cast<T *>(get_pool().allocate());
+
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        if(n == 1)
+            get_pool().deallocate(p);
+        else
+            std::allocator<T>().deallocate(p, n);
+    }
+
+    static FixedSizePool &get_pool()
+    {
+        static FixedSizePool &pool(make_pool());
+        return pool;
+    }
+
+  private:
+    static FixedSizePool &make_pool()
+    {
+        int status;
+        char *demangled =
+            abi::__cxa_demangle(typeid(Tag).name(), nullptr, nullptr, &status);
+        std::string name(status == 0 && demangled != nullptr
+                         ? demangled
+                         : typeid(Tag).name());
+        free(demangled);
+
+        auto *pool = new FixedSizePool(std::move(name), sizeof(T), alignof(T));
+        PoolRegistry::get_singleton().add(*pool);
+
+        return *pool;
+    }
+};
+
+template <typename T, typename U, typename Tag>
+static inline bool operator==(const PoolAllocator<T, Tag> &,
+                              const PoolAllocator<U, Tag> &)
+{
+    return true;
+}
+
+template <typename T, typename U, typename Tag>
+static inline bool operator!=(const PoolAllocator<T, Tag> &,
+                              const PoolAllocator<U, Tag> &)
+{
+    return false;
+}
+
+/*!
+ * Allocate object of type \p T from its pool.
+ */
+template <typename T, typename... Args>
+static inline std::shared_ptr<T> make_pooled(Args&&... args)
+{
+    return std::allocate_shared<T>(PoolAllocator<T>(),
+                                   std::forward<Args>(args)...);
+}
+
+}
+
+#endif /* !LRU_POOL_ALLOCATOR_HH */
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "lru_statistics.hh"
+#include "messages.h"
+
+LRU::Statistics &LRU::Statistics::get_singleton()
+{
+    static LRU::Statistics statistics;
+    return statistics;
+}
+
+void LRU::Statistics::reset()
+{
+    for(auto &c : counters_)
+        c.store(0, std::memory_order_relaxed);
+
+    for(auto &h : histograms_)
+        for(auto &b : h)
+            b.store(0, std::memory_order_relaxed);
+}
+
+const char *LRU::Statistics::get_name(Counter c)
+{
+    static const std::array<const char *, NUMBER_OF_COUNTERS> names
+    {
+        "lookup_hits",
+        "lookup_misses",
+        "insertions",
+        "discarded_by_age",
+        "discarded_by_soft_limit",
+        "discarded_by_hard_limit",
+        "purged",
+        "bytes_discarded_by_age",
+        "bytes_discarded_by_soft_limit",
+        "bytes_discarded_by_hard_limit",
+        "bytes_purged",
+        "tile_hits",
+        "tile_misses",
+        "tile_slides",
+        "tile_prefetches",
+        "tile_fills",
+        "tile_fill_failures",
+        "cold_tile_stores",
+        "cold_tile_hits",
+        "coalesced_tile_fills",
+    };
+
+    if(size_t(c) < names.size())
+        return names[size_t(c)];
+
+    MSG_BUG("Invalid statistics counter %zu", size_t(c));
+    return "invalid";
+}
+
+const char *LRU::Statistics::get_name(Histogram h)
+{
+    static const std::array<const char *, NUMBER_OF_HISTOGRAMS> names
+    {
+        "tile_fill_duration_us",
+        "gc_duration_us",
+    };
+
+    if(size_t(h) < names.size())
+        return names[size_t(h)];
+
+    MSG_BUG("Invalid statistics histogram %zu", size_t(h));
+    return "invalid";
+}
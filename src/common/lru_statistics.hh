@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef LRU_STATISTICS_HH
+#define LRU_STATISTICS_HH
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+
+namespace LRU
+{
+
+/*!
+ * Counters and latency histograms for cache and list tile operations.
+ *
+ * All counters count events since program start. They are updated with
+ * relaxed atomic operations, so they may be updated from any thread at very
+ * little cost, but a set of values read at some point in time may not be
+ * perfectly consistent.
+ *
+ * Latency histograms have logarithmic buckets. Bucket 0 counts durations
+ * below 1 microsecond, bucket \e i counts durations of at least
+ * 2<sup><em>i</em>-1</sup> and less than 2<sup><em>i</em></sup>
+ * microseconds, and the last bucket counts all longer durations.
+ */
+class Statistics
+{
+  public:
+    enum class Counter
+    {
+        LOOKUP_HITS,
+        LOOKUP_MISSES,
+        INSERTIONS,
+        DISCARDED_BY_AGE,
+        DISCARDED_BY_SOFT_LIMIT,
+        DISCARDED_BY_HARD_LIMIT,
+        PURGED,
+        BYTES_DISCARDED_BY_AGE,
+        BYTES_DISCARDED_BY_SOFT_LIMIT,
+        BYTES_DISCARDED_BY_HARD_LIMIT,
+        BYTES_PURGED,
+        TILE_HITS,
+        TILE_MISSES,
+        TILE_SLIDES,
+        TILE_PREFETCHES,
+        TILE_FILLS,
+        TILE_FILL_FAILURES,
+        COLD_TILE_STORES,
+        COLD_TILE_HITS,
+        COALESCED_TILE_FILLS,
+
+        LAST_COUNTER = COALESCED_TILE_FILLS,
+    };
+
+    enum class Histogram
+    {
+        TILE_FILL_DURATION,
+        GC_DURATION,
+
+        LAST_HISTOGRAM = GC_DURATION,
+    };
+
+    static constexpr const size_t NUMBER_OF_COUNTERS = size_t(Counter::LAST_COUNTER) + 1;
+    static constexpr const size_t NUMBER_OF_HISTOGRAMS = size_t(Histogram::LAST_HISTOGRAM) + 1;
+    static constexpr const size_t NUMBER_OF_BUCKETS = 25;
+
+    using Buckets = std::array<uint64_t, NUMBER_OF_BUCKETS>;
+
+  private:
+    std::array<std::atomic<uint64_t>, NUMBER_OF_COUNTERS> counters_;
+    std::array<std::array<std::atomic<uint64_t>, NUMBER_OF_BUCKETS>,
+               NUMBER_OF_HISTOGRAMS> histograms_;
+
+    explicit Statistics() { reset(); }
+
+  public:
+    Statistics(const Statistics &) = delete;
+    Statistics &operator=(const Statistics &) = delete;
+
+    static Statistics &get_singleton();
+
+    void count(Counter c, uint64_t n = 1)
+    {
+        counters_[size_t(c)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void record(Histogram h, std::chrono::microseconds duration)
+    {
+        histograms_[size_t(h)][get_bucket(duration)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t get(Counter c) const
+    {
+        return counters_[size_t(c)].load(std::memory_order_relaxed);
+    }
+
+    void get(Histogram h, Buckets &buckets) const
+    {
+        for(size_t i = 0; i < NUMBER_OF_BUCKETS; ++i)
+            buckets[i] = histograms_[size_t(h)][i].load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * Set all counters and histograms to zero.
+     */
+    void reset();
+
+    static const char *get_name(Counter c);
+    static const char *get_name(Histogram h);
+
+    /*!
+     * Smallest duration in microseconds not counted in given bucket, or
+     * \c UINT64_MAX for the last bucket.
+     */
+    static uint64_t get_bucket_upper_bound(size_t bucket)
+    {
+        return bucket < NUMBER_OF_BUCKETS - 1
+            ? uint64_t(1) << bucket
+            : UINT64_MAX;
+    }
+
+  private:
+    static size_t get_bucket(std::chrono::microseconds duration)
+    {
+        if(duration.count() <= 0)
+            return 0;
+
+        const size_t bucket =
+            64 - __builtin_clzll(static_cast<unsigned long long>(duration.count()));
+
+        return bucket < NUMBER_OF_BUCKETS ? bucket : NUMBER_OF_BUCKETS - 1;
+    }
+};
+
+}
+
+#endif /* !LRU_STATISTICS_HH */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STRING_ARENA_HH
+#define STRING_ARENA_HH
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+
+/*!
+ * Bump allocator for strings which share a lifetime.
+ *
+ * Strings are copied into large chunks of memory allocated by the arena and
+ * are released all at once by #StringArena::clear(). This replaces several
+ * heap allocations per item by a few allocations per tile of items.
+ *
+ * Stored strings are terminated by a zero byte. Chunks never move, so views
+ * returned by #StringArena::store() remain valid until the arena is cleared
+ * or destroyed, even if the arena object itself is moved.
+ *
+ * \remark
+ *     This class is not thread-safe. Only one thread may store strings at a
+ *     time, but any thread may read strings that have been stored already.
+ */
+class StringArena
+{
+  public:
+    static constexpr size_t MINIMUM_CHUNK_SIZE = 1024;
+    static constexpr size_t MAXIMUM_CHUNK_SIZE = 64 * 1024;
+
+  private:
+    struct Chunk
+    {
+        std::unique_ptr<char[]> data_;
+        size_t size_;
+    };
+
+    std::vector<Chunk> chunks_;
+    size_t used_in_last_chunk_;
+    size_t heap_size_;
+
+  public:
+    StringArena(const StringArena &) = delete;
+    StringArena &operator=(const StringArena &) = delete;
+
+    StringArena(StringArena &&src):
+        chunks_(std::move(src.chunks_)),
+        used_in_last_chunk_(src.used_in_last_chunk_),
+        heap_size_(src.heap_size_)
+    {
+        src.forget();
+    }
+
+    StringArena &operator=(StringArena &&src)
+    {
+        chunks_ = std::move(src.chunks_);
+        used_in_last_chunk_ = src.used_in_last_chunk_;
+        heap_size_ = src.heap_size_;
+        src.forget();
+        return *this;
+    }
+
+    explicit StringArena():
+        used_in_last_chunk_(0),
+        heap_size_(0)
+    {}
+
+    /*!
+     * Copy string into the arena.
+     *
+     * \returns
+     *     View of the copy. The byte following the view is a zero byte.
+     */
+    std::string_view store(std::string_view str)
+    {
+        const size_t length = str.length();
+
+        if(chunks_.empty() ||
+           chunks_.back().size_ - used_in_last_chunk_ < length + 1)
+            add_chunk(length + 1);
+
+        char *const dest = chunks_.back().data_.get() + used_in_last_chunk_;
+        std::memcpy(dest, str.data(), length);
+        dest[length] = '\0';
+        used_in_last_chunk_ += length + 1;
+
+        return std::string_view(dest, length);
+    }
+
+    /*!
+     * Release all strings at once.
+     *
+     * The largest chunk is kept for reuse so that an arena which is filled
+     * with similar amounts of data again and again does not allocate memory
+     * after the first round.
+     */
+    void clear()
+    {
+        if(chunks_.size() > 1)
+        {
+            /* chunks for long strings may be larger than later chunks */
+            auto it = std::max_element(chunks_.begin(), chunks_.end(),
+                                       [] (const Chunk &a, const Chunk &b)
+                                       { return a.size_ < b.size_; });
+            Chunk largest(std::move(*it));
+            chunks_.clear();
+            heap_size_ = largest.size_;
+            chunks_.emplace_back(std::move(largest));
+        }
+
+        used_in_last_chunk_ = 0;
+    }
+
+    bool empty() const
+    {
+        return chunks_.size() <= 1 && used_in_last_chunk_ == 0;
+    }
+
+    /*!
+     * Number of bytes allocated on the heap, including unused space.
+     */
+    size_t get_heap_size() const
+    {
+        return heap_size_ + chunks_.capacity() * sizeof(Chunk);
+    }
+
+  private:
+    void add_chunk(size_t minimum_size)
+    {
+        size_t size = chunks_.empty()
+            ? MINIMUM_CHUNK_SIZE
+            : std::min(2 * chunks_.back().size_, MAXIMUM_CHUNK_SIZE);
+
+        if(size < minimum_size)
+            size = minimum_size;
+
+        chunks_.push_back({std::unique_ptr<char[]>(new char[size]), size});
+        used_in_last_chunk_ = 0;
+        heap_size_ += size;
+    }
+
+    void forget()
+    {
+        chunks_.clear();
+        used_in_last_chunk_ = 0;
+        heap_size_ = 0;
+    }
+};
+
+#endif /* !STRING_ARENA_HH */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2017, 2019--2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2017, 2019--2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -27,15 +27,17 @@
 
 #include "dbus_upnp_list_filler.hh"
 #include "dbus_upnp_list_filler_helpers.hh"
+#include "dbus_upnp_snapshot.hh"
 #include "upnp_listtree.hh"
 #include "main.hh"
 #include "gerrorwrapper.hh"
 
 static UPnP::DBusUPnPFiller standard_dbus_filler;
 
-void UPnP::init_standard_dbus_fillers(const LRU::Cache &cache)
+void UPnP::init_standard_dbus_fillers(const LRU::Cache &cache,
+                                      BrowseCacheSnapshot *snapshot)
 {
-    standard_dbus_filler.init(cache);
+    standard_dbus_filler.init(cache, snapshot);
 }
 
 namespace UPnP
@@ -47,7 +49,8 @@ namespace UPnP
     }
 }
 
-static ListError fill_list_item_from_upnp_data(UPnP::ItemData &&list_item,
+static ListError fill_list_item_from_upnp_data(UPnP::ItemData &list_item,
+                                               StringArena &strings,
                                                GVariant *child_data)
 {
     GVariantIter iter;
@@ -85,11 +88,8 @@ static ListError fill_list_item_from_upnp_data(UPnP::ItemData &&list_item,
     {
         msg_vinfo(MESSAGE_LEVEL_DIAG,
                   "D-Bus subpath for \"%s\" is \"%s\"", display_name, path);
-        list_item = UPnP::ItemData(path, display_name,
-                                   album_art_url != nullptr
-                                   ? Url::String(Url::Sensitivity::GENERIC,
-                                                 album_art_url)
-                                   : Url::String(Url::Sensitivity::GENERIC),
+        list_item = UPnP::ItemData(strings, path, display_name,
+                                   album_art_url != nullptr ? album_art_url : "",
                                    is_container);
         return ListError();
     }
@@ -177,23 +177,15 @@ static ListError io_error_to_list_error(const GErrorWrapper &gerror)
     return ListError(ListError::PROTOCOL);
 }
 
-ssize_t UPnP::DBusUPnPFiller::fill(ItemProvider<UPnP::ItemData> &item_provider,
-                                   ID::List list_id, ID::Item idx,
-                                   size_t count, ListError &error,
-                                   const std::function<bool()> &may_continue) const
+ssize_t UPnP::list_children(const std::string &path, bool with_album_art,
+                            bool sorted, ID::Item idx, size_t count,
+                            const NextItemFn &next_item,
+                            ListError &error, size_t *payload_size)
 {
     error = ListError::OK;
 
-    msg_log_assert(cache_ != nullptr);
-
-    /*!
-     * \bug There should be a hot D-Bus proxy object for the most recently
-     *     accessed D-Bus object for a speed-up.
-     */
-    const auto media_list(std::static_pointer_cast<const UPnP::MediaList>(cache_->lookup(list_id)));
-
     tdbusupnpMediaContainer2 *proxy =
-        create_media_container_proxy_for_object_path(media_list->get_dbus_object_path().c_str());
+        create_media_container_proxy_for_object_path(path.c_str());
 
     if(proxy == nullptr)
     {
@@ -221,19 +213,13 @@ ssize_t UPnP::DBusUPnPFiller::fill(ItemProvider<UPnP::ItemData> &item_provider,
         NULL
     };
 
-    const auto *server =
-        static_cast<const ListTree &>(LBApp::get_list_tree_data_singleton().get_list_tree()).get_server_item(*media_list);
-
-    static constexpr ServerQuirks quirks(ServerQuirks::album_art_url_not_usable);
     const char *const *filter =
-        (server != nullptr && server->get_specific_data().has_quirks(quirks))
-        ? filter_without_album_art
-        : filter_with_album_art;
+        with_album_art ? filter_with_album_art : filter_without_album_art;
 
     ssize_t retval;
 
     GErrorWrapper gerror;
-    const gboolean success = request_alphabetically_sorted_
+    const gboolean success = sorted
         ? tdbus_upnp_media_container2_call_list_children_ex_sync(proxy,
                                                                  idx.get_raw_id(),
                                                                  count, filter,
@@ -248,6 +234,9 @@ ssize_t UPnP::DBusUPnPFiller::fill(ItemProvider<UPnP::ItemData> &item_provider,
 
     if(success)
     {
+        if(payload_size != nullptr)
+            *payload_size = g_variant_get_size(children);
+
         gsize num_of_children = g_variant_n_children(children);
 
         if(num_of_children > count)
@@ -266,8 +255,9 @@ ssize_t UPnP::DBusUPnPFiller::fill(ItemProvider<UPnP::ItemData> &item_provider,
             GVariant *child_data = g_variant_get_child_value(children, retval);
             msg_log_assert(child_data != nullptr);
 
-            UPnP::ItemData *item = item_provider.next();
-            error = fill_list_item_from_upnp_data(std::move(*item), child_data);
+            StringArena *strings;
+            UPnP::ItemData *item = next_item(strings);
+            error = fill_list_item_from_upnp_data(*item, *strings, child_data);
 
             g_variant_unref(child_data);
         }
@@ -277,7 +267,7 @@ ssize_t UPnP::DBusUPnPFiller::fill(ItemProvider<UPnP::ItemData> &item_provider,
     else
     {
         msg_error(0, LOG_ERR, "List children failed");
-        gerror.log_failure(request_alphabetically_sorted_
+        gerror.log_failure(sorted
                            ? "Get list of UPnP children (sorted)"
                            : "Get list of UPnP children (unsorted)");
         retval = -1;
@@ -288,3 +278,61 @@ ssize_t UPnP::DBusUPnPFiller::fill(ItemProvider<UPnP::ItemData> &item_provider,
 
     return retval;
 }
+
+ssize_t UPnP::DBusUPnPFiller::fill(ItemProvider<UPnP::ItemData> &item_provider,
+                                   ID::List list_id, ID::Item idx,
+                                   size_t count, ListError &error,
+                                   const std::function<bool()> &may_continue) const
+{
+    error = ListError::OK;
+
+    msg_log_assert(cache_ != nullptr);
+
+    /*!
+     * \bug There should be a hot D-Bus proxy object for the most recently
+     *     accessed D-Bus object for a speed-up.
+     */
+    const auto media_list(std::static_pointer_cast<UPnP::MediaList>(cache_->lookup(list_id)));
+
+    const auto *server =
+        static_cast<const ListTree &>(LBApp::get_list_tree_data_singleton().get_list_tree()).get_server_item(*media_list);
+
+    static constexpr ServerQuirks quirks(ServerQuirks::album_art_url_not_usable);
+    const bool with_album_art =
+        server == nullptr || !server->get_specific_data().has_quirks(quirks);
+
+    const UPnP::NextItemFn next_item(
+        [&item_provider] (StringArena *&strings)
+        {
+            return item_provider.next(strings);
+        });
+
+    if(snapshot_ != nullptr && server != nullptr)
+    {
+        const ssize_t served =
+            snapshot_->serve(*media_list, server->get_specific_data(),
+                             idx, count, with_album_art, next_item);
+
+        if(served >= 0)
+            return served;
+    }
+
+    size_t payload_size = 0;
+    const auto start = LRU::timebase->now();
+    const ssize_t result =
+        list_children(media_list->get_dbus_object_path(), with_album_art,
+                      request_alphabetically_sorted_, idx, count,
+                      next_item, error, &payload_size);
+
+    auto *advisor = server != nullptr
+        ? server->get_specific_data().get_tile_size_advisor()
+        : nullptr;
+
+    if(result >= 0 && advisor != nullptr)
+        media_list->request_tile_size(
+            advisor->add_sample(count, result, payload_size,
+                                std::chrono::duration_cast<std::chrono::microseconds>(
+                                    LRU::timebase->now() - start)));
+
+    return result;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2016, 2019, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2016, 2019, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -28,6 +28,41 @@
 namespace UPnP
 {
 
+class BrowseCacheSnapshot;
+
+/*!
+ * Read children of a UPnP container from dLeyna.
+ *
+ * \param path
+ *     D-Bus object path of the container.
+ *
+ * \param with_album_art
+ *     Whether or not to request album art URLs.
+ *
+ * \param sorted
+ *     Request children sorted by their display names.
+ *
+ * \param idx, count
+ *     Range of children to read.
+ *
+ * \param next_item
+ *     Returns the item to be filled in for the next child.
+ *
+ * \param error
+ *     Error code in case of failure.
+ *
+ * \param payload_size
+ *     If not \c nullptr, the size of the answer received from dLeyna in bytes
+ *     is returned here.
+ *
+ * \returns
+ *     Number of children read, or -1 on error.
+ */
+ssize_t list_children(const std::string &path, bool with_album_art,
+                      bool sorted, ID::Item idx, size_t count,
+                      const NextItemFn &next_item,
+                      ListError &error, size_t *payload_size = nullptr);
+
 /*!
  * Fill list items from UPnP sources using dLeyna over D-Bus.
  */
@@ -35,6 +70,7 @@ class DBusUPnPFiller: public TiledListFillerIface<ItemData>
 {
   private:
     const LRU::Cache *cache_;
+    BrowseCacheSnapshot *snapshot_;
     bool request_alphabetically_sorted_;
 
   public:
@@ -43,17 +79,26 @@ class DBusUPnPFiller: public TiledListFillerIface<ItemData>
 
     explicit DBusUPnPFiller():
         cache_(nullptr),
+        snapshot_(nullptr),
         request_alphabetically_sorted_(false)
     {}
 
     /*!
      * Init object at runtime after static initialization.
      *
+     * \param cache
+     *     The cache containing the lists to be filled.
+     *
+     * \param snapshot
+     *     Contents restored from this snapshot are used in favor of dLeyna,
+     *     if possible. May be \c nullptr.
+     *
      * \todo This is annoying. Static initialization should be possible.
      */
-    void init(const LRU::Cache &cache)
+    void init(const LRU::Cache &cache, BrowseCacheSnapshot *snapshot)
     {
         cache_ = &cache;
+        snapshot_ = snapshot;
     }
 
     ssize_t fill(ItemProvider<UPnP::ItemData> &item_provider, ID::List list_id,
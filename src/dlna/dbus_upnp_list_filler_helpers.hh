@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2019, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2019, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -31,7 +31,10 @@ namespace UPnP
 template <typename T>
 const TiledListFillerIface<T> &get_tiled_list_filler_for_root_directory();
 
-void init_standard_dbus_fillers(const LRU::Cache &cache);
+class BrowseCacheSnapshot;
+
+void init_standard_dbus_fillers(const LRU::Cache &cache,
+                                BrowseCacheSnapshot *snapshot);
 
 }
 
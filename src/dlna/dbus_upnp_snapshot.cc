@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <map>
+#include <ctime>
+
+#include "dbus_upnp_snapshot.hh"
+#include "dbus_upnp_list_filler.hh"
+#include "messages.h"
+
+/*!
+ * Containers captured longer ago are not carried over to the next snapshot.
+ */
+static constexpr uint64_t maximum_age_seconds = 30UL * 24UL * 60UL * 60UL;
+
+UPnP::BrowseCacheSnapshot::BrowseCacheSnapshot(std::string &&filename):
+    filename_(std::move(filename)),
+    shutdown_request_(true)
+{
+    LoggedLock::configure(lock_, "BrowseCacheSnapshot::lock_",
+                          MESSAGE_LEVEL_DEBUG);
+    LoggedLock::configure(work_available_,
+                          "BrowseCacheSnapshot::work_available_-cv",
+                          MESSAGE_LEVEL_DEBUG);
+}
+
+void UPnP::BrowseCacheSnapshot::start(StaleListFn &&stale_list_fn)
+{
+    msg_log_assert(!thread_.joinable());
+
+    stale_list_fn_ = std::move(stale_list_fn);
+    snapshot_.open(filename_);
+
+    shutdown_request_ = false;
+    thread_ = std::thread(&BrowseCacheSnapshot::worker, this);
+}
+
+void UPnP::BrowseCacheSnapshot::shutdown()
+{
+    if(!thread_.joinable())
+        return;
+
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+        shutdown_request_ = true;
+        revalidations_.clear();
+        work_available_.notify_all();
+    }
+
+    thread_.join();
+}
+
+/*!
+ * Get path relative to the D-Bus path of its server.
+ */
+static bool strip_server_path(const std::string &path,
+                              const std::string &server_path,
+                              std::string &relative_path)
+{
+    if(path.compare(0, server_path.length(), server_path) != 0 ||
+       (path.length() > server_path.length() && path[server_path.length()] != '/'))
+        return false;
+
+    relative_path = path.substr(server_path.length());
+
+    return true;
+}
+
+ssize_t UPnP::BrowseCacheSnapshot::serve(const MediaList &list,
+                                         const ServerItemData &server,
+                                         ID::Item first, size_t count,
+                                         bool with_album_art,
+                                         const NextItemFn &next_item)
+{
+    if(!snapshot_.is_open())
+        return -1;
+
+    const char *udn = server.get_udn();
+
+    if(udn == nullptr || udn[0] == '\0')
+        return -1;
+
+    Revalidation r
+    {
+        list.get_cache_id(), udn, server.get_dbus_path_copy(), std::string(),
+        list.size(), first, count, with_album_art,
+    };
+
+    if(!strip_server_path(list.get_dbus_object_path(), r.server_path_,
+                          r.container_path_))
+        return -1;
+
+    const ssize_t served =
+        snapshot_.lookup_items(r.server_udn_, r.container_path_,
+                               r.number_of_children_, first.get_raw_id(), count,
+            [&next_item, &r] (uint32_t, const SnapshotItem &item)
+            {
+                StringArena *strings;
+                ItemData *dest = next_item(strings);
+                *dest = ItemData(*strings, r.server_path_ + item.path_,
+                                 item.name_, item.album_art_url_,
+                                 item.is_container_);
+            });
+
+    if(served < 0)
+        return -1;
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG,
+              "Served %zd items of %s at %u from browse snapshot",
+              served, r.container_path_.c_str(), first.get_raw_id());
+
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    if(shutdown_request_)
+        return served;
+
+    for(const auto &pending : revalidations_)
+        if(pending.list_id_ == r.list_id_ && pending.first_ == r.first_)
+            return served;
+
+    /* items which are not revalidated now are revalidated next time they are
+     * served from the snapshot */
+    if(revalidations_.size() < MAXIMUM_NUMBER_OF_REVALIDATIONS)
+    {
+        revalidations_.emplace_back(std::move(r));
+        work_available_.notify_one();
+    }
+
+    return served;
+}
+
+void UPnP::BrowseCacheSnapshot::worker()
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    LoggedLock::UniqueLock<LoggedLock::Mutex> lock(lock_);
+
+    while(1)
+    {
+        work_available_.wait(lock,
+            [this]()
+            {
+                return shutdown_request_ || !revalidations_.empty();
+            });
+
+        if(shutdown_request_)
+            break;
+
+        const Revalidation r(std::move(revalidations_.front()));
+        revalidations_.pop_front();
+
+        lock.unlock();
+        revalidate(r);
+
+        LOGGED_LOCK_CONTEXT_HINT;
+        lock.lock();
+    }
+}
+
+namespace
+{
+
+struct StaleListNotification
+{
+    const UPnP::BrowseCacheSnapshot::StaleListFn fn_;
+    const ID::List list_id_;
+    const std::string path_;
+};
+
+}
+
+static gboolean notify_stale_list(gpointer user_data)
+{
+    const auto *n = static_cast<const StaleListNotification *>(user_data);
+
+    if(n->fn_ != nullptr)
+        n->fn_(n->list_id_, n->path_);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void free_stale_list_notification(gpointer user_data)
+{
+    delete static_cast<StaleListNotification *>(user_data);
+}
+
+void UPnP::BrowseCacheSnapshot::revalidate(const Revalidation &r)
+{
+    std::vector<ItemData> live(r.count_);
+    StringArena live_strings;
+    size_t next = 0;
+    ListError error;
+
+    const ssize_t count =
+        list_children(r.server_path_ + r.container_path_, r.with_album_art_,
+                      false, r.first_, r.count_,
+                      [&live, &live_strings, &next] (StringArena *&strings)
+                      {
+                          strings = &live_strings;
+                          return &live[next++];
+                      },
+                      error);
+
+    if(count < 0)
+    {
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Failed revalidating browse snapshot of %s: %s",
+                  r.container_path_.c_str(), error.to_string());
+        return;
+    }
+
+    bool is_equal = true;
+    size_t idx = 0;
+    std::string name;
+
+    const ssize_t stored =
+        snapshot_.lookup_items(r.server_udn_, r.container_path_,
+                               r.number_of_children_, r.first_.get_raw_id(),
+                               r.count_,
+            [&live, &r, count, &is_equal, &idx, &name]
+            (uint32_t, const SnapshotItem &item)
+            {
+                if(!is_equal || idx >= size_t(count))
+                {
+                    is_equal = false;
+                    return;
+                }
+
+                const auto &l(live[idx++]);
+                l.get_name(name);
+
+                is_equal =
+                    l.get_dbus_path() == r.server_path_ + item.path_ &&
+                    name == item.name_ &&
+                    l.get_album_art_url_cleartext() == item.album_art_url_ &&
+                    l.get_kind().is_directory() == item.is_container_;
+            });
+
+    /* container may have been retired in the meantime */
+    if(stored < 0)
+        return;
+
+    if(is_equal && stored == count)
+    {
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Browse snapshot of %s at %u is up to date",
+                  r.container_path_.c_str(), r.first_.get_raw_id());
+        return;
+    }
+
+    if(!snapshot_.retire(r.server_udn_, r.container_path_))
+        return;
+
+    msg_info("Browse snapshot of %s is outdated, invalidating list %u",
+             r.container_path_.c_str(), r.list_id_.get_raw_id());
+
+    g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, notify_stale_list,
+                    new StaleListNotification{stale_list_fn_, r.list_id_,
+                                              r.server_path_ + r.container_path_},
+                    free_stale_list_notification);
+}
+
+namespace
+{
+
+struct CapturedItem
+{
+    uint32_t index_;
+    std::string path_;
+    std::string name_;
+    std::string album_art_url_;
+    bool is_container_;
+    ID::List child_list_;
+};
+
+struct CapturedList
+{
+    ID::List id_;
+    size_t number_of_children_;
+    std::vector<CapturedItem> items_;
+};
+
+struct Location
+{
+    std::string server_udn_;
+    std::string server_path_;
+    std::string path_;
+};
+
+}
+
+bool UPnP::BrowseCacheSnapshot::write(const LRU::Cache &cache)
+{
+    std::vector<CapturedList> lists;
+    std::map<ID::List, Location> locations;
+
+    /* the paths of the containers are not taken from the lists' parents
+     * because that would block on tiles which are being filled, so we
+     * collect data now and reconstruct the paths without holding the lock */
+    cache.for_each_entry(
+        [&lists, &locations] (const LRU::Entry &e)
+        {
+            if(const auto *servers = dynamic_cast<const ServerList *>(&e))
+            {
+                for(const auto &server : *servers)
+                {
+                    const auto &data(server.get_specific_data());
+                    const char *udn = data.get_udn();
+
+                    if(server.get_child_list().is_valid() &&
+                       udn != nullptr && udn[0] != '\0')
+                        locations.emplace(server.get_child_list(),
+                                          Location{udn, data.get_dbus_path_copy(),
+                                                   std::string()});
+                }
+
+                return;
+            }
+
+            const auto *list = dynamic_cast<const MediaList *>(&e);
+
+            if(list == nullptr)
+                return;
+
+            lists.push_back({list->get_cache_id(), list->size(), {}});
+            auto &items(lists.back().items_);
+
+            list->for_each_ready_item(
+                [&items] (uint32_t idx, const ListItem_<ItemData> &item)
+                {
+                    const auto &data(item.get_specific_data());
+                    std::string name;
+                    data.get_name(name);
+                    items.push_back({idx, data.get_dbus_path_copy(), std::move(name),
+                                     std::string(data.get_album_art_url_cleartext()),
+                                     data.get_kind().is_directory(),
+                                     item.get_child_list()});
+                });
+        });
+
+    BrowseSnapshotWriter writer;
+    const uint64_t now = time(nullptr);
+
+    /* lists are enumerated oldest first, and parents are always younger than
+     * their children, so we see all parents before their children when
+     * walking backwards */
+    for(auto it = lists.rbegin(); it != lists.rend(); ++it)
+    {
+        const auto loc = locations.find(it->id_);
+
+        /* path unknown if the parent's tile is not ready */
+        if(loc == locations.end())
+            continue;
+
+        const Location &where(loc->second);
+
+        writer.add_container(std::string(where.server_udn_),
+                             std::string(where.path_),
+                             it->number_of_children_, now);
+
+        for(auto &item : it->items_)
+        {
+            std::string relative_path;
+
+            if(!strip_server_path(item.path_, where.server_path_, relative_path))
+                continue;
+
+            if(item.child_list_.is_valid())
+                locations.emplace(item.child_list_,
+                                  Location{where.server_udn_, where.server_path_,
+                                           relative_path});
+
+            writer.add_item(item.index_, std::move(relative_path),
+                            std::move(item.name_), std::move(item.album_art_url_),
+                            item.is_container_);
+        }
+    }
+
+    const size_t cached = writer.get_number_of_containers();
+    const size_t kept =
+        snapshot_.carry_over(writer, now > maximum_age_seconds
+                                     ? now - maximum_age_seconds
+                                     : 0);
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG,
+              "Writing browse snapshot: %zu cached containers, "
+              "%zu containers kept from previous snapshot", cached, kept);
+
+    return writer.write(filename_);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef DBUS_UPNP_SNAPSHOT_HH
+#define DBUS_UPNP_SNAPSHOT_HH
+
+#include <deque>
+#include <thread>
+
+#include "upnp_snapshot.hh"
+#include "upnp_list.hh"
+#include "logged_lock.hh"
+
+namespace UPnP
+{
+
+/*!
+ * Warm-start snapshot of the UPnP browse cache.
+ *
+ * Contents of cached #UPnP::MediaList objects are written to a
+ * #UPnP::BrowseSnapshot file on shutdown and periodically. After a restart,
+ * the list filler serves tiles from the snapshot instead of asking dLeyna,
+ * provided the number of children of the container still matches. That
+ * number is read from dLeyna whenever a container is entered, so it is
+ * always fresh.
+ *
+ * Restored contents are stale-but-servable. Each range served from the
+ * snapshot is read again from dLeyna in a background thread and compared
+ * with the snapshot. On mismatch, the container is retired from the
+ * snapshot and the function passed to #UPnP::BrowseCacheSnapshot::start() is
+ * called from the main loop so that the list can be purged from the cache.
+ *
+ * Containers are keyed by the UDN of their server and by their D-Bus path
+ * relative to the server's D-Bus path because dLeyna numbers its servers in
+ * order of discovery.
+ */
+class BrowseCacheSnapshot
+{
+  public:
+    using StaleListFn = std::function<void(ID::List, const std::string &)>;
+
+  private:
+    struct Revalidation
+    {
+        ID::List list_id_;
+        std::string server_udn_;
+        std::string server_path_;
+        std::string container_path_;
+        size_t number_of_children_;
+        ID::Item first_;
+        size_t count_;
+        bool with_album_art_;
+    };
+
+    static constexpr size_t MAXIMUM_NUMBER_OF_REVALIDATIONS = 64;
+
+    const std::string filename_;
+    BrowseSnapshot snapshot_;
+    StaleListFn stale_list_fn_;
+
+    LoggedLock::Mutex lock_;
+    LoggedLock::ConditionVariable work_available_;
+    std::deque<Revalidation> revalidations_;
+    bool shutdown_request_;
+    std::thread thread_;
+
+  public:
+    BrowseCacheSnapshot(const BrowseCacheSnapshot &) = delete;
+    BrowseCacheSnapshot &operator=(const BrowseCacheSnapshot &) = delete;
+
+    explicit BrowseCacheSnapshot(std::string &&filename);
+
+    ~BrowseCacheSnapshot() { shutdown(); }
+
+    /*!
+     * Map snapshot file and start revalidation thread.
+     *
+     * \param stale_list_fn
+     *     Called from the main loop for lists found outdated.
+     */
+    void start(StaleListFn &&stale_list_fn);
+
+    /*!
+     * Stop revalidation thread.
+     */
+    void shutdown();
+
+    /*!
+     * Fill items from snapshot, queue revalidation.
+     *
+     * Called by the list filler in place of dLeyna.
+     *
+     * \returns
+     *     The number of items filled in, or -1 if the requested range is not
+     *     available from the snapshot.
+     */
+    ssize_t serve(const MediaList &list, const ServerItemData &server,
+                  ID::Item first, size_t count, bool with_album_art,
+                  const NextItemFn &next_item);
+
+    /*!
+     * Write cached contents to snapshot file.
+     *
+     * Only tiles which are ready are written. Containers from the previous
+     * snapshot which are not cached anymore are kept unless they have been
+     * retired or are too old.
+     *
+     * Must be called from the main thread.
+     */
+    bool write(const LRU::Cache &cache);
+
+  private:
+    void worker();
+    void revalidate(const Revalidation &r);
+};
+
+}
+
+#endif /* !DBUS_UPNP_SNAPSHOT_HH */
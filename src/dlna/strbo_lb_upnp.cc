@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2017, 2019, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2017, 2019, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
@@ -26,6 +26,7 @@
 
 #include "main.hh"
 #include "dbus_upnp_iface.hh"
+#include "dbus_upnp_snapshot.hh"
 #include "periodic_rescan.hh"
 #include "messages_glib.h"
 #include "versioninfo.h"
@@ -37,6 +38,7 @@ class UPnPListTreeData: public ListTreeData
 {
   public:
     std::unique_ptr<UPnP::ListTree> list_tree_;
+    std::unique_ptr<UPnP::BrowseCacheSnapshot> snapshot_;
 
     static DBusAsync::WorkQueue navlists_get_range_;
     static DBusAsync::WorkQueue navlists_get_list_id_;
@@ -56,6 +58,12 @@ class UPnPListTreeData: public ListTreeData
         navlists_get_list_id_.shutdown();
         navlists_get_uris_.shutdown();
         navlists_realize_location_.shutdown();
+
+        if(snapshot_ != nullptr)
+        {
+            snapshot_->shutdown();
+            snapshot_->write(*cache_);
+        }
     }
 };
 
@@ -111,6 +119,16 @@ void LBApp::log_version_info(void)
               VCS_TAG, VCS_TICK, VCS_DATE);
 }
 
+static LRU::EvictionPolicy eviction_policy = LRU::EvictionPolicy::LEAST_RECENTLY_USED;
+static std::string browse_snapshot_file;
+
+static gboolean write_browse_snapshot(gpointer user_data)
+{
+    auto &lt(*static_cast<UPnPListTreeData *>(user_data));
+    lt.snapshot_->write(*lt.cache_);
+    return G_SOURCE_CONTINUE;
+}
+
 static int create_list_tree_and_cache(UPnPListTreeData &lt, GMainLoop *loop)
 {
     static constexpr size_t default_maximum_size_mib = 20UL * 1024UL * 1024UL;
@@ -122,6 +140,8 @@ static int create_list_tree_and_cache(UPnPListTreeData &lt, GMainLoop *loop)
     if(lt.cache_ == nullptr)
         return msg_out_of_memory("LRU cache");
 
+    lt.cache_->set_eviction_policy(eviction_policy);
+
     lt.cache_control_ = std::make_unique<LRU::CacheControl>(*lt.cache_, loop);
     if(lt.cache_control_ == nullptr)
         return msg_out_of_memory("LRU cache control");
@@ -130,7 +150,15 @@ static int create_list_tree_and_cache(UPnPListTreeData &lt, GMainLoop *loop)
     if(cache_check == nullptr)
         return msg_out_of_memory("Cacheable check");
 
-    UPnP::init_standard_dbus_fillers(*lt.cache_);
+    if(!browse_snapshot_file.empty())
+    {
+        lt.snapshot_ =
+            std::make_unique<UPnP::BrowseCacheSnapshot>(std::move(browse_snapshot_file));
+        if(lt.snapshot_ == nullptr)
+            return msg_out_of_memory("UPnP browse snapshot");
+    }
+
+    UPnP::init_standard_dbus_fillers(*lt.cache_, lt.snapshot_.get());
 
     lt.list_tree_ =
         std::make_unique<UPnP::ListTree>(
@@ -148,6 +176,19 @@ static int create_list_tree_and_cache(UPnPListTreeData &lt, GMainLoop *loop)
                              [&lt] { lt.cache_control_->disable_garbage_collection(); });
     lt.list_tree_->init();
 
+    if(lt.snapshot_ != nullptr)
+    {
+        static constexpr guint write_interval_seconds = 10 * 60;
+
+        lt.snapshot_->start(
+            [&lt] (ID::List id, const std::string &path)
+            {
+                lt.list_tree_->purge_stale_list(id, path);
+            });
+        g_timeout_add_seconds(write_interval_seconds,
+                              write_browse_snapshot, &lt);
+    }
+
     return 0;
 }
 
@@ -161,6 +202,13 @@ static void usage(const char *program_name)
            "  --stderr       Write log messages to stderr, not syslog.\n"
            "  --verbose lvl  Set verbosity level to given level.\n"
            "  --quiet        Short for \"--verbose quite\".\n"
+           "  --eviction-policy {lru|gds}\n"
+           "                 Discard least recently used lists first (lru,\n"
+           "                 default) or weigh cost of refilling lists against\n"
+           "                 their size and recency (gds).\n"
+           "  --browse-snapshot file\n"
+           "                 Restore browse cache from given file on startup,\n"
+           "                 write it back periodically and on shutdown.\n"
            ;
 }
 
@@ -212,6 +260,26 @@ static int process_command_line(int argc, char *argv[],
         }
         else if(strcmp(argv[i], "--quiet") == 0)
             verbose_level = MESSAGE_LEVEL_QUIET;
+        else if(strcmp(argv[i], "--eviction-policy") == 0)
+        {
+            CHECK_ARGUMENT();
+
+            if(strcmp(argv[i], "lru") == 0)
+                eviction_policy = LRU::EvictionPolicy::LEAST_RECENTLY_USED;
+            else if(strcmp(argv[i], "gds") == 0)
+                eviction_policy = LRU::EvictionPolicy::GREEDY_DUAL_SIZE;
+            else
+            {
+                std::cerr << "Invalid eviction policy \"" << argv[i]
+                          << "\". Valid policies are lru and gds." << std::endl;
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--browse-snapshot") == 0)
+        {
+            CHECK_ARGUMENT();
+            browse_snapshot_file = argv[i];
+        }
         else
         {
             std::cerr << "Unknown option \"" << argv[i]
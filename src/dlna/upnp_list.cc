@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2017--2020, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2017--2020, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -42,10 +42,11 @@ gpointer (*UPnP::ServerItemData::object_ref)(gpointer) = g_object_ref;
 void (*UPnP::ServerItemData::object_unref)(gpointer) = g_object_unref;
 
 template<>
-ListThreads<UPnP::ItemData, UPnP::media_list_tile_size> &
-TiledList<UPnP::ItemData, UPnP::media_list_tile_size>::get_thread_pool()
+ListThreads<UPnP::ItemData, UPnP::media_list_maximum_tile_size> &
+TiledList<UPnP::ItemData, UPnP::media_list_maximum_tile_size,
+          UPnP::media_list_number_of_tiles>::get_thread_pool()
 {
-    static ListThreads<UPnP::ItemData, UPnP::media_list_tile_size> thread_pool(false);
+    static ListThreads<UPnP::ItemData, UPnP::media_list_maximum_tile_size> thread_pool(false);
     return thread_pool;
 }
 
@@ -55,6 +56,10 @@ void UPnP::ServerItemData::init(tdbusdleynaserverMediaDevice *dbus_proxy)
     object_ref(dbus_proxy_);
 
     server_quirks_ = ServerQuirks();
+    tile_size_advisor_ =
+        std::make_shared<TileSizeAdvisor>(media_list_tile_size,
+                                          media_list_minimum_tile_size,
+                                          media_list_maximum_tile_size);
 
     const gchar *temp = tdbus_dleynaserver_media_device_get_model_name(dbus_proxy_);
 
@@ -141,18 +146,12 @@ void UPnP::ServerList::enumerate_tree_of_sublists(const LRU::Cache &cache,
     }
 }
 
-void UPnP::ServerList::enumerate_direct_sublists(const LRU::Cache &cache,
-                                                 std::vector<ID::List> &nodes) const
-{
-    MSG_BUG("%s(): function shall not be called", __PRETTY_FUNCTION__);
-}
-
 void UPnP::ServerList::obliviate_child(ID::List child_id, const Entry *child)
 {
     ID::Item idx;
 
     if(lookup_item_id_by_child_id(child_id, idx))
-        (*this)[idx].obliviate_child();
+        unlink_child_list(idx);
     else if(!LRU::KilledLists::get_singleton().erase(child_id))
         MSG_BUG("Got obliviate notification for server root %u, "
                 "but could not find it in server list (ID %u)",
@@ -348,24 +347,12 @@ UPnP::ServerList::remove_from_list(const std::string &object_path,
     return RemoveFromListResult::REMOVED;
 }
 
-void UPnP::MediaList::enumerate_direct_sublists(const LRU::Cache &cache,
-                                                std::vector<ID::List> &nodes) const
-{
-    for(auto it = begin(); it != end(); ++it)
-    {
-        auto id = it->get_child_list();
-
-        if(id.is_valid())
-            nodes.push_back(id);
-    }
-}
-
 void UPnP::MediaList::obliviate_child(ID::List child_id, const Entry *child)
 {
     ID::Item idx;
 
     if(lookup_item_id_by_child_id(child_id, idx))
-        (*this)[idx].obliviate_child();
+        unlink_child_list(idx);
     else if(!LRU::KilledLists::get_singleton().erase(child_id))
         MSG_BUG("Got obliviate notification for child %u, "
                 "but could not find it in list with ID %u",
@@ -382,6 +369,18 @@ static inline std::string get_dbus_object_path(const UPnP::MediaList &list)
     return child_item->get_specific_data().get_dbus_path_copy();
 }
 
+void UPnP::request_tile_size_of_list(const LRU::Cache &cache, ID::List id,
+                                     uint16_t items_per_tile)
+{
+    if(!id.is_valid())
+        return;
+
+    const auto list = std::dynamic_pointer_cast<MediaList>(cache.lookup(id));
+
+    if(list != nullptr)
+        list->request_tile_size(items_per_tile);
+}
+
 std::string UPnP::MediaList::get_dbus_object_path() const
 {
     msg_log_assert(get_parent() != nullptr);
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -23,11 +23,14 @@
 #define UPNP_LIST_HH
 
 #include <string>
+#include <string_view>
+#include <memory>
 
 #include "lists.hh"
 #include "enterchild_template.hh"
 #include "dbus_upnp_helpers.hh"
 #include "dbus_upnp_list_filler_helpers.hh"
+#include "upnp_tile_size.hh"
 #include "servers_lost_and_found.hh"
 #include "urlstring.hh"
 #include "i18nstring.hh"
@@ -37,6 +40,9 @@ namespace UPnP
 
 static constexpr uint16_t server_list_tile_size = 4;
 static constexpr uint16_t media_list_tile_size = 8;
+static constexpr uint16_t media_list_minimum_tile_size = 4;
+static constexpr uint16_t media_list_maximum_tile_size = 16;
+static constexpr size_t media_list_number_of_tiles = 3;
 
 class ServerQuirks
 {
@@ -84,13 +90,19 @@ class ServerItemData
      */
     ServerQuirks server_quirks_;
 
+    /*!
+     * Tile size for lists on this server, adapted to the server's speed.
+     */
+    std::shared_ptr<TileSizeAdvisor> tile_size_advisor_;
+
   public:
     ServerItemData(const ServerItemData &src) = delete;
     ServerItemData &operator=(const ServerItemData &src) = delete;
 
     ServerItemData(ServerItemData &&src):
         dbus_proxy_(src.dbus_proxy_),
-        server_quirks_(std::move(src.server_quirks_))
+        server_quirks_(std::move(src.server_quirks_)),
+        tile_size_advisor_(std::move(src.tile_size_advisor_))
     {
         src.dbus_proxy_ = nullptr;
     }
@@ -104,6 +116,7 @@ class ServerItemData
         src.dbus_proxy_ = nullptr;
 
         server_quirks_ = std::move(src.server_quirks_);
+        tile_size_advisor_ = std::move(src.tile_size_advisor_);
 
         return *this;
     }
@@ -137,6 +150,19 @@ class ServerItemData
         return UPnP::get_proxy_object_path(dbus_proxy_);
     }
 
+    /*!
+     * Unique device name of the server.
+     *
+     * In contrast to the D-Bus path of the server, the UDN does not change
+     * when dLeyna is restarted.
+     */
+    const char *get_udn() const
+    {
+        return dbus_proxy_ != nullptr
+            ? tdbus_dleynaserver_media_device_get_udn(dbus_proxy_)
+            : nullptr;
+    }
+
     /*!\internal
      * For D-Bus/UPnP code only.
      */
@@ -163,6 +189,21 @@ class ServerItemData
         return server_quirks_.check(quirks);
     }
 
+    /*!
+     * Tile size advisor for this server, \c nullptr if not initialized.
+     */
+    TileSizeAdvisor *get_tile_size_advisor() const
+    {
+        return tile_size_advisor_.get();
+    }
+
+    // cppcheck-suppress functionStatic
+    size_t get_heap_size() const
+    {
+        /* the D-Bus proxy is managed by GLib */
+        return 0;
+    }
+
     /*!\internal
      * Enable mocking away \c g_object_ref().
      */
@@ -177,6 +218,9 @@ class ServerItemData
 /*!
  * Data about one UPnP container or media object exposed over D-Bus by dLeyna.
  *
+ * The strings are not owned by the object, but are views of strings stored
+ * in a #StringArena. This saves three heap allocations per item.
+ *
  * \note
  *     This structure is meant to be embedded in a #ListItem_ template class.
  */
@@ -189,17 +233,26 @@ class ItemData
     ItemData &operator=(const ItemData &) = delete;
 
     explicit ItemData():
-        album_art_url_(Url::Sensitivity::GENERIC),
         kind_(ListItemKind::OPAQUE)
     {}
 
-    explicit ItemData(std::string &&dbus_path,
-                      std::string &&display_name_utf8,
-                      Url::String &&album_art_url,
+    /*!
+     * Create item data with strings stored in given arena.
+     *
+     * The item must not outlive the contents of \p strings, which is usually
+     * the arena of the tile the item is stored in (see
+     * #ItemProvider::next(StringArena *&)).
+     */
+    explicit ItemData(StringArena &strings,
+                      std::string_view dbus_path,
+                      std::string_view display_name_utf8,
+                      std::string_view album_art_url,
                       bool is_container):
-        dbus_path_(dbus_path),
-        display_name_utf8_(display_name_utf8),
-        album_art_url_(album_art_url),
+        dbus_path_(strings.store(dbus_path)),
+        display_name_utf8_(strings.store(display_name_utf8)),
+        album_art_url_(album_art_url.empty()
+                       ? std::string_view()
+                       : strings.store(album_art_url)),
         kind_(is_container ? ListItemKind::DIRECTORY : ListItemKind::REGULAR_FILE)
     {}
 
@@ -207,17 +260,17 @@ class ItemData
     /*!
      * Name of this object on D-Bus.
      */
-    std::string dbus_path_;
+    std::string_view dbus_path_;
 
     /*!
      * Name of the object as to be represented to the user.
      */
-    std::string display_name_utf8_;
+    std::string_view display_name_utf8_;
 
     /*!
      * URL of album art, if any.
      */
-    Url::String album_art_url_;
+    std::string_view album_art_url_;
 
     /*! Item is either a container (directory) or an object (file/stream). */
     ListItemKind kind_;
@@ -225,9 +278,9 @@ class ItemData
   public:
     void reset()
     {
-        dbus_path_.clear();
-        display_name_utf8_.clear();
-        album_art_url_.clear();
+        dbus_path_ = std::string_view();
+        display_name_utf8_ = std::string_view();
+        album_art_url_ = std::string_view();
         kind_ = ListItemKind(ListItemKind::OPAQUE);
     }
 
@@ -241,22 +294,57 @@ class ItemData
         return kind_;
     }
 
-    const std::string &get_dbus_path() const
+    std::string_view get_dbus_path() const
     {
         return dbus_path_;
     }
 
     std::string get_dbus_path_copy() const
     {
-        return dbus_path_;
+        return std::string(dbus_path_);
+    }
+
+    Url::String get_album_art_url() const
+    {
+        return Url::String(Url::Sensitivity::GENERIC, std::string(album_art_url_));
     }
 
-    const Url::String &get_album_art_url() const
+    /*!
+     * Album art URL without copying it into a #Url::String.
+     *
+     * The view points into the string arena of the item. If not empty, it is
+     * terminated by a zero byte (see #StringArena::store()), so that its data
+     * may be passed on as C string.
+     */
+    std::string_view get_album_art_url_cleartext() const
     {
         return album_art_url_;
     }
+
+    /*!
+     * The strings are accounted for by the arena they are stored in.
+     */
+    // cppcheck-suppress functionStatic
+    size_t get_heap_size() const
+    {
+        return 0;
+    }
 };
 
+/*!
+ * Function which returns the next item to be filled in and the storage for
+ * its strings.
+ */
+using NextItemFn = std::function<ItemData *(StringArena *&strings)>;
+
+/*!
+ * Request tile size for cached #UPnP::MediaList with given ID, if any.
+ *
+ * The size is applied when the list is filled from scratch next time.
+ */
+void request_tile_size_of_list(const LRU::Cache &cache, ID::List id,
+                               uint16_t items_per_tile);
+
 /*!
  * List of media containers and items on a UPnP server.
  *
@@ -264,7 +352,8 @@ class ItemData
  * these lists. Since these lists may be huge and fetching their contents over
  * the network is usually (very) slow, we are using a tiled list.
  */
-class MediaList: public TiledList<ItemData, media_list_tile_size>
+class MediaList: public TiledList<ItemData, media_list_maximum_tile_size,
+                                 media_list_number_of_tiles>
 {
   public:
     enum class Type
@@ -280,13 +369,11 @@ class MediaList: public TiledList<ItemData, media_list_tile_size>
     explicit MediaList(std::shared_ptr<Entry> parent,
                        size_t number_of_entries,
                        const TiledListFillerIface<ItemData> &filler):
-        TiledList(parent, number_of_entries, filler)
+        TiledList(parent, number_of_entries, filler, media_list_tile_size)
     {}
 
     virtual ~MediaList() {}
 
-    void enumerate_direct_sublists(const LRU::Cache &cache,
-                                   std::vector<ID::List> &nodes) const override;
     void obliviate_child(ID::List child_id, const Entry *child) override;
 
     template <typename T>
@@ -302,17 +389,23 @@ class MediaList: public TiledList<ItemData, media_list_tile_size>
             this, cache, item, may_continue, use_cached, purge_list, error,
             [this, &cache, &cmr, &filler] (const ListItemType &child_entry)
             {
-                const std::string &name = child_entry.get_specific_data().get_dbus_path();
+                const std::string name(child_entry.get_specific_data().get_dbus_path_copy());
 
                 msg_vinfo(MESSAGE_LEVEL_DIAG,
                         "D-Bus path of new list is %s", name.c_str());
 
-                return add_child_list_to_cache<UPnP::MediaList, T>(
+                const auto fill_start = LRU::timebase->now();
+                const ID::List id =
+                    add_child_list_to_cache<UPnP::MediaList, T>(
                             cache, get_cache_id(), LRU::to_cache_mode(cmr),
                             get_cache_id().get_context(),
                             UPnP::get_size_of_container(name),
                             UPnP::MediaList::estimate_size_in_bytes(),
                             filler);
+                set_refill_cost_of_list(cache, id, fill_start);
+                request_tile_size_of_list(cache, id, get_requested_tile_size());
+
+                return id;
             });
     }
 
@@ -369,8 +462,6 @@ class ServerList: public FlatList<ServerItemData>
     void enumerate_tree_of_sublists(const LRU::Cache &cache,
                                     std::vector<ID::List> &nodes,
                                     bool append_to_nodes = false) const override;
-    void enumerate_direct_sublists(const LRU::Cache &cache,
-                                   std::vector<ID::List> &nodes) const override;
     void obliviate_child(ID::List child_id, const Entry *child) override;
 
     void add_to_list(const std::string &object_path,
@@ -393,13 +484,23 @@ class ServerList: public FlatList<ServerItemData>
             {
                 const std::string name(child_entry.get_specific_data().get_dbus_path_copy());
 
-                return
+                const auto fill_start = LRU::timebase->now();
+                const ID::List id =
                     add_child_list_to_cache<UPnP::MediaList, T>(
                             cache, get_cache_id(), LRU::to_cache_mode(cmr),
                             get_cache_id().get_context(),
                             UPnP::get_size_of_container(name),
                             UPnP::MediaList::estimate_size_in_bytes(),
                             filler);
+                set_refill_cost_of_list(cache, id, fill_start);
+
+                const auto *advisor =
+                    child_entry.get_specific_data().get_tile_size_advisor();
+
+                if(advisor != nullptr)
+                    request_tile_size_of_list(cache, id, advisor->get_tile_size());
+
+                return id;
             });
     }
 
@@ -432,7 +533,9 @@ struct ForEachItemTraits<const UPnP::MediaList>
 {
     using ListType = const UPnP::MediaList;
     using ItemType = UPnP::ItemData;
-    using ParentListType = const TiledList<ItemType, UPnP::media_list_tile_size>;
+    using ParentListType =
+        const TiledList<ItemType, UPnP::media_list_maximum_tile_size,
+                        UPnP::media_list_number_of_tiles>;
     using ParentTraits = ForEachItemTraits<ParentListType>;
     using IterType = ParentTraits::IterType;
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -118,6 +118,39 @@ void UPnP::ListTree::clear()
     remove_from_server_list(list);
 }
 
+void UPnP::ListTree::purge_stale_list(ID::List list_id,
+                                      const std::string &dbus_path)
+{
+    const auto list = std::dynamic_pointer_cast<const UPnP::MediaList>(
+                            lt_manager_.lookup_list<LRU::Entry>(list_id));
+
+    if(list == nullptr || list->get_dbus_object_path() != dbus_path)
+    {
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Stale list %u for %s is gone already",
+                  list_id.get_raw_id(), dbus_path.c_str());
+        return;
+    }
+
+    switch(lt_manager_.purge_subtree(list_id, ID::List(), nullptr))
+    {
+      case ListTreeManager::PurgeResult::UNTOUCHED:
+      case ListTreeManager::PurgeResult::PURGED:
+        break;
+
+      case ListTreeManager::PurgeResult::REPLACED_ROOT:
+      case ListTreeManager::PurgeResult::PURGED_AND_REPLACED:
+        MSG_UNREACHABLE();
+        break;
+
+      case ListTreeManager::PurgeResult::INVALID:
+        msg_error(0, LOG_NOTICE,
+                  "Purging stale subtree %u for %s failed",
+                  list_id.get_raw_id(), dbus_path.c_str());
+        break;
+    }
+}
+
 void UPnP::ListTree::dump_server_list()
 {
     auto all_servers = get_server_list();
@@ -343,7 +376,7 @@ ListError UPnP::ListTree::get_uris_for_item(ID::List list_id, ID::Item item_id,
     if(item.get_kind().is_directory())
         return ListError();
 
-    const auto &dbus_path(item.get_specific_data().get_dbus_path());
+    const std::string dbus_path(item.get_specific_data().get_dbus_path_copy());
 
     tdbusupnpMediaItem2 *proxy =
         create_media_item_proxy_for_object_path(dbus_path.c_str());
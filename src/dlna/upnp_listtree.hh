@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2022, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2022, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -111,6 +111,20 @@ class ListTree: public ListTreeIface
         lt_manager_.list_discarded_from_cache(id);
     }
 
+    /*!
+     * Purge list whose contents have been found outdated.
+     *
+     * Nothing happens if there is no list with given ID anymore, or if it
+     * refers to another UPnP container by now.
+     *
+     * \param list_id
+     *     ID of the #UPnP::MediaList to be purged along with its sublists.
+     *
+     * \param dbus_path
+     *     D-Bus object path of the container the list was filled from.
+     */
+    void purge_stale_list(ID::List list_id, const std::string &dbus_path);
+
     /*!
      * Dump list of all UPnP to log for debugging.
      */
@@ -0,0 +1,560 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "upnp_snapshot.hh"
+#include "messages.h"
+
+void UPnP::BrowseSnapshotWriter::add_item(uint32_t index, std::string &&path,
+                                          std::string &&name,
+                                          std::string &&album_art_url,
+                                          bool is_container)
+{
+    if(containers_.empty())
+    {
+        MSG_BUG("Cannot add item to snapshot without container");
+        return;
+    }
+
+    containers_.back().items_.push_back({index, std::move(path), std::move(name),
+                                         std::move(album_art_url),
+                                         is_container});
+}
+
+namespace
+{
+
+class StringPool
+{
+  private:
+    std::string pool_;
+    std::unordered_map<std::string, uint32_t> offsets_;
+
+  public:
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    explicit StringPool() {}
+
+    UPnP::SnapshotFormat::StringRef add(const std::string &s)
+    {
+        const auto it = offsets_.find(s);
+
+        if(it != offsets_.end())
+            return {it->second, uint32_t(s.length())};
+
+        const uint32_t offset = pool_.length();
+        pool_.append(s.c_str(), s.length() + 1);
+        offsets_.emplace(s, offset);
+
+        return {offset, uint32_t(s.length())};
+    }
+
+    const std::string &get() const { return pool_; }
+};
+
+}
+
+static bool write_all(int fd, const void *data, size_t size)
+{
+    const auto *p = static_cast<const uint8_t *>(data);
+
+    while(size > 0)
+    {
+        const ssize_t ret = ::write(fd, p, size);
+
+        if(ret < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        p += ret;
+        size -= ret;
+    }
+
+    return true;
+}
+
+bool UPnP::BrowseSnapshotWriter::write(const std::string &filename)
+{
+    std::stable_sort(containers_.begin(), containers_.end(),
+        [] (const Container &a, const Container &b)
+        {
+            return a.server_ < b.server_ ||
+                   (a.server_ == b.server_ && a.path_ < b.path_);
+        });
+
+    containers_.erase(
+        std::unique(containers_.begin(), containers_.end(),
+            [] (const Container &a, const Container &b)
+            {
+                return a.server_ == b.server_ && a.path_ == b.path_;
+            }),
+        containers_.end());
+
+    std::vector<SnapshotFormat::ContainerRecord> container_records;
+    std::vector<SnapshotFormat::ItemRecord> item_records;
+    StringPool strings;
+
+    container_records.reserve(containers_.size());
+
+    for(auto &c : containers_)
+    {
+        std::stable_sort(c.items_.begin(), c.items_.end(),
+                         [] (const Item &a, const Item &b) { return a.index_ < b.index_; });
+        c.items_.erase(
+            std::unique(c.items_.begin(), c.items_.end(),
+                        [] (const Item &a, const Item &b) { return a.index_ == b.index_; }),
+            c.items_.end());
+
+        SnapshotFormat::ContainerRecord cr {};
+        cr.server_ = strings.add(c.server_);
+        cr.path_ = strings.add(c.path_);
+        cr.captured_at_ = c.captured_at_;
+        cr.number_of_children_ = c.number_of_children_;
+        cr.first_item_ = item_records.size();
+        cr.number_of_items_ = c.items_.size();
+        container_records.push_back(cr);
+
+        for(const auto &it : c.items_)
+        {
+            SnapshotFormat::ItemRecord ir {};
+            ir.index_ = it.index_;
+            ir.flags_ = it.is_container_ ? SnapshotFormat::ITEM_FLAG_IS_CONTAINER : 0;
+            ir.path_ = strings.add(it.path_);
+            ir.name_ = strings.add(it.name_);
+            ir.album_art_url_ = strings.add(it.album_art_url_);
+            item_records.push_back(ir);
+        }
+    }
+
+    SnapshotFormat::FileHeader header {};
+    std::copy(std::begin(SnapshotFormat::MAGIC), std::end(SnapshotFormat::MAGIC),
+              header.magic_);
+    header.version_ = SnapshotFormat::VERSION;
+    header.number_of_containers_ = container_records.size();
+    header.number_of_items_ = item_records.size();
+    header.size_of_strings_ = strings.get().size();
+
+    const std::string temp_name(filename + ".tmp");
+    const int fd = ::open(temp_name.c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if(fd < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed creating browse snapshot %s",
+                  temp_name.c_str());
+        return false;
+    }
+
+    const bool ok =
+        write_all(fd, &header, sizeof(header)) &&
+        write_all(fd, container_records.data(),
+                  container_records.size() * sizeof(container_records[0])) &&
+        write_all(fd, item_records.data(),
+                  item_records.size() * sizeof(item_records[0])) &&
+        write_all(fd, strings.get().data(), strings.get().size()) &&
+        fsync(fd) == 0;
+
+    if(!ok)
+        msg_error(errno, LOG_ERR, "Failed writing browse snapshot %s",
+                  temp_name.c_str());
+
+    ::close(fd);
+
+    if(ok && rename(temp_name.c_str(), filename.c_str()) == 0)
+    {
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Wrote browse snapshot %s: %zu containers, %zu items",
+                  filename.c_str(), container_records.size(), item_records.size());
+        return true;
+    }
+
+    if(ok)
+        msg_error(errno, LOG_ERR, "Failed renaming browse snapshot %s",
+                  temp_name.c_str());
+
+    unlink(temp_name.c_str());
+
+    return false;
+}
+
+void UPnP::BrowseSnapshot::reject(const char *reason)
+{
+    msg_error(0, LOG_NOTICE, "Ignoring browse snapshot %s: %s",
+              filename_.c_str(), reason);
+    close();
+}
+
+bool UPnP::BrowseSnapshot::open(const std::string &filename)
+{
+    close();
+
+    filename_ = filename;
+
+    const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+    {
+        if(errno == ENOENT)
+            msg_vinfo(MESSAGE_LEVEL_DIAG,
+                      "No browse snapshot %s", filename.c_str());
+        else
+            msg_error(errno, LOG_ERR, "Failed opening browse snapshot %s",
+                      filename.c_str());
+
+        return false;
+    }
+
+    struct stat st;
+
+    if(fstat(fd, &st) < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed to stat browse snapshot %s",
+                  filename.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    if(size_t(st.st_size) < sizeof(SnapshotFormat::FileHeader))
+    {
+        ::close(fd);
+        reject("file too short");
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if(mapped == MAP_FAILED)
+    {
+        msg_error(errno, LOG_ERR, "Failed mapping browse snapshot %s",
+                  filename.c_str());
+        return false;
+    }
+
+    mapped_ = static_cast<const uint8_t *>(mapped);
+    mapped_size_ = st.st_size;
+
+    const auto *header = reinterpret_cast<const SnapshotFormat::FileHeader *>(mapped_);
+
+    if(memcmp(header->magic_, SnapshotFormat::MAGIC, sizeof(header->magic_)) != 0)
+    {
+        reject("bad magic");
+        return false;
+    }
+
+    if(header->version_ != SnapshotFormat::VERSION)
+    {
+        reject("unsupported version");
+        return false;
+    }
+
+    const uint64_t expected_size =
+        sizeof(SnapshotFormat::FileHeader) +
+        uint64_t(header->number_of_containers_) * sizeof(SnapshotFormat::ContainerRecord) +
+        uint64_t(header->number_of_items_) * sizeof(SnapshotFormat::ItemRecord) +
+        header->size_of_strings_;
+
+    if(expected_size != mapped_size_)
+    {
+        reject("size mismatch");
+        return false;
+    }
+
+    number_of_containers_ = header->number_of_containers_;
+    number_of_items_ = header->number_of_items_;
+    size_of_strings_ = header->size_of_strings_;
+
+    containers_ = reinterpret_cast<const SnapshotFormat::ContainerRecord *>(header + 1);
+    items_ = reinterpret_cast<const SnapshotFormat::ItemRecord *>(containers_ + number_of_containers_);
+    strings_ = reinterpret_cast<const char *>(items_ + number_of_items_);
+
+    states_.assign(number_of_containers_, ContainerState::UNCHECKED);
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG,
+              "Opened browse snapshot %s: %u containers, %u items",
+              filename.c_str(), number_of_containers_, number_of_items_);
+
+    return true;
+}
+
+void UPnP::BrowseSnapshot::close()
+{
+    if(mapped_ != nullptr)
+        munmap(const_cast<uint8_t *>(mapped_), mapped_size_);
+
+    mapped_ = nullptr;
+    mapped_size_ = 0;
+    containers_ = nullptr;
+    items_ = nullptr;
+    strings_ = nullptr;
+    number_of_containers_ = 0;
+    number_of_items_ = 0;
+    size_of_strings_ = 0;
+    states_.clear();
+}
+
+bool UPnP::BrowseSnapshot::is_string_ref_valid(const SnapshotFormat::StringRef &ref) const
+{
+    return ref.offset_ < size_of_strings_ &&
+           ref.length_ < size_of_strings_ - ref.offset_ &&
+           strings_[ref.offset_ + ref.length_] == '\0';
+}
+
+int UPnP::BrowseSnapshot::compare_key(const SnapshotFormat::ContainerRecord &c,
+                                      const std::string &server,
+                                      const std::string &path) const
+{
+    int result = server.compare(0, std::string::npos,
+                                get_string(c.server_), c.server_.length_);
+
+    if(result == 0)
+        result = path.compare(0, std::string::npos,
+                              get_string(c.path_), c.path_.length_);
+
+    return result;
+}
+
+bool UPnP::BrowseSnapshot::find_container(const std::string &server,
+                                          const std::string &path,
+                                          uint32_t &idx) const
+{
+    uint32_t lo = 0;
+    uint32_t hi = number_of_containers_;
+
+    while(lo < hi)
+    {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        const auto &c(containers_[mid]);
+
+        /* keys are checked before use, all other fields are checked on
+         * first access to the container */
+        if(!is_string_ref_valid(c.server_) || !is_string_ref_valid(c.path_))
+        {
+            states_[mid] = ContainerState::CORRUPT;
+            return false;
+        }
+
+        const int cmp = compare_key(c, server, path);
+
+        if(cmp == 0)
+        {
+            idx = mid;
+            return true;
+        }
+
+        if(cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return false;
+}
+
+bool UPnP::BrowseSnapshot::check_container(uint32_t idx) const
+{
+    switch(states_[idx])
+    {
+      case ContainerState::UNCHECKED:
+        break;
+
+      case ContainerState::VALID:
+        return true;
+
+      case ContainerState::CORRUPT:
+      case ContainerState::RETIRED:
+        return false;
+    }
+
+    const auto &c(containers_[idx]);
+    bool is_valid =
+        is_string_ref_valid(c.server_) && is_string_ref_valid(c.path_) &&
+        c.first_item_ <= number_of_items_ &&
+        c.number_of_items_ <= number_of_items_ - c.first_item_;
+
+    for(uint32_t i = 0; is_valid && i < c.number_of_items_; ++i)
+    {
+        const auto &it(items_[c.first_item_ + i]);
+
+        is_valid =
+            it.index_ < c.number_of_children_ &&
+            (i == 0 || it.index_ > items_[c.first_item_ + i - 1].index_) &&
+            is_string_ref_valid(it.path_) && is_string_ref_valid(it.name_) &&
+            is_string_ref_valid(it.album_art_url_);
+    }
+
+    if(is_valid)
+        states_[idx] = ContainerState::VALID;
+    else
+    {
+        states_[idx] = ContainerState::CORRUPT;
+        msg_error(0, LOG_NOTICE,
+                  "Browse snapshot %s: container %u is corrupt",
+                  filename_.c_str(), idx);
+    }
+
+    return is_valid;
+}
+
+bool UPnP::BrowseSnapshot::get_number_of_children(const std::string &server,
+                                                  const std::string &path,
+                                                  uint32_t &number_of_children) const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    uint32_t idx;
+
+    if(!find_container(server, path, idx) || !check_container(idx))
+        return false;
+
+    number_of_children = containers_[idx].number_of_children_;
+
+    return true;
+}
+
+ssize_t UPnP::BrowseSnapshot::lookup_items(
+        const std::string &server, const std::string &path,
+        size_t number_of_children, uint32_t first, size_t count,
+        const std::function<void(uint32_t, const SnapshotItem &)> &fn) const
+{
+    const SnapshotFormat::ItemRecord *begin;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        uint32_t idx;
+
+        if(!find_container(server, path, idx) || !check_container(idx))
+            return -1;
+
+        const auto &c(containers_[idx]);
+
+        if(c.number_of_children_ != number_of_children)
+        {
+            msg_vinfo(MESSAGE_LEVEL_DIAG,
+                      "Browse snapshot outdated for %s%s: "
+                      "%u children in snapshot, %zu now",
+                      server.c_str(), path.c_str(),
+                      c.number_of_children_, number_of_children);
+            states_[idx] = ContainerState::RETIRED;
+            return -1;
+        }
+
+        if(first >= number_of_children || count == 0)
+            return -1;
+
+        count = std::min(count, number_of_children - first);
+
+        const auto *const items_begin = items_ + c.first_item_;
+        const auto *const items_end = items_begin + c.number_of_items_;
+
+        begin = std::lower_bound(items_begin, items_end, first,
+                                 [] (const SnapshotFormat::ItemRecord &it, uint32_t i)
+                                 {
+                                     return it.index_ < i;
+                                 });
+
+        /* indices are strictly increasing, so the range is complete if and
+         * only if its last item has the expected index */
+        if(size_t(items_end - begin) < count ||
+           begin[count - 1].index_ != first + count - 1)
+            return -1;
+    }
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto &it(begin[i]);
+        const SnapshotItem item
+        {
+            get_string(it.path_), get_string(it.name_),
+            get_string(it.album_art_url_),
+            (it.flags_ & SnapshotFormat::ITEM_FLAG_IS_CONTAINER) != 0,
+        };
+
+        fn(it.index_, item);
+    }
+
+    return count;
+}
+
+bool UPnP::BrowseSnapshot::retire(const std::string &server,
+                                  const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    uint32_t idx;
+
+    if(!find_container(server, path, idx) ||
+       states_[idx] == ContainerState::RETIRED)
+        return false;
+
+    states_[idx] = ContainerState::RETIRED;
+
+    return true;
+}
+
+size_t UPnP::BrowseSnapshot::carry_over(BrowseSnapshotWriter &writer,
+                                        uint64_t not_before) const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    size_t result = 0;
+
+    for(uint32_t idx = 0; idx < number_of_containers_; ++idx)
+    {
+        const auto &c(containers_[idx]);
+
+        if(c.captured_at_ < not_before || !check_container(idx))
+            continue;
+
+        writer.add_container(get_string(c.server_), get_string(c.path_),
+                             c.number_of_children_, c.captured_at_);
+
+        for(uint32_t i = 0; i < c.number_of_items_; ++i)
+        {
+            const auto &it(items_[c.first_item_ + i]);
+            writer.add_item(it.index_, get_string(it.path_),
+                            get_string(it.name_), get_string(it.album_art_url_),
+                            (it.flags_ & SnapshotFormat::ITEM_FLAG_IS_CONTAINER) != 0);
+        }
+
+        ++result;
+    }
+
+    return result;
+}
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef UPNP_SNAPSHOT_HH
+#define UPNP_SNAPSHOT_HH
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cinttypes>
+#include <sys/types.h>
+
+namespace UPnP
+{
+
+/*!
+ * On-disk layout of a browse snapshot.
+ *
+ * A snapshot file consists of a #UPnP::SnapshotFormat::FileHeader, followed
+ * by a table of #UPnP::SnapshotFormat::ContainerRecord structures sorted by
+ * server and container path, followed by a table of
+ * #UPnP::SnapshotFormat::ItemRecord structures, followed by a pool of
+ * zero-terminated strings. The items of each container are stored
+ * contiguously, sorted by their index in the container.
+ *
+ * All numbers are stored in host byte order and all records are naturally
+ * aligned, so that the file can be used straight from a read-only memory
+ * mapping. Nothing needs to be parsed or copied before use.
+ */
+namespace SnapshotFormat
+{
+
+static constexpr char MAGIC[8] = { 'U', 'P', 'N', 'P', 'S', 'N', 'A', 'P' };
+static constexpr uint32_t VERSION = 1;
+
+struct StringRef
+{
+    uint32_t offset_;
+    uint32_t length_;
+};
+
+struct FileHeader
+{
+    char magic_[8];
+    uint32_t version_;
+    uint32_t number_of_containers_;
+    uint32_t number_of_items_;
+    uint32_t size_of_strings_;
+};
+
+struct ContainerRecord
+{
+    /*! Unique device name of the UPnP server. */
+    StringRef server_;
+
+    /*! Path of the container, relative to the server's D-Bus path. */
+    StringRef path_;
+
+    /*! Wall clock time the container was captured at, in seconds. */
+    uint64_t captured_at_;
+
+    uint32_t number_of_children_;
+    uint32_t first_item_;
+    uint32_t number_of_items_;
+    uint32_t reserved_;
+};
+
+static constexpr uint32_t ITEM_FLAG_IS_CONTAINER = 1U << 0;
+
+struct ItemRecord
+{
+    uint32_t index_;
+    uint32_t flags_;
+
+    /*! Path of the item, relative to the server's D-Bus path. */
+    StringRef path_;
+    StringRef name_;
+    StringRef album_art_url_;
+};
+
+static_assert(sizeof(FileHeader) == 24, "Unexpected header size");
+static_assert(sizeof(ContainerRecord) == 40, "Unexpected container record size");
+static_assert(sizeof(ItemRecord) == 32, "Unexpected item record size");
+
+}
+
+/*!
+ * A single item as restored from a browse snapshot.
+ *
+ * The strings point into the memory mapped snapshot file.
+ */
+struct SnapshotItem
+{
+    const char *path_;
+    const char *name_;
+    const char *album_art_url_;
+    bool is_container_;
+};
+
+/*!
+ * Collect UPnP container contents and write them to a snapshot file.
+ */
+class BrowseSnapshotWriter
+{
+  private:
+    struct Item
+    {
+        uint32_t index_;
+        std::string path_;
+        std::string name_;
+        std::string album_art_url_;
+        bool is_container_;
+    };
+
+    struct Container
+    {
+        std::string server_;
+        std::string path_;
+        uint64_t captured_at_;
+        uint32_t number_of_children_;
+        std::vector<Item> items_;
+    };
+
+    std::vector<Container> containers_;
+
+  public:
+    BrowseSnapshotWriter(const BrowseSnapshotWriter &) = delete;
+    BrowseSnapshotWriter &operator=(const BrowseSnapshotWriter &) = delete;
+
+    explicit BrowseSnapshotWriter() {}
+
+    /*!
+     * Start new container.
+     *
+     * In case the same container is added more than once, then only the
+     * first one is written to file.
+     */
+    void add_container(std::string &&server, std::string &&path,
+                       uint32_t number_of_children, uint64_t captured_at)
+    {
+        containers_.push_back({std::move(server), std::move(path),
+                               captured_at, number_of_children, {}});
+    }
+
+    /*!
+     * Add item to most recently added container.
+     */
+    void add_item(uint32_t index, std::string &&path, std::string &&name,
+                  std::string &&album_art_url, bool is_container);
+
+    size_t get_number_of_containers() const { return containers_.size(); }
+
+    /*!
+     * Write snapshot to file.
+     *
+     * The file is written under a temporary name, then renamed to \p filename
+     * so that readers never see a partially written snapshot.
+     */
+    bool write(const std::string &filename);
+};
+
+/*!
+ * Read-only access to a browse snapshot file.
+ *
+ * The file is mapped into memory on #UPnP::BrowseSnapshot::open(), but only
+ * its header is checked at that point. Containers are checked for
+ * consistency when they are accessed for the first time, so the pages of
+ * the file are only read from disk on demand.
+ *
+ * Contents restored from a snapshot are stale by definition. Containers
+ * found outdated may be retired, after which they are not served anymore.
+ *
+ * All functions except #UPnP::BrowseSnapshot::open() and
+ * #UPnP::BrowseSnapshot::close() are thread-safe.
+ */
+class BrowseSnapshot
+{
+  private:
+    enum class ContainerState : uint8_t
+    {
+        UNCHECKED,
+        VALID,
+        CORRUPT,
+        RETIRED,
+    };
+
+    mutable std::mutex lock_;
+
+    std::string filename_;
+    const uint8_t *mapped_;
+    size_t mapped_size_;
+
+    const SnapshotFormat::ContainerRecord *containers_;
+    const SnapshotFormat::ItemRecord *items_;
+    const char *strings_;
+    uint32_t number_of_containers_;
+    uint32_t number_of_items_;
+    uint32_t size_of_strings_;
+
+    mutable std::vector<ContainerState> states_;
+
+  public:
+    BrowseSnapshot(const BrowseSnapshot &) = delete;
+    BrowseSnapshot &operator=(const BrowseSnapshot &) = delete;
+
+    explicit BrowseSnapshot():
+        mapped_(nullptr),
+        mapped_size_(0),
+        containers_(nullptr),
+        items_(nullptr),
+        strings_(nullptr),
+        number_of_containers_(0),
+        number_of_items_(0),
+        size_of_strings_(0)
+    {}
+
+    ~BrowseSnapshot() { close(); }
+
+    /*!
+     * Map snapshot file into memory.
+     *
+     * \returns
+     *     True if the file exists and has a valid header, false otherwise. A
+     *     missing file is not considered an error.
+     */
+    bool open(const std::string &filename);
+
+    void close();
+
+    bool is_open() const { return mapped_ != nullptr; }
+
+    size_t get_number_of_containers() const { return number_of_containers_; }
+
+    /*!
+     * Look up number of children of a container at the time it was captured.
+     */
+    bool get_number_of_children(const std::string &server,
+                                const std::string &path,
+                                uint32_t &number_of_children) const;
+
+    /*!
+     * Pass items from a range in given container to a function.
+     *
+     * Items are only passed to \p fn if the whole requested range is
+     * available from the snapshot, so that callers never need to fill in
+     * gaps. The range is clipped to \p number_of_children.
+     *
+     * \param server, path
+     *     Key of the container.
+     *
+     * \param number_of_children
+     *     Current number of children of the container. A container whose
+     *     number of children differs from this number is outdated and gets
+     *     retired.
+     *
+     * \param first, count
+     *     Range of items to look up.
+     *
+     * \param fn
+     *     Called for each item in the range, in order.
+     *
+     * \returns
+     *     The number of items passed to \p fn, or -1 if the container or the
+     *     range is not available from the snapshot.
+     */
+    ssize_t lookup_items(const std::string &server, const std::string &path,
+                         size_t number_of_children, uint32_t first,
+                         size_t count,
+                         const std::function<void(uint32_t, const SnapshotItem &)> &fn) const;
+
+    /*!
+     * Do not serve given container anymore.
+     *
+     * \returns
+     *     True if the container was retired, false if it was not in the
+     *     snapshot or had been retired already.
+     */
+    bool retire(const std::string &server, const std::string &path);
+
+    /*!
+     * Copy containers which have not been retired to a writer.
+     *
+     * This is used for keeping containers which are not cached anymore in
+     * the next snapshot.
+     *
+     * \param writer
+     *     Containers are added to this writer.
+     *
+     * \param not_before
+     *     Containers captured before this time are dropped.
+     *
+     * \returns
+     *     The number of containers copied.
+     */
+    size_t carry_over(BrowseSnapshotWriter &writer, uint64_t not_before) const;
+
+  private:
+    bool find_container(const std::string &server, const std::string &path,
+                        uint32_t &idx) const;
+    bool check_container(uint32_t idx) const;
+    bool is_string_ref_valid(const SnapshotFormat::StringRef &ref) const;
+
+    const char *get_string(const SnapshotFormat::StringRef &ref) const
+    {
+        return strings_ + ref.offset_;
+    }
+
+    int compare_key(const SnapshotFormat::ContainerRecord &c,
+                    const std::string &server, const std::string &path) const;
+
+    void reject(const char *reason);
+};
+
+}
+
+#endif /* !UPNP_SNAPSHOT_HH */
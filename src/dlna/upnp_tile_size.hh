@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef UPNP_TILE_SIZE_HH
+#define UPNP_TILE_SIZE_HH
+
+#include <chrono>
+#include <algorithm>
+
+#include "logged_lock.hh"
+#include "messages.h"
+
+namespace UPnP
+{
+
+/*!
+ * Choose the number of items per list tile from measured round trips.
+ *
+ * There is one object of this class per UPnP server. The list filler reports
+ * duration and payload size of each request sent to the server, and the tile
+ * size for lists on that server is derived from these measurements.
+ *
+ * Fast servers get larger tiles so that fewer round trips are needed while
+ * scrolling through a list. Slow servers get smaller tiles so that the first
+ * items show up sooner. Tiles are kept small enough so that their payload
+ * does not exceed #UPnP::TileSizeAdvisor::MAXIMUM_PAYLOAD_PER_TILE.
+ *
+ * The tile size is doubled or halved, and it is changed only after a few
+ * consistent measurements to avoid oscillation.
+ *
+ * This class is thread-safe.
+ */
+class TileSizeAdvisor
+{
+  public:
+    /*!
+     * Round trips shorter than this are considered fast.
+     */
+    static constexpr std::chrono::milliseconds FAST_ROUND_TRIP =
+        std::chrono::milliseconds(50);
+
+    /*!
+     * Round trips longer than this are considered slow.
+     */
+    static constexpr std::chrono::milliseconds SLOW_ROUND_TRIP =
+        std::chrono::milliseconds(400);
+
+    /*!
+     * Maximum number of bytes per tile received from a server.
+     */
+    static constexpr size_t MAXIMUM_PAYLOAD_PER_TILE = 16 * 1024;
+
+    /*!
+     * Number of measurements required before changing the tile size again.
+     */
+    static constexpr unsigned int MINIMUM_NUMBER_OF_SAMPLES = 3;
+
+  private:
+    mutable LoggedLock::Mutex lock_;
+
+    const uint16_t minimum_tile_size_;
+    const uint16_t maximum_tile_size_;
+    uint16_t tile_size_;
+
+    /*!
+     * Moving average of round trip times, scaled to the current tile size.
+     */
+    std::chrono::microseconds average_round_trip_;
+
+    /*!
+     * Moving average of payload per item.
+     */
+    size_t average_bytes_per_item_;
+
+    unsigned int number_of_samples_;
+
+  public:
+    TileSizeAdvisor(const TileSizeAdvisor &) = delete;
+    TileSizeAdvisor &operator=(const TileSizeAdvisor &) = delete;
+
+    explicit TileSizeAdvisor(uint16_t initial_tile_size,
+                             uint16_t minimum_tile_size,
+                             uint16_t maximum_tile_size):
+        minimum_tile_size_(minimum_tile_size),
+        maximum_tile_size_(std::max(minimum_tile_size, maximum_tile_size)),
+        tile_size_(std::min(std::max(initial_tile_size, minimum_tile_size_),
+                            maximum_tile_size_)),
+        average_round_trip_(0),
+        average_bytes_per_item_(0),
+        number_of_samples_(0)
+    {
+        LoggedLock::configure(lock_, "TileSizeAdvisor", MESSAGE_LEVEL_DEBUG);
+    }
+
+    uint16_t get_tile_size() const
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+        return tile_size_;
+    }
+
+    /*!
+     * Take measurement of a single request into account.
+     *
+     * \param requested_items
+     *     Number of items requested from the server.
+     *
+     * \param received_items
+     *     Number of items received from the server.
+     *
+     * \param payload_bytes
+     *     Size of the server's answer in bytes.
+     *
+     * \param round_trip
+     *     How long the request took.
+     *
+     * \returns
+     *     The tile size to be used from now on.
+     */
+    uint16_t add_sample(size_t requested_items, size_t received_items,
+                        size_t payload_bytes,
+                        std::chrono::microseconds round_trip)
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        if(requested_items == 0)
+            return tile_size_;
+
+        const std::chrono::microseconds scaled_round_trip(
+            round_trip.count() * tile_size_ / requested_items);
+
+        if(number_of_samples_ == 0)
+            average_round_trip_ = scaled_round_trip;
+        else
+            average_round_trip_ = (3 * average_round_trip_ + scaled_round_trip) / 4;
+
+        if(received_items > 0)
+        {
+            const size_t bytes_per_item = payload_bytes / received_items;
+
+            if(average_bytes_per_item_ == 0)
+                average_bytes_per_item_ = bytes_per_item;
+            else
+                average_bytes_per_item_ = (3 * average_bytes_per_item_ + bytes_per_item) / 4;
+        }
+
+        if(++number_of_samples_ < MINIMUM_NUMBER_OF_SAMPLES)
+            return tile_size_;
+
+        const size_t largest_by_payload = average_bytes_per_item_ > 0
+            ? MAXIMUM_PAYLOAD_PER_TILE / average_bytes_per_item_
+            : maximum_tile_size_;
+
+        uint16_t new_tile_size = tile_size_;
+
+        if(tile_size_ > largest_by_payload)
+            new_tile_size = std::max(size_t(minimum_tile_size_), largest_by_payload);
+        else if(average_round_trip_ > SLOW_ROUND_TRIP)
+            new_tile_size = std::max(uint16_t(tile_size_ / 2), minimum_tile_size_);
+        else if(average_round_trip_ < FAST_ROUND_TRIP &&
+                size_t(tile_size_) * 2 <= largest_by_payload)
+            new_tile_size = std::min(uint16_t(tile_size_ * 2), maximum_tile_size_);
+
+        if(new_tile_size == tile_size_)
+            return tile_size_;
+
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Change tile size from %u to %u (round trip %lld us, "
+                  "%zu bytes per item)",
+                  tile_size_, new_tile_size,
+                  static_cast<long long>(average_round_trip_.count()),
+                  average_bytes_per_item_);
+
+        /* assume round trip time grows linearly with the number of items */
+        average_round_trip_ = average_round_trip_ * new_tile_size / tile_size_;
+        tile_size_ = new_tile_size;
+        number_of_samples_ = 0;
+
+        return tile_size_;
+    }
+};
+
+}
+
+#endif /* !UPNP_TILE_SIZE_HH */
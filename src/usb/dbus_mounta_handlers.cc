@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2021  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2021, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -46,6 +46,8 @@ void DBusMounTA::signal_handler(GDBusProxy *proxy, const gchar *sender_name,
 
         g_variant_get(parameters, "(q&s&s)", &device_id, &device_uuid, &rootpath);
 
+        data->usb_list_tree_.cancel_volume_crawler(device_id);
+
         auto dev_list = data->usb_list_tree_.get_list_of_usb_devices();
 
         ID::List removed_list_id;
@@ -94,13 +96,27 @@ void DBusMounTA::signal_handler(GDBusProxy *proxy, const gchar *sender_name,
 
             if(referenced_device->add_volume(number, label, mountpoint,
                                              added_at_index))
+            {
                 data->usb_list_tree_.reinsert_volume_list(device_id, number,
                                                           added_at_index);
+                data->usb_list_tree_.crawl_volume(device_id, number, mountpoint,
+                                                  uuid);
+            }
         }
     }
     else if(strcmp(signal_name, "DeviceWillBeRemoved") == 0)
     {
-        /* ignored */
+        /* stop reading from the device early, the rest is done when the
+         * device is gone */
+        if(g_variant_n_children(parameters) > 0)
+        {
+            GVariant *first = g_variant_get_child_value(parameters, 0);
+
+            if(g_variant_is_of_type(first, G_VARIANT_TYPE_UINT16))
+                data->usb_list_tree_.cancel_volume_crawler(g_variant_get_uint16(first));
+
+            g_variant_unref(first);
+        }
     }
     else
         dbus_common_unknown_signal(iface_name, signal_name, sender_name);
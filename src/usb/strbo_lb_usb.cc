@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2017, 2019, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2017, 2019, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  * Copyright (C) 2023  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
@@ -31,6 +31,8 @@
 #include "versioninfo.h"
 
 #include <cstring>
+#include <cstdlib>
+#include <limits>
 #include <iostream>
 
 class USBListTreeData: public ListTreeData
@@ -111,6 +113,11 @@ void LBApp::log_version_info(void)
               VCS_TAG, VCS_TICK, VCS_DATE);
 }
 
+static LRU::EvictionPolicy eviction_policy = LRU::EvictionPolicy::LEAST_RECENTLY_USED;
+static bool crawl_volumes = false;
+static std::string volume_index_path;
+static size_t volume_index_maximum_size_mib = 16;
+
 static int create_list_tree_and_cache(USBListTreeData &lt, GMainLoop *loop)
 {
     static constexpr size_t default_maximum_size_mib = 5UL * 1024UL * 1024UL;
@@ -122,6 +129,8 @@ static int create_list_tree_and_cache(USBListTreeData &lt, GMainLoop *loop)
     if(lt.cache_ == nullptr)
         return msg_out_of_memory("LRU cache");
 
+    lt.cache_->set_eviction_policy(eviction_policy);
+
     lt.cache_control_ = std::make_unique<LRU::CacheControl>(*lt.cache_, loop);
     if(lt.cache_control_ == nullptr)
         return msg_out_of_memory("LRU cache control");
@@ -146,7 +155,12 @@ static int create_list_tree_and_cache(USBListTreeData &lt, GMainLoop *loop)
                              [&lt] { lt.cache_control_->disable_garbage_collection(); });
     lt.list_tree_->init();
 
+    if(crawl_volumes || !volume_index_path.empty())
+        lt.list_tree_->enable_volume_crawler(std::move(volume_index_path),
+                                             volume_index_maximum_size_mib * 1024UL * 1024UL);
+
     USB::Helpers::init(*lt.list_tree_, *lt.cache_);
+    USB::init_dir_list_filler(*lt.cache_);
 
     return 0;
 }
@@ -161,6 +175,20 @@ static void usage(const char *program_name)
            "  --stderr       Write log messages to stderr, not syslog.\n"
            "  --verbose lvl  Set verbosity level to given level.\n"
            "  --quiet        Short for \"--verbose quite\".\n"
+           "  --eviction-policy {lru|gds}\n"
+           "                 Discard least recently used lists first (lru,\n"
+           "                 default) or weigh cost of refilling lists against\n"
+           "                 their size and recency (gds).\n"
+           "  --crawl-volumes\n"
+           "                 Read directory trees of new USB volumes in the\n"
+           "                 background so that browsing them is faster.\n"
+           "  --volume-index-dir path\n"
+           "                 Keep directory indexes of crawled volumes in given\n"
+           "                 directory so that volumes seen before need not be\n"
+           "                 read again. Implies --crawl-volumes.\n"
+           "  --volume-index-size MiB\n"
+           "                 Maximum total size of the directory indexes\n"
+           "                 (default: 16 MiB).\n"
            ;
 }
 
@@ -212,6 +240,46 @@ static int process_command_line(int argc, char *argv[],
         }
         else if(strcmp(argv[i], "--quiet") == 0)
             verbose_level = MESSAGE_LEVEL_QUIET;
+        else if(strcmp(argv[i], "--eviction-policy") == 0)
+        {
+            CHECK_ARGUMENT();
+
+            if(strcmp(argv[i], "lru") == 0)
+                eviction_policy = LRU::EvictionPolicy::LEAST_RECENTLY_USED;
+            else if(strcmp(argv[i], "gds") == 0)
+                eviction_policy = LRU::EvictionPolicy::GREEDY_DUAL_SIZE;
+            else
+            {
+                std::cerr << "Invalid eviction policy \"" << argv[i]
+                          << "\". Valid policies are lru and gds." << std::endl;
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--crawl-volumes") == 0)
+            crawl_volumes = true;
+        else if(strcmp(argv[i], "--volume-index-dir") == 0)
+        {
+            CHECK_ARGUMENT();
+            volume_index_path = argv[i];
+        }
+        else if(strcmp(argv[i], "--volume-index-size") == 0)
+        {
+            CHECK_ARGUMENT();
+
+            char *endptr;
+            const unsigned long size = strtoul(argv[i], &endptr, 10);
+
+            /* the size is passed on in bytes, which must fit into size_t */
+            if(*endptr != '\0' || size == 0 ||
+               size > std::numeric_limits<size_t>::max() / (1024UL * 1024UL))
+            {
+                std::cerr << "Invalid volume index size \"" << argv[i]
+                          << "\"." << std::endl;
+                return -1;
+            }
+
+            volume_index_maximum_size_mib = size;
+        }
         else
         {
             std::cerr << "Unknown option \"" << argv[i]
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+
+#include "usb_dir_index.hh"
+#include "os.h"
+
+namespace
+{
+
+class CollectNamesData
+{
+  public:
+    std::vector<char> &names_;
+    std::vector<uint32_t> directories_;
+    std::vector<uint32_t> files_;
+
+    CollectNamesData(const CollectNamesData &) = delete;
+    CollectNamesData &operator=(const CollectNamesData &) = delete;
+
+    explicit CollectNamesData(std::vector<char> &names):
+        names_(names)
+    {}
+
+    uint32_t add_name(const char *name)
+    {
+        const uint32_t offset = names_.size();
+        names_.insert(names_.end(), name, name + strlen(name) + 1);
+        return offset;
+    }
+};
+
+}
+
+static int collect_all_names(const char *path, unsigned char dtype,
+                             void *user_data)
+{
+    auto &data = *static_cast<CollectNamesData *>(user_data);
+
+    if(dtype == DT_DIR)
+        data.directories_.push_back(data.add_name(path));
+    else if(dtype == DT_REG)
+        data.files_.push_back(data.add_name(path));
+    else
+    {
+        /* just ignore anything else */
+    }
+
+    return 0;
+}
+
+bool USB::DirIndex::read_from_file_system(const std::string &path)
+{
+    names_.clear();
+    offsets_.clear();
+    number_of_directories_ = 0;
+
+    CollectNamesData directories_and_files(names_);
+
+    if(os_foreach_in_path(path.c_str(), collect_all_names, &directories_and_files) < 0)
+    {
+        names_.clear();
+        return false;
+    }
+
+    const char *const names = names_.data();
+    const auto by_name =
+        [names] (uint32_t a, uint32_t b)
+        {
+            return strcmp(names + a, names + b) < 0;
+        };
+
+    std::sort(directories_and_files.directories_.begin(),
+              directories_and_files.directories_.end(), by_name);
+
+    std::sort(directories_and_files.files_.begin(),
+              directories_and_files.files_.end(), by_name);
+
+    number_of_directories_ = directories_and_files.directories_.size();
+
+    offsets_ = std::move(directories_and_files.directories_);
+    offsets_.insert(offsets_.end(),
+                    directories_and_files.files_.begin(),
+                    directories_and_files.files_.end());
+
+    names_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+
+    return true;
+}
+
+void USB::DirIndex::assign(const char *names, size_t size_of_names,
+                           const uint32_t *offsets, size_t number_of_entries,
+                           size_t number_of_directories)
+{
+    names_.assign(names, names + size_of_names);
+    offsets_.assign(offsets, offsets + number_of_entries);
+    number_of_directories_ = number_of_directories;
+}
+
+USB::DirIndex USB::DirIndex::clone() const
+{
+    DirIndex result;
+
+    result.offsets_.reserve(offsets_.size());
+
+    for(const auto &offset : offsets_)
+    {
+        const char *name = &names_[offset];
+        result.offsets_.push_back(result.names_.size());
+        result.names_.insert(result.names_.end(), name, name + strlen(name) + 1);
+    }
+
+    result.number_of_directories_ = number_of_directories_;
+    result.names_.shrink_to_fit();
+
+    return result;
+}
+
+bool USB::DirIndex::find(const char *name, bool is_directory,
+                         size_t &pos) const
+{
+    const auto group_begin =
+        offsets_.begin() + (is_directory ? 0 : number_of_directories_);
+    const auto group_end =
+        is_directory ? offsets_.begin() + number_of_directories_ : offsets_.end();
+
+    const char *const names = names_.data();
+    const auto it =
+        std::lower_bound(group_begin, group_end, name,
+                         [names] (uint32_t offset, const char *n)
+                         {
+                             return strcmp(names + offset, n) < 0;
+                         });
+
+    pos = std::distance(offsets_.begin(), it);
+
+    return it != group_end && strcmp(names + *it, name) == 0;
+}
+
+bool USB::DirIndex::insert(const char *name, bool is_directory, size_t &pos)
+{
+    if(find(name, is_directory, pos))
+        return false;
+
+    const uint32_t offset = names_.size();
+    names_.insert(names_.end(), name, name + strlen(name) + 1);
+    offsets_.insert(offsets_.begin() + pos, offset);
+
+    if(is_directory)
+        ++number_of_directories_;
+
+    return true;
+}
+
+bool USB::DirIndex::remove(const char *name, bool is_directory, size_t &pos)
+{
+    if(!find(name, is_directory, pos))
+        return false;
+
+    offsets_.erase(offsets_.begin() + pos);
+
+    if(is_directory)
+        --number_of_directories_;
+
+    return true;
+}
+
+void USB::collect_differences(const DirIndex &old_index,
+                              const DirIndex &new_index,
+                              std::vector<DirChange> &changes)
+{
+    size_t i = 0;
+    size_t j = 0;
+
+    while(i < old_index.size() || j < new_index.size())
+    {
+        int cmp;
+
+        if(i >= old_index.size())
+            cmp = 1;
+        else if(j >= new_index.size())
+            cmp = -1;
+        else
+        {
+            const bool old_is_dir = old_index.get_kind(i).is_directory();
+            const bool new_is_dir = new_index.get_kind(j).is_directory();
+
+            if(old_is_dir != new_is_dir)
+                cmp = old_is_dir ? -1 : 1;
+            else
+                cmp = strcmp(old_index.get_name(i), new_index.get_name(j));
+        }
+
+        if(cmp < 0)
+        {
+            changes.push_back({old_index.get_name(i),
+                               old_index.get_kind(i).is_directory(), false});
+            ++i;
+        }
+        else if(cmp > 0)
+        {
+            changes.push_back({new_index.get_name(j),
+                               new_index.get_kind(j).is_directory(), true});
+            ++j;
+        }
+        else
+        {
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void USB::move_child_links(std::map<uint32_t, ID::List> &child_by_item,
+                           std::unordered_map<uint32_t, uint32_t> &item_by_child,
+                           uint32_t first, int delta)
+{
+    const auto from = child_by_item.lower_bound(first);
+    const std::vector<std::pair<uint32_t, ID::List>> moved(from, child_by_item.end());
+
+    child_by_item.erase(from, child_by_item.end());
+
+    for(const auto &link : moved)
+    {
+        const uint32_t idx = link.first + delta;
+        child_by_item.emplace(idx, link.second);
+        item_by_child[link.second.get_raw_id()] = idx;
+    }
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef USB_DIR_INDEX_HH
+#define USB_DIR_INDEX_HH
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+
+#include "idtypes.hh"
+#include "de_tahifi_lists_item_kinds.hh"
+
+namespace USB
+{
+
+/*!
+ * Compact, sorted index of the names in a directory.
+ *
+ * All names are stored back to back, zero-terminated, in a single buffer. The
+ * sort order is kept in an array of offsets into that buffer, directories
+ * first, then regular files, each group sorted by name. Since the groups are
+ * contiguous, the kind of an entry follows from its position and need not be
+ * stored per entry. Compared to a list of #ListItem_ objects, this takes a
+ * few bytes per entry on top of the names themselves.
+ *
+ * The index is filled in a single pass over the directory. An index which is
+ * in use by a #USB::DirList is never modified. Changes to the directory are
+ * applied to a copy made by #USB::DirIndex::clone(), and the copy replaces
+ * the original.
+ */
+class DirIndex
+{
+  private:
+    std::vector<char> names_;
+    std::vector<uint32_t> offsets_;
+    size_t number_of_directories_;
+
+  public:
+    DirIndex(const DirIndex &) = delete;
+    DirIndex &operator=(const DirIndex &) = delete;
+    DirIndex(DirIndex &&) = default;
+    DirIndex &operator=(DirIndex &&) = default;
+
+    explicit DirIndex():
+        number_of_directories_(0)
+    {}
+
+    /*!
+     * Read names of all directories and regular files in given directory.
+     *
+     * Anything else found in the directory is ignored.
+     *
+     * \returns
+     *     True on success, false if the directory could not be read. The
+     *     index is empty in the latter case.
+     */
+    bool read_from_file_system(const std::string &path);
+
+    /*!
+     * Fill index from names and offsets stored elsewhere.
+     *
+     * This is how indexes are restored from a #USB::VolumeIndexFile. The
+     * data are copied as they are, so they must have been taken from an
+     * index which has not been modified after reading it from the file
+     * system, and they must have been checked by the caller.
+     */
+    void assign(const char *names, size_t size_of_names,
+                const uint32_t *offsets, size_t number_of_entries,
+                size_t number_of_directories);
+
+    /*!
+     * Make a copy of this index, dropping names of removed entries.
+     */
+    DirIndex clone() const;
+
+    /*!
+     * Find entry by name and kind.
+     *
+     * \param name
+     *     Name of the entry to find.
+     *
+     * \param is_directory
+     *     Which group of entries to search in.
+     *
+     * \param[out] pos
+     *     Position of the entry if found, otherwise the position at which it
+     *     would have to be inserted to keep the index sorted.
+     *
+     * \returns
+     *     True if the entry was found, false if not.
+     */
+    bool find(const char *name, bool is_directory, size_t &pos) const;
+
+    /*!
+     * Find entry by name only.
+     *
+     * Directories are searched first, so that a directory is found if there
+     * is also a file of the same name, just as with a linear search over the
+     * whole index.
+     *
+     * \returns
+     *     True if the entry was found at position \p pos, false if not.
+     */
+    bool find_by_name(const char *name, size_t &pos) const
+    {
+        return find(name, true, pos) || find(name, false, pos);
+    }
+
+    /*!
+     * Insert entry at its sorted position.
+     *
+     * \returns
+     *     True if the entry has been inserted at position \p pos, false if it
+     *     is in the index already.
+     */
+    bool insert(const char *name, bool is_directory, size_t &pos);
+
+    /*!
+     * Remove entry.
+     *
+     * The name remains in the name buffer until the index is cloned.
+     *
+     * \returns
+     *     True if the entry has been removed from position \p pos, false if it
+     *     is not in the index.
+     */
+    bool remove(const char *name, bool is_directory, size_t &pos);
+
+    size_t size() const { return offsets_.size(); }
+
+    bool empty() const { return offsets_.empty(); }
+
+    const char *get_name(size_t idx) const
+    {
+        return &names_[offsets_[idx]];
+    }
+
+    ListItemKind get_kind(size_t idx) const
+    {
+        return ListItemKind(idx < number_of_directories_
+                            ? ListItemKind::DIRECTORY
+                            : ListItemKind::REGULAR_FILE);
+    }
+
+    size_t get_number_of_directories() const { return number_of_directories_; }
+
+    const std::vector<char> &get_names() const { return names_; }
+
+    const std::vector<uint32_t> &get_offsets() const { return offsets_; }
+
+    size_t get_heap_size() const
+    {
+        return names_.capacity() + offsets_.capacity() * sizeof(offsets_[0]);
+    }
+};
+
+/*!
+ * Change of a directory entry reported by the file system.
+ */
+struct DirChange
+{
+    std::string name_;
+    bool is_directory_;
+    bool is_added_;
+};
+
+/*!
+ * Compare two indexes of the same directory, collect the differences.
+ *
+ * Applying the changes to a copy of \p old_index in the order they are
+ * appended to \p changes yields an index equal to \p new_index.
+ */
+void collect_differences(const DirIndex &old_index, const DirIndex &new_index,
+                         std::vector<DirChange> &changes);
+
+/*!
+ * Move links to child lists of items at or after given index.
+ *
+ * This is how links stored next to a #USB::DirIndex follow their items when
+ * an entry is inserted into or removed from the index.
+ *
+ * \param child_by_item, item_by_child
+ *     The links in both directions.
+ *
+ * \param first
+ *     Index of the first item whose link is to be moved.
+ *
+ * \param delta
+ *     By how many items to move the links, +1 for insertion before
+ *     \p first, -1 for removal of the item before \p first.
+ */
+void move_child_links(std::map<uint32_t, ID::List> &child_by_item,
+                      std::unordered_map<uint32_t, uint32_t> &item_by_child,
+                      uint32_t first, int delta);
+
+}
+
+#endif /* !USB_DIR_INDEX_HH */
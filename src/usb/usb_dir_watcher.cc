@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glib-unix.h>
+
+#include "usb_dir_watcher.hh"
+#include "messages.h"
+
+static constexpr uint32_t watch_mask =
+    IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+    IN_ONLYDIR | IN_EXCL_UNLINK;
+
+static gboolean trampoline(gint fd, GIOCondition condition, gpointer user_data)
+{
+    auto *watcher = static_cast<USB::DirWatcher *>(user_data);
+    msg_log_assert(watcher != nullptr);
+
+    watcher->process_events();
+
+    return G_SOURCE_CONTINUE;
+}
+
+bool USB::DirWatcher::start(ChangedFn &&changed_fn)
+{
+    msg_log_assert(fd_ < 0);
+
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if(fd < 0)
+    {
+        msg_error(errno, LOG_ERR,
+                  "Failed to initialize inotify, not watching directories");
+        return false;
+    }
+
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    fd_ = fd;
+    changed_fn_ = std::move(changed_fn);
+    source_id_ = g_unix_fd_add(fd_, G_IO_IN, trampoline, this);
+
+    return true;
+}
+
+void USB::DirWatcher::stop()
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    if(fd_ < 0)
+        return;
+
+    if(source_id_ != 0)
+    {
+        g_source_remove(source_id_);
+        source_id_ = 0;
+    }
+
+    /* closing the descriptor removes all watches */
+    close(fd_);
+    fd_ = -1;
+
+    watches_.clear();
+    watch_by_list_.clear();
+    changed_fn_ = nullptr;
+}
+
+void USB::DirWatcher::watch(const std::shared_ptr<DirList> &list,
+                            std::string &&path)
+{
+    msg_log_assert(list != nullptr);
+
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    if(fd_ < 0)
+        return;
+
+    forget_expired_unlocked();
+
+    const int wd = inotify_add_watch(fd_, path.c_str(), watch_mask);
+
+    if(wd < 0)
+    {
+        msg_error(errno, LOG_WARNING, "Cannot watch directory \"%s\"",
+                  path.c_str());
+        return;
+    }
+
+    /* same directory, same descriptor: the new list replaces the old one */
+    auto &w(watches_[wd]);
+    w.list_ = list;
+    w.path_ = std::move(path);
+    watch_by_list_[list.get()] = wd;
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Watching directory \"%s\" of list %u",
+              w.path_.c_str(), list->get_cache_id().get_raw_id());
+}
+
+bool USB::DirWatcher::is_watched(const DirList &list) const
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    const auto wd = watch_by_list_.find(&list);
+
+    if(wd == watch_by_list_.end())
+        return false;
+
+    const auto w = watches_.find(wd->second);
+
+    /* the list may have been replaced by another one at the same address */
+    return w != watches_.end() && w->second.list_.lock().get() == &list;
+}
+
+void USB::DirWatcher::forget_expired()
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+    forget_expired_unlocked();
+}
+
+void USB::DirWatcher::forget_expired_unlocked()
+{
+    for(auto it = watches_.begin(); it != watches_.end(); /* nothing */)
+    {
+        if(!it->second.list_.expired())
+        {
+            ++it;
+            continue;
+        }
+
+        if(fd_ >= 0)
+            inotify_rm_watch(fd_, it->first);
+
+        it = watches_.erase(it);
+    }
+
+    for(auto it = watch_by_list_.begin(); it != watch_by_list_.end(); /* nothing */)
+    {
+        const auto w = watches_.find(it->second);
+
+        if(w == watches_.end() || w->second.list_.lock().get() != it->first)
+            it = watch_by_list_.erase(it);
+        else
+            ++it;
+    }
+}
+
+static bool is_regular_file(const std::string &dir, const std::string &name)
+{
+    struct stat buf;
+    return lstat((dir + '/' + name).c_str(), &buf) == 0 && S_ISREG(buf.st_mode);
+}
+
+void USB::DirWatcher::process_events()
+{
+    alignas(struct inotify_event) char buffer[4096];
+    std::map<int, std::vector<DirList::Change>> changes;
+    std::vector<int> ignored;
+    bool is_overflow = false;
+
+    while(1)
+    {
+        const ssize_t len = read(fd_, buffer, sizeof(buffer));
+
+        if(len < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            if(errno != EAGAIN)
+                msg_error(errno, LOG_ERR, "Failed reading inotify events");
+
+            break;
+        }
+
+        if(len == 0)
+            break;
+
+        for(ssize_t offset = 0; offset < len; /* nothing */)
+        {
+            const auto *ev = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+            offset += sizeof(*ev) + ev->len;
+
+            if((ev->mask & IN_Q_OVERFLOW) != 0)
+                is_overflow = true;
+            else if((ev->mask & IN_IGNORED) != 0)
+                ignored.push_back(ev->wd);
+            else if(ev->len > 0)
+                changes[ev->wd].push_back(
+                    {ev->name, (ev->mask & IN_ISDIR) != 0,
+                     (ev->mask & (IN_CREATE | IN_MOVED_TO)) != 0});
+        }
+    }
+
+    std::vector<std::pair<std::shared_ptr<DirList>, std::vector<DirList::Change>>> lists;
+
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        /* watches are removed by the kernel when their directories are gone */
+        for(const int wd : ignored)
+            watches_.erase(wd);
+
+        for(auto &c : changes)
+        {
+            const auto w = watches_.find(c.first);
+
+            if(w == watches_.end())
+                continue;
+
+            auto list = w->second.list_.lock();
+
+            if(list == nullptr)
+                continue;
+
+            /* directory entries which are neither directories nor regular
+             * files are never stored in the lists */
+            auto &ch(c.second);
+            ch.erase(std::remove_if(ch.begin(), ch.end(),
+                                    [&w] (const DirList::Change &change)
+                                    {
+                                        return change.is_added_ &&
+                                               !change.is_directory_ &&
+                                               !is_regular_file(w->second.path_,
+                                                                change.name_);
+                                    }),
+                     ch.end());
+
+            if(!ch.empty())
+                lists.emplace_back(std::move(list), std::move(ch));
+        }
+
+        forget_expired_unlocked();
+    }
+
+    /* the change handler modifies the cache, so we must not hold the lock */
+    for(const auto &l : lists)
+        changed_fn_(l.first, l.second);
+
+    if(is_overflow)
+    {
+        msg_info("Lost track of directory changes, reading all watched "
+                 "directories again");
+        resync_all();
+    }
+}
+
+void USB::DirWatcher::resync_all()
+{
+    std::vector<std::pair<std::shared_ptr<DirList>, std::string>> lists;
+
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        for(const auto &w : watches_)
+        {
+            auto list = w.second.list_.lock();
+
+            if(list != nullptr)
+                lists.emplace_back(std::move(list), w.second.path_);
+        }
+    }
+
+    for(const auto &l : lists)
+    {
+        DirIndex index;
+
+        /* directory is gone, we'll get or have got an event for it */
+        if(!index.read_from_file_system(l.second))
+            continue;
+
+        std::vector<DirList::Change> changes;
+        USB::collect_differences(*l.first->get_index(), index, changes);
+
+        if(!changes.empty())
+            changed_fn_(l.first, changes);
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef USB_DIR_WATCHER_HH
+#define USB_DIR_WATCHER_HH
+
+#include <unordered_map>
+#include <functional>
+
+#include <glib.h>
+
+#include "usb_list.hh"
+#include "logged_lock.hh"
+
+namespace USB
+{
+
+/*!
+ * Watch directories of cached #USB::DirList objects for changes.
+ *
+ * Directories are watched using inotify for as long as their lists exist.
+ * Events are read from the GLib main loop. Created, deleted, and renamed
+ * entries are collected per directory, and changes read in one go are passed
+ * to the change handler in a single call per list, so that a burst of
+ * changes (e.g., copying many files) results in a single patch of the list.
+ *
+ * In case the kernel's event queue overflows, all watched directories are
+ * read again and compared with their lists.
+ */
+class DirWatcher
+{
+  public:
+    using ChangedFn =
+        std::function<void(const std::shared_ptr<DirList> &,
+                           const std::vector<DirList::Change> &)>;
+
+  private:
+    struct Watch
+    {
+        std::weak_ptr<DirList> list_;
+        std::string path_;
+    };
+
+    mutable LoggedLock::Mutex lock_;
+    int fd_;
+    guint source_id_;
+    ChangedFn changed_fn_;
+
+    /* watched directories by watch descriptor */
+    std::unordered_map<int, Watch> watches_;
+
+    /* watch descriptors by list, for lists which may have expired */
+    std::unordered_map<const DirList *, int> watch_by_list_;
+
+  public:
+    DirWatcher(const DirWatcher &) = delete;
+    DirWatcher &operator=(const DirWatcher &) = delete;
+
+    explicit DirWatcher():
+        fd_(-1),
+        source_id_(0)
+    {
+        LoggedLock::configure(lock_, "USB::DirWatcher::lock_",
+                              MESSAGE_LEVEL_DEBUG);
+    }
+
+    ~DirWatcher() { stop(); }
+
+    /*!
+     * Set up inotify and attach to default GLib main context.
+     *
+     * \param changed_fn
+     *     Called from the main loop with the changes read for each list.
+     *
+     * \returns
+     *     True on success, false if inotify is not available. In the latter
+     *     case, directories are not watched.
+     */
+    bool start(ChangedFn &&changed_fn);
+
+    /*!
+     * Stop watching all directories.
+     */
+    void stop();
+
+    /*!
+     * Watch directory of given list.
+     *
+     * This function is thread-safe. It does nothing if the watcher has not
+     * been started.
+     */
+    void watch(const std::shared_ptr<DirList> &list, std::string &&path);
+
+    /*!
+     * Check whether or not the directory of given list is watched.
+     */
+    bool is_watched(const DirList &list) const;
+
+    /*!
+     * Stop watching directories of lists which do not exist anymore.
+     */
+    void forget_expired();
+
+    /*!
+     * Read and process pending events.
+     *
+     * \internal
+     *     Called from the main loop.
+     */
+    void process_events();
+
+  private:
+    void forget_expired_unlocked();
+    void resync_all();
+};
+
+}
+
+#endif /* !USB_DIR_WATCHER_HH */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2017, 2019, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2017, 2019, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -63,7 +63,8 @@ bool USB::Helpers::construct_fspath_to_item(const DirList &list,
 
     const DirList *dir_list_ptr = nullptr;
     std::shared_ptr<const LRU::Entry> lru_entry;
-    std::vector<const std::string *> path_elements;
+    std::vector<std::shared_ptr<const DirIndex>> indices;
+    std::vector<const char *> path_elements;
 
     for(size_t i = 2; i < list_depth; ++i)
     {
@@ -71,8 +72,15 @@ bool USB::Helpers::construct_fspath_to_item(const DirList &list,
                         ? &list
                         : static_cast<const DirList *>(lru_entry.get()));
 
-        const auto &item = (*dir_list_ptr)[item_id];
-        path_elements.push_back(&item.get_specific_data().get_name());
+        /* names are taken from the index so that the tiles of the lists on
+         * the path are left alone; the indexes are kept so that the names
+         * remain valid while the lists are patched */
+        indices.emplace_back(dir_list_ptr->get_index());
+
+        if(item_id.get_raw_id() >= indices.back()->size())
+            return false;
+
+        path_elements.push_back(indices.back()->get_name(item_id.get_raw_id()));
 
         if(!usb_helpers_list_tree_pointer->get_parent_link(dir_list_ptr->get_cache_id(),
                                                            item_id, lru_entry))
@@ -97,7 +105,7 @@ bool USB::Helpers::construct_fspath_to_item(const DirList &list,
         for(auto str = path_elements.rbegin(); str != path_elements.rend(); ++str)
         {
             path += '/';
-            path += (*str)->c_str();
+            path += *str;
         }
     }
     else
@@ -106,9 +114,16 @@ bool USB::Helpers::construct_fspath_to_item(const DirList &list,
         for(auto str = path_elements.rbegin(); str != path_elements.rend(); ++str)
         {
             path += '/';
-            path += curlpp::escape(**str);
+            path += curlpp::escape(*str);
         }
     }
 
     return true;
 }
+
+std::shared_ptr<const USB::DirIndex>
+USB::Helpers::lookup_crawled_directory(const std::string &path)
+{
+    msg_log_assert(usb_helpers_list_tree_pointer != nullptr);
+    return usb_helpers_list_tree_pointer->lookup_crawled_directory(path);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2019  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2019, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -33,6 +33,7 @@ namespace USB
 class ListTree;
 class DeviceList;
 class DirList;
+class DirIndex;
 
 namespace Helpers
 {
@@ -52,6 +53,13 @@ std::shared_ptr<const DeviceList> get_list_of_usb_devices();
 bool construct_fspath_to_item(const DirList &list, ID::Item item_id,
                               std::string &path, const char *prefix = nullptr);
 
+/*!
+ * Look up index of directory read in advance.
+ *
+ * \see #USB::ListTree::lookup_crawled_directory()
+ */
+std::shared_ptr<const DirIndex> lookup_crawled_directory(const std::string &path);
+
 }
 
 }
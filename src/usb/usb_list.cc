@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2021, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2021, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -24,7 +24,6 @@
 #endif /* HAVE_CONFIG_H */
 
 #include <algorithm>
-#include <dirent.h>
 
 #include "usb_list.hh"
 #include "usb_helpers.hh"
@@ -32,6 +31,15 @@
 #include "dbus_usb_iface_deep.h"
 #include "gerrorwrapper.hh"
 
+template<>
+ListThreads<USB::ItemData, USB::dir_list_tile_size> &
+TiledList<USB::ItemData, USB::dir_list_tile_size,
+          USB::dir_list_number_of_tiles>::get_thread_pool()
+{
+    static ListThreads<USB::ItemData, USB::dir_list_tile_size> thread_pool(false);
+    return thread_pool;
+}
+
 bool USB::DeviceItemData::add_volume(uint32_t vol_id,
                                      const char *display_name_utf8,
                                      const char *mountpoint_path,
@@ -102,18 +110,12 @@ USB::DeviceItemData::lookup_existing_volume_info(uint32_t volume_number) const
 
 const I18n::String USB::DeviceList::LIST_TITLE(true, "All USB devices");
 
-void USB::DeviceList::enumerate_direct_sublists(const LRU::Cache &cache,
-                                                std::vector<ID::List> &nodes) const
-{
-    MSG_BUG("%s(): function shall not be called", __PRETTY_FUNCTION__);
-}
-
 void USB::DeviceList::obliviate_child(ID::List child_id, const Entry *child)
 {
     ID::Item idx;
 
     if(lookup_item_id_by_child_id(child_id, idx))
-        (*this)[idx].obliviate_child();
+        unlink_child_list(idx);
     else if(!LRU::KilledLists::get_singleton().erase(child_id))
         MSG_BUG("Got obliviate notification for USB device %u, "
                 "but could not find it in device list (ID %u)",
@@ -300,164 +302,278 @@ const std::string &USB::VolumeItemData::get_url() const
     return dev->get_volume_mountpoint(number_);
 }
 
-void USB::VolumeList::enumerate_direct_sublists(const LRU::Cache &cache,
-                                                std::vector<ID::List> &nodes) const
-{
-    for(auto it = begin(); it != end(); ++it)
-    {
-        auto id = it->get_child_list();
-
-        if(id.is_valid())
-            nodes.push_back(id);
-    }
-}
-
 void USB::VolumeList::obliviate_child(ID::List child_id, const Entry *child)
 {
     ID::Item idx;
 
     if(lookup_item_id_by_child_id(child_id, idx))
-        (*this)[idx].obliviate_child();
+        unlink_child_list(idx);
     else if(!LRU::KilledLists::get_singleton().erase(child_id))
         MSG_BUG("Got obliviate notification for USB volume %u, "
                 "but could not find it in volume list (ID %u)",
                 child_id.get_raw_id(), get_cache_id().get_raw_id());
 }
 
-void USB::DirList::enumerate_direct_sublists(const LRU::Cache &cache,
-                                             std::vector<ID::List> &nodes) const
-{
-    for(auto it = begin(); it != end(); ++it)
-    {
-        auto id = it->get_child_list();
-
-        if(id.is_valid())
-            nodes.push_back(id);
-    }
-}
-
 void USB::DirList::obliviate_child(ID::List child_id, const Entry *child)
 {
     ID::Item idx;
 
+    /* child lists are linked outside the tiles, so they are never killed by
+     * tile eviction */
     if(lookup_item_id_by_child_id(child_id, idx))
-        (*this)[idx].obliviate_child();
-    else if(!LRU::KilledLists::get_singleton().erase(child_id))
+        unlink_child_list(idx);
+    else
         MSG_BUG("Got obliviate notification for child %u, "
                 "but could not find it in list (ID %u)",
                 child_id.get_raw_id(), get_cache_id().get_raw_id());
 }
 
-class CollectNamesData
+size_t USB::DirList::get_size_in_bytes() const
 {
-  private:
-    std::string base_dir_;
-    const size_t base_dir_end_offset_;
+    /* not holding the lock while looking at the tiles, see
+     * #USB::DirList::apply_changes() */
+    const size_t tiles_size = TiledList::get_size_in_bytes();
 
-  public:
-    std::vector<std::string> directories_;
-    std::vector<std::string> files_;
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
 
-    CollectNamesData(const CollectNamesData &) = delete;
-    CollectNamesData &operator=(const CollectNamesData &) = delete;
+    return tiles_size + index_->get_heap_size() +
+           child_by_item_.size() * (sizeof(decltype(child_by_item_)::value_type) + 4 * sizeof(void *)) +
+           item_by_child_.bucket_count() * sizeof(void *) +
+           item_by_child_.size() * (sizeof(decltype(item_by_child_)::value_type) + 2 * sizeof(void *));
+}
 
-    explicit CollectNamesData(const std::string &base_dir):
-        base_dir_end_offset_(base_dir.length() + 1)
-    {
-        base_dir_.reserve(base_dir_end_offset_ + 128);
-        base_dir_ = base_dir;
-        base_dir_ += '/';
-    }
+const ListItem_<USB::ItemData> *
+USB::DirList::lookup_child_by_id(ID::List child_id) const
+{
+    ID::Item idx;
+
+    /* items are taken only from the tiles as they are, looking up a child
+     * must not cause any tile to be filled */
+    return lookup_item_id_by_child_id(child_id, idx)
+        ? lookup_list_item(idx)
+        : nullptr;
+}
+
+bool USB::DirList::lookup_item_id_by_child_id(ID::List child_id,
+                                              ID::Item &idx) const
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    const auto it = item_by_child_.find(child_id.get_raw_id());
+
+    if(it == item_by_child_.end())
+        return false;
+
+    idx = ID::Item(it->second);
+    return true;
+}
+
+ID::List USB::DirList::lookup_child_list(ID::Item idx) const
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    const auto it = child_by_item_.find(idx.get_raw_id());
+    return it != child_by_item_.end() ? it->second : ID::List();
+}
+
+void USB::DirList::link_child_list(ID::Item idx, ID::List child_id)
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    /* linking the invalid ID means there is no child list anymore, and an
+     * item may be linked again to replace its child list */
+    const auto it = child_by_item_.find(idx.get_raw_id());
 
-    void set_file_name(const char *path)
+    if(it != child_by_item_.end())
     {
-        base_dir_.resize(base_dir_end_offset_);
-        base_dir_ += path;
+        item_by_child_.erase(it->second.get_raw_id());
+        child_by_item_.erase(it);
     }
 
-    const char *get_path() const
+    if(!child_id.is_valid())
+        return;
+
+    msg_log_assert(idx.get_raw_id() < index_->size());
+
+    const auto other = item_by_child_.find(child_id.get_raw_id());
+
+    if(other != item_by_child_.end())
     {
-        return base_dir_.c_str();
+        MSG_BUG("Child list %u moved from item %u to item %u in list %u",
+                child_id.get_raw_id(), other->second, idx.get_raw_id(),
+                get_cache_id().get_raw_id());
+        child_by_item_.erase(other->second);
     }
-};
 
-static int collect_all_names(const char *path, unsigned char dtype,
-                             void *user_data)
+    child_by_item_[idx.get_raw_id()] = child_id;
+    item_by_child_[child_id.get_raw_id()] = idx.get_raw_id();
+}
+
+void USB::DirList::unlink_child_list(ID::Item idx)
 {
-    auto &data = *static_cast<CollectNamesData *>(user_data);
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
 
-    data.set_file_name(path);
+    const auto it = child_by_item_.find(idx.get_raw_id());
 
-    if(dtype == DT_DIR)
-        data.directories_.push_back(path);
-    else if(dtype == DT_REG)
-        data.files_.push_back(path);
-    else
+    if(it == child_by_item_.end())
     {
-        /* just ignore anything else */
+        MSG_BUG("Cannot unlink child of item %u in list %u, not linked",
+                idx.get_raw_id(), get_cache_id().get_raw_id());
+        return;
     }
 
-    return 0;
+    item_by_child_.erase(it->second.get_raw_id());
+    child_by_item_.erase(it);
 }
 
-bool USB::DirList::fill_from_file_system(const std::string &path)
+bool USB::DirList::apply_changes(const std::vector<Change> &changes)
 {
-    CollectNamesData directories_and_files(path);
+    /* positions of inserted (true) and removed (false) entries, in order */
+    std::vector<std::pair<size_t, bool>> edits;
+    std::shared_ptr<const DirIndex> new_index;
 
-    if(os_foreach_in_path(path.c_str(), collect_all_names, &directories_and_files) < 0)
-        return false;
+    {
+        DirIndex index(get_index()->clone());
+
+        for(const auto &change : changes)
+        {
+            size_t pos;
+
+            if(change.is_added_
+               ? index.insert(change.name_.c_str(), change.is_directory_, pos)
+               : index.remove(change.name_.c_str(), change.is_directory_, pos))
+                edits.emplace_back(pos, change.is_added_);
+        }
+
+        if(edits.empty())
+            return false;
+
+        new_index = std::make_shared<const DirIndex>(std::move(index));
+    }
+
+    /* the index and the child links are replaced while no reader or filler
+     * can see the tiles so that they never mix up old and new entries */
+    reset_tiles(new_index->size(),
+                [this, &edits, &new_index] ()
+                {
+                    LOGGED_LOCK_CONTEXT_HINT;
+                    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+                    for(const auto &edit : edits)
+                    {
+                        const size_t pos = edit.first;
+
+                        if(edit.second)
+                        {
+                            USB::move_child_links(child_by_item_, item_by_child_,
+                                             pos, 1);
+                            continue;
+                        }
+
+                        const auto it = child_by_item_.find(pos);
+
+                        if(it != child_by_item_.end())
+                        {
+                            MSG_BUG("Removed item %zu from list %u, "
+                                    "but it is still linked to list %u",
+                                    pos, get_cache_id().get_raw_id(),
+                                    it->second.get_raw_id());
+                            item_by_child_.erase(it->second.get_raw_id());
+                            child_by_item_.erase(it);
+                        }
+
+                        USB::move_child_links(child_by_item_, item_by_child_,
+                                         pos + 1, -1);
+                    }
+
+                    index_ = std::move(new_index);
+                });
+
+    return true;
+}
+
+ssize_t USB::DirListFiller::fill(ItemProvider<USB::ItemData> &item_provider,
+                                ID::List list_id, ID::Item idx,
+                                size_t count, ListError &error,
+                                const std::function<bool()> &may_continue) const
+{
+    error = ListError::OK;
 
-    std::sort(directories_and_files.directories_.begin(),
-              directories_and_files.directories_.end());
+    msg_log_assert(cache_ != nullptr);
 
-    std::sort(directories_and_files.files_.begin(),
-              directories_and_files.files_.end());
+    const auto list(std::static_pointer_cast<const USB::DirList>(cache_->lookup(list_id)));
 
-    for(const auto &dir : directories_and_files.directories_)
+    if(list == nullptr)
     {
-        ListItem_<ItemData> new_item;
-        new_item.get_specific_data() =
-            ItemData(dir, ListItemKind(ListItemKind::DIRECTORY));
-        append_unsorted(std::move(new_item));
+        error = ListError::INVALID_ID;
+        return -1;
     }
 
-    for(const auto &file : directories_and_files.files_)
+    const auto index(list->get_index());
+    const size_t end = std::min(idx.get_raw_id() + count, index->size());
+    size_t i = idx.get_raw_id();
+
+    for(/* nothing */; i < end; ++i)
     {
-        ListItem_<ItemData> new_item;
-        new_item.get_specific_data() =
-            ItemData(file, ListItemKind(ListItemKind::REGULAR_FILE));
-        append_unsorted(std::move(new_item));
+        auto *item = item_provider.next();
+
+        if(item == nullptr)
+            break;
+
+        item->assign(index->get_name(i), index->get_kind(i));
     }
 
-    return true;
+    return i - idx.get_raw_id();
+}
+
+static USB::DirListFiller dir_list_filler;
+
+void USB::init_dir_list_filler(const LRU::Cache &cache)
+{
+    dir_list_filler.init(cache);
 }
 
 static ID::List attach_new_dirlist(LRU::Cache &cache, ID::List parent_list,
                                    const std::string &path, ListError &error)
 {
-    ID::List id =
-        add_child_list_to_cache<USB::DirList>(cache, parent_list,
-                                              LRU::CacheMode::CACHED,
-                                              parent_list.get_context(),
-                                              USB::DirList::estimate_size_in_bytes());
+    const auto fill_start = LRU::timebase->now();
+    auto index(USB::Helpers::lookup_crawled_directory(path));
 
-    if(!id.is_valid())
+    if(index == nullptr)
     {
-        error = ListError::INTERNAL;
-        return ID::List();
+        auto fresh_index = std::make_shared<USB::DirIndex>();
+
+        if(!fresh_index->read_from_file_system(path))
+        {
+            error = ListError::PHYSICAL_MEDIA_IO;
+            return ID::List();
+        }
+
+        index = std::move(fresh_index);
     }
 
-    auto dir = std::static_pointer_cast<USB::DirList>(cache.lookup(id));
-    msg_log_assert(dir != nullptr);
+    auto dir = LRU::make_pooled<USB::DirList>(cache.lookup(parent_list),
+                                              std::move(index),
+                                              dir_list_filler);
+    const ID::List id = (dir != nullptr)
+        ? cache.insert(dir, LRU::CacheMode::CACHED, parent_list.get_context(),
+                       USB::DirList::estimate_size_in_bytes())
+        : ID::List();
 
-    if(!dir->fill_from_file_system(path))
+    if(!id.is_valid())
     {
-        MSG_BUG("LEAKING LIST ID %u after failure to fill list from file system",
-                id.get_raw_id());
-        error = ListError::PHYSICAL_MEDIA_IO;
+        error = ListError::INTERNAL;
         return ID::List();
     }
 
+    set_refill_cost_of_list(*dir, fill_start);
+    cache.set_object_size(id, dir->get_size_in_bytes());
+
     return id;
 }
 
@@ -484,6 +600,8 @@ ID::List DeviceList::enter_child<VolumeItemData>(LRU::Cache &cache, LRU::CacheMo
                 msg_info("Enter USB device %s", name.c_str());
             }
 
+            const auto fill_start = LRU::timebase->now();
+
             // false positive
             // cppcheck-suppress shadowVar
             const auto new_id =
@@ -497,6 +615,8 @@ ID::List DeviceList::enter_child<VolumeItemData>(LRU::Cache &cache, LRU::CacheMo
                 auto volumes = std::static_pointer_cast<USB::VolumeList>(cache.lookup(new_id));
                 msg_log_assert(volumes != nullptr);
                 device_data.fill_volume_list(*volumes);
+                set_refill_cost_of_list(*volumes, fill_start);
+                cache.set_object_size(new_id, volumes->get_size_in_bytes());
             }
             else
                 error = ListError::INTERNAL;
@@ -538,11 +658,14 @@ ID::List DirList::enter_child<ItemData>(LRU::Cache &cache, LRU::CacheModeRequest
                                         const EnterChild::DoPurgeList &purge_list,
                                         ListError &error)
 {
-    return EnterChild::enter_child_template<DirList::ListItemType>(
+    return EnterChild::enter_child_by_index_template(
         this, cache, item, may_continue, use_cached, purge_list, error,
-        [this, &cache, &item, &error] (const DirList::ListItemType &child_entry)
+        [this, &cache, &item, &error] ()
         {
-            if(!child_entry.get_kind().is_directory())
+            const auto index(get_index());
+
+            if(item.get_raw_id() >= index->size() ||
+               !index->get_kind(item.get_raw_id()).is_directory())
             {
                 error = ListError::INVALID_ID;
                 return ID::List();
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -23,15 +23,20 @@
 #define USB_LIST_HH
 
 #include <string>
+#include <map>
 
 #include "lists.hh"
 #include "usb_helpers.hh"
+#include "usb_dir_index.hh"
 #include "enterchild_glue.hh"
 #include "i18nstring.hh"
 
 namespace USB
 {
 
+static constexpr uint16_t dir_list_tile_size = 32;
+static constexpr size_t dir_list_number_of_tiles = 3;
+
 class VolumeList;
 
 /*!
@@ -141,6 +146,20 @@ class DeviceItemData
         return lookup_existing_volume_info(volume_number).mountpoint_path_;
     }
 
+    size_t get_heap_size() const
+    {
+        size_t result = ::get_heap_size(display_name_utf8_) +
+                        ::get_heap_size(usb_port_) +
+                        volumes_.capacity() * sizeof(volumes_[0]);
+
+        for(const auto &vol : volumes_)
+            result += sizeof(*vol) +
+                      ::get_heap_size(vol->display_name_utf8_) +
+                      ::get_heap_size(vol->mountpoint_path_);
+
+        return result;
+    }
+
   private:
     const VolumeInfo &lookup_existing_volume_info(uint32_t volume_number) const;
 };
@@ -184,6 +203,13 @@ class VolumeItemData
     }
 
     const std::string &get_url() const;
+
+    // cppcheck-suppress functionStatic
+    size_t get_heap_size() const
+    {
+        /* names are stored with the device */
+        return 0;
+    }
 };
 
 /*!
@@ -221,6 +247,15 @@ class ItemData
         kind_ = ListItemKind(ListItemKind::OPAQUE);
     }
 
+    /*!
+     * Replace name and kind, reusing memory allocated for the previous name.
+     */
+    void assign(const char *display_name_utf8, ListItemKind kind)
+    {
+        display_name_utf8_ = display_name_utf8;
+        kind_ = kind;
+    }
+
     void get_name(std::string &name) const
     {
         name = display_name_utf8_;
@@ -235,6 +270,11 @@ class ItemData
     {
         return kind_;
     }
+
+    size_t get_heap_size() const
+    {
+        return ::get_heap_size(display_name_utf8_);
+    }
 };
 
 /*!
@@ -258,8 +298,6 @@ class DeviceList: public FlatList<DeviceItemData>
 
     virtual ~DeviceList() {}
 
-    void enumerate_direct_sublists(const LRU::Cache &cache,
-                                   std::vector<ID::List> &nodes) const override;
     void obliviate_child(ID::List child_id, const Entry *child) override;
 
     template <typename T>
@@ -305,8 +343,6 @@ class VolumeList: public FlatList<VolumeItemData>
 
     virtual ~VolumeList() {}
 
-    void enumerate_direct_sublists(const LRU::Cache &cache,
-                                   std::vector<ID::List> &nodes) const override;
     void obliviate_child(ID::List child_id, const Entry *child) override;
 
     template <typename T>
@@ -326,31 +362,57 @@ class VolumeList: public FlatList<VolumeItemData>
 /*!
  * Directories on a USB volume.
  *
- * Despite the risk of running into a large directory on a slow USB device
- * (think cheap 2 TiB HDD connected over some slow USB 2.0 bridge, packed with
- * a huge collection of relatively small MP3 files), we use a flat list here
- * and fill it completely in a single go. The reason is that we must sort the
- * directory listings, requiring us to know all entries anyway.
+ * Directory listings must be sorted, so all entries of a directory must be
+ * known before the first one can be shown. We read the directory once into a
+ * compact #USB::DirIndex when the list is created, keeping only the names.
+ * Large directories on slow USB devices (think cheap 2 TiB HDD connected
+ * over some slow USB 2.0 bridge, packed with a huge collection of relatively
+ * small MP3 files) still take a while to read, but do not take much RAM.
+ * Directories read in advance by the #USB::VolumeCrawler are not read again;
+ * their indexes are shared with the crawler.
+ *
+ * Range queries read names straight from the index. The #ListItem_ objects
+ * required for random access are materialized from the index only for the
+ * hot tiles of this #TiledList, filled in by #USB::DirListFiller. Links to
+ * child lists are not stored in the tiles, but in a sparse map next to the
+ * index so that they survive eviction of the tiles.
+ *
+ * Changes to the directory reported by the file system are patched into the
+ * list by #USB::DirList::apply_changes(), see #USB::DirWatcher.
  *
  * Since the operating system is going to buffer directories anyway, we can get
  * away with storing only relatively few directories and purging the cache
  * frequently. Hot lists remain in RAM, sorted, new and rarely used lists are
  * fetched from the OS and sorted again when needed.
  */
-class DirList: public FlatList<ItemData>
+class DirList: public TiledList<ItemData, dir_list_tile_size,
+                               dir_list_number_of_tiles>
 {
+  public:
+    using Change = DirChange;
+
+  private:
+    mutable LoggedLock::Mutex lock_;
+    std::shared_ptr<const DirIndex> index_;
+    std::map<uint32_t, ID::List> child_by_item_;
+    std::unordered_map<uint32_t, uint32_t> item_by_child_;
+
   public:
     DirList(const DirList &) = delete;
     DirList &operator=(const DirList &) = delete;
 
-    explicit DirList(std::shared_ptr<Entry> parent):
-        FlatList(parent)
-    {}
+    explicit DirList(std::shared_ptr<Entry> parent,
+                     std::shared_ptr<const DirIndex> index,
+                     const TiledListFillerIface<ItemData> &filler):
+        TiledList(parent, index->size(), filler),
+        index_(std::move(index))
+    {
+        LoggedLock::configure(lock_, "USB::DirList::lock_",
+                              MESSAGE_LEVEL_DEBUG);
+    }
 
     virtual ~DirList() {}
 
-    void enumerate_direct_sublists(const LRU::Cache &cache,
-                                   std::vector<ID::List> &nodes) const override;
     void obliviate_child(ID::List child_id, const Entry *child) override;
 
     template <typename T>
@@ -366,9 +428,101 @@ class DirList: public FlatList<ItemData>
      */
     static constexpr size_t estimate_size_in_bytes() { return sizeof(DirList); }
 
-    bool fill_from_file_system(const std::string &path);
+    size_t get_size_in_bytes() const override;
+
+    /*!
+     * Names and kinds of all entries, without materializing any tiles.
+     *
+     * The returned index remains valid and unchanged for as long as the
+     * caller holds on to it, even if the list is patched in the meantime.
+     */
+    std::shared_ptr<const DirIndex> get_index() const
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+        return index_;
+    }
+
+    /*!
+     * Find entry by name in logarithmic time.
+     *
+     * \returns
+     *     True if the entry was found, false if not.
+     */
+    bool find_by_name(const char *name, ID::Item &item_id,
+                      ListItemKind &kind) const
+    {
+        const auto index(get_index());
+        size_t pos;
+
+        if(!index->find_by_name(name, pos))
+            return false;
+
+        item_id = ID::Item(pos);
+        kind = index->get_kind(pos);
+
+        return true;
+    }
+
+    /*!
+     * Patch list according to changes in the directory.
+     *
+     * The changes are applied to a copy of the index which then replaces the
+     * current index. Entries are inserted or removed at their sorted
+     * positions, and links to child lists are moved along with their items.
+     * Removed directories are expected to have been unlinked from their child
+     * lists already. All tiles are dropped, see #TiledList::reset_tiles().
+     *
+     * \returns
+     *     True if the list has changed, false if the changes did not apply to
+     *     the list (e.g., because they were reported twice).
+     */
+    bool apply_changes(const std::vector<Change> &changes);
+
+    const ListItem_<ItemData> *lookup_child_by_id(ID::List child_id) const override;
+    bool lookup_item_id_by_child_id(ID::List child_id, ID::Item &idx) const override;
+    ID::List lookup_child_list(ID::Item idx) const override;
+    void link_child_list(ID::Item idx, ID::List child_id) override;
+    void unlink_child_list(ID::Item idx) override;
+};
+
+/*!
+ * Fill tiles of a #USB::DirList from its #USB::DirIndex.
+ */
+class DirListFiller: public TiledListFillerIface<ItemData>
+{
+  private:
+    const LRU::Cache *cache_;
+
+  public:
+    DirListFiller(const DirListFiller &) = delete;
+    DirListFiller &operator=(const DirListFiller &) = delete;
+
+    explicit DirListFiller():
+        cache_(nullptr)
+    {}
+
+    /*!
+     * Init object at runtime after static initialization.
+     *
+     * \param cache
+     *     The cache containing the lists to be filled.
+     */
+    void init(const LRU::Cache &cache)
+    {
+        cache_ = &cache;
+    }
+
+    ssize_t fill(ItemProvider<ItemData> &item_provider, ID::List list_id,
+                 ID::Item idx, size_t count, ListError &error,
+                 const std::function<bool()> &may_continue) const override;
 };
 
+/*!
+ * Set up the filler for all #USB::DirList objects.
+ */
+void init_dir_list_filler(const LRU::Cache &cache);
+
 }
 
 /*!
@@ -439,7 +593,9 @@ struct ForEachItemTraits<const USB::DirList>
 {
     using ListType = const USB::DirList;
     using ItemType = USB::ItemData;
-    using ParentListType = const FlatList<ItemType>;
+    using ParentListType =
+        const TiledList<ItemType, USB::dir_list_tile_size,
+                        USB::dir_list_number_of_tiles>;
     using ParentTraits = ForEachItemTraits<ParentListType>;
     using IterType = ParentTraits::IterType;
 
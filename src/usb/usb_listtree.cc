@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2020, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2020, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -81,10 +81,10 @@ void USB::ListTree::reinsert_volume_list(uint16_t device_id, uint32_t volume_num
 
     volume_list->insert_before(added_at_index, std::move(vol));
 
-    dev.obliviate_child();
+    device_list.unlink_child_list(device_index);
     auto volume_list_id = volume_list->get_cache_id();
     lt_manager_.reinsert_list(volume_list_id);
-    dev.set_child_list(volume_list_id);
+    device_list.link_child_list(device_index, volume_list_id);
 }
 
 /*!
@@ -110,6 +110,13 @@ static bool is_volume_list_or_invalid(const ListTreeManager &lt_manager,
 
 void USB::ListTree::pre_main_loop()
 {
+    dir_watcher_.start(
+        [this] (const std::shared_ptr<DirList> &list,
+                const std::vector<DirList::Change> &changes)
+        {
+            directory_changed(list, changes);
+        });
+
     lt_manager_.announce_root_list(devices_list_id_);
 
     auto devices = lt_manager_.lookup_list<USB::DeviceList>(devices_list_id_);
@@ -126,18 +133,131 @@ I18n::String USB::ListTree::get_child_list_title(ID::List list_id,
         return ListTreeManager::get_dynamic_title<USB::DeviceList>(lt_manager_, list_id, child_item_id);
     else if(is_volume_list_or_invalid(lt_manager_, devices_list_id_, list_id))
         return ListTreeManager::get_dynamic_title<USB::VolumeList>(lt_manager_, list_id, child_item_id);
-    else
-        return ListTreeManager::get_dynamic_title<USB::DirList>(lt_manager_, list_id, child_item_id);
+
+    /* directory names are taken from the index, not from the tiles, which
+     * may be reset by a patch while we are looking at them */
+    const auto list = lt_manager_.lookup_list<const USB::DirList>(list_id);
+
+    if(list == nullptr)
+        return I18n::String(false);
+
+    const auto index(list->get_index());
+
+    if(child_item_id.get_raw_id() >= index->size() ||
+       !index->get_kind(child_item_id.get_raw_id()).is_directory())
+        return I18n::String(false);
+
+    return I18n::String(false, index->get_name(child_item_id.get_raw_id()));
 }
 
 ID::List USB::ListTree::enter_child(ID::List list_id, ID::Item item_id, ListError &error)
 {
     if(list_id == devices_list_id_)
         return lt_manager_.enter_child<USB::DeviceList, USB::VolumeItemData>(list_id, item_id, may_continue_fn_, error);
-    else if(is_volume_list_or_invalid(lt_manager_, devices_list_id_, list_id))
-        return lt_manager_.enter_child<USB::VolumeList, USB::ItemData>(list_id, item_id, may_continue_fn_, error);
+
+    const ID::List child_id =
+        is_volume_list_or_invalid(lt_manager_, devices_list_id_, list_id)
+        ? lt_manager_.enter_child<USB::VolumeList, USB::ItemData>(list_id, item_id, may_continue_fn_, error)
+        : lt_manager_.enter_child<USB::DirList, USB::ItemData>(list_id, item_id, may_continue_fn_, error);
+
+    if(child_id.is_valid())
+        watch_directory(list_id, item_id, child_id);
+
+    return child_id;
+}
+
+void USB::ListTree::watch_directory(ID::List parent_id, ID::Item item_id,
+                                    ID::List dir_list_id)
+{
+    const auto list = lt_manager_.lookup_list<USB::DirList>(dir_list_id);
+
+    if(list == nullptr || dir_watcher_.is_watched(*list))
+        return;
+
+    std::string path;
+
+    if(is_volume_list_or_invalid(lt_manager_, devices_list_id_, parent_id))
+    {
+        const auto volumes = lt_manager_.lookup_list<const USB::VolumeList>(parent_id);
+
+        if(volumes == nullptr)
+            return;
+
+        path = (*volumes)[item_id].get_specific_data().get_url();
+    }
     else
-        return lt_manager_.enter_child<USB::DirList, USB::ItemData>(list_id, item_id, may_continue_fn_, error);
+    {
+        const auto parent = lt_manager_.lookup_list<const USB::DirList>(parent_id);
+
+        if(parent == nullptr ||
+           !USB::Helpers::construct_fspath_to_item(*parent, item_id, path))
+            return;
+    }
+
+    dir_watcher_.watch(list, std::move(path));
+}
+
+template <typename T>
+static void reinsert_and_relink(ListTreeManager &lt_manager, ID::List &list_id,
+                                ID::List parent_id, ID::Item parent_item_id)
+{
+    const auto parent = lt_manager.lookup_list<T>(parent_id);
+    msg_log_assert(parent != nullptr);
+
+    parent->unlink_child_list(parent_item_id);
+    lt_manager.reinsert_list(list_id);
+    parent->link_child_list(parent_item_id, list_id);
+}
+
+void USB::ListTree::directory_changed(const std::shared_ptr<DirList> &list,
+                                      const std::vector<DirList::Change> &changes)
+{
+    ID::List list_id = list->get_cache_id();
+
+    if(lt_manager_.lookup_list<USB::DirList>(list_id) != list)
+        return;
+
+    /* removed or renamed directories take their subtrees with them */
+    const auto index(list->get_index());
+
+    for(const auto &change : changes)
+    {
+        size_t pos;
+
+        if(change.is_added_ || !change.is_directory_ ||
+           !index->find(change.name_.c_str(), true, pos))
+            continue;
+
+        const ID::List child_id = list->lookup_child_list(ID::Item(pos));
+
+        if(child_id.is_valid())
+            lt_manager_.purge_subtree(child_id, ID::List(), nullptr);
+    }
+
+    if(!list->apply_changes(changes))
+        return;
+
+    ID::Item parent_item_id;
+    const ID::List parent_id = get_parent_link(list_id, parent_item_id);
+
+    if(!parent_id.is_valid() || parent_id == list_id)
+    {
+        MSG_BUG("Changed directory list %u has no parent", list_id.get_raw_id());
+        return;
+    }
+
+    const ID::List old_id = list_id;
+
+    if(is_volume_list_or_invalid(lt_manager_, devices_list_id_, parent_id))
+        reinsert_and_relink<USB::VolumeList>(lt_manager_, list_id,
+                                             parent_id, parent_item_id);
+    else
+        reinsert_and_relink<USB::DirList>(lt_manager_, list_id,
+                                          parent_id, parent_item_id);
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG,
+              "Patched %zu changes into directory list %u, now list %u",
+              changes.size(), old_id.get_raw_id(), list_id.get_raw_id());
 }
 
 template <typename T>
@@ -163,6 +283,46 @@ static bool for_each_item_detailed_apply_fn(ID::Item item_id, T &item,
     return callback(data);
 }
 
+/*!
+ * Pass names and kinds of a range of entries in a directory to a function.
+ *
+ * Unlike #for_each_item(), this function reads from the #USB::DirIndex of
+ * the list, so that range queries neither materialize any tiles nor copy
+ * names into list items.
+ */
+static ListError for_each_dir_entry(std::shared_ptr<const USB::DirList> list,
+                                    ID::Item first, size_t count,
+                                    const std::function<bool(const char *, ListItemKind)> &apply)
+{
+    if(list == nullptr)
+        return ListError(ListError::INVALID_ID);
+
+    const auto index(list->get_index());
+    const size_t end =
+        (count > 0)
+        ? std::min(first.get_raw_id() + count, index->size())
+        : index->size();
+
+    if(first.get_raw_id() >= end)
+    {
+        if(count > 0)
+            msg_error(0, LOG_WARNING,
+                      "WARNING: Client requested %zu items starting at index %u, "
+                      "but list size is %zu",
+                      count, first.get_raw_id(), end);
+
+        return ListError();
+    }
+
+    for(size_t i = first.get_raw_id(); i < end; ++i)
+    {
+        if(!apply(index->get_name(i), index->get_kind(i)))
+            break;
+    }
+
+    return ListError();
+}
+
 ListError USB::ListTree::for_each(ID::List list_id, ID::Item first, size_t count,
                                   const ListTreeIface::ForEachGenericCallback &callback) const
 {
@@ -192,15 +352,14 @@ ListError USB::ListTree::for_each(ID::List list_id, ID::Item first, size_t count
     }
     else
     {
-        const std::function<bool(ID::Item, const ListItem_<USB::ItemData> &)> fn =
-            [&callback]
-            (ID::Item item_id, const ListItem_<USB::ItemData> &item)
-            {
-                return for_each_item_generic_apply_fn<const ListItem_<USB::ItemData>>(item_id, item, callback);
-            };
-
-        return ::for_each_item(lt_manager_.lookup_list<const USB::DirList>(list_id),
-                               first, count, fn);
+        return for_each_dir_entry(lt_manager_.lookup_list<const USB::DirList>(list_id),
+                                  first, count,
+                                  [&callback] (const char *name, ListItemKind kind)
+                                  {
+                                      ListTreeIface::ForEachItemDataGeneric data(kind);
+                                      data.name_ = name;
+                                      return callback(data);
+                                  });
     }
 }
 
@@ -233,15 +392,16 @@ ListError USB::ListTree::for_each(ID::List list_id, ID::Item first, size_t count
     }
     else
     {
-        const std::function<bool(ID::Item, const ListItem_<USB::ItemData> &)> fn =
-            [&callback]
-            (ID::Item item_id, const ListItem_<USB::ItemData> &item)
-            {
-                return for_each_item_detailed_apply_fn<const ListItem_<USB::ItemData>>(item_id, item, callback);
-            };
-
-        return ::for_each_item(lt_manager_.lookup_list<const USB::DirList>(list_id),
-                               first, count, fn);
+        std::string temp;
+
+        return for_each_dir_entry(lt_manager_.lookup_list<const USB::DirList>(list_id),
+                                  first, count,
+                                  [&callback, &temp] (const char *name, ListItemKind kind)
+                                  {
+                                      temp = name;
+                                      const ListTreeIface::ForEachItemDataDetailed data(temp, kind);
+                                      return callback(data);
+                                  });
     }
 }
 
@@ -272,6 +432,20 @@ ssize_t USB::ListTree::size(ID::List list_id) const
     return -1;
 }
 
+ListError USB::ListTree::find_dir_entry(ID::List list_id, const std::string &name,
+                                        ID::Item &item_id, ListItemKind &kind) const
+{
+    const auto list = lt_manager_.lookup_list<const USB::DirList>(list_id);
+
+    if(list == nullptr)
+        return ListError(ListError::INVALID_ID);
+
+    if(!list->find_by_name(name.c_str(), item_id, kind))
+        return ListError(ListError::NOT_FOUND);
+
+    return ListError();
+}
+
 ID::List USB::ListTree::get_parent_link(ID::List list_id, ID::Item &parent_item_id) const
 {
     std::shared_ptr<LRU::Entry const> parent_list;
@@ -336,12 +510,12 @@ ListError USB::ListTree::get_uris_for_item(ID::List list_id, ID::Item item_id,
     if(list == nullptr)
         return ListError(ListError::INVALID_ID);
 
-    if(item_id.get_raw_id() >= list->size())
-        return ListError(ListError::INVALID_ID);
+    const auto index(list->get_index());
 
-    const auto &item = (*list)[item_id];
+    if(item_id.get_raw_id() >= index->size())
+        return ListError(ListError::INVALID_ID);
 
-    if(item.get_kind().is_directory())
+    if(index->get_kind(item_id.get_raw_id()).is_directory())
         return ListError();
 
     std::string temp;
@@ -492,8 +666,6 @@ static ListError follow_path(USB::ListTree &lt, const std::string &path,
                              ID::List &dir_list_id,
                              std::pair<ID::List, ID::Item> &parent_link_candidate,
                              std::pair<ID::List, ID::Item> &parent_link,
-                             std::pair<ID::Item, size_t> &&range,
-                             bool auto_search_on_range_failure,
                              std::function<ListError(ID::List, ID::Item, ListItemKind)> found_item)
 {
     if(!dir_list_id.is_valid())
@@ -521,56 +693,21 @@ static ListError follow_path(USB::ListTree &lt, const std::string &path,
                                                   component_end - component_start)
                                     : path.substr(component_start - path.begin()));
 
-        size_t idx = range.first.get_raw_id();
+        ID::Item idx;
         ListItemKind kind(ListItemKind::LOGOUT_LINK);
-        bool found = false;
-
-        for(int i = 0; i < 2; ++i)
-        {
-            error = lt.for_each(dir_list_id, range.first, range.second,
-                        [&component, &found, &idx, &kind]
-                        (const ListTreeIface::ForEachItemDataGeneric &item_data)
-                        {
-                            if(item_data.name_ == component)
-                            {
-                                found = true;
-                                kind = item_data.kind_;
-                                return false;
-                            }
-
-                            ++idx;
-                            return true;
-                        });
-
-            if(found || i > 0)
-                break;
-
-            /* first round, nothing found */
-            if(!auto_search_on_range_failure)
-                break;
-
-            if(range.first == ID::Item() && range.second == 0)
-                break;
-
-            msg_vinfo(MESSAGE_LEVEL_DEBUG,
-                      "Lookup \"%s\" in range failed, searching entire list",
-                      component.c_str());
-
-            range.first = ID::Item();
-            range.second = 0;
-            idx = 0;
-        }
 
-        if(error.failed())
-            break;
+        error = lt.find_dir_entry(dir_list_id, component, idx, kind);
 
-        if(!found)
+        if(error.get() == ListError::NOT_FOUND)
         {
             msg_error(0, LOG_NOTICE,
                       "Path component \"%s\" not found", component.c_str());
-            return ListError(ListError::NOT_FOUND);
+            return error;
         }
 
+        if(error.failed())
+            break;
+
         component_start =
             std::find_if_not(path_iter, path.end(), [] (const char &ch)
                                                     { return ch == '/'; });
@@ -578,22 +715,21 @@ static ListError follow_path(USB::ListTree &lt, const std::string &path,
 
         if(kind.is_directory())
         {
-            const auto next_id =
-                lt.enter_child(dir_list_id, ID::Item(idx), error);
+            const auto next_id = lt.enter_child(dir_list_id, idx, error);
 
             if(!next_id.is_valid())
                 break;
 
-            error = found_item(dir_list_id, ID::Item(idx), kind);
+            error = found_item(dir_list_id, idx, kind);
 
             if(!error.failed())
-                parent_link_candidate = std::make_pair(dir_list_id, ID::Item(idx));
+                parent_link_candidate = std::make_pair(dir_list_id, idx);
 
             dir_list_id = next_id;
         }
         else
         {
-            error = found_item(dir_list_id, ID::Item(idx), kind);
+            error = found_item(dir_list_id, idx, kind);
 
             const bool is_last_component = (component_start == path.end());
             if(!is_last_component && !error.failed())
@@ -609,18 +745,6 @@ static ListError follow_path(USB::ListTree &lt, const std::string &path,
     return error;
 }
 
-static inline ListError follow_path(USB::ListTree &lt, const std::string &path,
-                                    ID::List &dir_list_id,
-                                    std::pair<ID::List, ID::Item> &parent_link_candidate,
-                                    std::pair<ID::List, ID::Item> &parent_link,
-                                    std::function<ListError(ID::List, ID::Item, ListItemKind)> found_item)
-{
-    return follow_path(lt, path, dir_list_id,
-                       parent_link_candidate, parent_link,
-                       std::make_pair(ID::Item(), size_t(0)), false,
-                       found_item);
-}
-
 static void set_list_title(USB::ListTree &lt,
                            const std::pair<ID::List, ID::Item> &parent_link,
                            ListTreeIface::RealizeURLResult &result)
@@ -702,10 +826,6 @@ static ListError realize(USB::ListTree &lt, const std::string &url,
     if(!error.failed())
         error = follow_path(lt, d.item_name_, dir_list_id,
                             parent_link_candidate, parent_link,
-                            d.item_position_.is_valid()
-                            ? std::make_pair(ID::Item(d.item_position_.get_object_index() - 1), 1)
-                            : std::make_pair(ID::Item(), 0),
-                            true,
                             [&d, &result]
                             (ID::List list_id, ID::Item item_id, ListItemKind item_kind)
                             {
@@ -865,22 +985,28 @@ USB::ListTree::get_location_key(const ID::List list_id, const StrBoUrl::ObjectIn
     else
     {
         /* directories */
-        std::vector<const std::string *> path_elements;
+        std::vector<std::shared_ptr<const DirIndex>> indices;
+        std::vector<const char *> path_elements;
         path_elements.reserve(list_depth - 2);
 
         while(list_depth > 2)
         {
             if(!get_component_name<DirList>(*this, lt_manager_, lru_entry,
                     list_id, current_item_id, error, "directory",
-                    [&path_elements]
+                    [&indices, &path_elements]
                     (const DirList &list, ID::Item item) -> bool
                     {
-                        const auto &temp(list[item].get_specific_data().get_name());
+                        indices.emplace_back(list.get_index());
+
+                        if(item.get_raw_id() >= indices.back()->size())
+                            return false;
 
-                        if(temp.empty())
+                        const char *temp = indices.back()->get_name(item.get_raw_id());
+
+                        if(temp[0] == '\0')
                             return false;
 
-                        path_elements.push_back(&temp);
+                        path_elements.push_back(temp);
 
                         return true;
                     }))
@@ -891,16 +1017,16 @@ USB::ListTree::get_location_key(const ID::List list_id, const StrBoUrl::ObjectIn
 
         if(simple_key != nullptr)
             for(auto it = path_elements.rbegin(); it != path_elements.rend(); ++it)
-                simple_key->append_to_path(**it);
+                simple_key->append_to_path(*it);
         else
         {
             if(path_elements.size() > 1)
                 for(auto it = path_elements.rbegin(); it != path_elements.rend() - 1; ++it)
-                    reference_key->append_to_reference_point(**it);
+                    reference_key->append_to_reference_point(*it);
             else
                 reference_key->set_reference_point("");
 
-            reference_key->set_item(*path_elements.front(), item_pos);
+            reference_key->set_item(path_elements.front(), item_pos);
         }
     }
 
@@ -1020,21 +1146,27 @@ USB::ListTree::get_location_trace(ID::List list_id, StrBoUrl::ObjectIndex item_p
     else
     {
         /* directories */
-        std::vector<const std::string *> ref_elements;
-        std::vector<const std::string *> item_elements;
-        std::vector<const std::string *> *elements = &item_elements;
+        std::vector<std::shared_ptr<const DirIndex>> indices;
+        std::vector<const char *> ref_elements;
+        std::vector<const char *> item_elements;
+        std::vector<const char *> *elements = &item_elements;
 
         while(list_depth > 2)
         {
             if(!get_component_name<DirList>(*this, lt_manager_, lru_entry,
                     list_id, current_item_id, error, "directory",
-                    [&ref_elements, &elements,
+                    [&indices, &ref_elements, &elements,
                      ref_list_id, ref_item_pos, &found_reference_point]
                     (const DirList &list, ID::Item item) -> bool
                     {
-                        const auto &temp(list[item].get_specific_data().get_name());
+                        indices.emplace_back(list.get_index());
+
+                        if(item.get_raw_id() >= indices.back()->size())
+                            return false;
+
+                        const char *temp = indices.back()->get_name(item.get_raw_id());
 
-                        if(temp.empty())
+                        if(temp[0] == '\0')
                             return false;
 
                         if(!handle_reference_point(list.get_cache_id(), item,
@@ -1046,7 +1178,7 @@ USB::ListTree::get_location_trace(ID::List list_id, StrBoUrl::ObjectIndex item_p
                                                    }))
                             return false;
 
-                        elements->push_back(&temp);
+                        elements->push_back(temp);
 
                         return true;
                     }))
@@ -1057,15 +1189,15 @@ USB::ListTree::get_location_trace(ID::List list_id, StrBoUrl::ObjectIndex item_p
 
         if(!ref_elements.empty())
             for(auto it = ref_elements.rbegin(); it != ref_elements.rend(); ++it)
-                trace->append_to_reference_point(**it);
+                trace->append_to_reference_point(*it);
         else
             trace->set_reference_point("");
 
         if(item_elements.size() > 1)
             for(auto it = item_elements.rbegin(); it != item_elements.rend() - 1; ++it)
-                trace->append_to_item_path(**it);
+                trace->append_to_item_path(*it);
 
-        trace->append_item(*item_elements.front(), item_pos);
+        trace->append_item(item_elements.front(), item_pos);
     }
 
     if(list_depth == 2)
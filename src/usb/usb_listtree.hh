@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2019, 2022, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2019, 2022, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -27,6 +27,8 @@
 #include "listtree.hh"
 #include "listtree_manager.hh"
 #include "usb_list.hh"
+#include "usb_dir_watcher.hh"
+#include "usb_volume_crawler.hh"
 #include "i18nstring.hh"
 
 namespace USB
@@ -45,8 +47,21 @@ class ListTree: public ListTreeIface
      */
     ID::List devices_list_id_;
 
+    /*!
+     * Changes in directories of cached lists are patched into the lists.
+     */
+    DirWatcher dir_watcher_;
+
+    /*!
+     * Directory trees of new volumes are read in advance if enabled.
+     */
+    VolumeCrawler volume_crawler_;
+
     static constexpr const char CONTEXT_ID[] = "usb";
 
+    void watch_directory(ID::List parent_id, ID::Item item_id,
+                         ID::List dir_list_id);
+
   public:
     ListTree(const ListTree &) = delete;
     ListTree &operator=(const ListTree &) = delete;
@@ -64,6 +79,8 @@ class ListTree: public ListTreeIface
 
     ~ListTree()
     {
+        volume_crawler_.shutdown();
+        dir_watcher_.stop();
         shutdown_threads();
     }
 
@@ -74,8 +91,16 @@ class ListTree: public ListTreeIface
         msg_log_assert(devices_list_id_.is_valid());
     }
 
-    void start_threads(unsigned int number_of_threads, bool synchronous_mode) const override {}
-    void shutdown_threads() const override {}
+    void start_threads(unsigned int number_of_threads,
+                       bool synchronous_mode) const override
+    {
+        USB::DirList::start_threads(number_of_threads, synchronous_mode);
+    }
+
+    void shutdown_threads() const override
+    {
+        USB::DirList::shutdown_threads();
+    }
 
     /*!
      * Called when a list was discarded from cache during garbage collection.
@@ -83,6 +108,7 @@ class ListTree: public ListTreeIface
     void list_discarded_from_cache(ID::List id)
     {
         lt_manager_.list_discarded_from_cache(id);
+        dir_watcher_.forget_expired();
     }
 
     /*!
@@ -129,6 +155,45 @@ class ListTree: public ListTreeIface
 
     void pre_main_loop() override;
 
+    /*!
+     * Read directory trees of volumes added from now on in the background.
+     *
+     * \see #USB::VolumeCrawler::start()
+     */
+    void enable_volume_crawler(std::string &&store_path,
+                               size_t maximum_store_size)
+    {
+        volume_crawler_.start(std::move(store_path), maximum_store_size);
+    }
+
+    /*!
+     * Queue new volume for crawling, if enabled.
+     */
+    void crawl_volume(uint16_t device_id, uint32_t volume_number,
+                      const char *mountpoint, const char *uuid)
+    {
+        volume_crawler_.add_volume(device_id, volume_number, mountpoint, uuid);
+    }
+
+    /*!
+     * Stop crawling volumes of a device which is about to be removed.
+     */
+    void cancel_volume_crawler(uint16_t device_id)
+    {
+        volume_crawler_.remove_device(device_id);
+    }
+
+    /*!
+     * Get index of directory read in advance by the volume crawler.
+     *
+     * \returns
+     *     The index, or \c nullptr if the directory must be read.
+     */
+    std::shared_ptr<const DirIndex> lookup_crawled_directory(const std::string &path)
+    {
+        return volume_crawler_.lookup(path);
+    }
+
     bool use_list(ID::List list_id, bool pin_it) override
     {
         return lt_manager_.use_list(list_id, pin_it);
@@ -169,6 +234,25 @@ class ListTree: public ListTreeIface
 
     ssize_t size(ID::List list_id) const override;
 
+    /*!
+     * Find entry in directory list by name.
+     *
+     * \param list_id
+     *     ID of a #USB::DirList.
+     *
+     * \param name
+     *     Name of the entry to find.
+     *
+     * \param[out] item_id, kind
+     *     Position and kind of the entry, if found.
+     *
+     * \returns
+     *     #ListError::NOT_FOUND if there is no such entry,
+     *     #ListError::INVALID_ID if the list is not cached.
+     */
+    ListError find_dir_entry(ID::List list_id, const std::string &name,
+                             ID::Item &item_id, ListItemKind &kind) const;
+
     ID::List get_parent_link(ID::List list_id, ID::Item &parent_item_id) const override;
 
     bool get_parent_link(ID::List list_id, ID::Item &parent_item_id,
@@ -212,6 +296,18 @@ class ListTree: public ListTreeIface
         return lt_manager_.get_gc_expiry_time();
     }
 
+    /*!
+     * Patch directory list according to changes reported by the file system.
+     *
+     * Only the changed list is invalidated and reinserted under a new ID.
+     * Child lists of removed directories are purged, all other child lists
+     * are kept.
+     *
+     * Must be called from the main loop.
+     */
+    void directory_changed(const std::shared_ptr<DirList> &list,
+                           const std::vector<DirList::Change> &changes);
+
     /*!
      * Get pointer to list of USB devices (the root list).
      *
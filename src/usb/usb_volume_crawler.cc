@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+#include <cerrno>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "usb_volume_crawler.hh"
+#include "messages.h"
+
+/* I/O priority definitions, not exported by the C library */
+static constexpr int ioprio_who_process = 1;
+static constexpr int ioprio_class_idle = 3;
+static constexpr int ioprio_class_shift = 13;
+
+/*!
+ * Directories modified this close to being read are not stored.
+ *
+ * FAT stores modification times with a resolution of two seconds, so changes
+ * made right after reading a directory may not change its modification time.
+ */
+static constexpr time_t mtime_granularity_seconds = 2;
+
+USB::VolumeCrawler::VolumeCrawler():
+    shutdown_request_(true)
+{
+    LoggedLock::configure(lock_, "USB::VolumeCrawler::lock_",
+                          MESSAGE_LEVEL_DEBUG);
+    LoggedLock::configure(work_available_,
+                          "USB::VolumeCrawler::work_available_-cv",
+                          MESSAGE_LEVEL_DEBUG);
+}
+
+void USB::VolumeCrawler::start(std::string &&store_path,
+                               size_t maximum_store_size)
+{
+    msg_log_assert(!thread_.joinable());
+
+    if(!store_path.empty())
+        store_.configure(std::move(store_path), maximum_store_size);
+
+    shutdown_request_ = false;
+    thread_ = std::thread(&VolumeCrawler::worker, this);
+}
+
+void USB::VolumeCrawler::shutdown()
+{
+    if(!thread_.joinable())
+        return;
+
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        shutdown_request_ = true;
+
+        for(auto &vol : volumes_)
+            vol->is_canceled_ = true;
+
+        volumes_.clear();
+        pending_.clear();
+        work_available_.notify_all();
+    }
+
+    thread_.join();
+}
+
+void USB::VolumeCrawler::add_volume(uint16_t device_id, uint32_t volume_number,
+                                    const char *mountpoint, const char *uuid)
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    if(shutdown_request_)
+        return;
+
+    for(const auto &vol : volumes_)
+        if(vol->device_id_ == device_id && vol->number_ == volume_number)
+            return;
+
+    volumes_.emplace_back(std::make_shared<Volume>(device_id, volume_number,
+                                                   std::string(mountpoint),
+                                                   std::string(uuid)));
+    pending_.push_back(volumes_.back());
+    work_available_.notify_one();
+}
+
+void USB::VolumeCrawler::remove_device(uint16_t device_id)
+{
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+    const auto of_device =
+        [device_id] (const std::shared_ptr<Volume> &vol)
+        {
+            return vol->device_id_ == device_id;
+        };
+
+    for(auto &vol : volumes_)
+    {
+        if(of_device(vol))
+        {
+            vol->is_canceled_ = true;
+            msg_vinfo(MESSAGE_LEVEL_DIAG, "Canceled crawling volume %u at %s",
+                      vol->number_, vol->mountpoint_.c_str());
+        }
+    }
+
+    volumes_.erase(std::remove_if(volumes_.begin(), volumes_.end(), of_device),
+                   volumes_.end());
+    pending_.erase(std::remove_if(pending_.begin(), pending_.end(), of_device),
+                   pending_.end());
+}
+
+std::shared_ptr<const USB::DirIndex>
+USB::VolumeCrawler::lookup(const std::string &path)
+{
+    std::shared_ptr<Volume> volume;
+    std::string relative_path;
+    Directory dir;
+    bool is_crawled = false;
+
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        for(const auto &vol : volumes_)
+        {
+            const auto &mp(vol->mountpoint_);
+
+            if(path.compare(0, mp.length(), mp) != 0)
+                continue;
+
+            if(path.length() == mp.length())
+                relative_path.clear();
+            else if(path[mp.length()] == '/')
+                relative_path = path.substr(mp.length() + 1);
+            else
+                continue;
+
+            const auto it = vol->directories_.find(relative_path);
+
+            if(it != vol->directories_.end())
+            {
+                dir = it->second;
+                is_crawled = true;
+            }
+            else if(!vol->has_stored_)
+                return nullptr;
+
+            volume = vol;
+            break;
+        }
+    }
+
+    if(volume == nullptr)
+        return nullptr;
+
+    struct stat buf;
+
+    if(stat(path.c_str(), &buf) < 0)
+        return nullptr;
+
+    if(!is_crawled)
+        return volume->stored_.lookup(relative_path, buf.st_mtim);
+
+    if(buf.st_mtim.tv_sec == dir.mtime_.tv_sec &&
+       buf.st_mtim.tv_nsec == dir.mtime_.tv_nsec)
+        return dir.index_;
+
+    LOGGED_LOCK_CONTEXT_HINT;
+    std::lock_guard<LoggedLock::Mutex> lock(lock_);
+    volume->directories_.erase(relative_path);
+
+    return nullptr;
+}
+
+void USB::VolumeCrawler::worker()
+{
+    if(syscall(SYS_ioprio_set, ioprio_who_process, 0,
+               ioprio_class_idle << ioprio_class_shift) < 0)
+        msg_error(errno, LOG_NOTICE,
+                  "Failed setting I/O priority of volume crawler");
+
+    LOGGED_LOCK_CONTEXT_HINT;
+    LoggedLock::UniqueLock<LoggedLock::Mutex> lock(lock_);
+
+    while(1)
+    {
+        work_available_.wait(lock,
+            [this]()
+            {
+                return shutdown_request_ || !pending_.empty();
+            });
+
+        if(shutdown_request_)
+            break;
+
+        const auto volume(std::move(pending_.front()));
+        pending_.pop_front();
+
+        lock.unlock();
+        crawl(*volume);
+
+        LOGGED_LOCK_CONTEXT_HINT;
+        lock.lock();
+    }
+}
+
+void USB::VolumeCrawler::crawl(Volume &volume)
+{
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Crawling volume %u at %s",
+              volume.number_, volume.mountpoint_.c_str());
+
+    if(store_.is_enabled())
+    {
+        volume.fingerprint_ = VolumeIndexStore::compute_fingerprint(volume.mountpoint_);
+
+        if(store_.open(volume.uuid_, volume.fingerprint_, volume.stored_))
+        {
+            LOGGED_LOCK_CONTEXT_HINT;
+            std::lock_guard<LoggedLock::Mutex> lock(lock_);
+            volume.has_stored_ = true;
+        }
+    }
+
+    std::deque<std::string> pending_directories(1);
+    size_t number_of_directories = 0;
+    size_t number_of_directories_read = 0;
+    size_t index_size = 0;
+
+    while(!pending_directories.empty())
+    {
+        if(volume.is_canceled_)
+            return;
+
+        std::string relative_path(std::move(pending_directories.front()));
+        pending_directories.pop_front();
+
+        const std::string path =
+            relative_path.empty()
+            ? volume.mountpoint_
+            : volume.mountpoint_ + '/' + relative_path;
+
+        const time_t read_time = time(nullptr);
+        struct stat buf;
+
+        if(stat(path.c_str(), &buf) < 0)
+            continue;
+
+        auto index(volume.has_stored_
+                   ? volume.stored_.lookup(relative_path, buf.st_mtim)
+                   : nullptr);
+
+        if(index == nullptr)
+        {
+            auto fresh_index = std::make_shared<DirIndex>();
+
+            if(!fresh_index->read_from_file_system(path))
+                continue;
+
+            index = std::move(fresh_index);
+            ++number_of_directories_read;
+        }
+
+        for(size_t i = 0;
+            i < index->size() && index->get_kind(i).is_directory();
+            ++i)
+            pending_directories.emplace_back(relative_path.empty()
+                                             ? index->get_name(i)
+                                             : relative_path + '/' + index->get_name(i));
+
+        index_size += index->get_heap_size() + relative_path.size();
+
+        if(index_size > MAXIMUM_INDEX_SIZE_PER_VOLUME)
+        {
+            msg_info("Stopped crawling volume %u at %s after %zu directories, "
+                     "index too large",
+                     volume.number_, volume.mountpoint_.c_str(),
+                     number_of_directories);
+            break;
+        }
+
+        if(buf.st_mtim.tv_sec + mtime_granularity_seconds >= read_time)
+            continue;
+
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        if(volume.is_canceled_)
+            return;
+
+        volume.directories_.emplace(std::move(relative_path),
+                                    Directory{std::move(index), buf.st_mtim});
+        ++number_of_directories;
+    }
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG,
+              "Crawled volume %u at %s: %zu directories, %zu read, %zu bytes",
+              volume.number_, volume.mountpoint_.c_str(),
+              number_of_directories, number_of_directories_read, index_size);
+
+    if(!store_.is_enabled() ||
+       (number_of_directories_read == 0 &&
+        number_of_directories == volume.stored_.get_number_of_directories()))
+        return;
+
+    VolumeIndexWriter writer;
+
+    {
+        LOGGED_LOCK_CONTEXT_HINT;
+        std::lock_guard<LoggedLock::Mutex> lock(lock_);
+
+        if(volume.is_canceled_)
+            return;
+
+        for(const auto &it : volume.directories_)
+            writer.add_directory(it.first, it.second.mtime_, it.second.index_);
+    }
+
+    store_.write(volume.uuid_, volume.fingerprint_, writer);
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef USB_VOLUME_CRAWLER_HH
+#define USB_VOLUME_CRAWLER_HH
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <ctime>
+
+#include "usb_volume_index_store.hh"
+#include "logged_lock.hh"
+
+namespace USB
+{
+
+/*!
+ * Read directory trees of USB volumes in the background.
+ *
+ * When a volume is added, a worker thread walks its directory tree breadth
+ * first at idle I/O priority. It stores a #USB::DirIndex for each directory,
+ * keyed by path relative to the mountpoint, so that the top-level directories
+ * which are most likely browsed first are available early. Lists of
+ * directories read by the crawler are created from these indexes without
+ * reading the directories again, see #USB::VolumeCrawler::lookup().
+ *
+ * The modification time of each directory is stored along with its index and
+ * checked on lookup, so changes made after crawling are never hidden. The
+ * amount of memory spent per volume is limited; directories beyond that limit
+ * are read on demand as usual.
+ *
+ * If a #USB::VolumeIndexStore is configured, the indexes of each volume are
+ * written to the store after crawling, keyed by file system UUID. When the
+ * volume is added again later, directories whose modification time has not
+ * changed are restored from the store instead of being read again, both by
+ * the crawler and by #USB::VolumeCrawler::lookup() while the crawler has not
+ * reached them yet.
+ */
+class VolumeCrawler
+{
+  private:
+    struct Directory
+    {
+        std::shared_ptr<const DirIndex> index_;
+        struct timespec mtime_;
+    };
+
+    struct Volume
+    {
+        const uint16_t device_id_;
+        const uint32_t number_;
+        const std::string mountpoint_;
+        const std::string uuid_;
+        std::atomic<bool> is_canceled_;
+        std::unordered_map<std::string, Directory> directories_;
+
+        /*! Fingerprint of the file system, set by the worker thread. */
+        uint64_t fingerprint_;
+
+        /*! Opened by the worker thread, read-only once #has_stored_ is set. */
+        VolumeIndexFile stored_;
+        bool has_stored_;
+
+        Volume(const Volume &) = delete;
+        Volume &operator=(const Volume &) = delete;
+
+        explicit Volume(uint16_t device_id, uint32_t number,
+                        std::string &&mountpoint, std::string &&uuid):
+            device_id_(device_id),
+            number_(number),
+            mountpoint_(std::move(mountpoint)),
+            uuid_(std::move(uuid)),
+            is_canceled_(false),
+            fingerprint_(0),
+            has_stored_(false)
+        {}
+    };
+
+    static constexpr size_t MAXIMUM_INDEX_SIZE_PER_VOLUME = 4UL * 1024UL * 1024UL;
+
+    mutable LoggedLock::Mutex lock_;
+    LoggedLock::ConditionVariable work_available_;
+    std::vector<std::shared_ptr<Volume>> volumes_;
+    std::deque<std::shared_ptr<Volume>> pending_;
+    bool shutdown_request_;
+    std::thread thread_;
+
+    VolumeIndexStore store_;
+
+  public:
+    VolumeCrawler(const VolumeCrawler &) = delete;
+    VolumeCrawler &operator=(const VolumeCrawler &) = delete;
+
+    explicit VolumeCrawler();
+
+    ~VolumeCrawler() { shutdown(); }
+
+    /*!
+     * Start worker thread.
+     *
+     * Volumes are not crawled unless this function has been called.
+     *
+     * \param store_path
+     *     Directory of the #USB::VolumeIndexStore, or empty string for not
+     *     storing indexes.
+     *
+     * \param maximum_store_size
+     *     Size limit of the store in bytes.
+     */
+    void start(std::string &&store_path, size_t maximum_store_size);
+
+    /*!
+     * Stop worker thread, forget all volumes.
+     */
+    void shutdown();
+
+    /*!
+     * Queue volume for crawling.
+     *
+     * \param device_id, volume_number, mountpoint
+     *     Volume as reported by MounTA.
+     *
+     * \param uuid
+     *     UUID of the file system as reported by MounTA, used as key into the
+     *     #USB::VolumeIndexStore. May be empty.
+     */
+    void add_volume(uint16_t device_id, uint32_t volume_number,
+                    const char *mountpoint, const char *uuid);
+
+    /*!
+     * Stop crawling volumes of given device, forget their indexes.
+     *
+     * The worker thread finishes reading the directory it is currently
+     * reading, if any, and does not touch the device's volumes anymore
+     * afterwards. This function does not wait for that.
+     */
+    void remove_device(uint16_t device_id);
+
+    /*!
+     * Get index of directory read by the crawler.
+     *
+     * \param path
+     *     Absolute path of the directory.
+     *
+     * \returns
+     *     The index, or \c nullptr if the directory has not been read by the
+     *     crawler or has changed since then.
+     */
+    std::shared_ptr<const DirIndex> lookup(const std::string &path);
+
+  private:
+    void worker();
+    void crawl(Volume &volume);
+};
+
+}
+
+#endif /* !USB_VOLUME_CRAWLER_HH */
@@ -0,0 +1,561 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+#include "usb_volume_index_store.hh"
+#include "os.h"
+#include "messages.h"
+
+static constexpr const char FILENAME_SUFFIX[] = ".usbindex";
+
+static bool write_all(int fd, const void *data, size_t size)
+{
+    const auto *p = static_cast<const uint8_t *>(data);
+
+    while(size > 0)
+    {
+        const ssize_t ret = ::write(fd, p, size);
+
+        if(ret < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        p += ret;
+        size -= ret;
+    }
+
+    return true;
+}
+
+bool USB::VolumeIndexWriter::write(const std::string &filename,
+                                   uint64_t fingerprint)
+{
+    std::sort(directories_.begin(), directories_.end(),
+              [] (const Directory &a, const Directory &b) { return a.path_ < b.path_; });
+
+    directories_.erase(
+        std::unique(directories_.begin(), directories_.end(),
+                    [] (const Directory &a, const Directory &b) { return a.path_ == b.path_; }),
+        directories_.end());
+
+    std::vector<VolumeIndexFormat::DirectoryRecord> directory_records;
+    std::vector<uint32_t> offsets;
+    std::string strings;
+
+    directory_records.reserve(directories_.size());
+
+    for(const auto &d : directories_)
+    {
+        const auto &names(d.index_->get_names());
+        const auto &name_offsets(d.index_->get_offsets());
+
+        if(strings.size() + d.path_.size() + names.size() + 1 > UINT32_MAX ||
+           offsets.size() + name_offsets.size() > UINT32_MAX)
+        {
+            msg_error(0, LOG_NOTICE, "Volume index %s too large",
+                      filename.c_str());
+            return false;
+        }
+
+        VolumeIndexFormat::DirectoryRecord dr {};
+        dr.path_offset_ = strings.size();
+        dr.path_length_ = d.path_.size();
+        strings.append(d.path_.c_str(), d.path_.size() + 1);
+
+        dr.mtime_sec_ = d.mtime_.tv_sec;
+        dr.mtime_nsec_ = d.mtime_.tv_nsec;
+        dr.first_offset_ = offsets.size();
+        dr.number_of_entries_ = name_offsets.size();
+        dr.number_of_directories_ = d.index_->get_number_of_directories();
+        dr.names_offset_ = strings.size();
+        dr.size_of_names_ = names.size();
+        strings.append(names.data(), names.size());
+        offsets.insert(offsets.end(), name_offsets.begin(), name_offsets.end());
+
+        directory_records.push_back(dr);
+    }
+
+    VolumeIndexFormat::FileHeader header {};
+    std::copy(std::begin(VolumeIndexFormat::MAGIC), std::end(VolumeIndexFormat::MAGIC),
+              header.magic_);
+    header.version_ = VolumeIndexFormat::VERSION;
+    header.number_of_directories_ = directory_records.size();
+    header.number_of_offsets_ = offsets.size();
+    header.size_of_strings_ = strings.size();
+    header.fingerprint_ = fingerprint;
+
+    const std::string temp_name(filename + ".tmp");
+    const int fd = ::open(temp_name.c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if(fd < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed creating volume index %s",
+                  temp_name.c_str());
+        return false;
+    }
+
+    const bool ok =
+        write_all(fd, &header, sizeof(header)) &&
+        write_all(fd, directory_records.data(),
+                  directory_records.size() * sizeof(directory_records[0])) &&
+        write_all(fd, offsets.data(), offsets.size() * sizeof(offsets[0])) &&
+        write_all(fd, strings.data(), strings.size()) &&
+        fsync(fd) == 0;
+
+    if(!ok)
+        msg_error(errno, LOG_ERR, "Failed writing volume index %s",
+                  temp_name.c_str());
+
+    ::close(fd);
+
+    if(ok && rename(temp_name.c_str(), filename.c_str()) == 0)
+    {
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Wrote volume index %s: %zu directories, %zu entries",
+                  filename.c_str(), directory_records.size(), offsets.size());
+        return true;
+    }
+
+    if(ok)
+        msg_error(errno, LOG_ERR, "Failed renaming volume index %s",
+                  temp_name.c_str());
+
+    unlink(temp_name.c_str());
+
+    return false;
+}
+
+void USB::VolumeIndexFile::reject(const char *reason)
+{
+    msg_error(0, LOG_NOTICE, "Ignoring volume index %s: %s",
+              filename_.c_str(), reason);
+    close();
+}
+
+bool USB::VolumeIndexFile::open(const std::string &filename,
+                                uint64_t fingerprint)
+{
+    close();
+
+    filename_ = filename;
+
+    const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+    {
+        if(errno == ENOENT)
+            msg_vinfo(MESSAGE_LEVEL_DIAG,
+                      "No volume index %s", filename.c_str());
+        else
+            msg_error(errno, LOG_ERR, "Failed opening volume index %s",
+                      filename.c_str());
+
+        return false;
+    }
+
+    struct stat st;
+
+    if(fstat(fd, &st) < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed to stat volume index %s",
+                  filename.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    if(size_t(st.st_size) < sizeof(VolumeIndexFormat::FileHeader))
+    {
+        ::close(fd);
+        reject("file too short");
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if(mapped == MAP_FAILED)
+    {
+        msg_error(errno, LOG_ERR, "Failed mapping volume index %s",
+                  filename.c_str());
+        return false;
+    }
+
+    mapped_ = static_cast<const uint8_t *>(mapped);
+    mapped_size_ = st.st_size;
+
+    const auto *header = reinterpret_cast<const VolumeIndexFormat::FileHeader *>(mapped_);
+
+    if(memcmp(header->magic_, VolumeIndexFormat::MAGIC, sizeof(header->magic_)) != 0)
+    {
+        reject("bad magic");
+        return false;
+    }
+
+    if(header->version_ != VolumeIndexFormat::VERSION)
+    {
+        reject("unsupported version");
+        return false;
+    }
+
+    const uint64_t expected_size =
+        sizeof(VolumeIndexFormat::FileHeader) +
+        uint64_t(header->number_of_directories_) * sizeof(VolumeIndexFormat::DirectoryRecord) +
+        uint64_t(header->number_of_offsets_) * sizeof(uint32_t) +
+        header->size_of_strings_;
+
+    if(expected_size != mapped_size_)
+    {
+        reject("size mismatch");
+        return false;
+    }
+
+    if(header->fingerprint_ != fingerprint)
+    {
+        /* not an error, the UUID has been reused by another file system */
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Volume index %s belongs to different file system",
+                  filename.c_str());
+        close();
+        return false;
+    }
+
+    number_of_directories_ = header->number_of_directories_;
+    number_of_offsets_ = header->number_of_offsets_;
+    size_of_strings_ = header->size_of_strings_;
+
+    directories_ = reinterpret_cast<const VolumeIndexFormat::DirectoryRecord *>(header + 1);
+    offsets_ = reinterpret_cast<const uint32_t *>(directories_ + number_of_directories_);
+    strings_ = reinterpret_cast<const char *>(offsets_ + number_of_offsets_);
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG,
+              "Opened volume index %s: %u directories, %u entries",
+              filename.c_str(), number_of_directories_, number_of_offsets_);
+
+    return true;
+}
+
+void USB::VolumeIndexFile::close()
+{
+    if(mapped_ != nullptr)
+        munmap(const_cast<uint8_t *>(mapped_), mapped_size_);
+
+    mapped_ = nullptr;
+    mapped_size_ = 0;
+    directories_ = nullptr;
+    offsets_ = nullptr;
+    strings_ = nullptr;
+    number_of_directories_ = 0;
+    number_of_offsets_ = 0;
+    size_of_strings_ = 0;
+}
+
+bool USB::VolumeIndexFile::find_directory(const std::string &path,
+                                          uint32_t &idx) const
+{
+    uint32_t lo = 0;
+    uint32_t hi = number_of_directories_;
+
+    while(lo < hi)
+    {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        const auto &d(directories_[mid]);
+
+        if(d.path_offset_ >= size_of_strings_ ||
+           d.path_length_ >= size_of_strings_ - d.path_offset_ ||
+           strings_[d.path_offset_ + d.path_length_] != '\0')
+            return false;
+
+        const int cmp = path.compare(0, std::string::npos,
+                                     strings_ + d.path_offset_, d.path_length_);
+
+        if(cmp == 0)
+        {
+            idx = mid;
+            return true;
+        }
+
+        if(cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return false;
+}
+
+bool USB::VolumeIndexFile::check_directory(const VolumeIndexFormat::DirectoryRecord &d) const
+{
+    if(d.first_offset_ > number_of_offsets_ ||
+       d.number_of_entries_ > number_of_offsets_ - d.first_offset_ ||
+       d.number_of_directories_ > d.number_of_entries_ ||
+       d.names_offset_ > size_of_strings_ ||
+       d.size_of_names_ > size_of_strings_ - d.names_offset_)
+        return false;
+
+    if(d.number_of_entries_ == 0)
+        return true;
+
+    const char *const names = strings_ + d.names_offset_;
+
+    if(d.size_of_names_ == 0 || names[d.size_of_names_ - 1] != '\0')
+        return false;
+
+    const uint32_t *const offsets = offsets_ + d.first_offset_;
+
+    /* the index is searched by name, so the sort order matters */
+    for(uint32_t i = 0; i < d.number_of_entries_; ++i)
+    {
+        if(offsets[i] >= d.size_of_names_)
+            return false;
+
+        if(i > 0 && i != d.number_of_directories_ &&
+           strcmp(names + offsets[i - 1], names + offsets[i]) >= 0)
+            return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<const USB::DirIndex>
+USB::VolumeIndexFile::lookup(const std::string &path,
+                             const struct timespec &mtime) const
+{
+    uint32_t idx;
+
+    if(!is_open() || !find_directory(path, idx))
+        return nullptr;
+
+    const auto &d(directories_[idx]);
+
+    if(d.mtime_sec_ != mtime.tv_sec || d.mtime_nsec_ != uint32_t(mtime.tv_nsec))
+        return nullptr;
+
+    if(!check_directory(d))
+    {
+        msg_error(0, LOG_NOTICE, "Volume index %s: directory %u is corrupt",
+                  filename_.c_str(), idx);
+        return nullptr;
+    }
+
+    auto index = std::make_shared<DirIndex>();
+    index->assign(strings_ + d.names_offset_, d.size_of_names_,
+                  offsets_ + d.first_offset_, d.number_of_entries_,
+                  d.number_of_directories_);
+
+    return index;
+}
+
+/*!
+ * Compute 64 bit FNV-1a hash.
+ */
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const auto *p = static_cast<const uint8_t *>(data);
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+uint64_t USB::VolumeIndexStore::compute_fingerprint(const std::string &mountpoint)
+{
+    struct statvfs vfs;
+    struct stat st;
+
+    if(statvfs(mountpoint.c_str(), &vfs) < 0 || stat(mountpoint.c_str(), &st) < 0)
+    {
+        msg_error(errno, LOG_NOTICE, "Failed to inspect file system at %s",
+                  mountpoint.c_str());
+        return 0;
+    }
+
+    /* only properties which do not change while the file system is in use,
+     * and which do not depend on the device it is connected to */
+    const uint64_t values[] =
+    {
+        vfs.f_frsize, vfs.f_blocks, vfs.f_files, vfs.f_namemax, st.st_ino,
+    };
+
+    const uint64_t hash = fnv1a(0xcbf29ce484222325ULL, values, sizeof(values));
+
+    return hash != 0 ? hash : 1;
+}
+
+bool USB::VolumeIndexStore::make_filename(const std::string &uuid,
+                                          std::string &filename) const
+{
+    if(!is_enabled() || uuid.empty() || uuid.length() > 64)
+        return false;
+
+    /* UUIDs come from outside, so we are picky about them */
+    for(const char ch : uuid)
+        if(!((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') ||
+             (ch >= 'A' && ch <= 'Z') || ch == '-' || ch == '_'))
+            return false;
+
+    filename = path_ + '/' + uuid + FILENAME_SUFFIX;
+
+    return true;
+}
+
+bool USB::VolumeIndexStore::open(const std::string &uuid, uint64_t fingerprint,
+                                 VolumeIndexFile &file) const
+{
+    std::string filename;
+
+    if(fingerprint == 0 || !make_filename(uuid, filename) ||
+       !file.open(filename, fingerprint))
+        return false;
+
+    /* mark as recently used */
+    if(utimensat(AT_FDCWD, filename.c_str(), nullptr, 0) < 0)
+        msg_error(errno, LOG_NOTICE, "Failed to touch volume index %s",
+                  filename.c_str());
+
+    return true;
+}
+
+bool USB::VolumeIndexStore::write(const std::string &uuid, uint64_t fingerprint,
+                                  VolumeIndexWriter &writer) const
+{
+    std::string filename;
+
+    if(fingerprint == 0 || !make_filename(uuid, filename))
+        return false;
+
+    if(mkdir(path_.c_str(), 0755) < 0 && errno != EEXIST)
+    {
+        msg_error(errno, LOG_ERR, "Failed creating volume index directory %s",
+                  path_.c_str());
+        return false;
+    }
+
+    const bool ok = writer.write(filename, fingerprint);
+
+    evict(filename);
+
+    return ok;
+}
+
+namespace
+{
+
+struct StoredFile
+{
+    std::string filename_;
+    size_t size_;
+    struct timespec mtime_;
+};
+
+struct CollectStoredFilesData
+{
+    const std::string &path_;
+    std::vector<StoredFile> files_;
+};
+
+}
+
+static int collect_stored_files(const char *name, unsigned char dtype,
+                                void *user_data)
+{
+    auto &data = *static_cast<CollectStoredFilesData *>(user_data);
+    const size_t name_length = strlen(name);
+    const size_t suffix_length = sizeof(FILENAME_SUFFIX) - 1;
+
+    if(dtype != DT_REG || name_length <= suffix_length ||
+       strcmp(name + name_length - suffix_length, FILENAME_SUFFIX) != 0)
+        return 0;
+
+    std::string filename(data.path_ + '/' + name);
+    struct stat st;
+
+    if(stat(filename.c_str(), &st) == 0)
+        data.files_.push_back({std::move(filename), size_t(st.st_size), st.st_mtim});
+
+    return 0;
+}
+
+void USB::VolumeIndexStore::evict(const std::string &keep) const
+{
+    CollectStoredFilesData data{path_, {}};
+
+    if(os_foreach_in_path(path_.c_str(), collect_stored_files, &data) < 0)
+        return;
+
+    size_t total_size = 0;
+
+    for(const auto &f : data.files_)
+        total_size += f.size_;
+
+    if(total_size <= maximum_size_)
+        return;
+
+    std::sort(data.files_.begin(), data.files_.end(),
+              [] (const StoredFile &a, const StoredFile &b)
+              {
+                  return a.mtime_.tv_sec < b.mtime_.tv_sec ||
+                         (a.mtime_.tv_sec == b.mtime_.tv_sec &&
+                          a.mtime_.tv_nsec < b.mtime_.tv_nsec);
+              });
+
+    /* the file just written is removed last */
+    std::stable_partition(data.files_.begin(), data.files_.end(),
+                          [&keep] (const StoredFile &f) { return f.filename_ != keep; });
+
+    for(const auto &f : data.files_)
+    {
+        if(total_size <= maximum_size_)
+            break;
+
+        if(unlink(f.filename_.c_str()) < 0)
+        {
+            msg_error(errno, LOG_NOTICE, "Failed removing volume index %s",
+                      f.filename_.c_str());
+            continue;
+        }
+
+        msg_vinfo(MESSAGE_LEVEL_DIAG, "Removed volume index %s", f.filename_.c_str());
+        total_size -= f.size_;
+    }
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef USB_VOLUME_INDEX_STORE_HH
+#define USB_VOLUME_INDEX_STORE_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cinttypes>
+#include <ctime>
+
+#include "usb_dir_index.hh"
+
+namespace USB
+{
+
+/*!
+ * On-disk layout of a stored volume index.
+ *
+ * A volume index file consists of a #USB::VolumeIndexFormat::FileHeader,
+ * followed by a table of #USB::VolumeIndexFormat::DirectoryRecord structures
+ * sorted by path, followed by a table of 32 bit name offsets, followed by a
+ * pool of zero-terminated strings. For each directory, the names of its
+ * entries are stored back to back in the pool, exactly as in a
+ * #USB::DirIndex, and the offsets are relative to the first name of the
+ * directory.
+ *
+ * All numbers are stored in host byte order and all records are naturally
+ * aligned, so that the file can be used straight from a read-only memory
+ * mapping.
+ */
+namespace VolumeIndexFormat
+{
+
+static constexpr char MAGIC[8] = { 'U', 'S', 'B', 'I', 'N', 'D', 'E', 'X' };
+static constexpr uint32_t VERSION = 1;
+
+struct FileHeader
+{
+    char magic_[8];
+    uint32_t version_;
+    uint32_t number_of_directories_;
+    uint32_t number_of_offsets_;
+    uint32_t size_of_strings_;
+
+    /*! Fingerprint of the file system, see #USB::VolumeIndexStore. */
+    uint64_t fingerprint_;
+};
+
+struct DirectoryRecord
+{
+    /*! Path of the directory, relative to the mountpoint. */
+    uint32_t path_offset_;
+    uint32_t path_length_;
+
+    /*! Modification time of the directory at the time it was read. */
+    int64_t mtime_sec_;
+    uint32_t mtime_nsec_;
+
+    uint32_t first_offset_;
+    uint32_t number_of_entries_;
+    uint32_t number_of_directories_;
+    uint32_t names_offset_;
+    uint32_t size_of_names_;
+};
+
+static_assert(sizeof(FileHeader) == 32, "Unexpected header size");
+static_assert(sizeof(DirectoryRecord) == 40, "Unexpected directory record size");
+
+}
+
+/*!
+ * Collect directory indexes of a volume and write them to a file.
+ */
+class VolumeIndexWriter
+{
+  private:
+    struct Directory
+    {
+        std::string path_;
+        struct timespec mtime_;
+        std::shared_ptr<const DirIndex> index_;
+    };
+
+    std::vector<Directory> directories_;
+
+  public:
+    VolumeIndexWriter(const VolumeIndexWriter &) = delete;
+    VolumeIndexWriter &operator=(const VolumeIndexWriter &) = delete;
+
+    explicit VolumeIndexWriter() {}
+
+    /*!
+     * Add directory index.
+     *
+     * The index must not have been modified since it was read from the file
+     * system so that its names are stored compactly.
+     */
+    void add_directory(std::string path, const struct timespec &mtime,
+                       std::shared_ptr<const DirIndex> index)
+    {
+        directories_.push_back({std::move(path), mtime, std::move(index)});
+    }
+
+    size_t get_number_of_directories() const { return directories_.size(); }
+
+    /*!
+     * Write index file.
+     *
+     * The file is written under a temporary name, then renamed to
+     * \p filename so that readers never see a partially written file.
+     */
+    bool write(const std::string &filename, uint64_t fingerprint);
+};
+
+/*!
+ * Read-only access to a stored volume index.
+ *
+ * The file is mapped into memory on #USB::VolumeIndexFile::open(), but only
+ * its header is checked at that point. Each directory is checked when it is
+ * looked up, so the pages of the file are only read from disk on demand.
+ *
+ * Once opened, all functions are thread-safe.
+ */
+class VolumeIndexFile
+{
+  private:
+    std::string filename_;
+    const uint8_t *mapped_;
+    size_t mapped_size_;
+
+    const VolumeIndexFormat::DirectoryRecord *directories_;
+    const uint32_t *offsets_;
+    const char *strings_;
+    uint32_t number_of_directories_;
+    uint32_t number_of_offsets_;
+    uint32_t size_of_strings_;
+
+  public:
+    VolumeIndexFile(const VolumeIndexFile &) = delete;
+    VolumeIndexFile &operator=(const VolumeIndexFile &) = delete;
+
+    explicit VolumeIndexFile():
+        mapped_(nullptr),
+        mapped_size_(0),
+        directories_(nullptr),
+        offsets_(nullptr),
+        strings_(nullptr),
+        number_of_directories_(0),
+        number_of_offsets_(0),
+        size_of_strings_(0)
+    {}
+
+    ~VolumeIndexFile() { close(); }
+
+    /*!
+     * Map index file into memory.
+     *
+     * \param filename
+     *     Name of the file to open.
+     *
+     * \param fingerprint
+     *     Expected fingerprint of the file system.
+     *
+     * \returns
+     *     True if the file exists, has a valid header, and matches the
+     *     fingerprint, false otherwise.
+     */
+    bool open(const std::string &filename, uint64_t fingerprint);
+
+    void close();
+
+    bool is_open() const { return mapped_ != nullptr; }
+
+    size_t get_number_of_directories() const { return number_of_directories_; }
+
+    /*!
+     * Restore index of given directory.
+     *
+     * \param path
+     *     Path of the directory, relative to the mountpoint.
+     *
+     * \param mtime
+     *     Current modification time of the directory. Directories modified
+     *     after they have been stored are not restored.
+     *
+     * \returns
+     *     The index, or \c nullptr if the directory is not stored, has been
+     *     modified, or is corrupt.
+     */
+    std::shared_ptr<const DirIndex>
+    lookup(const std::string &path, const struct timespec &mtime) const;
+
+  private:
+    bool find_directory(const std::string &path, uint32_t &idx) const;
+    bool check_directory(const VolumeIndexFormat::DirectoryRecord &d) const;
+    void reject(const char *reason);
+};
+
+/*!
+ * Directory of stored volume indexes.
+ *
+ * There is one #USB::VolumeIndexFile per volume in the store, named after
+ * the file system UUID reported by MounTA. The UUID alone is not trusted to
+ * identify a file system, though, as it is easily duplicated by imaging tools
+ * and, for FAT, only 32 bits wide. A fingerprint computed from the size of
+ * the file system is stored along with the index, and a stored index whose
+ * fingerprint does not match is ignored.
+ *
+ * The total size of all files in the store is limited. When the limit is
+ * exceeded, the least recently used files are removed first. Files are
+ * marked as used by setting their modification time.
+ *
+ * Only the worker thread of the #USB::VolumeCrawler writes to the store.
+ */
+class VolumeIndexStore
+{
+  private:
+    std::string path_;
+    size_t maximum_size_;
+
+  public:
+    VolumeIndexStore(const VolumeIndexStore &) = delete;
+    VolumeIndexStore &operator=(const VolumeIndexStore &) = delete;
+
+    explicit VolumeIndexStore():
+        maximum_size_(0)
+    {}
+
+    /*!
+     * Set directory and size limit, enabling the store.
+     *
+     * Must be called before any other function is called.
+     */
+    void configure(std::string &&path, size_t maximum_size)
+    {
+        path_ = std::move(path);
+        maximum_size_ = maximum_size;
+    }
+
+    bool is_enabled() const { return !path_.empty(); }
+
+    /*!
+     * Compute fingerprint of file system mounted at given path.
+     *
+     * \returns
+     *     The fingerprint, or 0 if the file system could not be inspected.
+     */
+    static uint64_t compute_fingerprint(const std::string &mountpoint);
+
+    /*!
+     * Open stored index of volume with given UUID, mark it as used.
+     */
+    bool open(const std::string &uuid, uint64_t fingerprint,
+              VolumeIndexFile &file) const;
+
+    /*!
+     * Write index of volume with given UUID, then enforce size limit.
+     */
+    bool write(const std::string &uuid, uint64_t fingerprint,
+               VolumeIndexWriter &writer) const;
+
+  private:
+    bool make_filename(const std::string &uuid, std::string &filename) const;
+    void evict(const std::string &keep) const;
+};
+
+}
+
+#endif /* !USB_VOLUME_INDEX_STORE_HH */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017--2020, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017--2020, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -416,12 +416,6 @@ class Object: public LRU::Entry
         }
     }
 
-    void enumerate_direct_sublists(const LRU::Cache &cache,
-                                   std::vector<ID::List> &nodes) const override
-    {
-        cut_fail("Unexpected child list enumeration");
-    }
-
     void obliviate_child(ID::List child_id, const LRU::Entry *child) override
     {
         auto it = std::find(children_.begin(), children_.end(), child_id);
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+
+#include "mock_messages.hh"
+
+#include "lists.hh"
+
+/*!
+ * \addtogroup lists_child_index_tests Unit tests
+ * \ingroup lru
+ *
+ * Lookup of items by child list ID.
+ */
+/*!@{*/
+
+static Timebase real_timebase;
+Timebase *LRU::timebase = &real_timebase;
+
+namespace lists_child_index_tests
+{
+
+class ItemData
+{
+  public:
+    unsigned int value_;
+
+    explicit ItemData(unsigned int value = 0): value_(value) {}
+
+    void reset() { value_ = 0; }
+    size_t get_heap_size() const { return 0; }
+};
+
+class List: public FlatList<ItemData>
+{
+  public:
+    List(const List &) = delete;
+    List &operator=(const List &) = delete;
+
+    explicit List(): FlatList<ItemData>(nullptr) {}
+
+    void enumerate_tree_of_sublists(const LRU::Cache &cache,
+                                    std::vector<ID::List> &nodes,
+                                    bool append_to_nodes) const override
+    {
+        cut_fail("Unexpected subtree enumeration");
+    }
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override
+    {
+        ID::Item idx;
+
+        if(lookup_item_id_by_child_id(child_id, idx))
+            unlink_child_list(idx);
+    }
+
+    void append(unsigned int value)
+    {
+        ListItem_<ItemData> item;
+        item.get_specific_data() = ItemData(value);
+        append_unsorted(std::move(item));
+    }
+};
+
+static MockMessages *mock_messages;
+static List *list;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_DIAG);
+
+    list = new List;
+
+    for(unsigned int i = 0; i < 10; ++i)
+        list->append(i);
+}
+
+void cut_teardown(void)
+{
+    delete list;
+    list = nullptr;
+
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+static void expect_item(unsigned int child_id, unsigned int expected_idx,
+                        unsigned int expected_value)
+{
+    ID::Item idx;
+    cut_assert_true(list->lookup_item_id_by_child_id(ID::List(child_id), idx));
+    cppcut_assert_equal(expected_idx, idx.get_raw_id());
+
+    const auto *item = list->lookup_child_by_id(ID::List(child_id));
+    cppcut_assert_not_null(item);
+    cppcut_assert_equal(expected_value, item->get_specific_data().value_);
+}
+
+static void expect_item(unsigned int child_id, unsigned int expected_idx)
+{
+    expect_item(child_id, expected_idx, expected_idx);
+}
+
+static void expect_no_item(unsigned int child_id)
+{
+    ID::Item idx(1234);
+    cut_assert_false(list->lookup_item_id_by_child_id(ID::List(child_id), idx));
+    cppcut_assert_equal(1234U, idx.get_raw_id());
+    cppcut_assert_null(list->lookup_child_by_id(ID::List(child_id)));
+}
+
+/*!\test
+ * Items linked to child lists are found by child list ID.
+ */
+void test_linked_items_are_found()
+{
+    list->link_child_list(ID::Item(3), ID::List(20));
+    list->link_child_list(ID::Item(0), ID::List(21));
+    list->link_child_list(ID::Item(9), ID::List(22));
+
+    expect_item(20, 3);
+    expect_item(21, 0);
+    expect_item(22, 9);
+    expect_no_item(23);
+    cppcut_assert_equal(20U, (*list)[ID::Item(3)].get_child_list().get_raw_id());
+}
+
+/*!\test
+ * Unlinked items are not found anymore.
+ */
+void test_unlinked_items_are_not_found()
+{
+    list->link_child_list(ID::Item(3), ID::List(20));
+    list->link_child_list(ID::Item(4), ID::List(21));
+
+    list->obliviate_child(ID::List(20), nullptr);
+
+    expect_no_item(20);
+    expect_item(21, 4);
+    cut_assert_false((*list)[ID::Item(3)].get_child_list().is_valid());
+
+    list->link_child_list(ID::Item(3), ID::List(20));
+    expect_item(20, 3);
+}
+
+/*!\test
+ * Child list IDs may be reused for other items after unlinking.
+ */
+void test_reused_child_list_id_is_found_at_new_item()
+{
+    list->link_child_list(ID::Item(3), ID::List(20));
+    list->unlink_child_list(ID::Item(3));
+    list->link_child_list(ID::Item(7), ID::List(20));
+
+    expect_item(20, 7);
+}
+
+/*!\test
+ * Inserting and removing items moves the linked items in the index.
+ */
+void test_index_follows_inserted_and_removed_items()
+{
+    list->link_child_list(ID::Item(2), ID::List(20));
+    list->link_child_list(ID::Item(5), ID::List(21));
+
+    ListItem_<ItemData> item;
+    item.get_specific_data() = ItemData(100);
+    list->insert_before(3, std::move(item));
+
+    expect_item(20, 2);
+    expect_item(21, 6, 5);
+
+    cppcut_assert_equal(20U, list->FIXME_remove(ID::Item(2)).get_raw_id());
+
+    expect_no_item(20);
+    expect_item(21, 5, 5);
+}
+
+/*!\test
+ * Child lists dropped without telling the list are not found.
+ */
+void test_stale_entries_are_not_found()
+{
+    list->link_child_list(ID::Item(3), ID::List(20));
+    (*list)[ID::Item(3)].obliviate_child();
+
+    expect_no_item(20);
+}
+
+/*!\test
+ * Child list IDs are read from the item at the given index.
+ */
+void test_lookup_child_list_by_item_index()
+{
+    list->link_child_list(ID::Item(3), ID::List(20));
+
+    cppcut_assert_equal(20U, list->lookup_child_list(ID::Item(3)).get_raw_id());
+    cut_assert_false(list->lookup_child_list(ID::Item(4)).is_valid());
+}
+
+}
+
+/*!@}*/
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2020, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2020, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -364,10 +364,10 @@ class ItemGenerator: public TiledListFillerIface<UPnP::ItemData>
             os.str("");
             os << "Generated item " << idx.get_raw_id();
 
-            *item_provider.next() =
-                std::move(UPnP::ItemData(std::move(temp), std::move(os.str()),
-                                         std::move(Url::String(Url::Sensitivity::GENERIC)),
-                                         generate_directories_));
+            StringArena *strings;
+            UPnP::ItemData *item = item_provider.next(strings);
+            *item = UPnP::ItemData(*strings, temp, os.str(), "",
+                                   generate_directories_);
 
             idx = ID::Item(idx.get_raw_id() + 1);
         }
@@ -486,7 +486,7 @@ static void check_list_generated_by_item_generator(std::shared_ptr<const UPnP::M
         os.clear();
         os.str("");
         os << "dbus-" << list->get_cache_id().get_raw_id() << "-" << i;
-        cppcut_assert_equal(os.str(), item.get_specific_data().get_dbus_path());
+        cppcut_assert_equal(os.str(), item.get_specific_data().get_dbus_path_copy());
 
         cut_assert_false(item.get_kind().is_directory());
     }
@@ -801,6 +801,70 @@ void test_walk_up_long_server_list()
     filler.check();
 }
 
+/*!\test
+ * Walking back up in a long server list takes tiles from the cold store.
+ *
+ * Tiles evicted while walking down are kept in cold store, so no items are
+ * requested from the server again when walking back up.
+ */
+void test_walk_down_and_back_up_long_server_list_uses_cold_tiles()
+{
+    cppcut_assert_operator(3U * UPnP::media_list_tile_size, <, 83U);
+
+    ItemGenerator filler(83, false,
+                         5 * UPnP::media_list_tile_size + 83 % UPnP::media_list_tile_size,
+                         6 * UPnP::media_list_tile_size);
+    ID::List child_id = prepare_enter_server_test(filler);
+    auto child_list = std::static_pointer_cast<const UPnP::MediaList>(cache->lookup(child_id));
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "prefetch 1 items, starting at index 0");
+    (void)(*child_list)[ID::Item(0)];
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "slide down to index 8");
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "materialize adjacent tile around index 16");
+    (void)(*child_list)[ID::Item(UPnP::media_list_tile_size)];
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "slide down to index 16");
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "materialize adjacent tile around index 24");
+    (void)(*child_list)[ID::Item(2 * UPnP::media_list_tile_size)];
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "slide down to index 24");
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "materialize adjacent tile around index 32");
+    (void)(*child_list)[ID::Item(3 * UPnP::media_list_tile_size)];
+
+    /* walking back up, evicted tiles are promoted from the cold store */
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "slide up to index 16");
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "materialize adjacent tile around index 8");
+    (void)(*child_list)[ID::Item(2 * UPnP::media_list_tile_size)];
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "slide up to index 8");
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "materialize adjacent tile around index 0");
+    (void)(*child_list)[ID::Item(UPnP::media_list_tile_size)];
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "slide up to index 0");
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "materialize adjacent tile around index 82");
+    (void)(*child_list)[ID::Item(0)];
+    check_list_generated_by_item_generator(child_list,
+                                           0 * UPnP::media_list_tile_size,
+                                           1 * UPnP::media_list_tile_size,
+                                           false);
+
+    filler.check();
+}
+
 /*!\test
  * Randomly access items in a long server list.
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015, 2016, 2018--2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015, 2016, 2018--2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -25,6 +25,11 @@
 
 #include <cppcutter.h>
 #include <array>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
 
 #include "mock_messages.hh"
 #include "mock_backtrace.hh"
@@ -165,12 +170,6 @@ class Object: public LRU::Entry
         cut_fail("Unexpected subtree enumeration");
     }
 
-    void enumerate_direct_sublists(const LRU::Cache &cache,
-                                   std::vector<ID::List> &nodes) const override
-    {
-        cut_fail("Unexpected child list enumeration");
-    }
-
     void obliviate_child(ID::List child_id, const LRU::Entry *child) override
     {
         obliviate_expectations->obliviate_child(get_cache_id(),
@@ -338,6 +337,53 @@ void test_exceeding_memory_limits_by_setting_size_of_object_triggers_gc(void)
     cppcut_assert_equal(size_t(0), cache->count());
 }
 
+/*!\test
+ * Exceeding only the soft memory limit by growing an object leaves garbage
+ * collection to the callback.
+ */
+void test_exceeding_soft_memory_limit_by_setting_size_of_object_requests_gc(void)
+{
+    unsigned int gc_requests = 0;
+    cache->set_callbacks([]{}, [&gc_requests] { ++gc_requests; },
+                         [] (ID::List id) {}, []{});
+
+    cut_assert_true(cache->set_object_size(root->get_cache_id(), 450));
+    cppcut_assert_equal(0U, gc_requests);
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_IMPORTANT,
+                                              "Soft memory limit exceeded by new size 500 of object 1, attempting to collect garbage");
+    cut_assert_true(cache->set_object_size(root->get_cache_id(), 500));
+    cppcut_assert_equal(1U, gc_requests);
+
+    cut_assert_true(cache->set_object_size(root->get_cache_id(), 500));
+    cppcut_assert_equal(1U, gc_requests);
+    cppcut_assert_equal(size_t(1), cache->count());
+}
+
+/*!\test
+ * Hard limits are enforced right away when inserting an object, remaining
+ * work is left to garbage collection requested via callback.
+ */
+void test_exceeding_hard_memory_limit_by_inserting_object_discards_objects(void)
+{
+    unsigned int gc_requests = 0;
+    cache->set_callbacks([]{}, [&gc_requests] { ++gc_requests; },
+                         [] (ID::List id) {}, []{});
+
+    std::shared_ptr<LRU::Entry> obj = std::make_shared<Object>(root, 456);
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_IMPORTANT,
+                                              "Hard memory limit exceeded by size 450 of new object 2, attempting to collect garbage");
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_IMPORTANT,
+                                              "Discarding hot object 2 (size exceeded, count not exceeded)");
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(2));
+
+    cppcut_assert_equal(2U, cache->insert(std::move(obj), LRU::CacheMode::CACHED,
+                                          0, 450).get_raw_id());
+    cppcut_assert_equal(1U, gc_requests);
+    cppcut_assert_equal(size_t(1), cache->count());
+}
+
 };
 
 
@@ -370,6 +416,7 @@ void cut_setup(void)
     mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_TRACE);
 
     mock_timebase.reset();
+    LRU::Statistics::get_singleton().reset();
 
     cache = new LRU::Cache(1024UL * 1024UL, maximum_number_of_objects,
                            std::chrono::minutes(maximum_object_age_minutes));
@@ -596,6 +643,126 @@ void test_insert_and_lookup_multiple_elements(void)
     check_aging_list(std::array<unsigned int, data_array.size()>({789, 456, 123}));
 }
 
+/*!\test
+ * All cached objects are passed to the function, in aging list order.
+ */
+void test_for_each_entry_visits_oldest_first(void)
+{
+    std::shared_ptr<LRU::Entry> root = add_object(nullptr, 123);
+    std::shared_ptr<LRU::Entry> a = add_object(root, 456);
+    (void)add_object(a, 789);
+
+    std::vector<unsigned int> visited;
+    cache->for_each_entry(
+        [&visited] (const LRU::Entry &e)
+        {
+            visited.push_back(static_cast<const Object &>(e).dummy_data_);
+        });
+
+    cppcut_assert_equal(size_t(3), visited.size());
+    cppcut_assert_equal(789U, visited[0]);
+    cppcut_assert_equal(456U, visited[1]);
+    cppcut_assert_equal(123U, visited[2]);
+}
+
+/*!\test
+ * The function passed to LRU::Cache::for_each_entry() may modify the cache.
+ */
+void test_for_each_entry_allows_using_objects(void)
+{
+    std::shared_ptr<LRU::Entry> root = add_object(nullptr, 123);
+    std::shared_ptr<LRU::Entry> a = add_object(root, 456);
+    (void)add_object(a, 789);
+
+    mock_timebase.step();
+
+    size_t visited = 0;
+    cache->for_each_entry(
+        [&visited] (const LRU::Entry &e)
+        {
+            cppcut_assert_not_equal(LRU::Cache::USED_ENTRY_INVALID_ID,
+                                    cache->use(e.get_cache_id()));
+            ++visited;
+        });
+
+    cppcut_assert_equal(size_t(3), visited);
+    cppcut_assert_equal(0L, root->get_age().count());
+}
+
+/*!\test
+ * Subtrees are enumerated breadth-first through the cached child objects.
+ */
+void test_enumerate_subtree(void)
+{
+    std::array<ID::List, 5> ids;
+    std::shared_ptr<LRU::Entry> root = add_object(nullptr, 0, &ids[0]);
+    std::shared_ptr<LRU::Entry> a = add_object(root, 1, &ids[1]);
+    (void)add_object(a, 2, &ids[2]);
+    (void)add_object(a, 3, &ids[3]);
+    (void)add_object(root, 4, &ids[4]);
+
+    cppcut_assert_equal(size_t(2), a->get_number_of_children());
+
+    std::vector<ID::List> nodes;
+    cache->enumerate_subtree(*root, nodes);
+
+    static const std::array<size_t, 5> expected_root = {0, 1, 4, 2, 3};
+    cppcut_assert_equal(expected_root.size(), nodes.size());
+
+    for(size_t i = 0; i < expected_root.size(); ++i)
+        cppcut_assert_equal(ids[expected_root[i]].get_raw_id(), nodes[i].get_raw_id());
+
+    nodes.clear();
+    cache->enumerate_subtree(*a, nodes);
+
+    cppcut_assert_equal(size_t(3), nodes.size());
+    cppcut_assert_equal(ids[1].get_raw_id(), nodes[0].get_raw_id());
+    cppcut_assert_equal(ids[2].get_raw_id(), nodes[1].get_raw_id());
+    cppcut_assert_equal(ids[3].get_raw_id(), nodes[2].get_raw_id());
+
+    /* IDs are appended */
+    cache->enumerate_subtree(*cache->lookup(ids[4]), nodes);
+
+    cppcut_assert_equal(size_t(4), nodes.size());
+    cppcut_assert_equal(ids[4].get_raw_id(), nodes[3].get_raw_id());
+}
+
+/*!\test
+ * Purged objects are not enumerated anymore.
+ */
+void test_purged_subtree_is_unlinked_from_parent(void)
+{
+    std::array<ID::List, 5> ids;
+    std::shared_ptr<LRU::Entry> root = add_object(nullptr, 0, &ids[0]);
+    std::shared_ptr<LRU::Entry> a = add_object(root, 1, &ids[1]);
+    (void)add_object(a, 2, &ids[2]);
+    (void)add_object(a, 3, &ids[3]);
+    (void)add_object(root, 4, &ids[4]);
+
+    std::vector<ID::List> kill_list;
+    cache->enumerate_subtree(*a, kill_list);
+    cut_assert_true(cache->toposort_for_purge(kill_list.begin(), kill_list.end()));
+
+    for(const auto &id : kill_list)
+        mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_IMPORTANT,
+                                                  ("Purge entry " + std::to_string(id.get_raw_id())).c_str());
+
+    obliviate_expectations->expect_obliviate_child(ids[1], kill_list[0]);
+    obliviate_expectations->expect_obliviate_child(ids[1], kill_list[1]);
+    obliviate_expectations->expect_obliviate_child(ids[0], ids[1]);
+    cache->purge_entries(kill_list.begin(), kill_list.end());
+
+    cppcut_assert_equal(size_t(2), cache->count());
+    cppcut_assert_equal(size_t(1), root->get_number_of_children());
+
+    std::vector<ID::List> nodes;
+    cache->enumerate_subtree(*root, nodes);
+
+    cppcut_assert_equal(size_t(2), nodes.size());
+    cppcut_assert_equal(ids[0].get_raw_id(), nodes[0].get_raw_id());
+    cppcut_assert_equal(ids[4].get_raw_id(), nodes[1].get_raw_id());
+}
+
 /*!\test
  * Run garbage collection on cache with one fresh (non-gc'ed) entry.
  */
@@ -772,6 +939,382 @@ void test_gc_multiple_expired_elements_with_unequal_ages(void)
     cppcut_assert_equal(size_t(0), cache->count());
 }
 
+static void add_expired_children_for_gc_slice_tests(std::shared_ptr<LRU::Entry> &root,
+                                                    unsigned int count)
+{
+    ID::List id;
+    root = add_object(nullptr, 100, &id);
+
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        mock_timebase.step();
+        (void)add_object(root, 101 + i, &id);
+    }
+
+    cppcut_assert_equal(size_t(count + 1), cache->count());
+
+    mock_timebase.step(std::chrono::milliseconds(maximum_object_age_minutes).count());
+}
+
+/*!\test
+ * Garbage collection with limited number of discards is done in multiple
+ * slices, each continuing where the previous one stopped.
+ */
+void test_gc_slices_are_limited_by_number_of_discards(void)
+{
+    std::shared_ptr<LRU::Entry> root;
+    add_expired_children_for_gc_slice_tests(root, 10);
+
+    const LRU::GCBudget budget(4, std::chrono::milliseconds(1000));
+    bool is_incomplete;
+
+    for(unsigned int i = 2; i <= 5; ++i)
+        obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(i));
+
+    auto duration = cache->gc(budget, is_incomplete);
+    cut_assert_true(is_incomplete);
+    assert_equal_times(std::chrono::seconds(0), duration);
+    cppcut_assert_equal(size_t(7), cache->count());
+    obliviate_expectations->check();
+    check_aging_list(std::array<unsigned int, 7>({105, 106, 107, 108, 109, 110, 100}));
+
+    for(unsigned int i = 6; i <= 9; ++i)
+        obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(i));
+
+    duration = cache->gc(budget, is_incomplete);
+    cut_assert_true(is_incomplete);
+    cppcut_assert_equal(size_t(3), cache->count());
+    obliviate_expectations->check();
+
+    /* the last two children and the root object */
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(10));
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(11));
+
+    duration = cache->gc(budget, is_incomplete);
+    cut_assert_false(is_incomplete);
+    assert_equal_times(std::chrono::seconds::max(), duration);
+    cppcut_assert_equal(size_t(0), cache->count());
+}
+
+/*!\test
+ * A slice of garbage collection stops after its maximum duration, exceeding
+ * it by at most the time it takes to discard a single object.
+ */
+void test_gc_slices_are_limited_by_duration(void)
+{
+    static constexpr unsigned int time_per_discard_ms = 3;
+    static constexpr std::chrono::milliseconds max_duration(10);
+
+    /* simulate expensive removal of objects */
+    cache->set_callbacks([]{}, []{},
+                         [] (ID::List id) { mock_timebase.step(time_per_discard_ms); },
+                         []{});
+
+    std::shared_ptr<LRU::Entry> root;
+    add_expired_children_for_gc_slice_tests(root, 20);
+
+    for(unsigned int i = 2; i <= 21; ++i)
+        obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(i));
+
+    const LRU::GCBudget budget(1000, max_duration);
+    bool is_incomplete = true;
+    size_t slices = 0;
+
+    while(is_incomplete)
+    {
+        const size_t count_before = cache->count();
+        const auto slice_start = mock_timebase.now();
+
+        (void)cache->gc(budget, is_incomplete);
+
+        const auto slice_duration = mock_timebase.now() - slice_start;
+        cppcut_assert_operator(std::chrono::milliseconds(max_duration + std::chrono::milliseconds(time_per_discard_ms)).count(),
+                               >, std::chrono::duration_cast<std::chrono::milliseconds>(slice_duration).count());
+        cppcut_assert_operator(count_before, >, cache->count());
+
+        ++slices;
+        cppcut_assert_operator(size_t(10), >, slices);
+    }
+
+    /* 4 discards per slice, 21 objects */
+    cppcut_assert_equal(size_t(6), slices);
+    cppcut_assert_equal(size_t(0), cache->count());
+}
+
+/*!\test
+ * Objects used between two slices of garbage collection are not discarded,
+ * and objects older than them still are.
+ */
+void test_gc_slice_continues_correctly_after_use_of_object(void)
+{
+    std::shared_ptr<LRU::Entry> root;
+    add_expired_children_for_gc_slice_tests(root, 6);
+
+    const LRU::GCBudget budget(2, std::chrono::milliseconds(1000));
+    bool is_incomplete;
+
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(2));
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(3));
+    (void)cache->gc(budget, is_incomplete);
+    cut_assert_true(is_incomplete);
+    obliviate_expectations->check();
+
+    /* object 4 is next in line, but is used now */
+    cache->use(ID::List(4));
+
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(5));
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(6));
+    (void)cache->gc(budget, is_incomplete);
+    cut_assert_true(is_incomplete);
+    obliviate_expectations->check();
+
+    obliviate_expectations->expect_obliviate_child(ID::List(1), ID::List(7));
+    auto duration = cache->gc(budget, is_incomplete);
+    cut_assert_false(is_incomplete);
+    obliviate_expectations->check();
+
+    cppcut_assert_equal(size_t(2), cache->count());
+    check_aging_list(std::array<unsigned int, 2>({103, 100}));
+    assert_equal_times(std::chrono::seconds(maximum_object_age_minutes), duration);
+}
+
+/*
+ * Replace cache by one which discards objects down to 700 bytes as soon as
+ * 900 bytes are exceeded.
+ */
+static void replace_cache_for_eviction_tests(LRU::EvictionPolicy policy)
+{
+    delete cache;
+
+    cache = new LRU::Cache(1000, maximum_number_of_objects,
+                           std::chrono::minutes(maximum_object_age_minutes),
+                           900, 700);
+    cppcut_assert_not_null(cache);
+    cache->set_callbacks([]{}, []{}, [] (ID::List id) {}, []{});
+
+    if(policy == LRU::EvictionPolicy::GREEDY_DUAL_SIZE)
+    {
+        mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DIAG,
+                                                  "Cache eviction policy: GreedyDual-Size");
+        cache->set_eviction_policy(policy);
+    }
+
+    cut_assert_true(cache->get_eviction_policy() == policy);
+}
+
+static std::shared_ptr<LRU::Entry>
+add_object_with_refill_cost(const std::shared_ptr<LRU::Entry> &parent,
+                            std::chrono::microseconds cost, size_t object_size,
+                            ID::List &object_id)
+{
+    mock_timebase.step();
+
+    std::shared_ptr<LRU::Entry> obj = std::make_shared<Object>(parent);
+    obj->set_refill_cost(cost);
+    object_id = cache->insert(std::shared_ptr<LRU::Entry>(obj),
+                              LRU::CacheMode::CACHED, 0, object_size);
+    cut_assert_true(object_id.is_valid());
+
+    return obj;
+}
+
+/*
+ * Root with three children of 300 bytes each. The first child is expensive
+ * to refill, the second one is cheap, the third one is the hot object.
+ */
+static void add_objects_for_eviction_tests(ID::List &expensive_id,
+                                           ID::List &cheap_id,
+                                           ID::List &hot_id)
+{
+    ID::List root_id;
+    std::shared_ptr<LRU::Entry> root =
+        add_object_with_refill_cost(nullptr, std::chrono::microseconds(0),
+                                    10, root_id);
+
+    add_object_with_refill_cost(root, std::chrono::seconds(2), 300, expensive_id);
+    add_object_with_refill_cost(root, std::chrono::milliseconds(1), 300, cheap_id);
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_IMPORTANT,
+                                              "Soft memory limit exceeded by size 300 of new object 4, attempting to collect garbage");
+    add_object_with_refill_cost(root, std::chrono::milliseconds(1), 300, hot_id);
+    cppcut_assert_equal(size_t(4), cache->count());
+}
+
+/*!\test
+ * In LRU mode, the least recently used object is discarded under memory
+ * pressure, regardless of its refill cost.
+ */
+void test_lru_eviction_ignores_refill_cost()
+{
+    replace_cache_for_eviction_tests(LRU::EvictionPolicy::LEAST_RECENTLY_USED);
+
+    ID::List expensive_id;
+    ID::List cheap_id;
+    ID::List hot_id;
+    add_objects_for_eviction_tests(expensive_id, cheap_id, hot_id);
+
+    obliviate_expectations->expect_obliviate_child(ID::List(1), expensive_id);
+    cache->gc();
+
+    cppcut_assert_equal(size_t(3), cache->count());
+    cppcut_assert_null(cache->lookup(expensive_id).get());
+    cppcut_assert_not_null(cache->lookup(cheap_id).get());
+    cppcut_assert_not_null(cache->lookup(hot_id).get());
+}
+
+/*!\test
+ * In GreedyDual-Size mode, an object which is cheap to refill is discarded
+ * under memory pressure before an older, but expensive object.
+ */
+void test_gds_eviction_discards_cheap_objects_first()
+{
+    replace_cache_for_eviction_tests(LRU::EvictionPolicy::GREEDY_DUAL_SIZE);
+
+    ID::List expensive_id;
+    ID::List cheap_id;
+    ID::List hot_id;
+    add_objects_for_eviction_tests(expensive_id, cheap_id, hot_id);
+
+    obliviate_expectations->expect_obliviate_child(ID::List(1), cheap_id);
+    cache->gc();
+
+    cppcut_assert_equal(size_t(3), cache->count());
+    cppcut_assert_not_null(cache->lookup(expensive_id).get());
+    cppcut_assert_null(cache->lookup(cheap_id).get());
+    cppcut_assert_not_null(cache->lookup(hot_id).get());
+}
+
+/*!\test
+ * In GreedyDual-Size mode, inner objects become candidates for eviction as
+ * soon as all their children have been discarded.
+ */
+void test_gds_eviction_discards_parents_after_their_children()
+{
+    replace_cache_for_eviction_tests(LRU::EvictionPolicy::GREEDY_DUAL_SIZE);
+
+    ID::List root_id;
+    ID::List expensive_id;
+    ID::List inner_id;
+    ID::List leaf_id;
+    ID::List hot_id;
+
+    std::shared_ptr<LRU::Entry> root =
+        add_object_with_refill_cost(nullptr, std::chrono::microseconds(0),
+                                    10, root_id);
+    add_object_with_refill_cost(root, std::chrono::seconds(2), 300, expensive_id);
+    std::shared_ptr<LRU::Entry> inner =
+        add_object_with_refill_cost(root, std::chrono::microseconds(100),
+                                    250, inner_id);
+    add_object_with_refill_cost(inner, std::chrono::microseconds(100),
+                                250, leaf_id);
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_IMPORTANT,
+                                              "Soft memory limit exceeded by size 150 of new object 5, attempting to collect garbage");
+    add_object_with_refill_cost(root, std::chrono::microseconds(100), 150, hot_id);
+    inner = nullptr;
+
+    obliviate_expectations->expect_obliviate_child(inner_id, leaf_id);
+    obliviate_expectations->expect_obliviate_child(root_id, inner_id);
+    cache->gc();
+
+    cppcut_assert_equal(size_t(3), cache->count());
+    cppcut_assert_not_null(cache->lookup(expensive_id).get());
+    cppcut_assert_null(cache->lookup(inner_id).get());
+    cppcut_assert_null(cache->lookup(leaf_id).get());
+    cppcut_assert_not_null(cache->lookup(hot_id).get());
+}
+
+/*!\test
+ * Objects inserted before switching to GreedyDual-Size mode are considered
+ * for eviction, except for pinned objects.
+ */
+void test_gds_eviction_after_switching_policy_skips_pinned_objects()
+{
+    replace_cache_for_eviction_tests(LRU::EvictionPolicy::LEAST_RECENTLY_USED);
+
+    ID::List expensive_id;
+    ID::List cheap_id;
+    ID::List hot_id;
+    add_objects_for_eviction_tests(expensive_id, cheap_id, hot_id);
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DIAG,
+                                              "Cache eviction policy: GreedyDual-Size");
+    cache->set_eviction_policy(LRU::EvictionPolicy::GREEDY_DUAL_SIZE);
+    cut_assert_true(cache->pin(cheap_id));
+
+    obliviate_expectations->expect_obliviate_child(ID::List(1), expensive_id);
+    cache->gc();
+
+    cppcut_assert_equal(size_t(3), cache->count());
+    cppcut_assert_null(cache->lookup(expensive_id).get());
+    cppcut_assert_not_null(cache->lookup(cheap_id).get());
+    cppcut_assert_not_null(cache->lookup(hot_id).get());
+}
+
+/*!\test
+ * Cache lookups are counted as hits or misses.
+ */
+void test_statistics_count_lookup_hits_and_misses()
+{
+    const auto &stats(LRU::Statistics::get_singleton());
+
+    ID::List id;
+    (void)add_object(nullptr, 0, &id);
+    cppcut_assert_equal(uint64_t(1), stats.get(LRU::Statistics::Counter::INSERTIONS));
+
+    cppcut_assert_not_null(cache->lookup(id).get());
+    cppcut_assert_not_null(cache->lookup(id).get());
+    cppcut_assert_null(cache->lookup(ID::List(id.get_raw_id() + 1)).get());
+
+    cppcut_assert_equal(uint64_t(2), stats.get(LRU::Statistics::Counter::LOOKUP_HITS));
+    cppcut_assert_equal(uint64_t(1), stats.get(LRU::Statistics::Counter::LOOKUP_MISSES));
+}
+
+/*!\test
+ * Objects discarded by the garbage collector and purged objects are counted
+ * separately, along with their sizes.
+ */
+void test_statistics_count_discarded_objects_by_reason()
+{
+    const auto &stats(LRU::Statistics::get_singleton());
+
+    replace_cache_for_eviction_tests(LRU::EvictionPolicy::LEAST_RECENTLY_USED);
+
+    ID::List expensive_id;
+    ID::List cheap_id;
+    ID::List hot_id;
+    add_objects_for_eviction_tests(expensive_id, cheap_id, hot_id);
+
+    obliviate_expectations->expect_obliviate_child(ID::List(1), expensive_id);
+    cache->gc();
+
+    cppcut_assert_equal(uint64_t(1), stats.get(LRU::Statistics::Counter::DISCARDED_BY_SOFT_LIMIT));
+    cppcut_assert_equal(uint64_t(300), stats.get(LRU::Statistics::Counter::BYTES_DISCARDED_BY_SOFT_LIMIT));
+
+    std::vector<ID::List> kill_list{cheap_id};
+    cut_assert_true(cache->toposort_for_purge(kill_list.begin(), kill_list.end()));
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_IMPORTANT,
+                                              ("Purge entry " + std::to_string(cheap_id.get_raw_id())).c_str());
+    obliviate_expectations->expect_obliviate_child(ID::List(1), cheap_id);
+    cache->purge_entries(kill_list.begin(), kill_list.end());
+
+    cppcut_assert_equal(uint64_t(1), stats.get(LRU::Statistics::Counter::PURGED));
+    cppcut_assert_equal(uint64_t(300), stats.get(LRU::Statistics::Counter::BYTES_PURGED));
+
+    mock_timebase.step(std::chrono::milliseconds(maximum_object_age_minutes).count());
+    obliviate_expectations->expect_obliviate_child(ID::List(1), hot_id);
+    cache->gc();
+
+    cppcut_assert_equal(size_t(0), cache->count());
+    cppcut_assert_equal(uint64_t(2), stats.get(LRU::Statistics::Counter::DISCARDED_BY_AGE));
+    cppcut_assert_equal(uint64_t(310), stats.get(LRU::Statistics::Counter::BYTES_DISCARDED_BY_AGE));
+    cppcut_assert_equal(uint64_t(0), stats.get(LRU::Statistics::Counter::DISCARDED_BY_HARD_LIMIT));
+
+    LRU::Statistics::Buckets buckets;
+    stats.get(LRU::Statistics::Histogram::GC_DURATION, buckets);
+    cppcut_assert_equal(uint64_t(2), buckets[0]);
+}
+
 /*!\test
  * Given an object A that was created before object B, attempting to insert A
  * into the cache after B has been inserted fails.
@@ -1949,27 +2492,12 @@ void cut_teardown(void)
     obliviate_expectations = nullptr;
 }
 
-static bool return_always_ok(ID::List id)
-{
-    return true;
-}
-
-static bool return_never_ok(ID::List id)
-{
-    return false;
-}
-
-static bool reject_all_smaller_than_2000(ID::List id)
-{
-    return id.get_cooked_id() >= 2000;
-}
-
 /*!\test
  * Cached IDs are assigned in ascending order.
  */
 void test_counts_up_cached()
 {
-    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX, return_always_ok);
+    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX);
     cppcut_assert_not_null(gen);
 
     cppcut_assert_equal(uint32_t(0xe0000001), gen->next(LRU::CacheMode::CACHED, 14).get_raw_id());
@@ -1983,7 +2511,7 @@ void test_counts_up_cached()
  */
 void test_counts_up_uncached()
 {
-    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX, return_always_ok);
+    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX);
     cppcut_assert_not_null(gen);
 
     cppcut_assert_equal(uint32_t(0x58000001), gen->next(LRU::CacheMode::UNCACHED, 5).get_raw_id());
@@ -1998,7 +2526,7 @@ void test_counts_up_uncached()
  */
 void test_counts_up_with_single_counter_for_cached_and_uncached()
 {
-    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX, return_always_ok);
+    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX);
     cppcut_assert_not_null(gen);
 
     cppcut_assert_equal(uint32_t(0xf0000001), gen->next(LRU::CacheMode::CACHED,   15).get_raw_id());
@@ -2016,7 +2544,7 @@ void test_counts_up_with_context()
 {
     cppcut_assert_equal(15U, DBUS_LISTS_CONTEXT_ID_MAX);
 
-    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX, return_always_ok);
+    gen = new LRU::CacheIdGenerator(1, LRU::CacheIdGenerator::ID_MAX);
     cppcut_assert_not_null(gen);
 
     cppcut_assert_equal(uint32_t(0x00000001), gen->next(LRU::CacheMode::CACHED, 0).get_raw_id());
@@ -2087,21 +2615,35 @@ void test_invalid_id_with_context()
         cut_assert_false(id.is_valid());
 }
 
+/*!
+ * Get next ID and release it right away, as if the object it had been
+ * assigned to was discarded immediately.
+ */
+static uint32_t next_and_release(LRU::CacheMode cache_mode,
+                                 ID::List::context_t ctx)
+{
+    const ID::List id = gen->next(cache_mode, ctx);
+    cut_assert_true(gen->is_used(id));
+    cut_assert_true(gen->release(id));
+    cut_assert_false(gen->is_used(id));
+    return id.get_raw_id();
+}
+
 /*!\test
  * When reaching the maximum ID, is returned. Next ID starts at minimum.
  */
 void test_wraps_around()
 {
-    gen = new LRU::CacheIdGenerator(10, 12, return_always_ok);
+    gen = new LRU::CacheIdGenerator(10, 12);
     cppcut_assert_not_null(gen);
 
-    cppcut_assert_equal(uint32_t(0x3000000a), gen->next(LRU::CacheMode::CACHED, 3).get_raw_id());
-    cppcut_assert_equal(uint32_t(0x3000000b), gen->next(LRU::CacheMode::CACHED, 3).get_raw_id());
-    cppcut_assert_equal(uint32_t(0x3000000c), gen->next(LRU::CacheMode::CACHED, 3).get_raw_id());
-    cppcut_assert_equal(uint32_t(0x3000000a), gen->next(LRU::CacheMode::CACHED, 3).get_raw_id());
-    cppcut_assert_equal(uint32_t(0x3000000b), gen->next(LRU::CacheMode::CACHED, 3).get_raw_id());
-    cppcut_assert_equal(uint32_t(0x3000000c), gen->next(LRU::CacheMode::CACHED, 3).get_raw_id());
-    cppcut_assert_equal(uint32_t(0x3000000a), gen->next(LRU::CacheMode::CACHED, 3).get_raw_id());
+    cppcut_assert_equal(uint32_t(0x3000000a), next_and_release(LRU::CacheMode::CACHED, 3));
+    cppcut_assert_equal(uint32_t(0x3000000b), next_and_release(LRU::CacheMode::CACHED, 3));
+    cppcut_assert_equal(uint32_t(0x3000000c), next_and_release(LRU::CacheMode::CACHED, 3));
+    cppcut_assert_equal(uint32_t(0x3000000a), next_and_release(LRU::CacheMode::CACHED, 3));
+    cppcut_assert_equal(uint32_t(0x3000000b), next_and_release(LRU::CacheMode::CACHED, 3));
+    cppcut_assert_equal(uint32_t(0x3000000c), next_and_release(LRU::CacheMode::CACHED, 3));
+    cppcut_assert_equal(uint32_t(0x3000000a), next_and_release(LRU::CacheMode::CACHED, 3));
 }
 
 /*!\test
@@ -2111,24 +2653,23 @@ void test_wraps_around()
 void test_wraps_around_at_integer_maximum()
 {
     gen = new LRU::CacheIdGenerator(LRU::CacheIdGenerator::ID_MAX - 4,
-                                    LRU::CacheIdGenerator::ID_MAX,
-                                    return_always_ok);
+                                    LRU::CacheIdGenerator::ID_MAX);
     cppcut_assert_not_null(gen);
 
     cppcut_assert_equal(uint32_t(0x80000000 | (LRU::CacheIdGenerator::ID_MAX - 4U)),
-                        gen->next(LRU::CacheMode::CACHED, 8).get_raw_id());
+                        next_and_release(LRU::CacheMode::CACHED, 8));
     cppcut_assert_equal(uint32_t(0x80000000 | (LRU::CacheIdGenerator::ID_MAX - 3U)),
-                        gen->next(LRU::CacheMode::CACHED, 8).get_raw_id());
+                        next_and_release(LRU::CacheMode::CACHED, 8));
     cppcut_assert_equal(uint32_t(0x80000000 | (LRU::CacheIdGenerator::ID_MAX - 2U)),
-                        gen->next(LRU::CacheMode::CACHED, 8).get_raw_id());
+                        next_and_release(LRU::CacheMode::CACHED, 8));
     cppcut_assert_equal(uint32_t(0x80000000 | (LRU::CacheIdGenerator::ID_MAX - 1U)),
-                        gen->next(LRU::CacheMode::CACHED, 8).get_raw_id());
+                        next_and_release(LRU::CacheMode::CACHED, 8));
     cppcut_assert_equal(uint32_t(0x80000000 | (LRU::CacheIdGenerator::ID_MAX)),
-                        gen->next(LRU::CacheMode::CACHED, 8).get_raw_id());
+                        next_and_release(LRU::CacheMode::CACHED, 8));
     cppcut_assert_equal(uint32_t(0x80000000 | (LRU::CacheIdGenerator::ID_MAX - 4U)),
-                        gen->next(LRU::CacheMode::CACHED, 8).get_raw_id());
+                        next_and_release(LRU::CacheMode::CACHED, 8));
     cppcut_assert_equal(uint32_t(0x80000000 | (LRU::CacheIdGenerator::ID_MAX - 3U)),
-                        gen->next(LRU::CacheMode::CACHED, 8).get_raw_id());
+                        next_and_release(LRU::CacheMode::CACHED, 8));
 }
 
 /*!\test
@@ -2137,9 +2678,15 @@ void test_wraps_around_at_integer_maximum()
  */
 void test_no_infinite_loop_if_no_free_ids()
 {
-    gen = new LRU::CacheIdGenerator(100, 110, return_never_ok);
+    gen = new LRU::CacheIdGenerator(100, 110);
     cppcut_assert_not_null(gen);
 
+    for(uint32_t i = 100; i <= 110; ++i)
+    {
+        cppcut_assert_equal(i, gen->next(LRU::CacheMode::CACHED, 0).get_cooked_id());
+        cppcut_assert_equal(i, gen->next(LRU::CacheMode::UNCACHED, 2).get_cooked_id());
+    }
+
     auto id1 = gen->next(LRU::CacheMode::CACHED, 0);
 
     cut_assert_false(id1.is_valid());
@@ -2161,14 +2708,35 @@ void test_no_infinite_loop_if_no_free_ids()
     cppcut_assert_equal(0U, id4.get_raw_id());
 }
 
+/*!
+ * Use up all IDs in given context, then release all IDs from \p first_free
+ * on.
+ */
+static void allocate_all_and_release_from(ID::List::context_t ctx,
+                                          uint32_t first_free)
+{
+    std::vector<ID::List> ids;
+
+    for(ID::List id = gen->next(LRU::CacheMode::CACHED, ctx);
+        id.is_valid();
+        id = gen->next(LRU::CacheMode::CACHED, ctx))
+        ids.push_back(id);
+
+    for(const auto &id : ids)
+        if(id.get_cooked_id() >= first_free)
+            cut_assert_true(gen->release(id));
+}
+
 /*!\test
  * Allocated cached IDs are never returned.
  */
 void test_skips_non_free_cached_ids()
 {
-    gen = new LRU::CacheIdGenerator(1000, 3000, reject_all_smaller_than_2000);
+    gen = new LRU::CacheIdGenerator(1000, 3000);
     cppcut_assert_not_null(gen);
 
+    allocate_all_and_release_from(11, 2000);
+
     cppcut_assert_equal(uint32_t(0xb0000000 | 2000U), gen->next(LRU::CacheMode::CACHED, 11).get_raw_id());
 }
 
@@ -2177,12 +2745,293 @@ void test_skips_non_free_cached_ids()
  */
 void test_skips_non_free_uncached_ids()
 {
-    gen = new LRU::CacheIdGenerator(1000, 3000, reject_all_smaller_than_2000);
+    gen = new LRU::CacheIdGenerator(1000, 3000);
     cppcut_assert_not_null(gen);
 
+    allocate_all_and_release_from(6, 2000);
+
     cppcut_assert_equal(uint32_t(0x68000000 | 2000U), gen->next(LRU::CacheMode::UNCACHED, 6).get_raw_id());
 }
 
+/*!\test
+ * Released IDs are not reused before the IDs have wrapped around.
+ */
+void test_released_ids_are_reused_after_wrap_around()
+{
+    gen = new LRU::CacheIdGenerator(1, 5);
+    cppcut_assert_not_null(gen);
+
+    const ID::List first = gen->next(LRU::CacheMode::CACHED, 1);
+    cppcut_assert_equal(1U, first.get_cooked_id());
+    cppcut_assert_equal(2U, gen->next(LRU::CacheMode::CACHED, 1).get_cooked_id());
+    const ID::List third = gen->next(LRU::CacheMode::CACHED, 1);
+    cppcut_assert_equal(3U, third.get_cooked_id());
+
+    cut_assert_true(gen->release(first));
+    cut_assert_true(gen->release(third));
+    cut_assert_false(gen->release(third));
+
+    cppcut_assert_equal(4U, gen->next(LRU::CacheMode::CACHED, 1).get_cooked_id());
+    cppcut_assert_equal(5U, gen->next(LRU::CacheMode::CACHED, 1).get_cooked_id());
+    cppcut_assert_equal(1U, gen->next(LRU::CacheMode::CACHED, 1).get_cooked_id());
+    cppcut_assert_equal(3U, gen->next(LRU::CacheMode::CACHED, 1).get_cooked_id());
+    cut_assert_false(gen->next(LRU::CacheMode::CACHED, 1).is_valid());
+}
+
+/*!\test
+ * Single free ID in a large range with many used IDs, spread over several
+ * bitmap pages, is found right away, near the maximum ID.
+ */
+void test_finds_single_free_id_among_many_used_ids()
+{
+    static constexpr uint32_t number_of_ids = 3 * LRU::IdBitmap::BITS_PER_PAGE + 100;
+
+    gen = new LRU::CacheIdGenerator(LRU::CacheIdGenerator::ID_MAX - number_of_ids + 1,
+                                    LRU::CacheIdGenerator::ID_MAX);
+    cppcut_assert_not_null(gen);
+
+    const uint32_t free_id = LRU::CacheIdGenerator::ID_MAX - 50;
+
+    for(uint32_t i = 0; i < number_of_ids; ++i)
+        cut_assert_true(gen->next(LRU::CacheMode::CACHED, 4).is_valid());
+
+    cut_assert_false(gen->next(LRU::CacheMode::CACHED, 4).is_valid());
+    cut_assert_true(gen->release(ID::List(free_id | (4U << DBUS_LISTS_CONTEXT_ID_SHIFT))));
+
+    cppcut_assert_equal(free_id, gen->next(LRU::CacheMode::CACHED, 4).get_cooked_id());
+    cut_assert_false(gen->next(LRU::CacheMode::CACHED, 4).is_valid());
+}
+
+};
+
+
+namespace lru_cache_concurrency_tests
+{
+
+/*!
+ * Time base which may be read and advanced from several threads.
+ */
+class ConcurrentTimebase: public Timebase
+{
+  private:
+    std::atomic<uint64_t> now_ms_;
+
+  public:
+    ConcurrentTimebase(const ConcurrentTimebase &) = delete;
+    ConcurrentTimebase &operator=(const ConcurrentTimebase &) = delete;
+
+    explicit ConcurrentTimebase(): now_ms_(0) {}
+
+    void step(uint64_t ms = 1) { now_ms_ += ms; }
+
+    time_point now() const override
+    {
+        return time_point(std::chrono::milliseconds(now_ms_.load()));
+    }
+};
+
+class SimpleObject: public LRU::Entry
+{
+  public:
+    SimpleObject(const SimpleObject &) = delete;
+    SimpleObject &operator=(const SimpleObject &) = delete;
+
+    explicit SimpleObject(const std::shared_ptr<Entry> &parent):
+        LRU::Entry(parent)
+    {}
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override {}
+};
+
+static MockMessages *mock_messages;
+static ConcurrentTimebase *concurrent_timebase;
+static Timebase *saved_timebase;
+
+static LRU::Cache *cache;
+static constexpr std::chrono::minutes maximum_object_age(1);
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_TRACE);
+
+    concurrent_timebase = new ConcurrentTimebase;
+    cppcut_assert_not_null(concurrent_timebase);
+    saved_timebase = LRU::timebase;
+    LRU::timebase = concurrent_timebase;
+
+    cache = new LRU::Cache(1024UL * 1024UL * 1024UL, 1000000,
+                           maximum_object_age);
+    cppcut_assert_not_null(cache);
+    cache->set_callbacks([]{}, []{}, [] (ID::List id) {}, []{});
+}
+
+void cut_teardown(void)
+{
+    cache->self_check();
+
+    delete cache;
+    cache = nullptr;
+
+    LRU::timebase = saved_timebase;
+    delete concurrent_timebase;
+    concurrent_timebase = nullptr;
+
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!
+ * IDs of inserted objects, shared between writer and reader threads.
+ *
+ * Objects may have been removed from the cache by the time their IDs are
+ * read from here, which is intended.
+ */
+class KnownIDs
+{
+  private:
+    mutable std::mutex lock_;
+    std::vector<ID::List> ids_;
+
+  public:
+    KnownIDs(const KnownIDs &) = delete;
+    KnownIDs &operator=(const KnownIDs &) = delete;
+
+    explicit KnownIDs() {}
+
+    void add(ID::List id)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        ids_.push_back(id);
+    }
+
+    ID::List pick(std::mt19937 &rng) const
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        std::uniform_int_distribution<size_t> dist(0, ids_.size() - 1);
+        return ids_[dist(rng)];
+    }
+};
+
+/*!\test
+ * Lookups and uses from several threads are safe while another thread
+ * inserts objects and collects garbage.
+ *
+ * There is a single writer thread which advances time, inserts new objects
+ * below randomly chosen, still cached parents, and expires old objects
+ * periodically. The reader threads look up and use random objects, most of
+ * which are gone already. The cache must be consistent in the end.
+ */
+void test_concurrent_lookups_while_inserting_and_collecting_garbage()
+{
+    static constexpr size_t number_of_readers = 4;
+    static constexpr size_t number_of_inserts = 20000;
+    static constexpr size_t inserts_per_gc = 1000;
+
+    std::shared_ptr<LRU::Entry> root = std::make_shared<SimpleObject>(nullptr);
+    const ID::List root_id =
+        cache->insert(std::shared_ptr<LRU::Entry>(root), LRU::CacheMode::CACHED, 0, 10);
+    cut_assert_true(root_id.is_valid());
+
+    KnownIDs known_ids;
+    known_ids.add(root_id);
+
+    std::atomic<bool> writer_done(false);
+    std::atomic<size_t> failed_inserts(0);
+
+    /* results per reader thread, checked after joining them because the
+     * assertion functions may only be called from the main thread */
+    std::vector<size_t> found_by_readers(number_of_readers, 0);
+    std::vector<size_t> wrong_ids_by_readers(number_of_readers, 0);
+
+    std::thread writer([&root_id, &known_ids, &writer_done, &failed_inserts] ()
+    {
+        std::mt19937 rng(1);
+
+        for(size_t i = 1; i <= number_of_inserts; ++i)
+        {
+            concurrent_timebase->step();
+
+            auto parent = cache->lookup(known_ids.pick(rng));
+
+            if(parent == nullptr)
+                parent = cache->lookup(root_id);
+
+            std::shared_ptr<LRU::Entry> obj = std::make_shared<SimpleObject>(parent);
+            const ID::List id =
+                cache->insert(std::move(obj), LRU::CacheMode::CACHED, 0, 10);
+
+            if(id.is_valid())
+                known_ids.add(id);
+            else
+                ++failed_inserts;
+
+            if(i % inserts_per_gc == 0)
+            {
+                cache->use(root_id);
+                concurrent_timebase->step(std::chrono::milliseconds(maximum_object_age).count() / 2);
+                cache->gc();
+            }
+        }
+
+        writer_done = true;
+    });
+
+    std::vector<std::thread> readers;
+
+    for(size_t r = 0; r < number_of_readers; ++r)
+        readers.emplace_back([r, &known_ids, &writer_done,
+                              &found = found_by_readers[r],
+                              &wrong_ids = wrong_ids_by_readers[r]] ()
+        {
+            std::mt19937 rng(100 + r);
+
+            while(!writer_done)
+            {
+                const ID::List id = known_ids.pick(rng);
+                const auto obj = cache->lookup(id);
+
+                if(obj != nullptr)
+                {
+                    if(obj->get_cache_id() != id)
+                        ++wrong_ids;
+
+                    ++found;
+                }
+
+                if(rng() % 4 == 0)
+                    cache->use(id);
+
+                cache->count();
+            }
+        });
+
+    writer.join();
+
+    for(auto &t : readers)
+        t.join();
+
+    cppcut_assert_equal(size_t(0), failed_inserts.load());
+
+    size_t found = 0;
+
+    for(size_t r = 0; r < number_of_readers; ++r)
+    {
+        cppcut_assert_equal(size_t(0), wrong_ids_by_readers[r]);
+        found += found_by_readers[r];
+    }
+
+    cppcut_assert_operator(size_t(0), <, found);
+    cppcut_assert_not_null(cache->lookup(root_id).get());
+    cppcut_assert_operator(size_t(number_of_inserts), >, cache->count());
+}
+
 };
 
 /*!@}*/
@@ -0,0 +1,997 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <array>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <fstream>
+#include <unistd.h>
+
+#include "mock_messages.hh"
+#include "mock_timebase.hh"
+
+#include "lru.hh"
+#include "lru_pool_allocator.hh"
+
+/*!
+ * \addtogroup lru_cache_benchmarks Benchmarks
+ * \ingroup lru_cache
+ *
+ * LRU cache performance measurements.
+ *
+ * These are not unit tests in the strict sense. They check a few invariants
+ * to make sure the measured code is doing what it is supposed to do, but
+ * their main purpose is to print timing information to the test log.
+ */
+/*!@{*/
+
+static MockTimebase mock_timebase;
+Timebase *LRU::timebase = &mock_timebase;
+
+class Object: public LRU::Entry
+{
+  public:
+    Object(const Object &) = delete;
+    Object &operator=(const Object &) = delete;
+
+    explicit Object(const std::shared_ptr<Entry> &parent):
+        LRU::Entry(parent)
+    {}
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override {}
+};
+
+/*!
+ * Wall clock stop watch, independent of the mock timebase.
+ */
+class StopWatch
+{
+  private:
+    using clock = std::chrono::steady_clock;
+    clock::time_point start_;
+
+  public:
+    explicit StopWatch(): start_(clock::now()) {}
+
+    std::chrono::nanoseconds elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_);
+    }
+};
+
+static void report(const char *what, const char *impl, size_t n,
+                   size_t number_of_operations,
+                   std::chrono::nanoseconds duration)
+{
+    const double ns_per_op =
+        double(duration.count()) / double(number_of_operations);
+
+    std::cout << std::left << std::setw(24) << what
+              << std::setw(14) << impl
+              << std::right << std::setw(8) << n << " entries: "
+              << std::fixed << std::setprecision(1) << std::setw(10)
+              << ns_per_op << " ns/op, "
+              << std::setprecision(0) << std::setw(12)
+              << (ns_per_op > 0.0 ? 1.0e9 / ns_per_op : 0.0) << " op/s"
+              << std::endl;
+}
+
+namespace lru_object_table_benchmarks
+{
+
+static MockMessages *mock_messages;
+
+static constexpr std::array<size_t, 3> table_sizes{1000, 10000, 100000};
+
+/*!
+ * Number of lookups done per benchmark, independent of table size.
+ */
+static constexpr size_t number_of_lookups = 1000000;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_TRACE);
+
+    mock_timebase.reset();
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*
+ * The container previously used by #LRU::Cache, kept here as reference.
+ */
+using ReferenceMap = std::map<ID::List, std::shared_ptr<LRU::Entry>>;
+
+static bool table_insert(ReferenceMap &table, ID::List id,
+                         std::shared_ptr<LRU::Entry> &&entry)
+{
+    return table.insert(std::make_pair(id, std::move(entry))).second;
+}
+
+static bool table_insert(LRU::ObjectTable &table, ID::List id,
+                         std::shared_ptr<LRU::Entry> &&entry)
+{
+    return table.insert(id, std::move(entry));
+}
+
+static std::vector<std::shared_ptr<LRU::Entry>> make_objects(size_t n)
+{
+    std::vector<std::shared_ptr<LRU::Entry>> objects;
+    objects.reserve(n);
+
+    for(size_t i = 0; i < n; ++i)
+        objects.emplace_back(std::make_shared<Object>(nullptr));
+
+    return objects;
+}
+
+/*!
+ * IDs the way #LRU::CacheIdGenerator hands them out: ascending, with a few
+ * objects in another context and some uncached objects.
+ */
+static ID::List make_id(size_t i)
+{
+    const uint32_t ctx = (i % 7 == 0) ? 1 : 0;
+    const uint32_t nocache = (i % 5 == 0) ? ID::List::NOCACHE_BIT : 0;
+
+    return ID::List((uint32_t(i) + 1) | (ctx << DBUS_LISTS_CONTEXT_ID_SHIFT) | nocache);
+}
+
+/*!
+ * Pseudo-random, but reproducible sequence of indices into a table.
+ */
+static std::vector<size_t> access_pattern(size_t n, size_t length)
+{
+    std::mt19937 rng(n);
+    std::uniform_int_distribution<size_t> dist(0, n - 1);
+    std::vector<size_t> result(length);
+
+    for(auto &idx : result)
+        idx = dist(rng);
+
+    return result;
+}
+
+template <typename TableType>
+static void bench_insert(const char *impl, size_t n)
+{
+    auto objects(make_objects(n));
+    TableType table;
+
+    const StopWatch sw;
+
+    for(size_t i = 0; i < n; ++i)
+        table_insert(table, make_id(i), std::move(objects[i]));
+
+    report("insert", impl, n, n, sw.elapsed());
+    cppcut_assert_equal(n, table.size());
+}
+
+template <typename TableType>
+static void bench_lookup(const char *impl, size_t n)
+{
+    auto objects(make_objects(n));
+    TableType table;
+
+    for(size_t i = 0; i < n; ++i)
+        table_insert(table, make_id(i), std::move(objects[i]));
+
+    const auto &pattern(access_pattern(n, number_of_lookups));
+    size_t found = 0;
+
+    const StopWatch sw;
+
+    for(const auto idx : pattern)
+        if(table.find(make_id(idx)) != table.end())
+            ++found;
+
+    report("lookup", impl, n, number_of_lookups, sw.elapsed());
+    cppcut_assert_equal(number_of_lookups, found);
+}
+
+/*!
+ * Emulate what garbage collection does to the table: erase all entries,
+ * oldest (i.e., smallest ID) first.
+ */
+template <typename TableType>
+static void bench_erase(const char *impl, size_t n)
+{
+    auto objects(make_objects(n));
+    TableType table;
+
+    for(size_t i = 0; i < n; ++i)
+        table_insert(table, make_id(i), std::move(objects[i]));
+
+    const StopWatch sw;
+
+    for(size_t i = 0; i < n; ++i)
+        table.erase(make_id(i));
+
+    report("erase", impl, n, n, sw.elapsed());
+    cut_assert_true(table.empty());
+}
+
+/*!\test
+ * Insertion into object table compared to \c std::map.
+ */
+void test_insert_throughput(void)
+{
+    for(const size_t n : table_sizes)
+    {
+        bench_insert<ReferenceMap>("std::map", n);
+        bench_insert<LRU::ObjectTable>("ObjectTable", n);
+    }
+}
+
+/*!\test
+ * Lookup in object table compared to \c std::map.
+ */
+void test_lookup_throughput(void)
+{
+    for(const size_t n : table_sizes)
+    {
+        bench_lookup<ReferenceMap>("std::map", n);
+        bench_lookup<LRU::ObjectTable>("ObjectTable", n);
+    }
+}
+
+/*!\test
+ * Removal from object table compared to \c std::map.
+ */
+void test_erase_throughput(void)
+{
+    for(const size_t n : table_sizes)
+    {
+        bench_erase<ReferenceMap>("std::map", n);
+        bench_erase<LRU::ObjectTable>("ObjectTable", n);
+    }
+}
+
+/*!\test
+ * Full cache operations: insert, use, and age-based garbage collection.
+ */
+void test_cache_throughput(void)
+{
+    static constexpr std::chrono::minutes maximum_age(5);
+
+    for(const size_t n : table_sizes)
+    {
+        LRU::Cache cache(1024UL * 1024UL * 1024UL, 2 * n, maximum_age);
+        cache.set_callbacks([]{}, []{}, [] (ID::List id) {}, []{});
+
+        /* shallow tree: root with a layer of directories with 100 leaves
+         * each, similar to a few big directories on a USB stick */
+        std::shared_ptr<LRU::Entry> root = std::make_shared<Object>(nullptr);
+        cache.insert(std::shared_ptr<LRU::Entry>(root), LRU::CacheMode::CACHED, 0, 1);
+
+        std::vector<ID::List> ids;
+        ids.reserve(n);
+
+        std::shared_ptr<LRU::Entry> dir;
+        StopWatch sw;
+
+        for(size_t i = 0; i < n; ++i)
+        {
+            mock_timebase.step();
+
+            if(i % 100 == 0)
+            {
+                dir = std::make_shared<Object>(root);
+                ids.push_back(cache.insert(std::shared_ptr<LRU::Entry>(dir),
+                                           LRU::CacheMode::CACHED, 0, 1));
+            }
+            else
+            {
+                std::shared_ptr<LRU::Entry> obj = std::make_shared<Object>(dir);
+                ids.push_back(cache.insert(std::move(obj),
+                                           LRU::CacheMode::CACHED, 0, 1));
+            }
+        }
+
+        report("cache insert", "ObjectTable", n, n, sw.elapsed());
+        cppcut_assert_equal(n + 1, cache.count());
+
+        dir = nullptr;
+
+        const auto &pattern(access_pattern(n, n));
+        sw = StopWatch();
+
+        for(const auto idx : pattern)
+        {
+            mock_timebase.step();
+            cache.use(ids[idx]);
+        }
+
+        report("cache use", "ObjectTable", n, n, sw.elapsed());
+
+        mock_timebase.step(std::chrono::milliseconds(maximum_age).count());
+        root = nullptr;
+        sw = StopWatch();
+
+        cache.gc();
+
+        report("cache gc", "ObjectTable", n, n, sw.elapsed());
+        cppcut_assert_equal(size_t(0), cache.count());
+    }
+}
+
+}
+
+
+namespace lru_subtree_benchmarks
+{
+
+static MockMessages *mock_messages;
+
+static constexpr size_t number_of_directories = 100;
+static constexpr size_t subdirectories_per_directory = 100;
+static constexpr size_t items_per_list = 500;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    /* purging emits one message per list */
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_IMPORTANT);
+
+    mock_timebase.reset();
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!
+ * Cached list with a fixed number of items, some of which refer to child
+ * lists, similar to a directory list.
+ */
+class ListObject: public LRU::Entry
+{
+  private:
+    std::vector<ID::List> items_;
+
+  public:
+    ListObject(const ListObject &) = delete;
+    ListObject &operator=(const ListObject &) = delete;
+
+    explicit ListObject(const std::shared_ptr<Entry> &parent):
+        LRU::Entry(parent),
+        items_(items_per_list)
+    {}
+
+    void set_child_list(size_t idx, ID::List id) { items_[idx] = id; }
+
+    void append_child_lists(std::vector<ID::List> &nodes) const
+    {
+        for(const auto &id : items_)
+            if(id.is_valid())
+                nodes.push_back(id);
+    }
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override
+    {
+        auto it = std::find(items_.begin(), items_.end(), child_id);
+        cut_assert_true(it != items_.end());
+        *it = ID::List();
+    }
+};
+
+/*!
+ * How subtrees were enumerated before cached objects were linked to their
+ * parents: breadth-first by looking at all items of each list.
+ */
+static void enumerate_by_items(const LRU::Cache &cache, const LRU::Entry &entry,
+                               std::vector<ID::List> &nodes)
+{
+    nodes.clear();
+    nodes.push_back(entry.get_cache_id());
+
+    for(size_t next_unprocessed = 0;
+        next_unprocessed < nodes.size();
+        ++next_unprocessed)
+        std::static_pointer_cast<const ListObject>(cache.lookup(nodes[next_unprocessed]))
+            ->append_child_lists(nodes);
+}
+
+static void enumerate_by_links(const LRU::Cache &cache, const LRU::Entry &entry,
+                               std::vector<ID::List> &nodes)
+{
+    nodes.clear();
+    cache.enumerate_subtree(entry, nodes);
+}
+
+using EnumerateFn = void (*)(const LRU::Cache &, const LRU::Entry &,
+                             std::vector<ID::List> &);
+
+static constexpr size_t number_of_lists =
+    1 + number_of_directories * (1 + subdirectories_per_directory);
+
+/*!
+ * Two-level tree of lists below a root list, with child lists spread evenly
+ * over the items of their parents.
+ */
+static std::shared_ptr<LRU::Entry>
+make_tree(LRU::Cache &cache, std::vector<ID::List> &directory_ids)
+{
+    auto add = [&cache] (const std::shared_ptr<LRU::Entry> &parent, size_t idx)
+    {
+        auto list = std::make_shared<ListObject>(parent);
+        const ID::List id =
+            cache.insert(std::shared_ptr<LRU::Entry>(list), LRU::CacheMode::CACHED, 0, 1);
+
+        if(parent != nullptr)
+            static_cast<ListObject *>(parent.get())->set_child_list(idx, id);
+
+        return std::static_pointer_cast<LRU::Entry>(list);
+    };
+
+    static constexpr size_t dir_stride = items_per_list / number_of_directories;
+    static constexpr size_t subdir_stride = items_per_list / subdirectories_per_directory;
+
+    auto root = add(nullptr, 0);
+
+    directory_ids.clear();
+
+    for(size_t d = 0; d < number_of_directories; ++d)
+    {
+        auto dir = add(root, d * dir_stride);
+        directory_ids.push_back(dir->get_cache_id());
+
+        for(size_t s = 0; s < subdirectories_per_directory; ++s)
+            add(dir, s * subdir_stride);
+    }
+
+    cppcut_assert_equal(number_of_lists, cache.count());
+
+    return root;
+}
+
+/*!\test
+ * Enumeration of full tree and of subtrees, by scanning list items compared
+ * to following links between cached objects.
+ */
+void test_enumerate_subtree_throughput(void)
+{
+    static const std::array<std::pair<const char *, EnumerateFn>, 2> impls =
+    {
+        std::make_pair("list items", enumerate_by_items),
+        std::make_pair("child links", enumerate_by_links),
+    };
+
+    LRU::Cache cache(1024UL * 1024UL * 1024UL, 2 * number_of_lists,
+                     std::chrono::minutes(5));
+    cache.set_callbacks([]{}, []{}, [] (ID::List id) {}, []{});
+
+    std::vector<ID::List> directory_ids;
+    auto root = make_tree(cache, directory_ids);
+    std::vector<ID::List> nodes;
+
+    for(const auto &impl : impls)
+    {
+        StopWatch sw;
+        impl.second(cache, *root, nodes);
+        report("enumerate tree", impl.first, number_of_lists, 1, sw.elapsed());
+        cppcut_assert_equal(number_of_lists, nodes.size());
+
+        sw = StopWatch();
+
+        for(const auto &id : directory_ids)
+            impl.second(cache, *cache.lookup(id), nodes);
+
+        report("enumerate subtree", impl.first, number_of_lists,
+               directory_ids.size(), sw.elapsed());
+        cppcut_assert_equal(subdirectories_per_directory + 1, nodes.size());
+    }
+
+    cache.self_check();
+}
+
+/*!\test
+ * Purging all subtrees below the root, one after another, as done by
+ * #ListTreeManager::purge_subtree() when a USB device or UPnP server is
+ * removed.
+ */
+void test_purge_subtree_throughput(void)
+{
+    static const std::array<std::pair<const char *, EnumerateFn>, 2> impls =
+    {
+        std::make_pair("list items", enumerate_by_items),
+        std::make_pair("child links", enumerate_by_links),
+    };
+
+    for(const auto &impl : impls)
+    {
+        LRU::Cache cache(1024UL * 1024UL * 1024UL, 2 * number_of_lists,
+                         std::chrono::minutes(5));
+        cache.set_callbacks([]{}, []{}, [] (ID::List id) {}, []{});
+
+        std::vector<ID::List> directory_ids;
+        auto root = make_tree(cache, directory_ids);
+        std::vector<ID::List> kill_list;
+
+        const StopWatch sw;
+
+        for(const auto &id : directory_ids)
+        {
+            impl.second(cache, *cache.lookup(id), kill_list);
+            cut_assert_true(cache.toposort_for_purge(kill_list.begin(), kill_list.end()));
+            cache.purge_entries(kill_list.begin(), kill_list.end());
+        }
+
+        report("purge subtree", impl.first, number_of_lists,
+               directory_ids.size(), sw.elapsed());
+        cppcut_assert_equal(size_t(1), cache.count());
+        cache.self_check();
+    }
+}
+
+}
+
+
+namespace lru_pool_allocator_benchmarks
+{
+
+static MockMessages *mock_messages;
+
+static constexpr size_t number_of_browse_steps = 200000;
+static constexpr size_t maximum_number_of_lists = 500;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    /* the cache complains about exceeded limits all the time */
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_IMPORTANT);
+
+    mock_timebase.reset();
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+static size_t get_resident_set_size()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+
+    statm >> total_pages >> resident_pages;
+
+    return resident_pages * size_t(sysconf(_SC_PAGESIZE));
+}
+
+/*!
+ * Cached list with some inline data and a few heap-allocated item names,
+ * roughly what a #TiledList with its first tile filled looks like.
+ *
+ * The \p Tag parameter only serves for having separate types for separate
+ * pools.
+ */
+template <unsigned int Tag>
+class BrowsedList: public LRU::Entry
+{
+  private:
+    std::array<uint8_t, 1024> inline_data_;
+    std::vector<std::string> names_;
+
+  public:
+    BrowsedList(const BrowsedList &) = delete;
+    BrowsedList &operator=(const BrowsedList &) = delete;
+
+    explicit BrowsedList(const std::shared_ptr<Entry> &parent, std::mt19937 &rng):
+        LRU::Entry(parent)
+    {
+        std::uniform_int_distribution<size_t> name_length(8, 80);
+
+        inline_data_.fill(0);
+        names_.resize(16);
+
+        for(auto &name : names_)
+            name.assign(name_length(rng), 'x');
+    }
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override {}
+};
+
+/*!
+ * Scripted browse session: walk up and down a tree of lists at random,
+ * creating a new list on each step down, with garbage collection driven by
+ * the cache's count limit.
+ */
+template <typename MakeList>
+static void browse(const char *impl, const MakeList &make_list)
+{
+    LRU::Cache cache(1024UL * 1024UL * 1024UL, maximum_number_of_lists,
+                     std::chrono::minutes(5));
+    cache.set_callbacks([]{}, [&cache] { cache.gc(); }, [] (ID::List id) {}, []{});
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> direction(0, 9);
+
+    std::shared_ptr<LRU::Entry> root = make_list(nullptr, rng);
+    const ID::List root_id =
+        cache.insert(std::shared_ptr<LRU::Entry>(root), LRU::CacheMode::CACHED, 0, 1);
+    cache.pin(root_id);
+
+    std::shared_ptr<LRU::Entry> current = root;
+
+    const size_t rss_before = get_resident_set_size();
+    const StopWatch sw;
+
+    for(size_t i = 0; i < number_of_browse_steps; ++i)
+    {
+        mock_timebase.step();
+
+        if(cache.lookup(current->get_cache_id()) != current)
+        {
+            /* our list has been garbage collected */
+            current = root;
+        }
+
+        if(direction(rng) < 7)
+        {
+            std::shared_ptr<LRU::Entry> list = make_list(current, rng);
+
+            if(cache.insert(std::shared_ptr<LRU::Entry>(list),
+                            LRU::CacheMode::CACHED, 0, 1).is_valid())
+                current = std::move(list);
+        }
+        else if(current->get_parent() != nullptr)
+        {
+            current = current->get_parent();
+            cache.use(current->get_cache_id());
+        }
+    }
+
+    const auto duration = sw.elapsed();
+    const size_t rss_after = get_resident_set_size();
+
+    report("browse session", impl, cache.count(), number_of_browse_steps, duration);
+    std::cout << "    RSS " << rss_before / 1024 << " kB before, "
+              << rss_after / 1024 << " kB after" << std::endl;
+
+    for(const auto &s : LRU::PoolRegistry::get_singleton().get_statistics())
+        std::cout << "    pool " << s.name_ << ": "
+                  << s.allocations_ << " allocations, "
+                  << s.deallocations_ << " deallocations, "
+                  << s.peak_in_use_ << " peak, "
+                  << s.slabs_ << " slabs" << std::endl;
+
+    current = nullptr;
+    cache.pin(ID::List());
+    mock_timebase.step(std::chrono::milliseconds(std::chrono::minutes(5)).count());
+    root = nullptr;
+    cache.gc();
+    cppcut_assert_equal(size_t(0), cache.count());
+}
+
+/*!\test
+ * Lists allocated from a per-type pool compared to \c std::make_shared().
+ */
+void test_browse_session(void)
+{
+    browse("make_shared",
+        [] (const std::shared_ptr<LRU::Entry> &parent, std::mt19937 &rng)
+        {
+            return std::make_shared<BrowsedList<0>>(parent, rng);
+        });
+
+    browse("make_pooled",
+        [] (const std::shared_ptr<LRU::Entry> &parent, std::mt19937 &rng)
+        {
+            return LRU::make_pooled<BrowsedList<1>>(parent, rng);
+        });
+}
+
+}
+
+namespace lru_eviction_policy_benchmarks
+{
+
+static MockMessages *mock_messages;
+
+static constexpr size_t number_of_navigation_steps = 50000;
+static constexpr size_t lists_per_directory = 8;
+static constexpr size_t directory_depth = 3;
+static constexpr size_t number_of_bookmarks = 20;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    /* the cache complains about exceeded limits all the time */
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_IMPORTANT);
+
+    mock_timebase.reset();
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!
+ * A directory in the simulated media library.
+ */
+struct Directory
+{
+    size_t parent_;
+    std::vector<size_t> children_;
+    std::chrono::microseconds refill_cost_;
+    size_t size_;
+};
+
+/*!
+ * Media library with a slow and a fast source below a common root.
+ *
+ * The slow source resembles a UPnP server which takes hundreds of
+ * milliseconds to browse a container, the fast source resembles a local file
+ * system. List sizes are independent of the source.
+ */
+static std::vector<Directory> make_library(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<size_t> list_size(2 * 1024, 64 * 1024);
+    std::uniform_int_distribution<int64_t> slow_cost(50000, 400000);
+    std::uniform_int_distribution<int64_t> fast_cost(1000, 10000);
+
+    std::vector<Directory> library;
+    library.push_back({0, {}, std::chrono::microseconds(1000), 1024});
+
+    for(int source = 0; source < 2; ++source)
+    {
+        auto &cost(source == 0 ? slow_cost : fast_cost);
+        std::vector<size_t> level{0};
+
+        for(size_t depth = 0; depth < directory_depth + 1; ++depth)
+        {
+            std::vector<size_t> next_level;
+
+            for(const size_t parent : level)
+            {
+                const size_t count = depth == 0 ? 1 : lists_per_directory;
+
+                for(size_t i = 0; i < count; ++i)
+                {
+                    library.push_back({parent, {},
+                                       std::chrono::microseconds(cost(rng)),
+                                       list_size(rng)});
+                    library[parent].children_.push_back(library.size() - 1);
+                    next_level.push_back(library.size() - 1);
+                }
+            }
+
+            level = std::move(next_level);
+        }
+    }
+
+    return library;
+}
+
+/*!
+ * Navigation trace: the sequence of directories a user visits.
+ *
+ * Users mostly step into directories (preferring the first few entries) and
+ * back out again, and every now and then jump to one of a few bookmarked
+ * directories, which are not equally popular.
+ */
+static std::vector<size_t> make_trace(const std::vector<Directory> &library,
+                                      std::mt19937 &rng)
+{
+    std::uniform_int_distribution<size_t> any_directory(1, library.size() - 1);
+    std::geometric_distribution<size_t> favorite(0.3);
+    std::uniform_int_distribution<int> action(0, 99);
+
+    std::vector<size_t> bookmarks;
+    for(size_t i = 0; i < number_of_bookmarks; ++i)
+        bookmarks.push_back(any_directory(rng));
+
+    std::vector<size_t> trace;
+    size_t current = 0;
+
+    for(size_t i = 0; i < number_of_navigation_steps; ++i)
+    {
+        const Directory &dir(library[current]);
+        const int a = action(rng);
+
+        if(a < 50 && !dir.children_.empty())
+            current = dir.children_[std::min(favorite(rng), dir.children_.size() - 1)];
+        else if(a < 85)
+            current = dir.parent_;
+        else
+            current = bookmarks[std::min(favorite(rng), bookmarks.size() - 1)];
+
+        trace.push_back(current);
+    }
+
+    return trace;
+}
+
+class TracedList: public LRU::Entry
+{
+  public:
+    const size_t directory_;
+
+    TracedList(const TracedList &) = delete;
+    TracedList &operator=(const TracedList &) = delete;
+
+    explicit TracedList(const std::shared_ptr<Entry> &parent, size_t directory):
+        LRU::Entry(parent),
+        directory_(directory)
+    {}
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override {}
+};
+
+/*!
+ * Replay navigation trace, filling lists which are not in cache.
+ *
+ * Visiting a directory requires all lists on the path from the root to be
+ * available, just like realizing a location does in the list brokers.
+ */
+static void replay(const char *impl, LRU::EvictionPolicy policy,
+                   const std::vector<Directory> &library,
+                   const std::vector<size_t> &trace)
+{
+    LRU::Cache cache(2UL * 1024UL * 1024UL, 10000, std::chrono::minutes(60));
+    std::vector<ID::List> cached_lists(library.size());
+    std::unordered_map<uint32_t, size_t> directories;
+
+    cache.set_eviction_policy(policy);
+    cache.set_callbacks([]{}, [&cache] { cache.gc(); },
+                        [&cached_lists, &directories] (ID::List id)
+                        {
+                            const auto it = directories.find(id.get_raw_id());
+
+                            if(it != directories.end())
+                            {
+                                cached_lists[it->second] = ID::List();
+                                directories.erase(it);
+                            }
+                        },
+                        []{});
+
+    size_t hits = 0;
+    size_t misses = 0;
+    std::chrono::microseconds refill_time(0);
+    std::vector<size_t> path;
+
+    const StopWatch sw;
+
+    for(const size_t directory : trace)
+    {
+        path.clear();
+
+        for(size_t d = directory; d != 0; d = library[d].parent_)
+            path.push_back(d);
+
+        path.push_back(0);
+
+        std::shared_ptr<LRU::Entry> parent;
+
+        for(auto d = path.rbegin(); d != path.rend(); ++d)
+        {
+            /* one second per directory, so that recency is measurable */
+            mock_timebase.step(1000);
+
+            if(cached_lists[*d].is_valid())
+            {
+                ++hits;
+                parent = cache.lookup(cached_lists[*d]);
+                cache.use(parent);
+                continue;
+            }
+
+            ++misses;
+            refill_time += library[*d].refill_cost_;
+
+            auto list = std::make_shared<TracedList>(parent, *d);
+            list->set_refill_cost(library[*d].refill_cost_);
+
+            const ID::List id =
+                cache.insert(std::shared_ptr<LRU::Entry>(list),
+                             LRU::CacheMode::CACHED, 0, library[*d].size_);
+            cppcut_assert_not_equal(0U, id.get_raw_id());
+
+            if(cache.lookup(id) != nullptr)
+            {
+                cached_lists[*d] = id;
+                directories[id.get_raw_id()] = *d;
+            }
+
+            parent = std::move(list);
+        }
+    }
+
+    const auto duration = sw.elapsed();
+
+    cppcut_assert_operator(size_t(0), <, hits);
+    cppcut_assert_operator(size_t(0), <, cache.count());
+
+    report("replay navigation", impl, cache.count(), hits + misses, duration);
+    std::cout << "    " << std::setprecision(1)
+              << 100.0 * double(hits) / double(hits + misses) << "% hits, "
+              << misses << " lists filled in "
+              << std::setprecision(1)
+              << double(refill_time.count()) / 1.0e6 << " s" << std::endl;
+}
+
+/*!\test
+ * Replay of the same navigation trace with LRU and GreedyDual-Size eviction.
+ *
+ * The cache is small enough for the trace to cause constant eviction. The
+ * GreedyDual-Size policy should keep the lists from the slow source in cache
+ * at the expense of lists from the fast source, resulting in lower total
+ * refill time.
+ */
+void test_replay_navigation_trace(void)
+{
+    std::mt19937 rng(42);
+    const auto library(make_library(rng));
+    const auto trace(make_trace(library, rng));
+
+    replay("LRU", LRU::EvictionPolicy::LEAST_RECENTLY_USED, library, trace);
+    replay("GreedyDual-Size", LRU::EvictionPolicy::GREEDY_DUAL_SIZE, library, trace);
+}
+
+}
+
+/*!@}*/
@@ -0,0 +1,521 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cstdlib>
+
+#include "mock_messages.hh"
+#include "mock_timebase.hh"
+
+#include "lru.hh"
+
+/*!
+ * \addtogroup lru_cache_latency_benchmarks Latency benchmarks
+ * \ingroup lru_cache
+ *
+ * Latency distribution of single #LRU::Cache operations on synthetic list
+ * trees.
+ *
+ * Each operation is timed individually, and the 50th, 90th, 99th, and
+ * 99.9th percentiles and the maximum are printed to the test log. The cache
+ * runs on the mock timebase and all random choices are made by a generator
+ * with fixed seed, so each run performs exactly the same operations on
+ * exactly the same cache contents. Only the measured durations vary.
+ *
+ * The shapes of the trees can be changed by setting environment variable
+ * \c LRU_BENCHMARK_TREE_SHAPES to a comma-separated list of shapes written
+ * as <tt>depth</tt><tt>x</tt><tt>fan-out</tt>, e.g., "3x32,12x2". If
+ * environment variable \c LRU_BENCHMARK_CSV is set, then results are also
+ * appended to the file it names, one line per operation and shape, so that
+ * CI jobs can keep track of them over time.
+ *
+ * Note that each sample includes the overhead of reading the clock twice,
+ * which is in the order of a few dozen nanoseconds.
+ */
+/*!@{*/
+
+static MockTimebase mock_timebase;
+Timebase *LRU::timebase = &mock_timebase;
+
+namespace lru_latency_benchmarks
+{
+
+static MockMessages *mock_messages;
+
+static constexpr std::chrono::minutes maximum_age(5);
+
+/*!
+ * Number of timed calls of #LRU::Cache::use() and #LRU::Cache::pin().
+ */
+static constexpr size_t number_of_uses = 100000;
+static constexpr size_t number_of_pins = 10000;
+
+/*!
+ * Minimum number of purged subtrees per tree shape.
+ */
+static constexpr size_t minimum_number_of_purges = 100;
+
+/*!
+ * Maximum number of objects discarded per garbage collection slice.
+ */
+static constexpr size_t discards_per_gc_slice = 64;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    /* purging and garbage collection emit messages for each list */
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_IMPORTANT);
+
+    mock_timebase.reset();
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+class Object: public LRU::Entry
+{
+  public:
+    Object(const Object &) = delete;
+    Object &operator=(const Object &) = delete;
+
+    explicit Object(const std::shared_ptr<Entry> &parent):
+        LRU::Entry(parent)
+    {}
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override {}
+};
+
+/*!
+ * Tree with \c depth_ levels, each inner node having \c fan_out_ children.
+ */
+struct TreeShape
+{
+    size_t depth_;
+    size_t fan_out_;
+
+    size_t get_number_of_lists() const
+    {
+        size_t total = 0;
+        size_t on_level = 1;
+
+        for(size_t i = 0; i < depth_; ++i)
+        {
+            total += on_level;
+            on_level *= fan_out_;
+        }
+
+        return total;
+    }
+
+    std::string to_string() const
+    {
+        return std::to_string(depth_) + "x" + std::to_string(fan_out_);
+    }
+};
+
+/*!
+ * Few big directories, a typical media library, a deep folder structure on
+ * a USB stick, and a very deep and narrow path.
+ */
+static const std::vector<TreeShape> default_tree_shapes
+{
+    {3, 32}, {5, 8}, {12, 2}, {40, 1},
+};
+
+static std::vector<TreeShape> get_tree_shapes()
+{
+    const char *env = getenv("LRU_BENCHMARK_TREE_SHAPES");
+
+    if(env == nullptr || env[0] == '\0')
+        return default_tree_shapes;
+
+    std::vector<TreeShape> shapes;
+    std::istringstream in(env);
+    std::string token;
+
+    while(std::getline(in, token, ','))
+    {
+        TreeShape shape;
+        char x;
+        std::istringstream t(token);
+
+        if(!(t >> shape.depth_ >> x >> shape.fan_out_) || x != 'x' ||
+           shape.depth_ == 0 || shape.fan_out_ == 0 ||
+           shape.get_number_of_lists() > 1000000)
+            cut_fail("Invalid tree shape \"%s\" in LRU_BENCHMARK_TREE_SHAPES",
+                     token.c_str());
+
+        shapes.push_back(shape);
+    }
+
+    return shapes;
+}
+
+/*!
+ * Collect durations of single operations.
+ */
+class LatencyRecorder
+{
+  private:
+    using clock = std::chrono::steady_clock;
+
+    std::vector<uint64_t> samples_;
+
+  public:
+    LatencyRecorder(const LatencyRecorder &) = delete;
+    LatencyRecorder &operator=(const LatencyRecorder &) = delete;
+
+    explicit LatencyRecorder(size_t expected_number_of_samples)
+    {
+        samples_.reserve(expected_number_of_samples);
+    }
+
+    template <typename F>
+    auto measure(const F &fn)
+    {
+        const auto start = clock::now();
+        const auto result = fn();
+        const auto stop = clock::now();
+
+        samples_.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+
+        return result;
+    }
+
+    size_t size() const { return samples_.size(); }
+
+    void report(const char *what, const TreeShape &shape);
+
+  private:
+    uint64_t percentile(double p) const
+    {
+        if(samples_.empty())
+            return 0;
+
+        const size_t rank = size_t(p * double(samples_.size()) + 0.999999);
+        return samples_[std::min(std::max(rank, size_t(1)), samples_.size()) - 1];
+    }
+};
+
+void LatencyRecorder::report(const char *what, const TreeShape &shape)
+{
+    std::sort(samples_.begin(), samples_.end());
+
+    const uint64_t p50 = percentile(0.5);
+    const uint64_t p90 = percentile(0.9);
+    const uint64_t p99 = percentile(0.99);
+    const uint64_t p999 = percentile(0.999);
+    const uint64_t max = samples_.empty() ? 0 : samples_.back();
+
+    std::cout << std::left << std::setw(12) << what
+              << std::setw(6) << shape.to_string()
+              << std::right << std::setw(8) << shape.get_number_of_lists()
+              << " lists, " << std::setw(7) << samples_.size() << " samples:"
+              << " p50 " << std::setw(7) << p50
+              << " p90 " << std::setw(7) << p90
+              << " p99 " << std::setw(7) << p99
+              << " p99.9 " << std::setw(8) << p999
+              << " max " << std::setw(9) << max << " ns" << std::endl;
+
+    const char *csv_name = getenv("LRU_BENCHMARK_CSV");
+
+    if(csv_name == nullptr || csv_name[0] == '\0')
+        return;
+
+    std::ofstream csv(csv_name, std::ios::app);
+
+    if(csv.tellp() == 0)
+        csv << "operation,depth,fan_out,lists,samples,"
+               "p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+
+    csv << what << ',' << shape.depth_ << ',' << shape.fan_out_ << ','
+        << shape.get_number_of_lists() << ',' << samples_.size() << ','
+        << p50 << ',' << p90 << ',' << p99 << ',' << p999 << ',' << max
+        << '\n';
+}
+
+static std::unique_ptr<LRU::Cache> make_cache(const TreeShape &shape)
+{
+    auto cache = std::make_unique<LRU::Cache>(1024UL * 1024UL * 1024UL,
+                                              2 * shape.get_number_of_lists(),
+                                              maximum_age);
+    cache->set_callbacks([]{}, []{}, [] (ID::List id) {}, []{});
+    return cache;
+}
+
+/*!
+ * Fill cache with tree of given shape, level by level.
+ *
+ * \param cache
+ *     The cache to insert the lists into.
+ *
+ * \param shape
+ *     Shape of the tree.
+ *
+ * \param[out] levels
+ *     IDs of the lists on each level of the tree, root first.
+ *
+ * \param recorder
+ *     If not \c nullptr, then each insertion is timed.
+ */
+static void make_tree(LRU::Cache &cache, const TreeShape &shape,
+                      std::vector<std::vector<ID::List>> &levels,
+                      LatencyRecorder *recorder = nullptr)
+{
+    auto insert = [&cache, recorder] (const std::shared_ptr<LRU::Entry> &parent)
+    {
+        mock_timebase.step();
+
+        std::shared_ptr<LRU::Entry> obj = std::make_shared<Object>(parent);
+
+        const auto do_insert = [&cache, &obj]
+        {
+            return cache.insert(std::move(obj), LRU::CacheMode::CACHED, 0, 1);
+        };
+
+        const ID::List id = recorder != nullptr
+            ? recorder->measure(do_insert)
+            : do_insert();
+
+        cut_assert_true(id.is_valid());
+        return id;
+    };
+
+    levels.clear();
+    levels.push_back({insert(nullptr)});
+
+    for(size_t depth = 1; depth < shape.depth_; ++depth)
+    {
+        std::vector<ID::List> level;
+        level.reserve(levels.back().size() * shape.fan_out_);
+
+        for(const auto &parent_id : levels.back())
+        {
+            const auto parent = cache.lookup(parent_id);
+
+            for(size_t i = 0; i < shape.fan_out_; ++i)
+                level.push_back(insert(parent));
+        }
+
+        levels.emplace_back(std::move(level));
+    }
+
+    cppcut_assert_equal(shape.get_number_of_lists(), cache.count());
+}
+
+/*!\test
+ * Insertion of lists, parents before their children.
+ */
+void test_insert_latency(void)
+{
+    for(const auto &shape : get_tree_shapes())
+    {
+        auto cache = make_cache(shape);
+        LatencyRecorder recorder(shape.get_number_of_lists());
+        std::vector<std::vector<ID::List>> levels;
+
+        make_tree(*cache, shape, levels, &recorder);
+        recorder.report("insert", shape);
+        cache->self_check();
+    }
+}
+
+/*!\test
+ * Use of random lists, the hot path taken on each list access.
+ */
+void test_use_latency(void)
+{
+    for(const auto &shape : get_tree_shapes())
+    {
+        auto cache = make_cache(shape);
+        std::vector<std::vector<ID::List>> levels;
+        make_tree(*cache, shape, levels);
+
+        std::vector<ID::List> ids;
+        for(const auto &level : levels)
+            ids.insert(ids.end(), level.begin(), level.end());
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+        LatencyRecorder recorder(number_of_uses);
+
+        for(size_t i = 0; i < number_of_uses; ++i)
+        {
+            mock_timebase.step();
+            const ID::List id = ids[pick(rng)];
+            cppcut_assert_operator(ssize_t(0), <=,
+                                   recorder.measure([&cache, id] { return cache->use(id); }));
+        }
+
+        recorder.report("use", shape);
+        cache->self_check();
+    }
+}
+
+/*!\test
+ * Moving the pinned path from one random leaf to another.
+ */
+void test_pin_latency(void)
+{
+    for(const auto &shape : get_tree_shapes())
+    {
+        auto cache = make_cache(shape);
+        std::vector<std::vector<ID::List>> levels;
+        make_tree(*cache, shape, levels);
+
+        const auto &leaves(levels.back());
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> pick(0, leaves.size() - 1);
+        LatencyRecorder recorder(number_of_pins);
+
+        for(size_t i = 0; i < number_of_pins; ++i)
+        {
+            mock_timebase.step();
+            const ID::List id = leaves[pick(rng)];
+            cut_assert_true(recorder.measure([&cache, id] { return cache->pin(id); }));
+        }
+
+        cut_assert_false(cache->pin(ID::List()));
+
+        recorder.report("pin", shape);
+        cache->self_check();
+    }
+}
+
+/*!\test
+ * Slices of garbage collection discarding a whole expired tree.
+ *
+ * Because the mock timebase does not advance during garbage collection,
+ * slices are limited only by their number of discards, so the number of
+ * slices is the same on each run.
+ */
+void test_gc_slice_latency(void)
+{
+    static const LRU::GCBudget budget(discards_per_gc_slice,
+                                      std::chrono::milliseconds(1000));
+
+    for(const auto &shape : get_tree_shapes())
+    {
+        auto cache = make_cache(shape);
+        std::vector<std::vector<ID::List>> levels;
+        make_tree(*cache, shape, levels);
+
+        mock_timebase.step(std::chrono::milliseconds(maximum_age).count() + 1);
+
+        const size_t expected_slices =
+            (shape.get_number_of_lists() + discards_per_gc_slice - 1) /
+            discards_per_gc_slice;
+        LatencyRecorder recorder(expected_slices + 1);
+        bool is_incomplete = true;
+
+        while(is_incomplete)
+        {
+            recorder.measure([&cache, &is_incomplete]
+                             { return cache->gc(budget, is_incomplete); });
+            cppcut_assert_operator(expected_slices + 1, >=, recorder.size());
+        }
+
+        recorder.report("gc_slice", shape);
+        cppcut_assert_equal(size_t(0), cache->count());
+    }
+}
+
+/*!\test
+ * Sorting and purging subtrees below the root, as done when a USB device or
+ * UPnP server is removed or a list is found outdated.
+ *
+ * Kill lists are shuffled before they are sorted so that
+ * #LRU::Cache::toposort_for_purge() has some work to do.
+ */
+void test_purge_latency(void)
+{
+    for(const auto &shape : get_tree_shapes())
+    {
+        if(shape.depth_ < 2)
+            continue;
+
+        const size_t rounds =
+            (minimum_number_of_purges + shape.fan_out_ - 1) / shape.fan_out_;
+        std::mt19937 rng(42);
+        LatencyRecorder toposort(rounds * shape.fan_out_);
+        LatencyRecorder purge(rounds * shape.fan_out_);
+
+        for(size_t round = 0; round < rounds; ++round)
+        {
+            auto cache = make_cache(shape);
+            std::vector<std::vector<ID::List>> levels;
+            make_tree(*cache, shape, levels);
+
+            std::vector<ID::List> kill_list;
+
+            for(const auto &id : levels[1])
+            {
+                kill_list.clear();
+                cache->enumerate_subtree(*cache->lookup(id), kill_list);
+                std::shuffle(kill_list.begin(), kill_list.end(), rng);
+
+                cut_assert_true(toposort.measure(
+                    [&cache, &kill_list]
+                    {
+                        return cache->toposort_for_purge(kill_list.begin(),
+                                                         kill_list.end());
+                    }));
+
+                purge.measure(
+                    [&cache, &kill_list]
+                    {
+                        cache->purge_entries(kill_list.cbegin(), kill_list.cend());
+                        return true;
+                    });
+            }
+
+            cppcut_assert_equal(size_t(1), cache->count());
+            cache->self_check();
+        }
+
+        toposort.report("toposort", shape);
+        purge.report("purge", shape);
+    }
+}
+
+}
+
+/*!@}*/
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include "mock_messages.hh"
+
+#include "lru_pool_allocator.hh"
+
+/*!
+ * \addtogroup lru_pool_allocator_tests Unit tests
+ * \ingroup lru_cache
+ *
+ * Pool allocator for cached objects unit tests.
+ */
+/*!@{*/
+
+namespace lru_pool_allocator_tests
+{
+
+static MockMessages *mock_messages;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!
+ * Pools are per type and live forever, so each test uses its own type to
+ * start with a fresh pool.
+ */
+template <unsigned int N, size_t Size = 64>
+class Payload
+{
+  public:
+    static size_t live_objects;
+
+    const unsigned int value_;
+    char dummy_[Size];
+
+    Payload(const Payload &) = delete;
+    Payload &operator=(const Payload &) = delete;
+
+    explicit Payload(unsigned int value):
+        value_(value)
+    {
+        ++live_objects;
+    }
+
+    ~Payload()
+    {
+        --live_objects;
+    }
+};
+
+template <unsigned int N, size_t Size>
+size_t Payload<N, Size>::live_objects;
+
+template <typename T>
+static LRU::PoolStatistics get_statistics()
+{
+    return LRU::PoolAllocator<T>::get_pool().get_statistics();
+}
+
+template <typename T>
+static LRU::PoolStatistics get_shared_statistics()
+{
+    /* std::allocate_shared() allocates from the pool for its rebound type,
+     * so we need to find our pool by name */
+    const auto own_name(get_statistics<T>().name_);
+
+    for(const auto &s : LRU::PoolRegistry::get_singleton().get_statistics())
+        if(s.name_ == own_name && s.allocations_ > 0)
+            return s;
+
+    cut_fail("Pool not found");
+    return get_statistics<T>();
+}
+
+/*!\test
+ * Objects allocated via #LRU::make_pooled() are constructed and destroyed
+ * properly.
+ */
+void test_make_pooled_constructs_and_destroys_objects(void)
+{
+    using T = Payload<0>;
+
+    auto a = LRU::make_pooled<T>(5);
+    auto b = LRU::make_pooled<T>(6);
+
+    cppcut_assert_not_null(a.get());
+    cppcut_assert_not_null(b.get());
+    cppcut_assert_equal(5U, a->value_);
+    cppcut_assert_equal(6U, b->value_);
+    cppcut_assert_equal(size_t(2), T::live_objects);
+
+    a = nullptr;
+    cppcut_assert_equal(size_t(1), T::live_objects);
+
+    b = nullptr;
+    cppcut_assert_equal(size_t(0), T::live_objects);
+}
+
+/*!\test
+ * Allocations and deallocations are counted.
+ */
+void test_statistics(void)
+{
+    using T = Payload<1>;
+
+    auto a = LRU::make_pooled<T>(1);
+    auto b = LRU::make_pooled<T>(2);
+    auto c = LRU::make_pooled<T>(3);
+    b = nullptr;
+
+    const auto s(get_shared_statistics<T>());
+
+    cppcut_assert_equal(size_t(3), s.allocations_);
+    cppcut_assert_equal(size_t(1), s.deallocations_);
+    cppcut_assert_equal(size_t(2), s.in_use_);
+    cppcut_assert_equal(size_t(3), s.peak_in_use_);
+    cppcut_assert_equal(size_t(1), s.slabs_);
+    cppcut_assert_operator(sizeof(T), <, s.object_size_);
+    cut_assert_true(s.name_.find("Payload") != std::string::npos);
+}
+
+/*!\test
+ * Memory of freed objects is reused for new objects of the same type.
+ */
+void test_freed_memory_is_reused(void)
+{
+    using T = Payload<2>;
+
+    auto a = LRU::make_pooled<T>(1);
+    const T *const first_address = a.get();
+
+    a = nullptr;
+    a = LRU::make_pooled<T>(2);
+
+    cppcut_assert_equal(first_address, static_cast<const T *>(a.get()));
+    cppcut_assert_equal(2U, a->value_);
+}
+
+/*!\test
+ * Different types use different pools, even if their sizes are equal.
+ */
+void test_types_do_not_share_pools(void)
+{
+    using T1 = Payload<3>;
+    using T2 = Payload<4>;
+
+    auto a = LRU::make_pooled<T1>(1);
+    auto b = LRU::make_pooled<T2>(2);
+
+    cppcut_assert_equal(size_t(1), get_shared_statistics<T1>().in_use_);
+    cppcut_assert_equal(size_t(1), get_shared_statistics<T2>().in_use_);
+    cut_assert_true(get_shared_statistics<T1>().name_ !=
+                    get_shared_statistics<T2>().name_);
+}
+
+/*!\test
+ * New slabs are added on demand, and all objects are distinct.
+ */
+void test_pool_grows_by_slabs(void)
+{
+    using T = Payload<5, 4000>;
+
+    std::vector<std::shared_ptr<T>> objects;
+
+    objects.emplace_back(LRU::make_pooled<T>(0));
+
+    const size_t per_slab = get_shared_statistics<T>().objects_per_slab_;
+    cppcut_assert_operator(size_t(1), <, per_slab);
+
+    for(size_t i = 1; i < 2 * per_slab + 1; ++i)
+        objects.emplace_back(LRU::make_pooled<T>(i));
+
+    cppcut_assert_equal(size_t(3), get_shared_statistics<T>().slabs_);
+
+    for(size_t i = 0; i < objects.size(); ++i)
+        cppcut_assert_equal(unsigned(i), objects[i]->value_);
+
+    std::vector<const T *> addresses;
+    std::transform(objects.begin(), objects.end(), std::back_inserter(addresses),
+                   [] (const auto &o) { return o.get(); });
+    std::sort(addresses.begin(), addresses.end());
+    cut_assert_true(std::adjacent_find(addresses.begin(), addresses.end()) == addresses.end());
+
+    objects.clear();
+    cppcut_assert_equal(size_t(0), get_shared_statistics<T>().in_use_);
+
+    /* slabs are kept for reuse */
+    for(size_t i = 0; i < 2 * per_slab + 1; ++i)
+        objects.emplace_back(LRU::make_pooled<T>(i));
+
+    cppcut_assert_equal(size_t(3), get_shared_statistics<T>().slabs_);
+}
+
+/*!\test
+ * Allocation of arrays bypasses the pool.
+ */
+void test_array_allocation_bypasses_pool(void)
+{
+    using T = Payload<6>;
+
+    LRU::PoolAllocator<T> alloc;
+    T *array = alloc.allocate(3);
+    cppcut_assert_not_null(array);
+    alloc.deallocate(array, 3);
+
+    T *single = alloc.allocate(1);
+    cppcut_assert_not_null(single);
+    alloc.deallocate(single, 1);
+
+    const auto s(get_statistics<T>());
+    cppcut_assert_equal(size_t(1), s.allocations_);
+    cppcut_assert_equal(size_t(1), s.deallocations_);
+}
+
+}
+
+/*!@}*/
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015--2020, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2015--2020, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of T+A List Brokers.
  *
@@ -619,14 +619,13 @@ class EnumerateMediaListFiller: public TiledListFillerIface<UPnP::ItemData>
 
             const RawItem &it = items_[idx.get_raw_id()];
 
-            *item_provider.next() =
-                std::move(UPnP::ItemData(std::move(std::string("/de/tahifi/unittests/23/") + it.dbus_name_),
-                                         it.name_,
-                                         std::move(it.album_art_url_ != nullptr
-                                                   ? Url::String(Url::Sensitivity::GENERIC,
-                                                                 it.album_art_url_)
-                                                   : Url::String(Url::Sensitivity::GENERIC)),
-                                         it.type_ == UPnP::MediaList::Type::SUBDIRECTORY));
+            StringArena *strings;
+            UPnP::ItemData *item = item_provider.next(strings);
+            *item = UPnP::ItemData(*strings,
+                                   std::string("/de/tahifi/unittests/23/") + it.dbus_name_,
+                                   it.name_,
+                                   it.album_art_url_ != nullptr ? it.album_art_url_ : "",
+                                   it.type_ == UPnP::MediaList::Type::SUBDIRECTORY);
 
             idx = ID::Item(idx.get_raw_id() + 1);
         }
@@ -755,9 +754,9 @@ void test_enumerate_root_media_list()
     cppcut_assert_equal(std::get<1>(media_list_items_tree[0]), root_directory->size());
 
     /* OK, so there is a list now, but no materialized sublists yet */
+    cppcut_assert_equal(size_t(0), root_directory->get_number_of_children());
+
     std::vector <ID::List> nodes;
-    root_directory->enumerate_direct_sublists(*cache, nodes);
-    cppcut_assert_equal(size_t(0), nodes.size());
 
     cache->lookup(root_directory_id)->enumerate_tree_of_sublists(*cache, nodes);
     cppcut_assert_equal(size_t(1), nodes.size());
@@ -798,15 +797,12 @@ void test_enumerate_root_media_list()
         cppcut_assert_not_null(child.get());
         cppcut_assert_equal(std::get<1>(media_list_items_tree[i + 1]), child->size());
 
-        nodes.clear();
-        child->enumerate_direct_sublists(*cache, nodes);
-        cppcut_assert_equal(size_t(0), nodes.size());
+        cppcut_assert_equal(size_t(0), child->get_number_of_children());
     }
 
     /* root list has 3 populated child lists now */
-    nodes.clear();
-    root_directory->enumerate_direct_sublists(*cache, nodes);
-    cppcut_assert_equal(std::get<1>(media_list_items_tree[0]), nodes.size());
+    cppcut_assert_equal(std::get<1>(media_list_items_tree[0]),
+                        root_directory->get_number_of_children());
 
     /* add another nested list */
     mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
@@ -839,6 +835,36 @@ void test_enumerate_root_media_list()
     cut_assert_true(nodes[0] == root_directory_id);
 }
 
+/*!\test
+ * The size of a media list grows with the data stored in its tiles.
+ */
+void test_size_of_media_list_includes_tile_contents()
+{
+    EnumerateMediaListFiller filler(media_list_items_child_1);
+    auto list = std::make_shared<UPnP::MediaList>(nullptr,
+                                                  media_list_items_child_1.size(),
+                                                  filler);
+
+    const size_t empty_size = list->get_size_in_bytes();
+    cppcut_assert_equal(UPnP::MediaList::estimate_size_in_bytes(), empty_size);
+
+    mock_messages->expect_msg_vinfo_formatted(MESSAGE_LEVEL_DEBUG,
+                                              "prefetch 8 items, starting at index 0");
+    cut_assert_true(list->prefetch_range(ID::Item(0), media_list_items_child_1.size()));
+
+    size_t count = 0;
+    size_t expected_minimum_size = empty_size;
+
+    for(const auto &it : *list)
+    {
+        expected_minimum_size += it.get_specific_data().get_dbus_path().length();
+        ++count;
+    }
+
+    cppcut_assert_equal(media_list_items_child_1.size(), count);
+    cppcut_assert_operator(expected_minimum_size, <=, list->get_size_in_bytes());
+}
+
 /*!\test
  * Get D-Bus path of subdirectories, given only the subdirectory.
  *
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <string>
+
+#include "mock_messages.hh"
+
+#include "string_arena.hh"
+
+/*!
+ * \addtogroup string_arena_tests Unit tests
+ * \ingroup lru_cache
+ *
+ * String arena for tile items unit tests.
+ */
+/*!@{*/
+
+namespace string_arena_tests
+{
+
+static MockMessages *mock_messages;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!\test
+ * Stored strings are copies terminated by a zero byte.
+ */
+void test_stored_strings_are_zero_terminated_copies()
+{
+    StringArena arena;
+    std::string src("first string");
+
+    const auto first = arena.store(src);
+    const auto empty = arena.store("");
+    const auto second = arena.store("second");
+
+    src = "overwritten";
+
+    cppcut_assert_equal(std::string("first string"), std::string(first));
+    cppcut_assert_equal(size_t(0), empty.length());
+    cppcut_assert_equal(std::string("second"), std::string(second));
+    cppcut_assert_equal('\0', first.data()[first.length()]);
+    cppcut_assert_equal('\0', empty.data()[0]);
+    cppcut_assert_equal('\0', second.data()[second.length()]);
+}
+
+/*!\test
+ * Views remain valid while more chunks are allocated.
+ */
+void test_views_are_stable_while_arena_grows()
+{
+    StringArena arena;
+    std::vector<std::string_view> views;
+
+    for(unsigned int i = 0; i < 1000; ++i)
+        views.push_back(arena.store("string number " + std::to_string(i)));
+
+    cppcut_assert_operator(StringArena::MINIMUM_CHUNK_SIZE, <, arena.get_heap_size());
+
+    for(unsigned int i = 0; i < 1000; ++i)
+        cppcut_assert_equal("string number " + std::to_string(i),
+                            std::string(views[i]));
+}
+
+/*!\test
+ * Strings larger than the chunk size are stored as well.
+ */
+void test_large_strings_are_stored()
+{
+    StringArena arena;
+    const std::string small("small");
+    const std::string large(3 * StringArena::MAXIMUM_CHUNK_SIZE, 'x');
+
+    const auto a = arena.store(small);
+    const auto b = arena.store(large);
+    const auto c = arena.store(small);
+
+    cppcut_assert_equal(small, std::string(a));
+    cppcut_assert_equal(large, std::string(b));
+    cppcut_assert_equal(small, std::string(c));
+}
+
+/*!\test
+ * Clearing keeps the largest chunk so that refilling does not allocate.
+ */
+void test_clear_keeps_largest_chunk()
+{
+    StringArena arena;
+    cut_assert_true(arena.empty());
+    cppcut_assert_equal(size_t(0), arena.get_heap_size());
+
+    for(unsigned int i = 0; i < 200; ++i)
+        arena.store("some string which is stored in the arena");
+
+    cut_assert_false(arena.empty());
+    const size_t size_before = arena.get_heap_size();
+
+    arena.clear();
+    cut_assert_true(arena.empty());
+
+    const size_t size_after_clear = arena.get_heap_size();
+    cppcut_assert_operator(size_t(0), <, size_after_clear);
+    cppcut_assert_operator(size_before, >, size_after_clear);
+
+    for(unsigned int i = 0; i < 100; ++i)
+        arena.store("some string which is stored in the arena");
+
+    cppcut_assert_equal(size_after_clear, arena.get_heap_size());
+}
+
+/*!\test
+ * The chunk kept by clearing is the largest one, not the last one.
+ */
+void test_clear_keeps_chunk_of_large_string()
+{
+    StringArena arena;
+    const std::string small("small");
+    const std::string large(3 * StringArena::MAXIMUM_CHUNK_SIZE, 'x');
+
+    arena.store(small);
+    arena.store(large);
+    arena.store(small);
+
+    arena.clear();
+
+    const size_t size_after_clear = arena.get_heap_size();
+    cppcut_assert_operator(large.size(), <, size_after_clear);
+
+    cppcut_assert_equal(large, std::string(arena.store(large)));
+    cppcut_assert_equal(size_after_clear, arena.get_heap_size());
+}
+
+/*!\test
+ * Views remain valid when the arena object is moved.
+ */
+void test_views_survive_moving_the_arena()
+{
+    StringArena arena;
+    const auto view = arena.store("moved along");
+
+    StringArena other(std::move(arena));
+    cut_assert_true(arena.empty());
+    cppcut_assert_equal(size_t(0), arena.get_heap_size());
+
+    StringArena third;
+    third = std::move(other);
+
+    cppcut_assert_equal(std::string("moved along"), std::string(view));
+    cut_assert_false(third.empty());
+}
+
+}
+
+/*!@}*/
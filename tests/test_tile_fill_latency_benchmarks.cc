@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include <cstdlib>
+
+#include "mock_messages.hh"
+
+#include "lists_base.hh"
+
+/*!
+ * \addtogroup tile_fill_latency_benchmarks Tile fill latency benchmarks
+ * \ingroup lru_cache
+ *
+ * Time it takes until a list item becomes readable when tiles are filled by
+ * a slow filler.
+ *
+ * A single filler thread fills tiles of a #ListTiles_ object, taking a fixed
+ * amount of time per request as a slow UPnP server would, plus a little time
+ * per item for parsing the answer. Note that a single request may fill
+ * several adjacent tiles. The time between the request of an item and the
+ * moment the reader can access it is measured, and its 50th, 90th, and 99th
+ * percentiles and the maximum are printed to the test log.
+ *
+ * The time taken per request and per item can be changed by setting
+ * environment variables \c TILE_BENCHMARK_FILL_DELAY_US and
+ * \c TILE_BENCHMARK_ITEM_DELAY_US to a number of microseconds. If
+ * environment variable \c TILE_BENCHMARK_CSV is set, then results are also
+ * appended to the file it names, one line per scenario.
+ */
+/*!@{*/
+
+static Timebase real_timebase;
+Timebase *LRU::timebase = &real_timebase;
+
+namespace tile_fill_latency_benchmarks
+{
+
+static MockMessages *mock_messages;
+
+static constexpr uint16_t tile_size = 8;
+static constexpr size_t number_of_tiles = 5;
+static constexpr size_t number_of_items = 1000;
+static constexpr size_t number_of_rounds = 20;
+
+static constexpr std::chrono::microseconds default_fill_delay(2000);
+static constexpr std::chrono::microseconds default_item_delay(100);
+
+struct Item
+{
+    uint32_t value_ = UINT32_MAX;
+
+    void reset() { value_ = UINT32_MAX; }
+    size_t get_heap_size() const { return 0; }
+};
+
+using Threads = ListThreads<Item, tile_size>;
+using Tiles = ListTiles_<Item, tile_size, number_of_tiles>;
+
+static Threads *thread_pool;
+
+static std::chrono::microseconds get_delay(const char *name,
+                                           std::chrono::microseconds fallback)
+{
+    const char *env = getenv(name);
+
+    if(env == nullptr || env[0] == '\0')
+        return fallback;
+
+    return std::chrono::microseconds(strtoul(env, nullptr, 10));
+}
+
+static std::chrono::microseconds get_fill_delay()
+{
+    return get_delay("TILE_BENCHMARK_FILL_DELAY_US", default_fill_delay);
+}
+
+static std::chrono::microseconds get_item_delay()
+{
+    return get_delay("TILE_BENCHMARK_ITEM_DELAY_US", default_item_delay);
+}
+
+/*!
+ * Filler which takes a fixed amount of time per request and per item.
+ */
+class SlowFiller: public TiledListFillerIface<Item>
+{
+  private:
+    const std::chrono::microseconds delay_;
+    const std::chrono::microseconds item_delay_;
+
+  public:
+    SlowFiller(const SlowFiller &) = delete;
+    SlowFiller &operator=(const SlowFiller &) = delete;
+
+    explicit SlowFiller(std::chrono::microseconds delay,
+                        std::chrono::microseconds item_delay):
+        delay_(delay),
+        item_delay_(item_delay)
+    {}
+
+    ssize_t fill(ItemProvider<Item> &item_provider, ID::List list_id,
+                 ID::Item idx, size_t count, ListError &error,
+                 const std::function<bool()> &may_continue) const override
+    {
+        std::this_thread::sleep_for(delay_);
+
+        size_t n = 0;
+
+        for(uint32_t i = idx.get_raw_id(); i < number_of_items && n < count; ++i, ++n)
+        {
+            std::this_thread::sleep_for(item_delay_);
+            item_provider.next()->value_ = i;
+        }
+
+        error = ListError::OK;
+        return n;
+    }
+};
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    /* tile management emits messages for each tile */
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_IMPORTANT);
+
+    thread_pool = new Threads(false);
+    cppcut_assert_not_null(thread_pool);
+    thread_pool->start(1);
+}
+
+void cut_teardown(void)
+{
+    thread_pool->shutdown();
+    delete thread_pool;
+    thread_pool = nullptr;
+
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!
+ * Collect times until items became readable.
+ */
+class LatencyRecorder
+{
+  private:
+    using clock = std::chrono::steady_clock;
+
+    std::vector<uint64_t> samples_;
+
+  public:
+    LatencyRecorder(const LatencyRecorder &) = delete;
+    LatencyRecorder &operator=(const LatencyRecorder &) = delete;
+
+    explicit LatencyRecorder(size_t expected_number_of_samples)
+    {
+        samples_.reserve(expected_number_of_samples);
+    }
+
+    /*!
+     * Request item, wait until it can be read.
+     */
+    void measure(Tiles &tiles, const SlowFiller &filler, ID::Item idx)
+    {
+        const auto start = clock::now();
+
+        cut_assert_true(tiles.prefetch(filler, ID::List(1), idx, 1,
+                                       number_of_items, true));
+        const uint32_t value = tiles.begin(idx)->get_specific_data().value_;
+
+        const auto stop = clock::now();
+
+        cppcut_assert_equal(idx.get_raw_id(), value);
+        samples_.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+    }
+
+    void report(const char *what, std::chrono::microseconds fill_delay,
+                std::chrono::microseconds item_delay);
+
+  private:
+    uint64_t percentile(double p) const
+    {
+        if(samples_.empty())
+            return 0;
+
+        const size_t rank = size_t(p * double(samples_.size()) + 0.999999);
+        return samples_[std::min(std::max(rank, size_t(1)), samples_.size()) - 1];
+    }
+};
+
+void LatencyRecorder::report(const char *what, std::chrono::microseconds fill_delay,
+                             std::chrono::microseconds item_delay)
+{
+    std::sort(samples_.begin(), samples_.end());
+
+    const uint64_t p50 = percentile(0.5);
+    const uint64_t p90 = percentile(0.9);
+    const uint64_t p99 = percentile(0.99);
+    const uint64_t max = samples_.empty() ? 0 : samples_.back();
+
+    std::cout << std::left << std::setw(20) << what
+              << std::right << std::setw(7) << fill_delay.count()
+              << " us per request, " << std::setw(5) << item_delay.count()
+              << " us per item, " << std::setw(5) << samples_.size() << " samples:"
+              << " p50 " << std::setw(7) << p50
+              << " p90 " << std::setw(7) << p90
+              << " p99 " << std::setw(7) << p99
+              << " max " << std::setw(7) << max << " us" << std::endl;
+
+    const char *csv_name = getenv("TILE_BENCHMARK_CSV");
+
+    if(csv_name == nullptr || csv_name[0] == '\0')
+        return;
+
+    std::ofstream csv(csv_name, std::ios::app);
+
+    if(csv.tellp() == 0)
+        csv << "scenario,fill_delay_us,item_delay_us,samples,"
+               "p50_us,p90_us,p99_us,max_us\n";
+
+    csv << what << ',' << fill_delay.count() << ',' << item_delay.count() << ','
+        << samples_.size() << ','
+        << p50 << ',' << p90 << ',' << p99 << ',' << max << '\n';
+}
+
+/*!\test
+ * First access to a list, all tiles are empty.
+ *
+ * This is the lower bound for all other scenarios: the tile containing the
+ * requested item is filled first, so the reader waits for a single request.
+ */
+void test_first_access_latency(void)
+{
+    const auto fill_delay = get_fill_delay();
+    const auto item_delay = get_item_delay();
+    const SlowFiller filler(fill_delay, item_delay);
+    LatencyRecorder recorder(number_of_rounds);
+
+    for(size_t i = 0; i < number_of_rounds; ++i)
+    {
+        Tiles tiles(*thread_pool, tile_size);
+        recorder.measure(tiles, filler, ID::Item(500));
+        thread_pool->wait_empty();
+    }
+
+    recorder.report("first_access", fill_delay, item_delay);
+}
+
+/*!\test
+ * First item of a freshly entered list.
+ *
+ * The reader should not need to wait for the remaining items of the tile.
+ */
+void test_first_item_latency(void)
+{
+    const auto fill_delay = get_fill_delay();
+    const auto item_delay = get_item_delay();
+    const SlowFiller filler(fill_delay, item_delay);
+    LatencyRecorder recorder(number_of_rounds);
+
+    for(size_t i = 0; i < number_of_rounds; ++i)
+    {
+        Tiles tiles(*thread_pool, tile_size);
+        recorder.measure(tiles, filler, ID::Item(0));
+        thread_pool->wait_empty();
+    }
+
+    recorder.report("first_item", fill_delay, item_delay);
+}
+
+/*!\test
+ * Access to the last tile of the ring right after the ring has been filled
+ * for another item.
+ *
+ * The tile containing the item is still queued for speculative prefetching
+ * when it is requested, so it should jump ahead of the other queued tiles.
+ */
+void test_demand_in_ring_latency(void)
+{
+    const auto fill_delay = get_fill_delay();
+    const auto item_delay = get_item_delay();
+    const SlowFiller filler(fill_delay, item_delay);
+    LatencyRecorder recorder(number_of_rounds);
+
+    for(size_t i = 0; i < number_of_rounds; ++i)
+    {
+        Tiles tiles(*thread_pool, tile_size);
+        cut_assert_true(tiles.prefetch(filler, ID::List(1), ID::Item(500), 1,
+                                       number_of_items, false));
+        recorder.measure(tiles, filler, ID::Item(500 + 2 * tile_size));
+        thread_pool->wait_empty();
+    }
+
+    recorder.report("demand_in_ring", fill_delay, item_delay);
+}
+
+/*!\test
+ * Fast scrolling down, one tile per access, without waiting for
+ * prefetched tiles.
+ *
+ * Each access slides the ring and queues new tiles, so that the reader
+ * competes with prefetching of tiles it may never look at.
+ */
+void test_fast_scrolling_latency(void)
+{
+    const auto fill_delay = get_fill_delay();
+    const auto item_delay = get_item_delay();
+    const SlowFiller filler(fill_delay, item_delay);
+    static constexpr size_t steps = 40;
+    LatencyRecorder recorder(number_of_rounds * steps);
+
+    for(size_t i = 0; i < number_of_rounds; ++i)
+    {
+        Tiles tiles(*thread_pool, tile_size);
+
+        for(size_t step = 0; step < steps; ++step)
+            recorder.measure(tiles, filler, ID::Item(step * tile_size));
+
+        thread_pool->wait_empty();
+    }
+
+    recorder.report("fast_scrolling", fill_delay, item_delay);
+}
+
+}
+
+/*!@}*/
@@ -0,0 +1,619 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <thread>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include "mock_messages.hh"
+
+#include "lists.hh"
+#include "lru_killed_lists.hh"
+
+/*!
+ * \addtogroup tiled_lists_tests Unit tests
+ * \ingroup lru_cache
+ *
+ * Tiled lists in the cache.
+ */
+/*!@{*/
+
+static Timebase real_timebase;
+Timebase *LRU::timebase = &real_timebase;
+
+namespace tiled_lists_tests
+{
+
+static constexpr uint16_t tile_size = 8;
+static constexpr size_t number_of_tiles = 3;
+
+/* a single tile, so that there is exactly one fill per list */
+static constexpr size_t number_of_items = tile_size;
+
+struct Item
+{
+    uint32_t value_ = UINT32_MAX;
+
+    void reset() { value_ = UINT32_MAX; }
+    size_t get_heap_size() const { return 0; }
+};
+
+using List = TiledList<Item, tile_size, number_of_tiles>;
+
+static LRU::Cache *cache;
+static std::atomic<bool> is_list_removed;
+
+}
+
+template<>
+ListThreads<tiled_lists_tests::Item, tiled_lists_tests::tile_size> &
+TiledList<tiled_lists_tests::Item, tiled_lists_tests::tile_size,
+          tiled_lists_tests::number_of_tiles>::get_thread_pool()
+{
+    static ListThreads<tiled_lists_tests::Item, tiled_lists_tests::tile_size> thread_pool(false);
+    return thread_pool;
+}
+
+namespace tiled_lists_tests
+{
+
+/*!
+ * Filler which looks up its list in the cache only after the list has been
+ * removed from the cache.
+ *
+ * The lookup is done as in the real fillers, so it has to wait for the cache
+ * lock if the cache is still locked.
+ */
+class SlowFiller: public TiledListFillerIface<Item>
+{
+  public:
+    mutable std::atomic<bool> is_filling_;
+
+    SlowFiller(const SlowFiller &) = delete;
+    SlowFiller &operator=(const SlowFiller &) = delete;
+
+    explicit SlowFiller(): is_filling_(false) {}
+
+    ssize_t fill(ItemProvider<Item> &item_provider, ID::List list_id,
+                 ID::Item idx, size_t count, ListError &error,
+                 const std::function<bool()> &may_continue) const override
+    {
+        error = ListError::OK;
+        is_filling_ = true;
+
+        while(!is_list_removed)
+            std::this_thread::yield();
+
+        if(cache->lookup(list_id) == nullptr)
+        {
+            error = ListError::INVALID_ID;
+            return -1;
+        }
+
+        size_t n = 0;
+
+        for(uint32_t i = idx.get_raw_id(); i < number_of_items && n < count; ++i, ++n)
+            item_provider.next()->value_ = i;
+
+        return n;
+    }
+};
+
+class TestList: public List
+{
+  public:
+    TestList(const TestList &) = delete;
+    TestList &operator=(const TestList &) = delete;
+
+    explicit TestList(const SlowFiller &filler):
+        List(nullptr, number_of_items, filler)
+    {}
+
+    void obliviate_child(ID::List child_id, const LRU::Entry *child) override
+    {
+        cut_fail("Unexpected obliviate");
+    }
+};
+
+static MockMessages *mock_messages;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    /* tile management and purging emit messages */
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_IMPORTANT);
+
+    cache = new LRU::Cache(200000, 100, std::chrono::minutes(1));
+    cppcut_assert_not_null(cache);
+    cache->set_callbacks([]{}, []{},
+                         [] (ID::List id) { is_list_removed = true; }, []{});
+
+    LRU::KilledLists::get_singleton().reset();
+
+    List::start_threads(1, false);
+}
+
+void cut_teardown(void)
+{
+    List::shutdown_threads();
+
+    delete cache;
+    cache = nullptr;
+
+    LRU::KilledLists::get_singleton().reset();
+
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!\test
+ * Purging a list while its tiles are being filled does not deadlock.
+ *
+ * The last reference to the purged list is held by the cache. Destroying the
+ * list waits for the filler, and the filler waits for the cache lock when
+ * looking up the list, so the list must be destroyed after the cache has been
+ * unlocked. The filler looks up the list only after it has been removed from
+ * the cache, so that the deadlock would happen in each round.
+ */
+void test_purge_list_while_filling_tiles()
+{
+    static constexpr size_t number_of_rounds = 20;
+
+    for(size_t i = 0; i < number_of_rounds; ++i)
+    {
+        const SlowFiller filler;
+        ID::List list_id;
+        is_list_removed = false;
+
+        {
+            auto list = std::make_shared<TestList>(filler);
+            const List &l(*list);
+            list_id = cache->insert(std::move(list), LRU::CacheMode::CACHED,
+                                    0, sizeof(TestList));
+            cut_assert_true(list_id.is_valid());
+
+            std::ostringstream os;
+            os << "Failed filling tile from list " << list_id.get_raw_id()
+               << ", index 0";
+            mock_messages->expect_msg_error_formatted(0, LOG_ERR, os.str().c_str());
+
+            cut_assert_true(l.prefetch_range(ID::Item(i % number_of_items), 1));
+        }
+
+        while(!filler.is_filling_)
+            std::this_thread::yield();
+
+        std::vector<ID::List> kill_list;
+        kill_list.push_back(list_id);
+        cut_assert_true(cache->toposort_for_purge(kill_list.begin(), kill_list.end()));
+        cache->purge_entries(kill_list.begin(), kill_list.end());
+
+        cppcut_assert_equal(size_t(0), cache->count());
+        List::sync_threads();
+    }
+}
+
+}
+
+namespace list_tiles_tests
+{
+
+static constexpr uint16_t tile_size = 8;
+
+struct Item
+{
+    uint32_t value_ = UINT32_MAX;
+
+    void reset() { value_ = UINT32_MAX; }
+    size_t get_heap_size() const { return 0; }
+};
+
+/*!
+ * Filler which stores each item's index in the item and remembers which
+ * items have been filled.
+ */
+class RecordingFiller: public TiledListFillerIface<Item>
+{
+  private:
+    const size_t number_of_items_;
+    mutable std::mutex lock_;
+    mutable std::set<uint32_t> filled_tiles_;
+
+  public:
+    RecordingFiller(const RecordingFiller &) = delete;
+    RecordingFiller &operator=(const RecordingFiller &) = delete;
+
+    explicit RecordingFiller(size_t number_of_items):
+        number_of_items_(number_of_items)
+    {}
+
+    ssize_t fill(ItemProvider<Item> &item_provider, ID::List list_id,
+                 ID::Item idx, size_t count, ListError &error,
+                 const std::function<bool()> &may_continue) const override
+    {
+        error = ListError::OK;
+
+        std::lock_guard<std::mutex> lock(lock_);
+        size_t n = 0;
+
+        for(uint32_t i = idx.get_raw_id(); i < number_of_items_ && n < count; ++i, ++n)
+        {
+            item_provider.next()->value_ = i;
+            filled_tiles_.insert(i - i % tile_size);
+        }
+
+        return n;
+    }
+
+    /*!
+     * Bases of tiles filled since last call, separated by blanks.
+     */
+    std::string take_filled_tiles() const
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        std::ostringstream os;
+
+        for(const auto &base : filled_tiles_)
+            os << (os.tellp() > 0 ? " " : "") << base;
+
+        filled_tiles_.clear();
+
+        return os.str();
+    }
+};
+
+/*!
+ * Tile cache with \p N tiles and its filler thread.
+ */
+template <size_t N>
+class Tiles
+{
+  private:
+    ListThreads<Item, tile_size> thread_pool_;
+    const size_t number_of_items_;
+
+  public:
+    const RecordingFiller filler_;
+    ListTiles_<Item, tile_size, N> tiles_;
+
+    Tiles(const Tiles &) = delete;
+    Tiles &operator=(const Tiles &) = delete;
+
+    explicit Tiles(size_t number_of_items):
+        thread_pool_(false),
+        number_of_items_(number_of_items),
+        filler_(number_of_items),
+        tiles_(thread_pool_)
+    {
+        thread_pool_.start(1);
+    }
+
+    /*!
+     * Prefetch and wait until all tiles have been filled.
+     */
+    bool prefetch(uint32_t first, size_t count = 1, bool auto_slide = true)
+    {
+        const bool result =
+            tiles_.prefetch(filler_, ID::List(1), ID::Item(first), count,
+                            number_of_items_, auto_slide);
+
+        thread_pool_.wait_empty();
+        thread_pool_.start(thread_pool_.shutdown());
+
+        return result;
+    }
+
+    /*!
+     * Bases of tiles in logical slot order, separated by blanks.
+     *
+     * Items must match their indices. Empty slots are skipped.
+     */
+    std::string get_ring() const
+    {
+        std::ostringstream os;
+        uint32_t expected_id = UINT32_MAX;
+
+        for(auto it = tiles_.begin(); it != tiles_.end(); ++it)
+        {
+            const uint32_t id = it.get_item_id();
+
+            cppcut_assert_equal(id, it->get_specific_data().value_);
+
+            if(id != expected_id)
+                cppcut_assert_equal(uint32_t(0), id % tile_size);
+
+            if(id % tile_size == 0)
+                os << (os.tellp() > 0 ? " " : "") << id;
+
+            expected_id = id + 1;
+        }
+
+        return os.str();
+    }
+
+    void expect_center_item(uint32_t id) const
+    {
+        cppcut_assert_equal(id, tiles_.get_list_item_unsafe(ID::Item(id)).get_specific_data().value_);
+    }
+};
+
+static MockMessages *mock_messages;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_IMPORTANT);
+
+    LRU::KilledLists::get_singleton().reset();
+}
+
+void cut_teardown(void)
+{
+    LRU::KilledLists::get_singleton().reset();
+
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!\test
+ * Five tiles are filled around the accessed item, two above and two below.
+ */
+void test_initial_fill_with_five_tiles()
+{
+    Tiles<5> t(200);
+
+    cut_assert_true(t.prefetch(80));
+    cppcut_assert_equal(std::string("64 72 80 88 96"), t.get_ring());
+    cppcut_assert_equal(std::string("64 72 80 88 96"), t.filler_.take_filled_tiles());
+    t.expect_center_item(80);
+}
+
+/*!\test
+ * Four tiles are filled around the accessed item, one above and two below.
+ */
+void test_initial_fill_with_four_tiles()
+{
+    Tiles<4> t(200);
+
+    cut_assert_true(t.prefetch(80));
+    cppcut_assert_equal(std::string("72 80 88 96"), t.get_ring());
+    cppcut_assert_equal(std::string("72 80 88 96"), t.filler_.take_filled_tiles());
+    t.expect_center_item(80);
+}
+
+/*!\test
+ * Accessing the last tile slides it into the second slot, and sliding back
+ * up takes the evicted tiles from cold store.
+ */
+void test_slide_down_and_up_with_five_tiles()
+{
+    Tiles<5> t(200);
+
+    cut_assert_true(t.prefetch(80));
+    t.filler_.take_filled_tiles();
+
+    cut_assert_true(t.prefetch(100));
+    cppcut_assert_equal(std::string("88 96 104 112 120"), t.get_ring());
+    cppcut_assert_equal(std::string("104 112 120"), t.filler_.take_filled_tiles());
+    t.expect_center_item(100);
+
+    cut_assert_true(t.prefetch(90));
+    cppcut_assert_equal(std::string("64 72 80 88 96"), t.get_ring());
+    cppcut_assert_equal(std::string(""), t.filler_.take_filled_tiles());
+    t.expect_center_item(90);
+
+    cut_assert_true(t.prefetch(64));
+    cppcut_assert_equal(std::string("40 48 56 64 72"), t.get_ring());
+    cppcut_assert_equal(std::string("40 48 56"), t.filler_.take_filled_tiles());
+    t.expect_center_item(64);
+}
+
+/*!\test
+ * Sliding with four tiles keeps one tile above the center after sliding down
+ * and one tile below the center after sliding up.
+ */
+void test_slide_down_and_up_with_four_tiles()
+{
+    Tiles<4> t(200);
+
+    cut_assert_true(t.prefetch(80));
+    t.filler_.take_filled_tiles();
+
+    cut_assert_true(t.prefetch(96));
+    cppcut_assert_equal(std::string("88 96 104 112"), t.get_ring());
+    cppcut_assert_equal(std::string("104 112"), t.filler_.take_filled_tiles());
+    t.expect_center_item(96);
+
+    cut_assert_true(t.prefetch(88));
+    cppcut_assert_equal(std::string("72 80 88 96"), t.get_ring());
+    cppcut_assert_equal(std::string(""), t.filler_.take_filled_tiles());
+    t.expect_center_item(88);
+
+    cut_assert_true(t.prefetch(72));
+    cppcut_assert_equal(std::string("56 64 72 80"), t.get_ring());
+    cppcut_assert_equal(std::string("56 64"), t.filler_.take_filled_tiles());
+    t.expect_center_item(72);
+}
+
+/*!\test
+ * Tiles wrap around at both ends of the list.
+ */
+void test_tiles_wrap_around_list_boundaries()
+{
+    Tiles<5> t(200);
+
+    cut_assert_true(t.prefetch(0));
+    cppcut_assert_equal(std::string("184 192 0 8 16"), t.get_ring());
+    cppcut_assert_equal(std::string("0 8 16 184 192"), t.filler_.take_filled_tiles());
+
+    cut_assert_true(t.prefetch(199));
+    cppcut_assert_equal(std::string("168 176 184 192 0"), t.get_ring());
+    cppcut_assert_equal(std::string("168 176"), t.filler_.take_filled_tiles());
+    t.expect_center_item(199);
+
+    Tiles<4> u(200);
+
+    cut_assert_true(u.prefetch(192));
+    cppcut_assert_equal(std::string("184 192 0 8"), u.get_ring());
+    cppcut_assert_equal(std::string("0 8 184 192"), u.filler_.take_filled_tiles());
+
+    cut_assert_true(u.prefetch(8));
+    cppcut_assert_equal(std::string("0 8 16 24"), u.get_ring());
+    cppcut_assert_equal(std::string("16 24"), u.filler_.take_filled_tiles());
+    u.expect_center_item(8);
+}
+
+/*!\test
+ * Sliding down from an item in the tile before the short last tile ends up
+ * in the last tile, not at the beginning of the list.
+ */
+void test_slide_down_into_short_last_tile()
+{
+    Tiles<5> t(197);
+
+    cut_assert_true(t.prefetch(168));
+    cppcut_assert_equal(std::string("152 160 168 176 184"), t.get_ring());
+    t.filler_.take_filled_tiles();
+
+    cut_assert_true(t.prefetch(190));
+    cppcut_assert_equal(std::string("176 184 192 0 8"), t.get_ring());
+    cppcut_assert_equal(std::string("0 8 192"), t.filler_.take_filled_tiles());
+    t.expect_center_item(190);
+
+    Tiles<4> u(197);
+
+    cut_assert_true(u.prefetch(176));
+    cppcut_assert_equal(std::string("168 176 184 192"), u.get_ring());
+    u.filler_.take_filled_tiles();
+
+    cut_assert_true(u.prefetch(190));
+    cppcut_assert_equal(std::string("176 184 192 0"), u.get_ring());
+    cppcut_assert_equal(std::string("0"), u.filler_.take_filled_tiles());
+    u.expect_center_item(190);
+}
+
+/*!\test
+ * Ranges spanning three tiles slide down if they start in the center tile or
+ * below, and they slide up if they end in the center tile or above.
+ */
+void test_three_tile_ranges_slide_towards_range()
+{
+    Tiles<5> t(200);
+
+    cut_assert_true(t.prefetch(80));
+    t.filler_.take_filled_tiles();
+
+    cut_assert_true(t.prefetch(96, 17, false));
+    cppcut_assert_equal(std::string("88 96 104 112 120"), t.get_ring());
+    cppcut_assert_equal(std::string("104 112 120"), t.filler_.take_filled_tiles());
+
+    cut_assert_true(t.prefetch(72, 17, false));
+    cppcut_assert_equal(std::string("64 72 80 88 96"), t.get_ring());
+    cppcut_assert_equal(std::string(""), t.filler_.take_filled_tiles());
+
+    cut_assert_true(t.prefetch(88, 17, false));
+    cppcut_assert_equal(std::string("80 88 96 104 112"), t.get_ring());
+    cppcut_assert_equal(std::string(""), t.filler_.take_filled_tiles());
+
+    cut_assert_true(t.prefetch(72, 17, false));
+    cppcut_assert_equal(std::string("64 72 80 88 96"), t.get_ring());
+    cppcut_assert_equal(std::string(""), t.filler_.take_filled_tiles());
+
+    Tiles<4> u(200);
+
+    cut_assert_true(u.prefetch(80));
+    u.filler_.take_filled_tiles();
+
+    cut_assert_true(u.prefetch(64, 17, false));
+    cppcut_assert_equal(std::string("64 72 80 88"), u.get_ring());
+    cppcut_assert_equal(std::string("64"), u.filler_.take_filled_tiles());
+
+    cut_assert_true(u.prefetch(80, 17, false));
+    cppcut_assert_equal(std::string("72 80 88 96"), u.get_ring());
+    cppcut_assert_equal(std::string(""), u.filler_.take_filled_tiles());
+
+    cut_assert_true(u.prefetch(88, 17, false));
+    cppcut_assert_equal(std::string("80 88 96 104"), u.get_ring());
+    cppcut_assert_equal(std::string("104"), u.filler_.take_filled_tiles());
+}
+
+/*!\test
+ * Lists which fit into the tiles are filled once, sliding only rotates the
+ * ring of tiles.
+ */
+void test_short_list_is_only_rotated()
+{
+    Tiles<5> t(20);
+
+    cut_assert_true(t.prefetch(0));
+    cppcut_assert_equal(std::string("16 0 8"), t.get_ring());
+    cppcut_assert_equal(std::string("0 8 16"), t.filler_.take_filled_tiles());
+
+    cut_assert_true(t.prefetch(8));
+    cut_assert_true(t.prefetch(19));
+    cut_assert_true(t.prefetch(3));
+    cut_assert_true(t.prefetch(16));
+    cppcut_assert_equal(std::string(""), t.filler_.take_filled_tiles());
+    t.expect_center_item(16);
+
+    Tiles<4> u(20);
+
+    cut_assert_true(u.prefetch(8));
+    cppcut_assert_equal(std::string("0 8 16"), u.get_ring());
+    cppcut_assert_equal(std::string("0 8 16"), u.filler_.take_filled_tiles());
+
+    cut_assert_true(u.prefetch(16));
+    cut_assert_true(u.prefetch(0));
+    cut_assert_true(u.prefetch(19));
+    cut_assert_true(u.prefetch(8));
+    cppcut_assert_equal(std::string(""), u.filler_.take_filled_tiles());
+    u.expect_center_item(8);
+
+    for(uint32_t i = 0; i < 20; ++i)
+    {
+        cut_assert_true(u.prefetch(i));
+        u.expect_center_item(i);
+    }
+
+    cppcut_assert_equal(std::string(""), u.filler_.take_filled_tiles());
+}
+
+}
+
+/*!@}*/
@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <fstream>
+#include <iterator>
+#include <cstdlib>
+#include <cstddef>
+#include <unistd.h>
+
+#include "mock_messages.hh"
+
+#include "upnp_snapshot.hh"
+
+/*!
+ * \addtogroup upnp_snapshot_tests Unit tests
+ * \ingroup upnp
+ *
+ * Browse snapshot file format unit tests.
+ */
+/*!@{*/
+
+namespace upnp_snapshot_tests
+{
+
+static MockMessages *mock_messages;
+static std::string temp_dir;
+static std::string snapshot_file;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_DIAG);
+
+    char dir[] = "/tmp/test_upnp_snapshot.XXXXXX";
+    cppcut_assert_not_null(mkdtemp(dir));
+    temp_dir = dir;
+    snapshot_file = temp_dir + "/snapshot";
+}
+
+void cut_teardown(void)
+{
+    unlink(snapshot_file.c_str());
+    unlink((snapshot_file + ".tmp").c_str());
+    rmdir(temp_dir.c_str());
+
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+struct ReadItem
+{
+    uint32_t index_;
+    std::string path_;
+    std::string name_;
+    std::string album_art_url_;
+    bool is_container_;
+};
+
+static ssize_t read_items(const UPnP::BrowseSnapshot &snapshot,
+                          const std::string &server, const std::string &path,
+                          size_t number_of_children, uint32_t first,
+                          size_t count, std::vector<ReadItem> &items)
+{
+    items.clear();
+
+    return snapshot.lookup_items(server, path, number_of_children, first, count,
+        [&items] (uint32_t idx, const UPnP::SnapshotItem &item)
+        {
+            items.push_back({idx, item.path_, item.name_, item.album_art_url_,
+                             item.is_container_});
+        });
+}
+
+/*!
+ * Add container with items in given range, named after their indices.
+ */
+static void add_container(UPnP::BrowseSnapshotWriter &writer,
+                          const std::string &server, const std::string &path,
+                          uint32_t number_of_children,
+                          uint32_t first, uint32_t count,
+                          uint64_t captured_at = 1000)
+{
+    writer.add_container(std::string(server), std::string(path),
+                         number_of_children, captured_at);
+
+    for(uint32_t i = first; i < first + count; ++i)
+        writer.add_item(i, path + "/" + std::to_string(i),
+                        "Item " + std::to_string(i),
+                        i % 2 == 0 ? "http://art/" + std::to_string(i) : "",
+                        i % 3 == 0);
+}
+
+static std::string read_file(const std::string &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string &filename, const std::string &content)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+/*!\test
+ * Items written to a snapshot can be read back.
+ */
+void test_write_and_read_back(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:b", "/c1", 20, 0, 16);
+    add_container(writer, "uuid:a", "", 3, 0, 3);
+    cut_assert_true(writer.write(snapshot_file));
+
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_true(snapshot.open(snapshot_file));
+    cppcut_assert_equal(size_t(2), snapshot.get_number_of_containers());
+
+    uint32_t n = 0;
+    cut_assert_true(snapshot.get_number_of_children("uuid:b", "/c1", n));
+    cppcut_assert_equal(20U, n);
+    cut_assert_true(snapshot.get_number_of_children("uuid:a", "", n));
+    cppcut_assert_equal(3U, n);
+    cut_assert_false(snapshot.get_number_of_children("uuid:a", "/c1", n));
+    cut_assert_false(snapshot.get_number_of_children("uuid:c", "", n));
+
+    std::vector<ReadItem> items;
+    cppcut_assert_equal(ssize_t(8), read_items(snapshot, "uuid:b", "/c1", 20, 8, 8, items));
+    cppcut_assert_equal(size_t(8), items.size());
+
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        const auto &it(items[i]);
+        cppcut_assert_equal(8 + i, it.index_);
+        cppcut_assert_equal("/c1/" + std::to_string(8 + i), it.path_);
+        cppcut_assert_equal("Item " + std::to_string(8 + i), it.name_);
+        cppcut_assert_equal(i % 2 == 0 ? "http://art/" + std::to_string(8 + i) : "",
+                            it.album_art_url_);
+        cppcut_assert_equal((8 + i) % 3 == 0, it.is_container_);
+    }
+
+    cppcut_assert_equal(ssize_t(3), read_items(snapshot, "uuid:a", "", 3, 0, 3, items));
+    cppcut_assert_equal(std::string("/0"), items[0].path_);
+    cppcut_assert_equal(std::string("Item 2"), items[2].name_);
+}
+
+/*!\test
+ * Ranges are served only if they are completely contained in the snapshot.
+ */
+void test_incomplete_ranges_are_not_served(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:a", "/c", 40, 8, 8);
+    add_container(writer, "uuid:a", "/c", 40, 24, 8);
+    cut_assert_true(writer.write(snapshot_file));
+
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_true(snapshot.open(snapshot_file));
+
+    std::vector<ReadItem> items;
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 40, 0, 8, items));
+    cppcut_assert_equal(ssize_t(8), read_items(snapshot, "uuid:a", "/c", 40, 8, 8, items));
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 40, 12, 8, items));
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 40, 16, 8, items));
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 40, 32, 8, items));
+    cut_assert_true(items.empty());
+
+    /* first writer entry wins */
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 40, 24, 8, items));
+}
+
+/*!\test
+ * Requested ranges are clipped to the end of the container.
+ */
+void test_range_is_clipped_to_number_of_children(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:a", "/c", 11, 8, 3);
+    cut_assert_true(writer.write(snapshot_file));
+
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_true(snapshot.open(snapshot_file));
+
+    std::vector<ReadItem> items;
+    cppcut_assert_equal(ssize_t(3), read_items(snapshot, "uuid:a", "/c", 11, 8, 8, items));
+    cppcut_assert_equal(10U, items.back().index_);
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 11, 11, 8, items));
+}
+
+/*!\test
+ * Containers whose number of children has changed are retired on access.
+ */
+void test_outdated_container_is_retired(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:a", "/c", 8, 0, 8);
+    cut_assert_true(writer.write(snapshot_file));
+
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_true(snapshot.open(snapshot_file));
+
+    std::vector<ReadItem> items;
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 9, 0, 8, items));
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 8, 0, 8, items));
+
+    uint32_t n;
+    cut_assert_false(snapshot.get_number_of_children("uuid:a", "/c", n));
+}
+
+/*!\test
+ * Retired containers are not served anymore.
+ */
+void test_retired_container_is_not_served(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:a", "/c", 8, 0, 8);
+    add_container(writer, "uuid:a", "/d", 8, 0, 8);
+    cut_assert_true(writer.write(snapshot_file));
+
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_true(snapshot.open(snapshot_file));
+
+    cut_assert_true(snapshot.retire("uuid:a", "/c"));
+    cut_assert_false(snapshot.retire("uuid:a", "/c"));
+    cut_assert_false(snapshot.retire("uuid:a", "/e"));
+
+    std::vector<ReadItem> items;
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 8, 0, 8, items));
+    cppcut_assert_equal(ssize_t(8), read_items(snapshot, "uuid:a", "/d", 8, 0, 8, items));
+}
+
+/*!\test
+ * Containers which have not been retired are kept in the next snapshot,
+ * unless they are too old or superseded by fresh data.
+ */
+void test_carry_over_to_next_snapshot(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:a", "/new", 8, 0, 8, 2000);
+    add_container(writer, "uuid:a", "/old", 8, 0, 8, 500);
+    add_container(writer, "uuid:a", "/retired", 8, 0, 8, 2000);
+    add_container(writer, "uuid:a", "/updated", 8, 0, 8, 2000);
+    cut_assert_true(writer.write(snapshot_file));
+
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_true(snapshot.open(snapshot_file));
+    cut_assert_true(snapshot.retire("uuid:a", "/retired"));
+
+    UPnP::BrowseSnapshotWriter next;
+    add_container(next, "uuid:a", "/updated", 12, 0, 12, 3000);
+    cppcut_assert_equal(size_t(2), snapshot.carry_over(next, 1000));
+    cut_assert_true(next.write(snapshot_file));
+
+    /* the old file is still mapped, but has been replaced on disk */
+    std::vector<ReadItem> items;
+    cppcut_assert_equal(ssize_t(8), read_items(snapshot, "uuid:a", "/updated", 8, 0, 8, items));
+
+    UPnP::BrowseSnapshot reread;
+    cut_assert_true(reread.open(snapshot_file));
+    cppcut_assert_equal(size_t(2), reread.get_number_of_containers());
+
+    uint32_t n;
+    cut_assert_true(reread.get_number_of_children("uuid:a", "/new", n));
+    cut_assert_false(reread.get_number_of_children("uuid:a", "/old", n));
+    cut_assert_false(reread.get_number_of_children("uuid:a", "/retired", n));
+    cut_assert_true(reread.get_number_of_children("uuid:a", "/updated", n));
+    cppcut_assert_equal(12U, n);
+    cppcut_assert_equal(ssize_t(8), read_items(reread, "uuid:a", "/updated", 12, 4, 8, items));
+}
+
+/*!\test
+ * A missing snapshot file is not an error.
+ */
+void test_missing_file_is_not_an_error(void)
+{
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_false(snapshot.open(snapshot_file));
+    cut_assert_false(snapshot.is_open());
+
+    std::vector<ReadItem> items;
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "", 8, 0, 8, items));
+}
+
+/*!\test
+ * Files which are not snapshots are rejected.
+ */
+void test_file_with_bad_magic_is_rejected(void)
+{
+    write_file(snapshot_file, std::string(64, 'x'));
+
+    UPnP::BrowseSnapshot snapshot;
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Ignoring browse snapshot " + snapshot_file + ": bad magic").c_str());
+    cut_assert_false(snapshot.open(snapshot_file));
+    cut_assert_false(snapshot.is_open());
+}
+
+/*!\test
+ * Truncated snapshots are rejected.
+ */
+void test_truncated_file_is_rejected(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:a", "/c", 8, 0, 8);
+    cut_assert_true(writer.write(snapshot_file));
+
+    const auto content(read_file(snapshot_file));
+
+    write_file(snapshot_file, content.substr(0, content.size() - 1));
+
+    UPnP::BrowseSnapshot snapshot;
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Ignoring browse snapshot " + snapshot_file + ": size mismatch").c_str());
+    cut_assert_false(snapshot.open(snapshot_file));
+
+    write_file(snapshot_file, content.substr(0, 10));
+
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Ignoring browse snapshot " + snapshot_file + ": file too short").c_str());
+    cut_assert_false(snapshot.open(snapshot_file));
+}
+
+/*!\test
+ * Containers with broken references are detected on first access and are
+ * not served, other containers are still usable.
+ */
+void test_corrupt_container_is_not_served(void)
+{
+    UPnP::BrowseSnapshotWriter writer;
+    add_container(writer, "uuid:a", "/c", 8, 0, 8);
+    add_container(writer, "uuid:a", "/d", 8, 0, 8);
+    cut_assert_true(writer.write(snapshot_file));
+
+    auto content(read_file(snapshot_file));
+
+    /* point name of first item of container "/c" beyond string pool */
+    const size_t name_offset =
+        sizeof(UPnP::SnapshotFormat::FileHeader) +
+        2 * sizeof(UPnP::SnapshotFormat::ContainerRecord) +
+        offsetof(UPnP::SnapshotFormat::ItemRecord, name_);
+    const uint32_t bad_offset = 0xffffff00;
+    content.replace(name_offset, sizeof(bad_offset),
+                    reinterpret_cast<const char *>(&bad_offset), sizeof(bad_offset));
+    write_file(snapshot_file, content);
+
+    UPnP::BrowseSnapshot snapshot;
+    cut_assert_true(snapshot.open(snapshot_file));
+
+    std::vector<ReadItem> items;
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Browse snapshot " + snapshot_file + ": container 0 is corrupt").c_str());
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 8, 0, 8, items));
+    cppcut_assert_equal(ssize_t(-1), read_items(snapshot, "uuid:a", "/c", 8, 0, 8, items));
+    cppcut_assert_equal(ssize_t(8), read_items(snapshot, "uuid:a", "/d", 8, 0, 8, items));
+}
+
+}
+
+/*!@}*/
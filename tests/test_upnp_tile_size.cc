@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+
+#include "mock_messages.hh"
+
+#include "upnp_tile_size.hh"
+
+/*!
+ * \addtogroup upnp_tile_size_tests Unit tests
+ * \ingroup upnp
+ *
+ * Adaptive tile size unit tests.
+ */
+/*!@{*/
+
+namespace upnp_tile_size_tests
+{
+
+static MockMessages *mock_messages;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_DIAG);
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+static uint16_t add_samples(UPnP::TileSizeAdvisor &advisor, unsigned int n,
+                            size_t bytes_per_item,
+                            std::chrono::milliseconds round_trip)
+{
+    uint16_t result = advisor.get_tile_size();
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        const size_t items = advisor.get_tile_size();
+        result = advisor.add_sample(items, items, items * bytes_per_item,
+                                    round_trip);
+    }
+
+    return result;
+}
+
+/*!\test
+ * Initial tile size is clamped to configured bounds.
+ */
+void test_initial_tile_size_is_clamped()
+{
+    cppcut_assert_equal(uint16_t(8), UPnP::TileSizeAdvisor(8, 4, 16).get_tile_size());
+    cppcut_assert_equal(uint16_t(4), UPnP::TileSizeAdvisor(1, 4, 16).get_tile_size());
+    cppcut_assert_equal(uint16_t(16), UPnP::TileSizeAdvisor(100, 4, 16).get_tile_size());
+}
+
+/*!\test
+ * Tile size is not changed before enough samples have been taken.
+ */
+void test_tile_size_is_stable_with_few_samples()
+{
+    UPnP::TileSizeAdvisor fast(8, 4, 16);
+    cppcut_assert_equal(uint16_t(8),
+                        add_samples(fast,
+                                    UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES - 1,
+                                    100, std::chrono::milliseconds(1)));
+
+    UPnP::TileSizeAdvisor slow(8, 4, 16);
+    cppcut_assert_equal(uint16_t(8),
+                        add_samples(slow,
+                                    UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES - 1,
+                                    100, std::chrono::milliseconds(1000)));
+}
+
+/*!\test
+ * Fast servers get larger tiles, up to the configured maximum.
+ */
+void test_fast_server_gets_larger_tiles()
+{
+    UPnP::TileSizeAdvisor advisor(8, 4, 16);
+
+    add_samples(advisor, UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES,
+                100, std::chrono::milliseconds(5));
+    cppcut_assert_equal(uint16_t(16), advisor.get_tile_size());
+
+    add_samples(advisor, 10 * UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES,
+                100, std::chrono::milliseconds(5));
+    cppcut_assert_equal(uint16_t(16), advisor.get_tile_size());
+}
+
+/*!\test
+ * Slow servers get smaller tiles, down to the configured minimum.
+ */
+void test_slow_server_gets_smaller_tiles()
+{
+    UPnP::TileSizeAdvisor advisor(8, 4, 16);
+
+    add_samples(advisor, UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES,
+                100, std::chrono::milliseconds(1000));
+    cppcut_assert_equal(uint16_t(4), advisor.get_tile_size());
+
+    add_samples(advisor, 10 * UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES,
+                100, std::chrono::milliseconds(1000));
+    cppcut_assert_equal(uint16_t(4), advisor.get_tile_size());
+}
+
+/*!\test
+ * Moderately fast servers keep their tile size.
+ */
+void test_medium_server_keeps_tile_size()
+{
+    UPnP::TileSizeAdvisor advisor(8, 4, 16);
+
+    add_samples(advisor, 10 * UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES,
+                100, std::chrono::milliseconds(200));
+    cppcut_assert_equal(uint16_t(8), advisor.get_tile_size());
+}
+
+/*!\test
+ * Tiles do not grow beyond payload limit, even for fast servers.
+ */
+void test_large_items_limit_tile_size()
+{
+    UPnP::TileSizeAdvisor advisor(8, 4, 16);
+    const size_t bytes_per_item =
+        UPnP::TileSizeAdvisor::MAXIMUM_PAYLOAD_PER_TILE / 10;
+
+    add_samples(advisor, 10 * UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES,
+                bytes_per_item, std::chrono::milliseconds(5));
+    cppcut_assert_equal(uint16_t(8), advisor.get_tile_size());
+
+    add_samples(advisor, 10 * UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES,
+                2 * bytes_per_item, std::chrono::milliseconds(5));
+    cppcut_assert_equal(uint16_t(5), advisor.get_tile_size());
+}
+
+/*!\test
+ * Samples for partially filled tiles are scaled to the current tile size.
+ */
+void test_short_answers_are_scaled()
+{
+    UPnP::TileSizeAdvisor advisor(16, 4, 16);
+
+    for(unsigned int i = 0; i < 10 * UPnP::TileSizeAdvisor::MINIMUM_NUMBER_OF_SAMPLES; ++i)
+        advisor.add_sample(2, 2, 200, std::chrono::milliseconds(60));
+
+    cppcut_assert_equal(uint16_t(8), advisor.get_tile_size());
+}
+
+}
+
+/*!@}*/
@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <dirent.h>
+
+#include "mock_messages.hh"
+
+#include "usb_dir_index.hh"
+
+/*!
+ * \addtogroup usb_dir_index_tests Unit tests
+ * \ingroup usb
+ *
+ * Directory index and patching of directory lists unit tests.
+ */
+/*!@{*/
+
+struct FakeDirEntry
+{
+    const char *name_;
+    unsigned char dtype_;
+};
+
+/* contents of the directory "read" by #USB::DirIndex::read_from_file_system() */
+static std::vector<FakeDirEntry> fake_directory;
+static bool fake_directory_is_readable;
+
+extern "C" int os_foreach_in_path(const char *path,
+                                  int (*callback)(const char *path,
+                                                  unsigned char dtype,
+                                                  void *user_data),
+                                  void *user_data)
+{
+    if(!fake_directory_is_readable)
+        return -1;
+
+    for(const auto &e : fake_directory)
+        callback(e.name_, e.dtype_, user_data);
+
+    return 0;
+}
+
+namespace usb_dir_index_tests
+{
+
+static MockMessages *mock_messages;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    fake_directory.clear();
+    fake_directory_is_readable = true;
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+/*!
+ * Build index by inserting the given entries, directories have a trailing
+ * slash in their names.
+ */
+static USB::DirIndex make_index(const std::vector<std::string> &entries)
+{
+    USB::DirIndex index;
+
+    for(const auto &e : entries)
+    {
+        const bool is_dir = !e.empty() && e.back() == '/';
+        const std::string name(is_dir ? e.substr(0, e.size() - 1) : e);
+        size_t pos;
+
+        cut_assert_true(index.insert(name.c_str(), is_dir, pos));
+    }
+
+    return index;
+}
+
+/*!
+ * Entries of the index in index order, same format as for #make_index().
+ */
+static std::vector<std::string> get_entries(const USB::DirIndex &index)
+{
+    std::vector<std::string> result;
+
+    for(size_t i = 0; i < index.size(); ++i)
+        result.push_back(std::string(index.get_name(i)) +
+                         (index.get_kind(i).is_directory() ? "/" : ""));
+
+    return result;
+}
+
+static void expect_entries(const std::vector<std::string> &expected,
+                           const USB::DirIndex &index)
+{
+    const auto entries(get_entries(index));
+
+    cppcut_assert_equal(expected.size(), entries.size());
+
+    for(size_t i = 0; i < expected.size(); ++i)
+        cppcut_assert_equal(expected[i], entries[i]);
+}
+
+/*!\test
+ * Directories come first, then files, both sorted by name.
+ */
+void test_read_from_file_system_sorts_directories_before_files(void)
+{
+    fake_directory = {
+        {"zebra.mp3", DT_REG}, {"Music", DT_DIR}, {"abba.mp3", DT_REG},
+        {"link", DT_LNK}, {"Audiobooks", DT_DIR}, {"Zappa.flac", DT_REG},
+    };
+
+    USB::DirIndex index;
+    cut_assert_true(index.read_from_file_system("/media/usb"));
+
+    expect_entries({"Audiobooks/", "Music/", "Zappa.flac", "abba.mp3", "zebra.mp3"},
+                   index);
+    cppcut_assert_equal(size_t(2), index.get_number_of_directories());
+}
+
+/*!\test
+ * Failure to read a directory leaves an empty index.
+ */
+void test_read_unreadable_directory_fails(void)
+{
+    fake_directory = {{"file", DT_REG}};
+    fake_directory_is_readable = false;
+
+    USB::DirIndex index;
+    cut_assert_false(index.read_from_file_system("/media/usb"));
+    cut_assert_true(index.empty());
+}
+
+/*!\test
+ * Entries are inserted at their sorted positions within their group.
+ */
+void test_insert_entries_at_sorted_positions(void)
+{
+    USB::DirIndex index;
+    size_t pos;
+
+    cut_assert_true(index.insert("b.mp3", false, pos));
+    cppcut_assert_equal(size_t(0), pos);
+    cut_assert_true(index.insert("a.mp3", false, pos));
+    cppcut_assert_equal(size_t(0), pos);
+    cut_assert_true(index.insert("c.mp3", false, pos));
+    cppcut_assert_equal(size_t(2), pos);
+    cut_assert_true(index.insert("Dir", true, pos));
+    cppcut_assert_equal(size_t(0), pos);
+    cut_assert_true(index.insert("c.mp3", true, pos));
+    cppcut_assert_equal(size_t(1), pos);
+
+    expect_entries({"Dir/", "c.mp3/", "a.mp3", "b.mp3", "c.mp3"}, index);
+    cppcut_assert_equal(size_t(2), index.get_number_of_directories());
+}
+
+/*!\test
+ * Inserting an entry which is in the index already fails.
+ */
+void test_insert_existing_entry_fails(void)
+{
+    auto index(make_index({"Dir/", "file"}));
+    size_t pos = 42;
+
+    cut_assert_false(index.insert("Dir", true, pos));
+    cppcut_assert_equal(size_t(0), pos);
+    cut_assert_false(index.insert("file", false, pos));
+    cppcut_assert_equal(size_t(1), pos);
+
+    expect_entries({"Dir/", "file"}, index);
+}
+
+/*!\test
+ * Entries are removed from their positions, the others move up.
+ */
+void test_remove_entries(void)
+{
+    auto index(make_index({"A/", "B/", "a", "b", "c"}));
+    size_t pos;
+
+    cut_assert_true(index.remove("b", false, pos));
+    cppcut_assert_equal(size_t(3), pos);
+    cut_assert_true(index.remove("A", true, pos));
+    cppcut_assert_equal(size_t(0), pos);
+
+    expect_entries({"B/", "a", "c"}, index);
+    cppcut_assert_equal(size_t(1), index.get_number_of_directories());
+}
+
+/*!\test
+ * Removing an entry which is not in the index fails, also if there is an
+ * entry of the same name, but of other kind.
+ */
+void test_remove_nonexistent_entry_fails(void)
+{
+    auto index(make_index({"A/", "a"}));
+    size_t pos;
+
+    cut_assert_false(index.remove("b", false, pos));
+    cut_assert_false(index.remove("a", true, pos));
+    cut_assert_false(index.remove("A", false, pos));
+
+    expect_entries({"A/", "a"}, index);
+}
+
+/*!\test
+ * Finding an entry returns its position, or the position it would have to be
+ * inserted at.
+ */
+void test_find_entries(void)
+{
+    const auto index(make_index({"B/", "D/", "b", "d"}));
+    size_t pos;
+
+    cut_assert_true(index.find("D", true, pos));
+    cppcut_assert_equal(size_t(1), pos);
+    cut_assert_true(index.find("d", false, pos));
+    cppcut_assert_equal(size_t(3), pos);
+
+    cut_assert_false(index.find("A", true, pos));
+    cppcut_assert_equal(size_t(0), pos);
+    cut_assert_false(index.find("E", true, pos));
+    cppcut_assert_equal(size_t(2), pos);
+    cut_assert_false(index.find("c", false, pos));
+    cppcut_assert_equal(size_t(3), pos);
+    cut_assert_false(index.find("e", false, pos));
+    cppcut_assert_equal(size_t(4), pos);
+    cut_assert_false(index.find("d", true, pos));
+    cppcut_assert_equal(size_t(2), pos);
+}
+
+/*!\test
+ * Directories are found before files of the same name.
+ */
+void test_find_by_name_prefers_directories(void)
+{
+    const auto index(make_index({"x/", "x", "y"}));
+    size_t pos;
+
+    cut_assert_true(index.find_by_name("x", pos));
+    cppcut_assert_equal(size_t(0), pos);
+    cut_assert_true(index.find_by_name("y", pos));
+    cppcut_assert_equal(size_t(2), pos);
+    cut_assert_false(index.find_by_name("z", pos));
+}
+
+/*!\test
+ * Names of removed entries are dropped by cloning the index.
+ */
+void test_clone_drops_removed_names(void)
+{
+    auto index(make_index({"Dir/", "a-rather-long-file-name", "b"}));
+    size_t pos;
+
+    cut_assert_true(index.remove("a-rather-long-file-name", false, pos));
+
+    const auto copy(index.clone());
+
+    expect_entries({"Dir/", "b"}, copy);
+    cppcut_assert_equal(size_t(1), copy.get_number_of_directories());
+    cppcut_assert_equal(size_t(6), copy.get_names().size());
+}
+
+/*!\test
+ * Links of items after an inserted entry are moved down by one.
+ */
+void test_move_child_links_for_insertion(void)
+{
+    std::map<uint32_t, ID::List> child_by_item{
+        {0, ID::List(10)}, {3, ID::List(13)}, {5, ID::List(15)},
+    };
+    std::unordered_map<uint32_t, uint32_t> item_by_child{
+        {10, 0}, {13, 3}, {15, 5},
+    };
+
+    USB::move_child_links(child_by_item, item_by_child, 3, 1);
+
+    cppcut_assert_equal(size_t(3), child_by_item.size());
+    cppcut_assert_equal(10U, child_by_item.at(0).get_raw_id());
+    cppcut_assert_equal(13U, child_by_item.at(4).get_raw_id());
+    cppcut_assert_equal(15U, child_by_item.at(6).get_raw_id());
+
+    cppcut_assert_equal(size_t(3), item_by_child.size());
+    cppcut_assert_equal(0U, item_by_child.at(10));
+    cppcut_assert_equal(4U, item_by_child.at(13));
+    cppcut_assert_equal(6U, item_by_child.at(15));
+}
+
+/*!\test
+ * Links of items after a removed entry are moved up by one.
+ */
+void test_move_child_links_for_removal(void)
+{
+    std::map<uint32_t, ID::List> child_by_item{
+        {0, ID::List(10)}, {4, ID::List(14)}, {5, ID::List(15)},
+    };
+    std::unordered_map<uint32_t, uint32_t> item_by_child{
+        {10, 0}, {14, 4}, {15, 5},
+    };
+
+    /* item 3 has been removed */
+    USB::move_child_links(child_by_item, item_by_child, 4, -1);
+
+    cppcut_assert_equal(size_t(3), child_by_item.size());
+    cppcut_assert_equal(10U, child_by_item.at(0).get_raw_id());
+    cppcut_assert_equal(14U, child_by_item.at(3).get_raw_id());
+    cppcut_assert_equal(15U, child_by_item.at(4).get_raw_id());
+
+    cppcut_assert_equal(0U, item_by_child.at(10));
+    cppcut_assert_equal(3U, item_by_child.at(14));
+    cppcut_assert_equal(4U, item_by_child.at(15));
+}
+
+/*!\test
+ * Moving links behind the last link changes nothing.
+ */
+void test_move_child_links_behind_last_link_is_noop(void)
+{
+    std::map<uint32_t, ID::List> child_by_item{{2, ID::List(12)}};
+    std::unordered_map<uint32_t, uint32_t> item_by_child{{12, 2}};
+
+    USB::move_child_links(child_by_item, item_by_child, 3, 1);
+
+    cppcut_assert_equal(size_t(1), child_by_item.size());
+    cppcut_assert_equal(12U, child_by_item.at(2).get_raw_id());
+    cppcut_assert_equal(2U, item_by_child.at(12));
+}
+
+/*!\test
+ * Identical indexes have no differences.
+ */
+void test_collect_differences_of_equal_indexes(void)
+{
+    const auto a(make_index({"A/", "B/", "a", "b"}));
+    const auto b(make_index({"B/", "b", "a", "A/"}));
+
+    std::vector<USB::DirChange> changes;
+    USB::collect_differences(a, b, changes);
+
+    cut_assert_true(changes.empty());
+}
+
+/*!\test
+ * Added and removed entries are reported in index order.
+ */
+void test_collect_differences_of_added_and_removed_entries(void)
+{
+    const auto a(make_index({"A/", "C/", "a", "c"}));
+    const auto b(make_index({"B/", "C/", "a", "b"}));
+
+    std::vector<USB::DirChange> changes;
+    USB::collect_differences(a, b, changes);
+
+    cppcut_assert_equal(size_t(4), changes.size());
+
+    cppcut_assert_equal(std::string("A"), changes[0].name_);
+    cut_assert_true(changes[0].is_directory_);
+    cut_assert_false(changes[0].is_added_);
+
+    cppcut_assert_equal(std::string("B"), changes[1].name_);
+    cut_assert_true(changes[1].is_directory_);
+    cut_assert_true(changes[1].is_added_);
+
+    cppcut_assert_equal(std::string("b"), changes[2].name_);
+    cut_assert_false(changes[2].is_directory_);
+    cut_assert_true(changes[2].is_added_);
+
+    cppcut_assert_equal(std::string("c"), changes[3].name_);
+    cut_assert_false(changes[3].is_directory_);
+    cut_assert_false(changes[3].is_added_);
+}
+
+/*!\test
+ * A file replaced by a directory of the same name is reported as removal of
+ * the file and addition of the directory.
+ */
+void test_collect_differences_of_entry_changing_kind(void)
+{
+    const auto a(make_index({"x"}));
+    const auto b(make_index({"x/"}));
+
+    std::vector<USB::DirChange> changes;
+    USB::collect_differences(a, b, changes);
+
+    cppcut_assert_equal(size_t(2), changes.size());
+
+    cppcut_assert_equal(std::string("x"), changes[0].name_);
+    cut_assert_true(changes[0].is_directory_);
+    cut_assert_true(changes[0].is_added_);
+
+    cppcut_assert_equal(std::string("x"), changes[1].name_);
+    cut_assert_false(changes[1].is_directory_);
+    cut_assert_false(changes[1].is_added_);
+}
+
+/*!\test
+ * Applying the collected differences to the old index yields the new index.
+ */
+void test_applying_collected_differences_yields_new_index(void)
+{
+    std::mt19937 rng(23);
+    std::vector<std::string> all;
+
+    for(unsigned int i = 0; i < 200; ++i)
+        all.push_back("entry" + std::to_string(i) + (i % 4 == 0 ? "/" : ""));
+
+    for(unsigned int round = 0; round < 20; ++round)
+    {
+        std::vector<std::string> old_entries;
+        std::vector<std::string> new_entries;
+
+        for(const auto &e : all)
+        {
+            if(rng() % 2 == 0)
+                old_entries.push_back(e);
+
+            if(rng() % 2 == 0)
+                new_entries.push_back(e);
+        }
+
+        auto index(make_index(old_entries));
+        const auto new_index(make_index(new_entries));
+
+        std::vector<USB::DirChange> changes;
+        USB::collect_differences(index, new_index, changes);
+
+        for(const auto &change : changes)
+        {
+            size_t pos;
+
+            if(change.is_added_)
+                cut_assert_true(index.insert(change.name_.c_str(),
+                                             change.is_directory_, pos));
+            else
+                cut_assert_true(index.remove(change.name_.c_str(),
+                                             change.is_directory_, pos));
+        }
+
+        cut_assert_true(get_entries(index) == get_entries(new_index));
+    }
+}
+
+}
+
+/*!@}*/
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <array>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+#include "mock_messages.hh"
+
+#include "usb_dir_index.hh"
+
+/*!
+ * \addtogroup usb_path_benchmarks USB path resolution benchmarks
+ * \ingroup usb
+ *
+ * Resolution of deep paths in large USB directories.
+ *
+ * Paths stored in bookmarks and location traces are resolved component by
+ * component, each component being looked up by name in the
+ * #USB::DirIndex of its directory. This benchmark compares a linear scan
+ * over each directory with #USB::DirIndex::find_by_name(). As with the LRU
+ * benchmarks, a few invariants are checked, but the main purpose is to print
+ * timing information to the test log.
+ */
+/*!@{*/
+
+/* directories are never read from the file system in this benchmark */
+extern "C" int os_foreach_in_path(const char *path,
+                                  int (*callback)(const char *path,
+                                                  unsigned char dtype,
+                                                  void *user_data),
+                                  void *user_data)
+{
+    cut_fail("Unexpected call of os_foreach_in_path()");
+    return -1;
+}
+
+namespace usb_path_benchmarks
+{
+
+static MockMessages *mock_messages;
+
+static constexpr size_t path_depth = 10;
+static constexpr size_t entries_per_directory = 10000;
+static constexpr size_t directories_per_directory = 1000;
+static constexpr size_t number_of_paths = 1000;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+}
+
+void cut_teardown(void)
+{
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+class StopWatch
+{
+  private:
+    using clock = std::chrono::steady_clock;
+
+    const clock::time_point start_;
+
+  public:
+    StopWatch(const StopWatch &) = delete;
+    StopWatch &operator=(const StopWatch &) = delete;
+
+    explicit StopWatch(): start_(clock::now()) {}
+
+    std::chrono::nanoseconds elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_);
+    }
+};
+
+static void report(const char *impl, std::chrono::nanoseconds duration)
+{
+    const double ns_per_path = double(duration.count()) / double(number_of_paths);
+
+    std::cout << std::left << std::setw(14) << impl
+              << std::right << std::setw(3) << path_depth << " levels, "
+              << std::setw(6) << entries_per_directory << " entries: "
+              << std::fixed << std::setprecision(1) << std::setw(12)
+              << ns_per_path << " ns/path, " << std::setw(10)
+              << ns_per_path / path_depth << " ns/component" << std::endl;
+}
+
+/*!
+ * Make index of a directory with names that sort like on a media stick.
+ *
+ * Names share long prefixes so that string comparisons are not decided by
+ * their first character.
+ */
+static void make_index(USB::DirIndex &index, unsigned int level)
+{
+    std::vector<char> names;
+    std::vector<uint32_t> offsets;
+    char buffer[64];
+
+    for(size_t i = 0; i < entries_per_directory; ++i)
+    {
+        if(i < directories_per_directory)
+            snprintf(buffer, sizeof(buffer), "Level %02u - Album %05zu", level, i);
+        else
+            snprintf(buffer, sizeof(buffer), "Level %02u - Track %05zu.flac", level, i);
+
+        offsets.push_back(names.size());
+        names.insert(names.end(), buffer, buffer + strlen(buffer) + 1);
+    }
+
+    index.assign(names.data(), names.size(), offsets.data(), offsets.size(),
+                 directories_per_directory);
+}
+
+/*!
+ * Look up name by comparing it with each entry, in list order.
+ *
+ * This is how paths were resolved before #USB::DirIndex::find_by_name() was
+ * introduced.
+ */
+static bool linear_find(const USB::DirIndex &index, const char *name,
+                        size_t &pos)
+{
+    for(pos = 0; pos < index.size(); ++pos)
+        if(strcmp(index.get_name(pos), name) == 0)
+            return true;
+
+    return false;
+}
+
+/*!\test
+ * Resolve many random paths of 10 directories, each containing 10000
+ * entries.
+ *
+ * Only directories are looked up, and they come first in each directory, so
+ * the linear scan is measured at its best.
+ */
+void test_resolve_deep_paths(void)
+{
+    std::array<USB::DirIndex, path_depth> levels;
+
+    for(size_t i = 0; i < levels.size(); ++i)
+        make_index(levels[i], i);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, directories_per_directory - 1);
+    std::vector<std::array<std::string, path_depth>> paths(number_of_paths);
+    std::vector<std::array<size_t, path_depth>> expected(number_of_paths);
+
+    for(size_t p = 0; p < number_of_paths; ++p)
+    {
+        for(size_t i = 0; i < path_depth; ++i)
+        {
+            expected[p][i] = pick(rng);
+            paths[p][i] = levels[i].get_name(expected[p][i]);
+        }
+    }
+
+    const auto resolve_all =
+        [&levels, &paths, &expected]
+        (bool (*find)(const USB::DirIndex &, const char *, size_t &))
+        {
+            size_t found = 0;
+            StopWatch sw;
+
+            for(size_t p = 0; p < number_of_paths; ++p)
+            {
+                for(size_t i = 0; i < path_depth; ++i)
+                {
+                    size_t pos;
+
+                    if(find(levels[i], paths[p][i].c_str(), pos) &&
+                       pos == expected[p][i])
+                        ++found;
+                }
+            }
+
+            const auto duration = sw.elapsed();
+            cppcut_assert_equal(number_of_paths * path_depth, found);
+
+            return duration;
+        };
+
+    report("linear scan",
+           resolve_all(linear_find));
+    report("binary search",
+           resolve_all([] (const USB::DirIndex &index, const char *name, size_t &pos)
+                       {
+                           return index.find_by_name(name, pos);
+                       }));
+}
+
+}
+
+/*!@}*/
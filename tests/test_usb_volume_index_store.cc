@@ -0,0 +1,429 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of T+A List Brokers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cppcutter.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <cstddef>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "mock_messages.hh"
+
+#include "usb_volume_index_store.hh"
+
+/*!
+ * \addtogroup usb_volume_index_store_tests Unit tests
+ * \ingroup usb
+ *
+ * Stored volume index file format unit tests.
+ */
+/*!@{*/
+
+struct FakeDirEntry
+{
+    const char *name_;
+    unsigned char dtype_;
+};
+
+/* directories "read" by #USB::DirIndex::read_from_file_system(), by path */
+static std::map<std::string, std::vector<FakeDirEntry>> fake_directories;
+
+extern "C" int os_foreach_in_path(const char *path,
+                                  int (*callback)(const char *path,
+                                                  unsigned char dtype,
+                                                  void *user_data),
+                                  void *user_data)
+{
+    const auto it = fake_directories.find(path);
+
+    if(it == fake_directories.end())
+        return -1;
+
+    for(const auto &e : it->second)
+        callback(e.name_, e.dtype_, user_data);
+
+    return 0;
+}
+
+namespace usb_volume_index_store_tests
+{
+
+static MockMessages *mock_messages;
+static std::string temp_dir;
+static std::string index_file;
+
+static constexpr uint64_t fingerprint = 0x0123456789abcdefULL;
+
+void cut_setup(void)
+{
+    mock_messages = new MockMessages;
+    cppcut_assert_not_null(mock_messages);
+    mock_messages->init();
+    mock_messages_singleton = mock_messages;
+
+    mock_messages->ignore_messages_with_level_or_above(MESSAGE_LEVEL_DIAG);
+
+    char dir[] = "/tmp/test_usb_volume_index_store.XXXXXX";
+    cppcut_assert_not_null(mkdtemp(dir));
+    temp_dir = dir;
+    index_file = temp_dir + "/index";
+
+    fake_directories.clear();
+    fake_directories["/mnt/usb"] =
+        { {"music", DT_DIR}, {"readme.txt", DT_REG}, {"Photos", DT_DIR}, };
+    fake_directories["/mnt/usb/music"] =
+        { {"b.flac", DT_REG}, {"a.flac", DT_REG}, {"c.flac", DT_REG},
+          {"Live", DT_DIR}, };
+    fake_directories["/mnt/usb/Photos"] = {};
+}
+
+void cut_teardown(void)
+{
+    unlink(index_file.c_str());
+    unlink((index_file + ".tmp").c_str());
+    rmdir(temp_dir.c_str());
+
+    fake_directories.clear();
+
+    mock_messages->check();
+    mock_messages_singleton = nullptr;
+    delete mock_messages;
+    mock_messages = nullptr;
+}
+
+static struct timespec make_mtime(time_t sec, long nsec = 0)
+{
+    struct timespec ts;
+    ts.tv_sec = sec;
+    ts.tv_nsec = nsec;
+    return ts;
+}
+
+/*!
+ * Paths of the fake directories relative to the mountpoint, sorted.
+ */
+static const std::vector<std::string> stored_paths { "", "Photos", "music", };
+
+static std::shared_ptr<const USB::DirIndex> read_index(const std::string &path)
+{
+    auto index = std::make_shared<USB::DirIndex>();
+    cut_assert_true(index->read_from_file_system("/mnt/usb" + (path.empty() ? "" : "/" + path)));
+    return index;
+}
+
+/*!
+ * Write index file containing all fake directories, with modification times
+ * 1000, 1001, and so on, in order of #stored_paths.
+ */
+static void write_index_file()
+{
+    USB::VolumeIndexWriter writer;
+
+    /* not sorted, the writer takes care of that */
+    for(size_t i = stored_paths.size(); i-- > 0;)
+        writer.add_directory(stored_paths[i], make_mtime(1000 + i),
+                             read_index(stored_paths[i]));
+
+    cppcut_assert_equal(stored_paths.size(), writer.get_number_of_directories());
+    cut_assert_true(writer.write(index_file, fingerprint));
+}
+
+static std::string read_file(const std::string &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string &filename, const std::string &content)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+static void patch_u32(std::string &content, size_t offset, uint32_t value)
+{
+    content.replace(offset, sizeof(value),
+                    reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static size_t directory_record_offset(size_t idx, size_t field_offset)
+{
+    return sizeof(USB::VolumeIndexFormat::FileHeader) +
+           idx * sizeof(USB::VolumeIndexFormat::DirectoryRecord) +
+           field_offset;
+}
+
+static void expect_equal_indexes(const USB::DirIndex &expected,
+                                 const USB::DirIndex &index)
+{
+    cppcut_assert_equal(expected.size(), index.size());
+    cppcut_assert_equal(expected.get_number_of_directories(),
+                        index.get_number_of_directories());
+
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+        cppcut_assert_equal(std::string(expected.get_name(i)),
+                            std::string(index.get_name(i)));
+        cppcut_assert_equal(expected.get_kind(i).is_directory(),
+                            index.get_kind(i).is_directory());
+    }
+}
+
+/*!\test
+ * Directory indexes written to a volume index file can be restored.
+ */
+void test_write_and_lookup_round_trip(void)
+{
+    write_index_file();
+
+    USB::VolumeIndexFile file;
+    cut_assert_true(file.open(index_file, fingerprint));
+    cut_assert_true(file.is_open());
+    cppcut_assert_equal(stored_paths.size(), file.get_number_of_directories());
+
+    for(size_t i = 0; i < stored_paths.size(); ++i)
+    {
+        const auto index(file.lookup(stored_paths[i], make_mtime(1000 + i)));
+        cppcut_assert_not_null(index.get());
+        expect_equal_indexes(*read_index(stored_paths[i]), *index);
+    }
+
+    const auto music(file.lookup("music", make_mtime(1002)));
+    size_t pos;
+    cut_assert_true(music->find("Live", true, pos));
+    cppcut_assert_equal(size_t(0), pos);
+    cut_assert_true(music->find("b.flac", false, pos));
+    cppcut_assert_equal(size_t(2), pos);
+
+    cppcut_assert_null(file.lookup("music/Live", make_mtime(1002)).get());
+    cppcut_assert_null(file.lookup("mus", make_mtime(1002)).get());
+}
+
+/*!\test
+ * Volume index files of other file systems are ignored without error.
+ */
+void test_fingerprint_mismatch_is_not_an_error(void)
+{
+    write_index_file();
+
+    USB::VolumeIndexFile file;
+    cut_assert_false(file.open(index_file, fingerprint + 1));
+    cut_assert_false(file.is_open());
+    cppcut_assert_null(file.lookup("", make_mtime(1000)).get());
+
+    cut_assert_true(file.open(index_file, fingerprint));
+}
+
+/*!\test
+ * Directories modified after they have been stored are not restored.
+ */
+void test_modified_directories_are_not_restored(void)
+{
+    write_index_file();
+
+    USB::VolumeIndexFile file;
+    cut_assert_true(file.open(index_file, fingerprint));
+
+    cppcut_assert_null(file.lookup("music", make_mtime(1003)).get());
+    cppcut_assert_null(file.lookup("music", make_mtime(1002, 1)).get());
+    cppcut_assert_not_null(file.lookup("music", make_mtime(1002)).get());
+}
+
+/*!\test
+ * A missing volume index file is not an error.
+ */
+void test_missing_file_is_not_an_error(void)
+{
+    USB::VolumeIndexFile file;
+    cut_assert_false(file.open(index_file, fingerprint));
+    cut_assert_false(file.is_open());
+    cppcut_assert_null(file.lookup("", make_mtime(1000)).get());
+}
+
+/*!\test
+ * Files which are not volume indexes are rejected.
+ */
+void test_file_with_bad_magic_is_rejected(void)
+{
+    write_file(index_file, std::string(64, 'x'));
+
+    USB::VolumeIndexFile file;
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Ignoring volume index " + index_file + ": bad magic").c_str());
+    cut_assert_false(file.open(index_file, fingerprint));
+    cut_assert_false(file.is_open());
+}
+
+/*!\test
+ * Truncated volume index files are rejected.
+ */
+void test_truncated_file_is_rejected(void)
+{
+    write_index_file();
+
+    const auto content(read_file(index_file));
+
+    write_file(index_file, content.substr(0, content.size() - 1));
+
+    USB::VolumeIndexFile file;
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Ignoring volume index " + index_file + ": size mismatch").c_str());
+    cut_assert_false(file.open(index_file, fingerprint));
+
+    write_file(index_file, content.substr(0, 10));
+
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Ignoring volume index " + index_file + ": file too short").c_str());
+    cut_assert_false(file.open(index_file, fingerprint));
+    cut_assert_false(file.is_open());
+}
+
+/*!\test
+ * Directories with offsets pointing outside the file are detected on lookup
+ * and are not restored, other directories are still usable.
+ */
+void test_directories_with_bad_offsets_are_not_restored(void)
+{
+    write_index_file();
+
+    auto content(read_file(index_file));
+
+    patch_u32(content,
+              directory_record_offset(0, offsetof(USB::VolumeIndexFormat::DirectoryRecord,
+                                                  first_offset_)),
+              0xffffff00);
+    patch_u32(content,
+              directory_record_offset(1, offsetof(USB::VolumeIndexFormat::DirectoryRecord,
+                                                  names_offset_)),
+              0xffffff00);
+    write_file(index_file, content);
+
+    USB::VolumeIndexFile file;
+    cut_assert_true(file.open(index_file, fingerprint));
+
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Volume index " + index_file + ": directory 0 is corrupt").c_str());
+    cppcut_assert_null(file.lookup("", make_mtime(1000)).get());
+
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Volume index " + index_file + ": directory 1 is corrupt").c_str());
+    cppcut_assert_null(file.lookup("Photos", make_mtime(1001)).get());
+
+    cppcut_assert_not_null(file.lookup("music", make_mtime(1002)).get());
+}
+
+/*!\test
+ * Directories with a path pointing outside the file cannot be found.
+ */
+void test_directories_with_bad_path_are_not_found(void)
+{
+    write_index_file();
+
+    auto content(read_file(index_file));
+
+    patch_u32(content,
+              directory_record_offset(1, offsetof(USB::VolumeIndexFormat::DirectoryRecord,
+                                                  path_length_)),
+              0xffffffff);
+    write_file(index_file, content);
+
+    USB::VolumeIndexFile file;
+    cut_assert_true(file.open(index_file, fingerprint));
+
+    cppcut_assert_null(file.lookup("", make_mtime(1000)).get());
+    cppcut_assert_null(file.lookup("Photos", make_mtime(1001)).get());
+    cppcut_assert_null(file.lookup("music", make_mtime(1002)).get());
+}
+
+/*!\test
+ * Directories whose names are not sorted are not restored because they
+ * could not be searched.
+ */
+void test_directories_with_unsorted_names_are_not_restored(void)
+{
+    write_index_file();
+
+    auto content(read_file(index_file));
+
+    /* swap offsets of "a.flac" and "b.flac" in directory "music", which
+     * are the second and third entry of the third directory */
+    const size_t offsets_start =
+        directory_record_offset(stored_paths.size(), 0) +
+        (read_index("")->size() + read_index("Photos")->size()) * sizeof(uint32_t);
+    const std::string first(content.substr(offsets_start + 1 * sizeof(uint32_t),
+                                           sizeof(uint32_t)));
+    const std::string second(content.substr(offsets_start + 2 * sizeof(uint32_t),
+                                            sizeof(uint32_t)));
+    content.replace(offsets_start + 1 * sizeof(uint32_t), sizeof(uint32_t), second);
+    content.replace(offsets_start + 2 * sizeof(uint32_t), sizeof(uint32_t), first);
+    write_file(index_file, content);
+
+    USB::VolumeIndexFile file;
+    cut_assert_true(file.open(index_file, fingerprint));
+
+    mock_messages->expect_msg_error_formatted(0, LOG_NOTICE,
+        ("Volume index " + index_file + ": directory 2 is corrupt").c_str());
+    cppcut_assert_null(file.lookup("music", make_mtime(1002)).get());
+    cppcut_assert_not_null(file.lookup("", make_mtime(1000)).get());
+}
+
+/*!\test
+ * Unsorted directory records do not lead to wrong directories being
+ * restored, they may just not be found.
+ */
+void test_unsorted_directory_records_do_not_restore_wrong_directories(void)
+{
+    write_index_file();
+
+    auto content(read_file(index_file));
+
+    /* swap records of "" and "music" */
+    const size_t record_size = sizeof(USB::VolumeIndexFormat::DirectoryRecord);
+    const std::string first(content.substr(directory_record_offset(0, 0), record_size));
+    const std::string third(content.substr(directory_record_offset(2, 0), record_size));
+    content.replace(directory_record_offset(0, 0), record_size, third);
+    content.replace(directory_record_offset(2, 0), record_size, first);
+    write_file(index_file, content);
+
+    USB::VolumeIndexFile file;
+    cut_assert_true(file.open(index_file, fingerprint));
+
+    for(size_t i = 0; i < stored_paths.size(); ++i)
+    {
+        const auto index(file.lookup(stored_paths[i], make_mtime(1000 + i)));
+
+        if(index != nullptr)
+            expect_equal_indexes(*read_index(stored_paths[i]), *index);
+    }
+
+    cppcut_assert_not_null(file.lookup("Photos", make_mtime(1001)).get());
+}
+
+}
+
+/*!@}*/